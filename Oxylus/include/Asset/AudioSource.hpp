@@ -2,6 +2,7 @@
 
 #include "Oxylus.hpp"
 
+struct ma_engine;
 struct ma_sound;
 
 namespace ox {
@@ -11,11 +12,33 @@ public:
   AudioSource() = default;
   ~AudioSource();
 
+  AudioSource(const AudioSource&) = delete;
+  auto operator=(const AudioSource&) -> AudioSource& = delete;
+  AudioSource(AudioSource&& other) noexcept;
+  auto operator=(AudioSource&& other) noexcept -> AudioSource&;
+
+  // Files smaller than `audio.stream_min_kb` are decoded once into the resource manager's
+  // shared PCM cache, bigger ones are streamed from disk in pages. Both load in the background.
   auto load(const std::string& path) -> bool;
+  // Loads into `engine` instead of the app's audio engine.
+  auto load(const std::string& path, ma_engine* engine_) -> bool;
   auto unload() -> void;
   auto get_source() -> ma_sound*;
 
+  // Initializes another playable instance of this source. Decoded sources share their PCM
+  // with it, streamed ones get their own stream.
+  auto init_instance(ma_sound* sound) const -> bool;
+
+  auto is_streamed() const -> bool { return streamed; }
+  auto get_load_millis() const -> f64 { return load_millis; }
+
 private:
+  ma_engine* engine = nullptr;
   ma_sound* _sound = nullptr;
+  std::string path = {};
+  bool streamed = false;
+  f64 load_millis = 0.0;
+
+  auto get_flags() const -> u32;
 };
 } // namespace ox
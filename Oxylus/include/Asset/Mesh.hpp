@@ -2,6 +2,7 @@
 
 #include <vuk/Buffer.hpp>
 
+#include "Asset/MeshQuantization.hpp"
 #include "Core/UUID.hpp"
 namespace ox {
 
@@ -11,12 +12,24 @@ struct Mesh {
   constexpr static auto MAX_MESHLET_INDICES = 64_sz;
   constexpr static auto MAX_MESHLET_PRIMITIVES = 64_sz;
 
+  // Level 0 is full detail, every following level has about half the triangles.
+  constexpr static auto MAX_LODS = 8_sz;
+  constexpr static auto LOD_REDUCTION = 0.5f;
+  // Simplification error cap relative to the primitive's extents.
+  constexpr static auto LOD_MAX_ERROR = 0.05f;
+
   using Index = u32;
 
+  struct LOD {
+    u32 meshlet_offset = 0;
+    u32 meshlet_count = 0;
+    // Object space distance the simplified surface may deviate from the original, 0 for level 0.
+    f32 error = 0.0f;
+  };
+
   struct Primitive {
     u32 material_index = 0;
-    u32 meshlet_count = 0;
-    u32 meshlet_offset = 0;
+    std::vector<LOD> lods = {};
     u32 local_triangle_indices_offset = 0;
     u32 vertex_count = 0;
     u32 vertex_offset = 0;
@@ -27,6 +40,17 @@ struct Mesh {
   struct GLTFMesh {
     std::string name = {};
     std::vector<u32> primitive_indices = {};
+    // Object space bounding sphere, used to project LOD errors.
+    glm::vec3 bounds_center = {};
+    f32 bounds_radius = 0.0f;
+    // Half size of the object space box around `bounds_center`.
+    glm::vec3 bounds_extent = {};
+    // Grid of the quantized positions of every primitive of this mesh.
+    mesh_quantization::PositionBounds position_bounds = {};
+    // Triangles of every primitive with only the vertices they use, kept on the CPU for
+    // software occlusion culling. Meant for simple meshes like walls and terrain.
+    std::vector<glm::vec3> occluder_positions = {};
+    std::vector<u32> occluder_indices = {};
   };
 
   struct Node {
@@ -54,6 +78,11 @@ struct Mesh {
 
   usize indices_count = 0;
 
+  // Vertex streams are quantized, see `mesh_quantization`.
+  bool quantized_vertices = false;
+  // GPU size of the position, normal and texture coordinate streams.
+  usize vertex_bytes = 0;
+
   vuk::Unique<vuk::Buffer> indices = vuk::Unique<vuk::Buffer>();
   vuk::Unique<vuk::Buffer> vertex_positions = vuk::Unique<vuk::Buffer>();
   vuk::Unique<vuk::Buffer> vertex_normals = vuk::Unique<vuk::Buffer>();
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Asset/Mesh.hpp"
+
+namespace ox::mesh_lod {
+struct Level {
+  std::vector<u32> indices = {};
+  // Object space error, accumulated over the chain.
+  f32 error = 0.0f;
+};
+
+struct BuildInfo {
+  usize max_levels = Mesh::MAX_LODS;
+  f32 reduction = Mesh::LOD_REDUCTION;
+  f32 max_error = Mesh::LOD_MAX_ERROR;
+  // Stop once a level keeps more than this fraction of its parent, the simplifier got stuck.
+  f32 min_progress = 0.9f;
+  usize min_index_count = 3 * 16;
+};
+
+// Simplifies `indices` repeatedly with meshoptimizer, each level from the previous one.
+// Returns only the simplified levels, level 0 is the input itself.
+auto build_lod_chain(std::span<const u32> indices,
+                     std::span<const glm::vec3> positions,
+                     const BuildInfo& info = {}) -> std::vector<Level>;
+
+struct SelectInfo {
+  glm::vec3 camera_position = {};
+  // Pixels per unit of view space size at distance 1, see `get_projection_scale`.
+  f32 projection_scale = 0.0f;
+  f32 error_threshold_pixels = 1.0f;
+  // Fraction of the threshold a level has to be under before switching to it from a finer
+  // one, so instances sitting at the threshold don't flip between levels every frame.
+  f32 hysteresis = 0.0f;
+  bool orthographic = false;
+};
+
+// `previous_lod` of an instance that had no level selected last frame.
+constexpr static auto NO_PREVIOUS_LOD = ~0_u32;
+
+auto get_projection_scale(const glm::mat4& projection, f32 viewport_height) -> f32;
+
+// Screen space size in pixels of `world_error` for a sphere, measured at its closest point.
+auto get_projected_error(f32 world_error, const glm::vec3& center, f32 radius, const SelectInfo& info) -> f32;
+
+// Coarsest level whose projected error stays under the threshold, levels coarser than
+// `previous_lod` have to stay under the threshold reduced by the hysteresis.
+auto select_lod(std::span<const Mesh::LOD> lods,
+                const glm::mat4& world,
+                const glm::vec3& bounds_center,
+                f32 bounds_radius,
+                const SelectInfo& info,
+                u32 previous_lod = NO_PREVIOUS_LOD) -> u32;
+} // namespace ox::mesh_lod
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Oxylus.hpp"
+
+namespace ox::mesh_optimizer {
+// Reorders triangles for the post transform cache and overdraw, then vertices in fetch
+// order. All vertex streams are remapped in place, `indices` is rewritten to match.
+// `tex_coords` may be empty. Returns the number of referenced vertices, they come first.
+auto optimize_primitive(std::span<u32> indices,
+                        std::span<glm::vec3> positions,
+                        std::span<glm::vec3> normals,
+                        std::span<glm::vec2> tex_coords) -> usize;
+
+// Average cache miss ratio per triangle for a 16 entry FIFO, 0.5 is ideal and 3 is the worst.
+// Not computed at load, see the mesh_optimizer_corpus_report benchmark.
+auto get_acmr(std::span<const u32> indices, usize vertex_count) -> f32;
+} // namespace ox::mesh_optimizer
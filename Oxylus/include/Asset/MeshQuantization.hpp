@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Oxylus.hpp"
+
+namespace ox::mesh_quantization {
+// Positions are stored as 16 bit unorms relative to the bounds of their glTF mesh, xy in
+// the first word and z in the low half of the second one. Every primitive of a mesh uses
+// the same grid, so shared edges between primitives and meshlets stay watertight, while
+// small meshes of a large model keep their own precision.
+struct PositionBounds {
+  glm::vec3 min = {};
+  glm::vec3 extent = {};
+};
+
+auto get_position_bounds(std::span<const glm::vec3> positions) -> PositionBounds;
+
+auto encode_position(const glm::vec3& position, const PositionBounds& bounds) -> glm::uvec2;
+auto decode_position(const glm::uvec2& encoded, const PositionBounds& bounds) -> glm::vec3;
+
+// Octahedral normal, 16 bit snorm per component.
+auto encode_normal(const glm::vec3& normal) -> u32;
+auto decode_normal(u32 encoded) -> glm::vec3;
+
+// Half precision texture coordinates, steps are 1/2048 between 0.5 and 1 and grow with magnitude.
+auto encode_tex_coord(const glm::vec2& tex_coord) -> u32;
+auto decode_tex_coord(u32 encoded) -> glm::vec2;
+} // namespace ox::mesh_quantization
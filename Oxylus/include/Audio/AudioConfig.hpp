@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Utils/CVars.hpp"
+
+namespace ox {
+namespace AudioCVar {
+// clang-format off
+inline AutoCVar_Int cvar_max_voices("audio.max_voices", "maximum number of sounds mixed at once, quieter or lower priority voices are virtualized", 32);
+inline AutoCVar_Float cvar_virtual_gain("audio.virtual_gain", "voices with an estimated gain below this are virtualized", 0.001f);
+inline AutoCVar_Float cvar_rank_interval_ms("audio.rank_interval_ms", "how often playing voices are ranked again when nothing started or stopped, in milliseconds", 100.0f);
+inline AutoCVar_Int cvar_stream_min_kb("audio.stream_min_kb", "audio files at least this big in kilobytes are streamed from disk instead of decoded up front", 1024);
+inline AutoCVar_Int cvar_job_threads("audio.job_threads", "threads that decode and stream audio in the background", 1);
+inline AutoCVar_Int cvar_null_backend("audio.null_backend", "mix into miniaudio's null backend instead of an audio device, read at startup", 0);
+// clang-format on
+} // namespace AudioCVar
+} // namespace ox
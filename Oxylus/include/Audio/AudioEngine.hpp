@@ -1,8 +1,11 @@
 #pragma once
 
+#include "Audio/AudioVoiceManager.hpp"
 #include "Core/ESystem.hpp"
 
 struct ma_engine;
+struct ma_context;
+struct ma_resource_manager;
 struct ma_sound;
 
 namespace ox {
@@ -13,8 +16,10 @@ public:
 
   auto init() -> std::expected<void, std::string> override;
   auto deinit() -> std::expected<void, std::string> override;
+  auto on_update() -> void override;
 
   auto get_engine() const -> ma_engine*;
+  auto get_voice_manager() -> AudioVoiceManager& { return voice_manager; }
 
   // -- Source --
   auto play_source(ma_sound* sound) -> void;
@@ -45,5 +50,8 @@ public:
 
 private:
   ma_engine* engine = nullptr;
+  ma_context* context = nullptr;
+  ma_resource_manager* resource_manager = nullptr;
+  AudioVoiceManager voice_manager = {};
 };
 } // namespace ox
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <flecs.h>
+
+#include "Oxylus.hpp"
+
+namespace ox {
+// Audio sources whose voice needs new parameters. Marking an entity marks every source below
+// it as well, their world transform moved with it. Each entity is visited once until `clear`,
+// so a frame costs as much as the subtrees that changed, not as many sources as the scene has.
+class AudioSourceTracker {
+public:
+  auto mark_dirty(flecs::entity entity) -> void;
+  auto clear() -> void;
+
+  // Entities with an `AudioSourceComponent` marked since the last `clear`, some may be dead by now.
+  auto get_dirty() const -> std::span<const flecs::entity> { return dirty_sources; }
+  auto get_visited_count() const -> u32 { return static_cast<u32>(visited.size()); }
+
+private:
+  std::vector<flecs::entity> dirty_sources = {};
+  ankerl::unordered_dense::set<flecs::entity_t> visited = {};
+};
+} // namespace ox
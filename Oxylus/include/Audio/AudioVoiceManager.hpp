@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Memory/SlotMap.hpp"
+#include "Oxylus.hpp"
+
+struct ma_sound;
+
+namespace ox {
+class AudioEngine;
+class AudioSource;
+
+enum class AudioVoiceID : u64 { Invalid = std::numeric_limits<u64>::max() };
+
+enum class AudioVoiceDirty : u32 {
+  None = 0,
+  Attenuation = 1 << 0,
+  Volume = 1 << 1,
+  Pitch = 1 << 2,
+  Looping = 1 << 3,
+  Spatialization = 1 << 4,
+  RollOff = 1 << 5,
+  Gain = 1 << 6,
+  Distance = 1 << 7,
+  Cone = 1 << 8,
+  Doppler = 1 << 9,
+  Position = 1 << 10,
+  Direction = 1 << 11,
+  All = (1 << 12) - 1,
+};
+consteval void enable_bitmask(AudioVoiceDirty);
+
+struct AudioVoiceParams {
+  u32 attenuation_model = 1;
+  f32 volume = 1.0f;
+  f32 pitch = 1.0f;
+  bool looping = false;
+  bool spatialization = false;
+  f32 roll_off = 1.0f;
+  f32 min_gain = 0.0f;
+  f32 max_gain = 1.0f;
+  f32 min_distance = 0.3f;
+  f32 max_distance = 1000.0f;
+  f32 cone_inner_angle = glm::radians(360.0f);
+  f32 cone_outer_angle = glm::radians(360.0f);
+  f32 cone_outer_gain = 0.0f;
+  f32 doppler_factor = 1.0f;
+  glm::vec3 position = {};
+  glm::vec3 direction = {0.0f, 0.0f, -1.0f};
+
+  // Fields of `other` that differ from this one.
+  auto diff(const AudioVoiceParams& other) const -> AudioVoiceDirty;
+};
+
+struct AudioVoiceStats {
+  u32 voice_count = 0;
+  u32 playing_count = 0;
+  u32 real_count = 0;
+  u32 virtual_count = 0;
+  // Per update.
+  u32 parameter_updates = 0;
+  u32 virtualized_count = 0;
+  u32 resumed_count = 0;
+};
+
+// Owns one sound instance per voice and decides which of the playing voices are actually
+// mixed. Parameters are only forwarded to miniaudio when they changed, so idle voices cost
+// nothing per frame. When more than `audio.max_voices` voices play, the ones with the lowest
+// priority and estimated gain become virtual: their sound is stopped and only a start time is
+// kept, when they become audible again the sound seeks to where it would have been.
+class AudioVoiceManager {
+public:
+  AudioVoiceManager() = default;
+  ~AudioVoiceManager() = default;
+
+  AudioVoiceManager(const AudioVoiceManager&) = delete;
+  auto operator=(const AudioVoiceManager&) -> AudioVoiceManager& = delete;
+
+  auto init(AudioEngine* audio_engine) -> void;
+  auto deinit() -> void;
+
+  // `source` is only used to create the voice's own instance, it can be unloaded afterwards.
+  auto create_voice(const AudioSource& source, const AudioVoiceParams& params, i32 priority = 0) -> AudioVoiceID;
+  auto destroy_voice(AudioVoiceID voice_id) -> void;
+
+  auto set_params(AudioVoiceID voice_id, const AudioVoiceParams& params) -> void;
+  // Higher priorities are mixed first, distance only decides between equal priorities.
+  auto set_priority(AudioVoiceID voice_id, i32 priority) -> void;
+
+  auto play(AudioVoiceID voice_id) -> void;
+  auto pause(AudioVoiceID voice_id) -> void;
+  auto unpause(AudioVoiceID voice_id) -> void;
+  auto stop(AudioVoiceID voice_id) -> void;
+  // True for virtual voices too.
+  auto is_playing(AudioVoiceID voice_id) -> bool;
+  auto is_virtual(AudioVoiceID voice_id) -> bool;
+
+  auto update(f64 delta_time) -> void;
+
+  auto get_stats() const -> const AudioVoiceStats& { return stats; }
+
+private:
+  enum class State : u32 { Stopped = 0, Playing, Paused };
+
+  struct Voice {
+    ma_sound* sound = nullptr;
+    AudioVoiceParams params = {};
+    AudioVoiceDirty dirty = AudioVoiceDirty::None;
+    i32 priority = 0;
+    State state = State::Stopped;
+    // Whether the sound is started and takes one of the mixed voices.
+    bool is_real = false;
+    bool is_queued_dirty = false;
+    bool is_queued_playing = false;
+    f64 length_seconds = 0.0;
+    // Playback position at `cursor_time`, while virtual the position is derived from the clock.
+    f64 cursor_seconds = 0.0;
+    f64 cursor_time = 0.0;
+  };
+
+  struct RankEntry {
+    AudioVoiceID voice_id = AudioVoiceID::Invalid;
+    Voice* voice = nullptr;
+    i32 priority = 0;
+    f32 audibility = 0.0f;
+  };
+
+  AudioEngine* engine = nullptr;
+  SlotMap<Voice, AudioVoiceID> voices = {};
+  std::vector<AudioVoiceID> dirty_voices = {};
+  std::vector<AudioVoiceID> playing_voices = {};
+  std::vector<RankEntry> rank_entries = {};
+
+  f64 time = 0.0;
+  f64 last_rank_time = 0.0;
+  bool needs_rank = false;
+  AudioVoiceStats stats = {};
+
+  auto mark_dirty(AudioVoiceID voice_id, Voice& voice, AudioVoiceDirty dirty) -> void;
+  auto mark_playing(AudioVoiceID voice_id, Voice& voice) -> void;
+  auto apply_params(Voice& voice) -> void;
+  auto get_virtual_cursor(const Voice& voice) const -> f64;
+  auto make_real(Voice& voice) -> bool;
+  auto make_virtual(Voice& voice) -> void;
+  auto rank_voices(const glm::vec3& listener_position) -> void;
+};
+} // namespace ox
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <memory_resource>
+
+#include "Oxylus.hpp"
+
+namespace ox::memory {
+struct FrameArenaStats {
+  // Every allocation served by the arena is a heap allocation that didn't happen.
+  u64 allocation_count = 0;
+  u64 allocated_bytes = 0;
+  // Requests that didn't fit and fell back to the heap.
+  u64 overflow_count = 0;
+  u64 overflow_bytes = 0;
+};
+
+// Double-buffered linear allocator for data that lives at most until the end of the next frame.
+// Memory allocated during frame N stays valid until `begin_frame()` of frame N + 2, so data
+// produced in one frame can still be consumed by GPU passes recorded in the same frame or by
+// systems that run one frame behind. Allocation is a single atomic bump and is thread safe,
+// deallocation is a no-op. `begin_frame()` must only be called on the main thread.
+class FrameArena {
+public:
+  constexpr static usize BUFFER_COUNT = 2;
+  constexpr static usize DEFAULT_CAPACITY = ox::mib_to_bytes(16);
+
+  explicit FrameArena(usize capacity = DEFAULT_CAPACITY);
+  ~FrameArena();
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena(FrameArena&&) = delete;
+  auto operator=(const FrameArena&) -> FrameArena& = delete;
+  auto operator=(FrameArena&&) -> FrameArena& = delete;
+
+  auto begin_frame() -> void;
+
+  // Returns nullptr when the current frame buffer is exhausted.
+  auto alloc(usize size, usize alignment = alignof(std::max_align_t)) -> void*;
+
+  template <typename T>
+  auto alloc(usize count) -> std::span<T> {
+    auto* ptr = static_cast<T*>(alloc(sizeof(T) * count, alignof(T)));
+    if (!ptr)
+      return {};
+
+    return {ptr, count};
+  }
+
+  auto owns(const void* ptr) const -> bool;
+
+  auto get_frame_index() const -> u64 { return frame_index; }
+  // Whether memory allocated during `frame` is still valid.
+  auto is_alive(u64 frame) const -> bool { return frame <= frame_index && frame_index - frame < BUFFER_COUNT; }
+
+  // pmr adapter that allocates from the current frame buffer and falls back to the heap
+  // when the buffer is exhausted. The resource itself is stable across frames, containers
+  // built on it must be recreated every frame since their memory does not survive the flip.
+  auto get_resource() -> std::pmr::memory_resource* { return &resource; }
+
+  auto get_capacity() const -> usize { return capacity; }
+  auto get_used_bytes() const -> usize;
+  auto get_peak_bytes() const -> usize { return peak_bytes; }
+  // Stats of the last completed frame.
+  auto get_stats() const -> const FrameArenaStats& { return last_frame_stats; }
+
+private:
+  class Resource final : public std::pmr::memory_resource {
+  public:
+    explicit Resource(FrameArena* arena_) : arena(arena_) {}
+
+  private:
+    FrameArena* arena = nullptr;
+
+    auto do_allocate(usize bytes, usize alignment) -> void* override;
+    auto do_deallocate(void* ptr, usize bytes, usize alignment) -> void override;
+    auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override;
+  };
+
+  struct Buffer {
+    u8* data = nullptr;
+    std::atomic<usize> offset = 0;
+  };
+
+  usize capacity = 0;
+  u64 frame_index = 0;
+  usize peak_bytes = 0;
+  Buffer buffers[BUFFER_COUNT] = {};
+  Resource resource;
+
+  std::atomic<u64> allocation_count = 0;
+  std::atomic<u64> allocated_bytes = 0;
+  std::atomic<u64> overflow_count = 0;
+  std::atomic<u64> overflow_bytes = 0;
+  FrameArenaStats last_frame_stats = {};
+
+  auto current_buffer() -> Buffer& { return buffers[frame_index % BUFFER_COUNT]; }
+  auto current_buffer() const -> const Buffer& { return buffers[frame_index % BUFFER_COUNT]; }
+};
+
+auto get_frame_arena() -> FrameArena&;
+} // namespace ox::memory
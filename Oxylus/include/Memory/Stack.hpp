@@ -6,10 +6,24 @@
 
 namespace ox::memory {
 struct ThreadStack {
+  constexpr static usize STACK_SIZE = ox::mib_to_bytes(32);
+
+  u8* begin = nullptr;
+  u8* end = nullptr;
   u8* ptr = nullptr;
 
   ThreadStack();
   ~ThreadStack();
+
+  auto available() const -> usize { return static_cast<usize>(end - ptr); }
+
+  // Checked before anything is written at `ptr`, so an overflow never touches memory past `end`.
+  auto require(usize size) const -> void { OX_ASSERT(size <= available(), "Thread stack overflow!"); }
+
+  auto advance(u8* new_ptr) -> void {
+    OX_ASSERT(new_ptr <= end, "Thread stack overflow!");
+    ptr = new_ptr;
+  }
 };
 
 inline ThreadStack& get_thread_stack() {
@@ -33,8 +47,9 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require(sizeof(T));
     T* v = reinterpret_cast<T*>(stack.ptr);
-    stack.ptr = ox::align_up(stack.ptr + sizeof(T), alignof(T));
+    stack.advance(ox::align_up(stack.ptr + sizeof(T), alignof(T)));
 
     return v;
   }
@@ -44,8 +59,9 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require(sizeof(T) * count);
     T* v = reinterpret_cast<T*>(stack.ptr);
-    stack.ptr = ox::align_up(stack.ptr + sizeof(T) * count, alignof(T));
+    stack.advance(ox::align_up(stack.ptr + sizeof(T) * count, alignof(T)));
 
     return {v, count};
   }
@@ -67,9 +83,9 @@ struct ScopedStack {
 
     auto& stack = get_thread_stack();
     c8* begin = reinterpret_cast<c8*>(stack.ptr);
-    c8* end = fmt::vformat_to(begin, fmt.get(), fmt::make_format_args(args...));
+    c8* end = format_bounded(stack, begin, fmt.get(), fmt::make_format_args(args...));
     *end = '\0';
-    stack.ptr = ox::align_up(reinterpret_cast<u8*>(end + 1), 8);
+    stack.advance(ox::align_up(reinterpret_cast<u8*>(end + 1), 8));
 
     return {begin, end};
   }
@@ -80,9 +96,9 @@ struct ScopedStack {
 
     auto& stack = get_thread_stack();
     c8* begin = reinterpret_cast<c8*>(stack.ptr);
-    c8* end = fmt::vformat_to(begin, fmt.get(), fmt::make_format_args(args...));
+    c8* end = format_bounded(stack, begin, fmt.get(), fmt::make_format_args(args...));
     *end = '\0';
-    stack.ptr = ox::align_up(reinterpret_cast<u8*>(end + 1), 8);
+    stack.advance(ox::align_up(reinterpret_cast<u8*>(end + 1), 8));
 
     return begin;
   }
@@ -91,10 +107,11 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require((simdutf::utf32_length_from_utf8(str.data(), str.length()) + 1) * sizeof(c32));
     auto* begin = reinterpret_cast<c32*>(stack.ptr);
     usize size = simdutf::convert_utf8_to_utf32(str.data(), str.length(), begin);
     begin[size] = L'\0';
-    stack.ptr = ox::align_up(stack.ptr + (size + 1) * sizeof(c32), 8);
+    stack.advance(ox::align_up(stack.ptr + (size + 1) * sizeof(c32), 8));
 
     return {reinterpret_cast<c32*>(begin), size};
   }
@@ -103,10 +120,11 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require((simdutf::utf16_length_from_utf8(str.data(), str.length()) + 1) * sizeof(c16));
     c16* begin = reinterpret_cast<c16*>(stack.ptr);
     usize size = simdutf::convert_utf8_to_utf16(str.data(), str.length(), begin);
     begin[size] = L'\0';
-    stack.ptr = ox::align_up(stack.ptr + (size + 1) * sizeof(c16), 8);
+    stack.advance(ox::align_up(stack.ptr + (size + 1) * sizeof(c16), 8));
 
     return {reinterpret_cast<c16*>(begin), size};
   }
@@ -115,10 +133,11 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require(simdutf::utf8_length_from_utf32(str.data(), str.length()) + 1);
     auto* begin = reinterpret_cast<c8*>(stack.ptr);
     usize size = simdutf::convert_utf32_to_utf8(str.data(), str.length(), begin);
     begin[size] = '\0';
-    stack.ptr = ox::align_up(stack.ptr + size + 1, 8);
+    stack.advance(ox::align_up(stack.ptr + size + 1, 8));
 
     return {begin, size};
   }
@@ -127,10 +146,11 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require(simdutf::utf8_length_from_utf16(str.data(), str.length()) + 1);
     auto* begin = reinterpret_cast<c8*>(stack.ptr);
     usize size = simdutf::convert_utf16_to_utf8(str.data(), str.length(), begin);
     begin[size] = '\0';
-    stack.ptr = ox::align_up(stack.ptr + size + 1, 8);
+    stack.advance(ox::align_up(stack.ptr + size + 1, 8));
 
     return {begin, size};
   }
@@ -145,10 +165,11 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require(str.length() + 1);
     auto* begin = reinterpret_cast<c8*>(stack.ptr);
     std::ranges::copy(str, begin);
     c8* end = reinterpret_cast<c8*>(stack.ptr + str.length());
-    stack.ptr = ox::align_up(reinterpret_cast<u8*>(end + 1), 8);
+    stack.advance(ox::align_up(reinterpret_cast<u8*>(end + 1), 8));
 
     std::transform(begin, end, begin, ::toupper);
     *end = '\0';
@@ -160,10 +181,11 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require(str.length() + 1);
     auto* begin = reinterpret_cast<c8*>(stack.ptr);
     std::ranges::copy(str, begin);
     auto* end = reinterpret_cast<c8*>(stack.ptr + str.length());
-    stack.ptr = ox::align_up(reinterpret_cast<u8*>(end + 1), 8);
+    stack.advance(ox::align_up(reinterpret_cast<u8*>(end + 1), 8));
 
     std::transform(begin, end, begin, ::tolower);
     *end = '\0';
@@ -175,10 +197,11 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require(str.length() + 1);
     auto* begin = reinterpret_cast<c8*>(stack.ptr);
     std::ranges::copy(str, begin);
     auto* end = reinterpret_cast<c8*>(stack.ptr + str.length());
-    stack.ptr = ox::align_up(reinterpret_cast<u8*>(end + 1), 8);
+    stack.advance(ox::align_up(reinterpret_cast<u8*>(end + 1), 8));
 
     *end = '\0';
 
@@ -189,14 +212,26 @@ struct ScopedStack {
     ZoneScoped;
 
     auto& stack = get_thread_stack();
+    stack.require(str.length() + 1);
     auto* begin = reinterpret_cast<c8*>(stack.ptr);
     std::ranges::copy(str, begin);
     auto* end = reinterpret_cast<c8*>(stack.ptr + str.length());
-    stack.ptr = ox::align_up(reinterpret_cast<u8*>(end + 1), 8);
+    stack.advance(ox::align_up(reinterpret_cast<u8*>(end + 1), 8));
 
     *end = '\0';
 
     return begin;
   }
+
+private:
+  // Formats at most up to the end of the stack, leaving room for the terminator.
+  static c8* format_bounded(ThreadStack& stack, c8* begin, fmt::string_view fmt, fmt::format_args args) {
+    stack.require(1);
+    const auto limit = stack.available() - 1;
+    const auto result = fmt::vformat_to_n(begin, limit, fmt, args);
+    OX_ASSERT(result.size <= limit, "Thread stack overflow!");
+
+    return result.out;
+  }
 };
 } // namespace ox::memory
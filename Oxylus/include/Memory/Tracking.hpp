@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+
+#include "Oxylus.hpp"
+
+namespace ox::memory {
+enum class Subsystem : u32 {
+  General = 0,
+  Physics,
+  PhysicsTemp,
+  Lua,
+  Audio,
+
+  Count,
+};
+
+struct SubsystemStats {
+  std::atomic<u64> current_bytes = 0;
+  std::atomic<u64> peak_bytes = 0;
+  std::atomic<u64> allocation_count = 0;
+  std::atomic<u64> free_count = 0;
+};
+
+auto subsystem_to_sv(Subsystem subsystem) -> std::string_view;
+auto get_subsystem_stats(Subsystem subsystem) -> SubsystemStats&;
+
+// Heap allocations that are accounted per subsystem and reported to Tracy as named memory pools.
+auto tracked_alloc(Subsystem subsystem, usize size, usize alignment = alignof(std::max_align_t)) -> void*;
+auto tracked_realloc(Subsystem subsystem, void* ptr, usize new_size) -> void*;
+auto tracked_free(Subsystem subsystem, void* ptr) -> void;
+auto tracked_size(const void* ptr) -> usize;
+} // namespace ox::memory
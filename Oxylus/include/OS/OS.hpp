@@ -10,5 +10,10 @@ auto mem_reserve(u64 size) -> void*;
 auto mem_release(void* data, u64 size = 0) -> void;
 auto mem_commit(void* data, u64 size) -> bool;
 auto mem_decommit(void* data, u64 size) -> void;
+
+//  ── THREAD ──────────────────────────────────────────────────────────
+// Blocks the calling thread for `milliseconds` on a high resolution timer,
+// it usually wakes up well within a millisecond of the deadline.
+auto thread_sleep(f64 milliseconds) -> void;
 } // namespace os
 } // namespace ox
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyID.h>
+#include <Jolt/Physics/Collision/Shape/SubShapeID.h>
+
+#include "Oxylus.hpp"
+
+namespace ox {
+// Compact copy of a Jolt contact callback, safe to consume after the physics step.
+// `user_data` is the flecs entity id stored on the body. Removed contacts only
+// carry body and sub shape ids, their user data is resolved when flushing.
+struct ContactEvent {
+  enum class Type : u32 { Added = 0, Persisted, Removed };
+
+  Type type = Type::Added;
+  JPH::BodyID body1 = {};
+  JPH::BodyID body2 = {};
+  JPH::SubShapeID sub_shape1 = {};
+  JPH::SubShapeID sub_shape2 = {};
+  u64 user_data1 = 0;
+  u64 user_data2 = 0;
+  glm::vec3 position = {};  // First contact point on body1, world space
+  glm::vec3 normal = {};    // World space, pointing from body1 to body2
+  f32 penetration_depth = 0.0f;
+  u32 contact_point_count = 0;
+  f32 combined_friction = 0.0f;
+  f32 combined_restitution = 0.0f;
+
+  auto operator==(const ContactEvent&) const -> bool = default;
+};
+
+// Order of events in a flushed batch: type, body pair, then sub shapes. Built from plain
+// integers so sorting compares neither events nor Jolt types. Jolt reports a sub shape pair
+// at most once per step and type, so keys of one batch are unique.
+struct ContactSortKey {
+  u64 type_body1 = 0;
+  u64 body2_sub_shape1 = 0;
+  u64 sub_shape2 = 0;
+
+  auto operator<=>(const ContactSortKey&) const = default;
+};
+
+auto get_contact_sort_key(const ContactEvent& event) -> ContactSortKey;
+
+// Collects contact events from the physics job threads without locking and hands
+// them out as one batch once the step is done. Each thread writes into its own
+// buffer, the registry lock is only taken the first time a thread records.
+class ContactEventStream {
+public:
+  ContactEventStream();
+  ~ContactEventStream() = default;
+
+  ContactEventStream(const ContactEventStream&) = delete;
+  auto operator=(const ContactEventStream&) -> ContactEventStream& = delete;
+
+  // Callable from any thread during the physics step.
+  auto record(const ContactEvent& event) -> void;
+
+  // Merges all thread buffers into one batch ordered by `ContactSortKey`, so the result
+  // doesn't depend on job scheduling or thread count. Must not run concurrently with `record`.
+  auto flush() -> std::vector<ContactEvent>&;
+
+  auto get_batch() const -> const std::vector<ContactEvent>& { return batch; }
+
+private:
+  struct ThreadBuffer {
+    std::thread::id thread_id = {};
+    std::vector<ContactEvent> events = {};
+  };
+
+  u64 stream_id = 0;
+  std::mutex registry_mutex = {};
+  std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers = {};
+  std::vector<ContactEvent> batch = {};
+
+  struct SortEntry {
+    ContactSortKey key = {};
+    u32 event_index = 0;
+
+    auto operator<=>(const SortEntry&) const = default;
+  };
+
+  // Flush scratch, kept to reuse the allocations.
+  std::vector<ContactEvent> merged = {};
+  std::vector<SortEntry> sort_entries = {};
+
+  auto get_thread_buffer() -> ThreadBuffer&;
+};
+} // namespace ox
@@ -3,6 +3,7 @@
 // clang-format off
 #include "Core/ESystem.hpp"
 #include "Physics/PhysicsInterfaces.hpp"
+#include "Physics/PhysicsQueries.hpp"
 #include "Render/DebugRenderer.hpp"
 
 #include <Jolt/Core/JobSystemThreadPool.h>
@@ -34,6 +35,13 @@ public:
   static constexpr uint32_t MAX_BODIES = 1024;
   static constexpr uint32_t MAX_BODY_PAIRS = 1024;
   static constexpr uint32_t MAX_CONTACT_CONSTRAINS = 1024;
+  // Initial per step scratch memory, the temp allocator grows from the actual workload afterwards.
+  static constexpr usize INITIAL_TEMP_ALLOCATOR_SIZE = std::max(
+      ox::mib_to_bytes(1_sz),
+      MAX_BODIES * ox::kib_to_bytes(1_sz) + MAX_BODY_PAIRS * 256_sz + MAX_CONTACT_CONSTRAINS * 512_sz);
+  // Batched queries smaller than this run inline on the calling thread.
+  static constexpr uint32_t PARALLEL_QUERY_THRESHOLD = 256;
+  static constexpr uint32_t QUERY_BATCH_SIZE = 64;
   BPLayerInterfaceImpl layer_interface;
   ObjectVsBroadPhaseLayerFilterImpl object_vs_broad_phase_layer_filter_interface;
   ObjectLayerPairFilterImpl object_layer_pair_filter_interface;
@@ -48,12 +56,27 @@ public:
   const JPH::BroadPhaseQuery& get_broad_phase_query() { return physics_system->GetBroadPhaseQuery(); }
   const JPH::BodyLockInterface& get_body_interface_lock() { return physics_system->GetBodyLockInterface(); }
   PhysicsDebugRenderer* get_debug_renderer() { return debug_renderer; }
+  const PhysicsTempAllocator* get_temp_allocator() const { return temp_allocator; }
 
   JPH::AllHitCollisionCollector<JPH::RayCastBodyCollector> cast_ray(const RayCast& ray_cast);
 
+  // Batched narrow phase queries. Only bodies whose layer bit is set in `layer_mask` are considered.
+  // `hits` must be at least as large as the query span. Large batches are spread across worker threads.
+  auto cast_rays(std::span<const RayCast> rays, std::span<QueryHit> hits, EntityLayer layer_mask = 0xFFFF) const
+      -> void;
+  auto cast_shapes(std::span<const ShapeCast> casts, std::span<QueryHit> hits, EntityLayer layer_mask = 0xFFFF) const
+      -> void;
+  // Each query writes up to `max_hits_per_query` hits into its own slice of `hits`
+  // starting at `query_index * max_hits_per_query`, `hit_counts[query_index]` holds the written count.
+  auto overlap(std::span<const OverlapQuery> queries,
+               std::span<QueryHit> hits,
+               std::span<u32> hit_counts,
+               u32 max_hits_per_query,
+               EntityLayer layer_mask = 0xFFFF) const -> void;
+
 private:
   JPH::PhysicsSystem* physics_system = nullptr;
-  JPH::TempAllocatorImpl* temp_allocator = nullptr;
+  PhysicsTempAllocator* temp_allocator = nullptr;
   JPH::JobSystemThreadPool* job_system = nullptr;
   PhysicsDebugRenderer* debug_renderer = nullptr;
 };
@@ -1,10 +1,13 @@
 ﻿#pragma once
 #include <Jolt/Jolt.h>
+#include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 #include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h>
 #include <Jolt/Physics/Collision/ContactListener.h>
 #include <Jolt/Physics/Collision/ObjectLayer.h>
 
+#include "Physics/ContactEvents.hpp"
+
 namespace ox {
 class Scene;
 }
@@ -66,6 +69,34 @@ public:
                          [[maybe_unused]] JPH::uint64 inBodyUserData) override;
 };
 
+// LIFO allocator handed to the physics step. Requests that don't fit into the block fall back to the tracked heap,
+// grow_to_fit() then resizes the block to the observed high water mark so the next step stays inside it.
+class PhysicsTempAllocator final : public JPH::TempAllocator {
+public:
+  explicit PhysicsTempAllocator(size_t initial_size);
+  ~PhysicsTempAllocator() override;
+
+  void* Allocate(JPH::uint inSize) override;
+  void Free(void* inAddress, JPH::uint inSize) override;
+
+  // Only valid between steps, when nothing is allocated.
+  auto grow_to_fit() -> bool;
+
+  auto get_capacity() const -> size_t { return capacity; }
+  auto get_high_water_mark() const -> size_t { return high_water_mark; }
+  auto get_overflow_count() const -> uint64_t { return overflow_count; }
+
+private:
+  uint8_t* base = nullptr;
+  size_t capacity = 0;
+  size_t top = 0;
+  size_t in_use = 0;
+  size_t high_water_mark = 0;
+  uint64_t overflow_count = 0;
+
+  auto owns(const void* ptr) const -> bool { return ptr >= base && ptr < base + capacity; }
+};
+
 class Physics3DContactListener : public JPH::ContactListener {
 public:
   Physics3DContactListener(ox::Scene* scene) : _scene(scene) {}
@@ -86,8 +117,18 @@ public:
 
   void OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) override;
 
+  auto get_event_stream() -> ContactEventStream& { return event_stream; }
+
 private:
   ox::Scene* _scene = nullptr;
+  ContactEventStream event_stream = {};
+
+  static auto make_contact_event(ContactEvent::Type type,
+                                 const JPH::Body& inBody1,
+                                 const JPH::Body& inBody2,
+                                 const JPH::ContactManifold& inManifold,
+                                 const JPH::ContactSettings& inSettings) -> ContactEvent;
+
   static void GetFrictionAndRestitution(const JPH::Body& inBody,
                                         const JPH::SubShapeID& inSubShapeID,
                                         float& outFriction,
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyID.h>
+
+#include "Oxylus.hpp"
+
+namespace ox {
+struct QueryShape {
+  enum class Type : u32 { Sphere = 0, Box, Capsule };
+
+  Type type = Type::Sphere;
+  f32 radius = 0.5f;              // Sphere, Capsule
+  f32 half_height = 0.5f;         // Capsule, half height of the cylinder part
+  glm::vec3 half_extents = {0.5f, 0.5f, 0.5f}; // Box
+
+  static auto sphere(f32 radius) -> QueryShape { return {.type = Type::Sphere, .radius = radius}; }
+  static auto box(const glm::vec3& half_extents) -> QueryShape {
+    return {.type = Type::Box, .half_extents = half_extents};
+  }
+  static auto capsule(f32 half_height, f32 radius) -> QueryShape {
+    return {.type = Type::Capsule, .radius = radius, .half_height = half_height};
+  }
+};
+
+// Sweeps `shape` from `origin` along `direction`. Length of `direction` is the length of the sweep.
+struct ShapeCast {
+  QueryShape shape = {};
+  glm::vec3 origin = {};
+  glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+  glm::vec3 direction = {};
+};
+
+struct OverlapQuery {
+  QueryShape shape = {};
+  glm::vec3 position = {};
+  glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
+// Narrow phase query result. `user_data` is the flecs entity id stored on the body.
+struct QueryHit {
+  JPH::BodyID body_id = {};
+  u64 user_data = 0;
+  f32 fraction = 1.0f;
+  glm::vec3 position = {};
+  glm::vec3 normal = {};
+  bool hit = false;
+};
+} // namespace ox
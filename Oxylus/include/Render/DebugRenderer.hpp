@@ -1,21 +1,20 @@
 ﻿#pragma once
 
+#include <atomic>
+
 #include <Jolt/Jolt.h>
 #include <Jolt/Renderer/DebugRenderer.h>
 
 #include "Physics/RayCast.hpp"
 #include "Render/BoundingVolume.hpp"
-#include "Render/MeshVertex.hpp"
 
 namespace ox {
 class PhysicsDebugRenderer;
 
+enum class DebugGeometryID : u32 { Invalid = std::numeric_limits<u32>::max() };
+
 class DebugRenderer {
 public:
-  static constexpr uint32_t MAX_LINES = 10'000;
-  static constexpr uint32_t MAX_LINE_VERTICES = MAX_LINES * 2;
-  static constexpr uint32_t MAX_LINE_INDICES = MAX_LINES * 6;
-
   struct Line {
     glm::vec3 p1 = {};
     glm::vec3 p2 = {};
@@ -35,12 +34,53 @@ public:
     glm::vec4 col = {};
   };
 
+  // GPU layout, color is RGBA8.
+  struct DrawVertex {
+    alignas(4) glm::vec3 position = {};
+    alignas(4) u32 color = 0;
+  };
+
+  struct DrawInstance {
+    alignas(4) glm::mat4 transform = {};
+    alignas(4) glm::vec4 color = {};
+  };
+
+  enum class Topology : u32 { Lines, Triangles };
+
+  // `vertex_count` vertices starting at `first_vertex`, drawn once per instance. Retained
+  // batches read `DrawData::geometry_vertices`, the others `DrawData::vertices`.
+  struct DrawBatch {
+    Topology topology = Topology::Lines;
+    bool depth_tested = false;
+    bool retained = false;
+    u32 first_vertex = 0;
+    u32 vertex_count = 0;
+    u32 first_instance = 0;
+    u32 instance_count = 0;
+  };
+
+  // Everything drawn since the last `collect`, ready to be uploaded.
+  struct DrawData {
+    // Immediate lines, points and triangles in world space.
+    std::vector<DrawVertex> vertices = {};
+    // The first instance is the identity, immediate batches use it.
+    std::vector<DrawInstance> instances = {};
+    std::vector<DrawBatch> batches = {};
+    // Retained geometry, only copied when it changed since this data was collected last.
+    std::vector<DrawVertex> geometry_vertices = {};
+    u64 geometry_version = 0;
+  };
+
   DebugRenderer() = default;
   ~DebugRenderer() = default;
 
   static void init();
   static void release();
+  // Drops everything drawn so far, `clear_depth_tested = false` keeps the depth tested draws.
   static void reset(bool clear_depth_tested = true);
+  // Moves the draws of every thread into `data`. Threads may keep drawing meanwhile, those
+  // draws end up in the next collect.
+  static void collect(DrawData& data);
 
   /// Draw Point (circle)
   static void draw_point(const glm::vec3& pos,
@@ -87,56 +127,97 @@ public:
   static void
   draw_ray(const RayCast& ray, const glm::vec4& color, const float distance, const bool depth_tested = false);
 
-  static DebugRenderer* get_instance() { return instance; }
-  const std::vector<Line>& get_lines(bool depth_tested = true) const {
-    return !depth_tested ? draw_list.debug_lines : draw_list_depth_tested.debug_lines;
-  }
-  const std::vector<Triangle>& get_triangles(bool depth_tested = true) const {
-    return !depth_tested ? draw_list.debug_triangles : draw_list_depth_tested.debug_triangles;
-  }
-  const std::vector<Point>& get_points(bool depth_tested = true) const {
-    return !depth_tested ? draw_list.debug_points : draw_list_depth_tested.debug_points;
-  }
-
-  const vuk::Unique<vuk::Buffer>& get_global_index_buffer() const { return debug_renderer_context.index_buffer; }
+  /// Retained geometry in local space, drawn any number of times through `draw_geometry`.
+  /// Triangle edges are kept as well, so the geometry can also be drawn as wireframe.
+  static DebugGeometryID create_geometry(std::span<const Line> lines, std::span<const Triangle> triangles);
+  static void destroy_geometry(DebugGeometryID id);
+  /// One instance of `id`, its colors are multiplied by `color`.
+  static void draw_geometry(DebugGeometryID id,
+                            const glm::mat4& transform,
+                            const glm::vec4& color = glm::vec4(1.0f),
+                            bool wireframe = true,
+                            bool depth_tested = false);
 
-  static std::pair<std::vector<Vertex>, uint32_t> get_vertices_from_lines(const std::vector<Line>& lines);
-  static std::pair<std::vector<Vertex>, uint32_t> get_vertices_from_triangles(const std::vector<Triangle>& triangles);
+  static DebugRenderer* get_instance() { return instance; }
 
 private:
   static DebugRenderer* instance;
 
-  friend PhysicsDebugRenderer;
+  struct GeometryInstance {
+    DebugGeometryID geometry = DebugGeometryID::Invalid;
+    bool wireframe = true;
+    glm::mat4 transform = {};
+    glm::vec4 color = {};
+  };
 
   struct DebugDrawList {
     std::vector<Line> debug_lines = {};
     std::vector<Point> debug_points = {};
     std::vector<Triangle> debug_triangles = {};
+    std::vector<GeometryInstance> geometry_instances = {};
+
+    void clear();
+    void append(DebugDrawList& other);
   };
 
-  struct DebugRendererContext {
-    vuk::Unique<vuk::Buffer> index_buffer;
-  } debug_renderer_context;
+  // Draws of one thread, only that thread appends so the lock is never contended outside
+  // of `collect`.
+  struct ThreadDrawList {
+    std::mutex mutex = {};
+    DebugDrawList draw_list = {};
+    DebugDrawList draw_list_depth_tested = {};
+
+    DebugDrawList& get(bool depth_tested) { return depth_tested ? draw_list_depth_tested : draw_list; }
+  };
+
+  struct Geometry {
+    u32 line_offset = 0;
+    u32 line_vertex_count = 0;
+    u32 triangle_offset = 0;
+    u32 triangle_vertex_count = 0;
+    bool alive = false;
+  };
 
-  DebugDrawList draw_list;
-  DebugDrawList draw_list_depth_tested;
+  static auto get_thread_list() -> ThreadDrawList&;
+  // Drops the vertices of destroyed geometry once they make up half of the store.
+  void compact_geometry();
+
+  std::mutex thread_lists_mutex = {};
+  std::vector<std::unique_ptr<ThreadDrawList>> thread_lists = {};
+  u64 generation = 0;
+
+  std::mutex geometry_mutex = {};
+  std::vector<Geometry> geometries = {};
+  std::vector<u32> free_geometries = {};
+  std::vector<DrawVertex> geometry_vertices = {};
+  usize dead_geometry_vertices = 0;
+  u64 geometry_version = 1;
+
+  DebugGeometryID unit_sphere = DebugGeometryID::Invalid;
+  DebugGeometryID unit_box = DebugGeometryID::Invalid;
+
+  // Merged lists of the last collect, kept so collecting doesn't allocate every frame.
+  DebugDrawList collected = {};
+  DebugDrawList collected_depth_tested = {};
 };
 
 class PhysicsDebugRenderer final : public JPH::DebugRenderer {
 public:
   bool draw_depth_tested = false; // TODO: configurable via cvar
 
+  // Triangles are uploaded once as retained debug geometry, drawing a batch only records
+  // an instance of it.
   struct TriangleBatch : public JPH::RefTargetVirtual {
-    std::vector<ox::DebugRenderer::Triangle> triangles;
+    DebugGeometryID geometry = DebugGeometryID::Invalid;
+
+    std::atomic<int> ref_count = 0;
 
-    int ref_count = 0;
+    ~TriangleBatch() override { ox::DebugRenderer::destroy_geometry(geometry); }
 
     virtual void AddRef() override { ++ref_count; }
 
     virtual void Release() override {
-      --ref_count;
-
-      if (ref_count == 0) {
+      if (--ref_count == 0) {
         auto* pThis = this;
         delete pThis;
       }
@@ -1,11 +1,20 @@
 #pragma once
 
+#include <memory>
+#include <memory_resource>
 #include <vuk/Types.hpp>
 #include <vuk/Value.hpp>
 #include <vuk/runtime/vk/Allocator.hpp>
 #include <vuk/runtime/vk/Descriptor.hpp>
 
+#include "Asset/Mesh.hpp"
 #include "Asset/Texture.hpp"
+#include "Memory/FrameArena.hpp"
+#include "Render/DebugRenderer.hpp"
+#include "Render/LightClustering.hpp"
+#include "Render/OcclusionCulling.hpp"
+#include "Render/ParticleSystem.hpp"
+#include "Render/ShadowAtlas.hpp"
 #include "RenderPipeline.hpp"
 #include "Scene/ECSModule/Core.hpp"
 #include "Scene/SceneGPU.hpp"
@@ -30,6 +39,11 @@ public:
 
   auto on_update(Scene* scene) -> void override;
 
+  // Occluders of the last published frame, empty unless rr.occlusion_culling is set.
+  auto get_occlusion_buffer() const -> const OcclusionBuffer& {
+    return frame_packets[published_packet_index].occlusion_buffer;
+  }
+
 private:
   enum BindlessID : u32 {
     Samplers = 0,
@@ -88,8 +102,8 @@ private:
   };
 
   struct RenderQueue2D {
-    std::vector<DrawBatch2D> batches = {};
-    std::vector<SpriteGPUData> sprite_data = {};
+    std::pmr::vector<DrawBatch2D> batches;
+    std::pmr::vector<SpriteGPUData> sprite_data;
 
     vuk::Name current_pipeline_name = {};
 
@@ -99,12 +113,29 @@ private:
     u32 last_batches_size = 0;
     u32 last_sprite_data_size = 0;
 
+    RenderQueue2D(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : batches(resource),
+          sprite_data(resource) {}
+
+    // Containers are recreated so they pick up fresh memory when the resource is the frame arena.
     void init() {
       clear();
+      batches = std::pmr::vector<DrawBatch2D>(batches.get_allocator());
+      sprite_data = std::pmr::vector<SpriteGPUData>(sprite_data.get_allocator());
       batches.reserve(last_batches_size);
       sprite_data.reserve(last_sprite_data_size);
     }
 
+    // Copies `other` into fresh memory of our own resource, `other` may be this queue.
+    void assign(const RenderQueue2D& other) {
+      batches = std::pmr::vector<DrawBatch2D>(other.batches.begin(), other.batches.end(), batches.get_allocator());
+      sprite_data = std::pmr::vector<SpriteGPUData>(
+          other.sprite_data.begin(), other.sprite_data.end(), sprite_data.get_allocator());
+      current_pipeline_name = other.current_pipeline_name;
+      num_sprites = other.num_sprites;
+      previous_offset = other.previous_offset;
+    }
+
     // TODO: this will take a list of materials
     // TODO: sort pipelines
     void update() {
@@ -119,11 +150,7 @@ private:
       previous_offset = num_sprites;
     }
 
-    void add(const SpriteComponent& sprite,
-             const float& position_y,
-             u32 transform_id,
-             u32 material_id,
-             const float distance) {
+    static u16 get_flags(const SpriteComponent& sprite) {
       u16 flags = 0;
       if (sprite.sort_y)
         flags |= RENDER_FLAGS_2D_SORT_Y;
@@ -131,6 +158,10 @@ private:
       if (sprite.flip_x)
         flags |= RENDER_FLAGS_2D_FLIP_X;
 
+      return flags;
+    }
+
+    void add(u16 flags, const float& position_y, u32 transform_id, u32 material_id, const float distance) {
       const u32 flags_and_distance = math::pack_u16(flags, glm::packHalf1x16(distance));
       const u32 materialid_and_ypos = math::pack_u16(static_cast<u16>(material_id), glm::packHalf1x16(position_y));
 
@@ -157,30 +188,219 @@ private:
     }
   };
 
+  struct SpriteExtract {
+    u32 transform_id = 0;
+    u32 material_id = 0;
+    u16 flags = 0;
+    f32 position_y = 0.0f;
+    f32 position_z = 0.0f;
+  };
+
+  // (mesh, transform, primitive), its LODs are `primitive_lods[first_lod, first_lod + lod_count)`.
+  struct PrimitiveInstance {
+    u32 mesh_instance = 0;
+    u32 first_lod = 0;
+    u32 lod_count = 0;
+  };
+
+  // Built on the main thread when meshes are added or removed, every packet until the next
+  // rebuild shares it. Culling and LOD selection only produce `primitive_instance_lods`.
+  struct MeshInstances {
+    std::vector<GPU::Mesh> gpu_meshes = {};
+    // Meshlets of every LOD of every primitive instance.
+    std::vector<GPU::MeshletInstance> gpu_meshlet_instances = {};
+    std::vector<PrimitiveInstance> primitive_instances = {};
+    std::vector<Mesh::LOD> primitive_lods = {};
+    // Per (mesh, transform), in `rendering_meshes_map` order.
+    InstanceBounds local_bounds = {};
+    std::vector<f32> bounds_radius = {};
+    std::vector<u32> transform_indices = {};
+    // Primitives of instance `i` are [first_primitives[i], first_primitives[i + 1]).
+    std::vector<u32> first_primitives = {};
+    // Level 0 meshlets of every primitive instance, into `gpu_meshlet_instances`. Shadow views
+    // see more than the camera and are cached across frames, they don't follow its LOD.
+    std::vector<u32> shadow_meshlet_indices = {};
+    // Level 0 meshlets of instance `i` are [first_shadow_meshlets[i], first_shadow_meshlets[i + 1]).
+    std::vector<u32> first_shadow_meshlets = {};
+  };
+
+  // Occluder triangles stay owned by their mesh asset.
+  struct OccluderExtract {
+    std::span<const glm::vec3> positions = {};
+    std::span<const u32> indices = {};
+    glm::mat4 world = {};
+  };
+
+  // Lights that asked for shadows, `light_index` is into `FramePacket::lights`.
+  struct ShadowCaster {
+    u64 entity = 0;
+    u32 light_index = 0;
+    u32 resolution = 0;
+    f32 outer_cone_angle = 0.0f;
+    f32 importance = 0.0f;
+    // Importance with lights that had a shadow last frame favored.
+    f32 priority = 0.0f;
+  };
+
+  // Renderer cvars, read once while extracting.
+  struct PrepareSettings {
+    bool clustered_lights = true;
+    bool cpu_frustum_culling = true;
+    bool occlusion_culling = false;
+    u32 occlusion_width = 0;
+    u32 occlusion_height = 0;
+    bool lod_enable = true;
+    f32 lod_error_pixels = 1.0f;
+    f32 lod_hysteresis = 0.0f;
+    // Of the last rendered frame, 0 before the first one.
+    f32 viewport_height = 0.0f;
+    bool shadows = true;
+    f32 shadow_distance = 0.0f;
+    f32 shadow_depth_bias = 0.0f;
+    f32 shadow_normal_bias = 0.0f;
+    f32 shadow_hysteresis = 0.0f;
+    usize shadow_max_lights = 0;
+    u32 shadow_atlas_size = 0;
+  };
+
+  // Render relevant scene state, copied out of the scene on the main thread.
+  // Preparing a packet must never touch the scene or the asset manager, so
+  // it can run on the render thread while the next frame simulates.
+  struct FramePacket {
+    CameraComponent camera = {};
+    PrepareSettings settings = {};
+    std::vector<GPU::TransformID> dirty_transforms = {};
+    std::vector<GPU::Transforms> dirty_transform_values = {};
+    // Every transform slot, only when the slot count or the mesh instances changed. The
+    // dirty transforms are enough to keep prepare's copy current otherwise.
+    std::vector<GPU::Transforms> transforms = {};
+    std::shared_ptr<const MeshInstances> instances = nullptr;
+    std::vector<OccluderExtract> occluders = {};
+    std::vector<SpriteExtract> sprites = {};
+    option<GPU::Atmosphere> atmosphere = nullopt;
+    option<GPU::Sun> sun = nullopt;
+    option<GPU::HistogramInfo> histogram_info = nullopt;
+    std::vector<GPU::Light> lights = {};
+    std::vector<ShadowCaster> shadow_casters = {};
+    option<ShadowCaster> sun_shadow_caster = nullopt;
+    DebugRenderer::DrawData debug_draw = {};
+    std::vector<ParticleInstance> particles = {};
+
+    // Written by prepare()
+    GPU::CameraData camera_data = {};
+    RenderQueue2D render_queue_2d = {};
+    std::vector<glm::uvec2> light_cluster_ranges = {};
+    std::vector<u32> light_cluster_indices = {};
+    GPU::LightClusters light_clusters = {};
+    std::vector<u32> primitive_instance_lods = {};
+    u32 visible_meshlet_count = 0;
+    OcclusionBuffer occlusion_buffer = {};
+    std::vector<GPU::ShadowView> shadow_views = {};
+    std::vector<ShadowViewKey> shadow_view_keys = {};
+    // Views whose atlas rect must be rendered again, each with the range of
+    // `shadow_draw_meshlets` holding the casters inside it.
+    std::vector<u32> shadow_dirty_views = {};
+    std::vector<glm::uvec2> shadow_dirty_ranges = {};
+    std::vector<u32> shadow_draw_meshlets = {};
+    GPU::Shadows shadows = {};
+    u32 shadow_atlas_size = 0;
+  };
+
+  FramePacket frame_packets[2] = {};
+  u32 frame_packet_index = 0;
+  u32 published_packet_index = 0;
+  bool frame_packet_in_flight = false;
+
+  auto extract(Scene* scene, FramePacket& packet) -> void;
+  // Everything that only needs the packet: light binning, culling, LOD selection and
+  // shadow view packing. Never runs twice at once, the state it owns is marked below.
+  auto prepare(FramePacket& packet) -> void;
+  auto prepare_instances(FramePacket& packet) -> void;
+  auto prepare_shadows(FramePacket& packet, bool instances_changed) -> void;
+  // Brings a copy of every transform slot up to the state `packet` was extracted with.
+  static auto apply_transforms(std::vector<GPU::Transforms>& transforms, const FramePacket& packet) -> void;
+  auto publish(const FramePacket& packet) -> void;
+  auto wait_for_render_thread() -> void;
+
   bool initalized = false;
 
   vuk::Unique<vuk::PersistentDescriptorSet> descriptor_set_01 = vuk::Unique<vuk::PersistentDescriptorSet>();
 
-  RenderQueue2D render_queue_2d = {};
+  // Per-frame data below is allocated from the frame arena.
+  u64 frame_data_index = 0;
+  RenderQueue2D render_queue_2d{memory::get_frame_arena().get_resource()};
   bool saved_camera = false;
 
   vuk::Unique<vuk::Buffer> exposure_buffer = vuk::Unique<vuk::Buffer>();
 
   std::span<GPU::Transforms> transforms = {};
-  std::vector<GPU::TransformID> dirty_transforms = {};
+  // What on_render uploads, the scene's transforms are a frame ahead of the published packet.
+  std::vector<GPU::Transforms> published_transforms = {};
+  std::pmr::vector<GPU::TransformID> dirty_transforms{memory::get_frame_arena().get_resource()};
+  std::pmr::vector<GPU::Transforms> dirty_transform_values{memory::get_frame_arena().get_resource()};
   vuk::Unique<vuk::Buffer> transforms_buffer = vuk::Unique<vuk::Buffer>();
 
   GPU::CameraData camera_data = {};
 
+  // Main thread, rebuilt by extract.
+  std::shared_ptr<const MeshInstances> mesh_instances = nullptr;
+  usize extracted_transform_count = 0;
+
+  // Owned by prepare.
+  std::vector<GPU::Transforms> prepared_transforms = {};
+  std::shared_ptr<const MeshInstances> prepared_instances = nullptr;
+  InstanceBounds instance_world_bounds = {};
+  std::vector<u8> instance_visibility = {};
+  // Last selection per primitive instance, the LOD hysteresis is kept against it.
+  std::vector<u32> selected_lods = {};
+  LightSpheres light_spheres = {};
+  LightClusterList light_cluster_list = {};
+  // The atlas keeps the depth of views nothing moved in across frames.
+  ShadowAtlas shadow_atlas = {};
+  std::vector<ShadowViewRequest> shadow_view_requests = {};
+  // World boxes of every instance, in `MeshInstances::local_bounds` order.
+  InstanceBounds shadow_caster_bounds = {};
+  InstanceBounds shadow_moved_bounds = {};
+  // One bit per dirty view of the batch being culled.
+  std::vector<u8> shadow_caster_visibility = {};
+  std::vector<u8> moved_transform_flags = {};
+
+  // Published for on_render.
+  std::shared_ptr<const MeshInstances> instances = nullptr;
   bool meshes_dirty = false;
-  std::vector<GPU::Mesh> gpu_meshes = {};
-  std::vector<GPU::MeshletInstance> gpu_meshlet_instances = {};
+  // Selected LOD per primitive instance or `GPU::CULLED_LOD`, uploaded every frame.
+  std::vector<u32> primitive_instance_lods = {};
+  u32 visible_meshlet_count = 0;
   vuk::Unique<vuk::Buffer> meshes_buffer = vuk::Unique<vuk::Buffer>();
   vuk::Unique<vuk::Buffer> meshlet_instances_buffer = vuk::Unique<vuk::Buffer>();
 
   option<GPU::Atmosphere> atmosphere = nullopt;
   option<GPU::Sun> sun = nullopt;
 
+  // Point and spot lights.
+  std::vector<GPU::Light> lights = {};
+  std::vector<glm::uvec2> light_cluster_ranges = {};
+  std::vector<u32> light_cluster_indices = {};
+  GPU::LightClusters light_clusters = {};
+
+  std::vector<GPU::ShadowView> shadow_views = {};
+  std::vector<ShadowViewKey> shadow_view_keys = {};
+  std::vector<u32> shadow_dirty_views = {};
+  std::vector<glm::uvec2> shadow_dirty_ranges = {};
+  std::vector<u32> shadow_draw_meshlets = {};
+  GPU::Shadows shadows = {};
+  u32 shadow_atlas_size = 0;
+  Texture shadow_atlas_view;
+  vuk::Access shadow_atlas_access = vuk::eNone;
+
+  // Retained debug geometry lives on the GPU and is only uploaded again when it changed.
+  DebugRenderer::DrawData debug_draw = {};
+  bool debug_geometry_dirty = false;
+  vuk::Unique<vuk::Buffer> debug_geometry_buffer = vuk::Unique<vuk::Buffer>();
+
+  // Rebuilt every frame, read from scratch memory.
+  std::vector<ParticleInstance> particles = {};
+
   option<GPU::HistogramInfo> histogram_info = nullopt;
 
   Texture sky_transmittance_lut_view;
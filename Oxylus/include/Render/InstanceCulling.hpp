@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+
+#include "Scene/SceneGPU.hpp"
+
+namespace ox {
+// Axis aligned boxes as center and half extent, one array per component so that
+// consecutive boxes can be loaded into SIMD lanes directly.
+struct InstanceBounds {
+  std::vector<f32> center_x = {};
+  std::vector<f32> center_y = {};
+  std::vector<f32> center_z = {};
+  std::vector<f32> extent_x = {};
+  std::vector<f32> extent_y = {};
+  std::vector<f32> extent_z = {};
+
+  auto size() const -> usize { return center_x.size(); }
+  auto resize(usize count) -> void;
+  auto clear() -> void;
+  auto push_back(const glm::vec3& center, const glm::vec3& extent) -> void;
+};
+
+// Planes as written by `math::calc_frustum_planes`, a point is inside when `dot(n, p) - w >= 0`
+// for all of them. Same convention as the meshlet culling shader.
+struct CullFrustum {
+  glm::vec4 planes[6] = {};
+};
+
+namespace instance_culling {
+// One visibility bit per frustum.
+constexpr static auto MAX_FRUSTA = 8_sz;
+
+// World space boxes of instances [begin, end) from their local boxes and transforms.
+auto transform_bounds(const InstanceBounds& local,
+                      std::span<const u32> transform_indices,
+                      std::span<const GPU::Transforms> transforms,
+                      InstanceBounds& world,
+                      usize begin,
+                      usize end) -> void;
+
+// Scalar reference of `cull`.
+auto is_visible(const InstanceBounds& bounds, usize index, const CullFrustum& frustum) -> bool;
+
+// Sets bit `f` of `visibility[i]` when instance `i` in [begin, end) touches `frusta[f]`.
+// Four instances are tested at once where SSE2 is available, the result is bit exact with
+// `is_visible`.
+auto cull(const InstanceBounds& bounds,
+          std::span<const CullFrustum> frusta,
+          std::span<u8> visibility,
+          usize begin,
+          usize end) -> void;
+
+// Runs on the worker that culled instances [begin, end), right after their visibility is known.
+using CulledRangeFn = std::function<void(usize begin, usize end)>;
+
+// `transform_bounds` then `cull` for every instance, split over the task scheduler.
+auto cull_parallel(const InstanceBounds& local,
+                   std::span<const u32> transform_indices,
+                   std::span<const GPU::Transforms> transforms,
+                   InstanceBounds& world,
+                   std::span<const CullFrustum> frusta,
+                   std::span<u8> visibility,
+                   const CulledRangeFn& on_culled = {}) -> void;
+} // namespace instance_culling
+} // namespace ox
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Scene/SceneGPU.hpp"
+
+namespace ox {
+// View space bounding spheres of punctual lights, one array per component so that
+// consecutive lights can be loaded into SIMD lanes directly. `depth` is the distance
+// along the view direction, i.e. `-z` of the view space position.
+struct LightSpheres {
+  std::vector<f32> x = {};
+  std::vector<f32> y = {};
+  std::vector<f32> depth = {};
+  std::vector<f32> radius = {};
+
+  auto size() const -> usize { return x.size(); }
+  auto clear() -> void;
+  auto push_back(const glm::vec3& view_position, f32 radius) -> void;
+};
+
+// Froxel grid over the view frustum: screen tiles in x and y, exponential depth slices in z.
+struct LightClusterGrid {
+  glm::uvec3 size = {16, 9, 24};
+  f32 near_clip = 0.1f;
+  f32 far_clip = 1000.0f;
+  // `projection[0][0]` and `projection[1][1]`.
+  glm::vec2 projection_scale = {1.0f, 1.0f};
+  bool orthographic = false;
+
+  auto get_cluster_count() const -> u32 { return size.x * size.y * size.z; }
+  auto get_cluster_index(u32 x, u32 y, u32 z) const -> u32 { return (z * size.y + y) * size.x + x; }
+  // Start of depth slice `z`, the first slice starts at the eye and `size.z` ends at `far_clip`.
+  auto get_slice_depth(u32 z) const -> f32;
+  // View space box of a cluster as (x, y, depth).
+  auto get_cluster_bounds(u32 x, u32 y, u32 z, glm::vec3& min, glm::vec3& max) const -> void;
+  // Values the shader needs to find the cluster of a pixel, buffer addresses are left zero.
+  auto to_gpu() const -> GPU::LightClusters;
+};
+
+// Light indices per cluster, `ranges[cluster]` is (offset, count) into `indices`. Lights
+// of a cluster are in ascending order.
+struct LightClusterList {
+  std::vector<glm::uvec2> ranges = {};
+  std::vector<u32> indices = {};
+  // Cluster slots that did not fit into `MAX_LIGHTS_PER_CLUSTER`.
+  u32 overflow_count = 0;
+
+  // Working memory of `bin_lights`, kept so binning doesn't allocate every frame.
+  std::vector<u32> cluster_slots = {};
+  std::vector<u32> cluster_counts = {};
+};
+
+namespace light_clustering {
+constexpr static auto MAX_LIGHTS_PER_CLUSTER = 256_u32;
+
+// Scalar reference of the SIMD test in `bin_lights`.
+auto is_in_cluster(const glm::vec3& min, const glm::vec3& max, const LightSpheres& spheres, usize index) -> bool;
+
+// Brute force assignment, every light against every cluster.
+auto bin_lights_reference(const LightClusterGrid& grid, const LightSpheres& spheres, LightClusterList& list) -> void;
+
+// Same result as `bin_lights_reference`. Each depth slice first keeps the lights overlapping
+// its depth range and then tests four of those against each of its clusters at once where
+// SSE2 is available.
+auto bin_lights(const LightClusterGrid& grid, const LightSpheres& spheres, LightClusterList& list) -> void;
+
+// `bin_lights` with the depth slices split over the task scheduler.
+auto bin_lights_parallel(const LightClusterGrid& grid, const LightSpheres& spheres, LightClusterList& list) -> void;
+} // namespace light_clustering
+} // namespace ox
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Scene/SceneGPU.hpp"
+
+namespace ox::meshlet_culling {
+// CPU reference of the cone test in cull_meshlets.slang. True when every triangle of the
+// meshlet faces away from `camera_position`.
+auto is_cone_culled(const GPU::MeshletBounds& bounds,
+                    const glm::mat4& world,
+                    const glm::mat3& normal_matrix,
+                    const glm::vec3& camera_position) -> bool;
+
+// Fraction of meshlets rejected by the cone test, averaged over `camera_positions`.
+auto get_cone_rejection_rate(std::span<const GPU::MeshletBounds> bounds,
+                             const glm::mat4& world,
+                             std::span<const glm::vec3> camera_positions) -> f32;
+} // namespace ox::meshlet_culling
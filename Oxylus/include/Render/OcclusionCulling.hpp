@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Render/InstanceCulling.hpp"
+
+namespace ox {
+// Low resolution depth buffer of designated occluder meshes, rasterized on the CPU so
+// instances hidden behind them can be dropped before any per instance work is done.
+// Depth is stored as 1 / w, which interpolates linearly in screen space; larger is nearer
+// and 0 means nothing was drawn.
+class OcclusionBuffer {
+public:
+  // Rows rasterized per task, every task owns its rows so no synchronization is needed.
+  constexpr static auto BAND_HEIGHT = 8_u32;
+  // Triangles and boxes closer than this in clip w are not rasterized or culled.
+  constexpr static auto NEAR_W = 1e-4f;
+
+  OcclusionBuffer() = default;
+  ~OcclusionBuffer() = default;
+
+  OcclusionBuffer(const OcclusionBuffer&) = delete;
+  auto operator=(const OcclusionBuffer&) -> OcclusionBuffer& = delete;
+
+  // `width` is rounded up to a multiple of 4.
+  auto begin_frame(const glm::mat4& projection_view, u32 width, u32 height) -> void;
+  // Projects the triangles, nothing is drawn until `rasterize`.
+  auto add_occluder(std::span<const glm::vec3> positions, std::span<const u32> indices, const glm::mat4& world)
+      -> void;
+  // Rasterizes all added occluders, split in bands over the task scheduler when `parallel`.
+  auto rasterize(bool parallel = true) -> void;
+  // Scalar rasterization of the same triangles into `depth`, bit exact with `rasterize`.
+  auto rasterize_reference(std::span<f32> depth) const -> void;
+
+  // False when the box is completely behind rasterized occluders.
+  auto is_visible(const glm::vec3& center, const glm::vec3& extent) const -> bool;
+  // Clears `bit` in `visibility[i]` of every instance with the bit set that is occluded.
+  auto cull_instances(const InstanceBounds& world_bounds, std::span<u8> visibility, u8 bit, bool parallel = true) const
+      -> void;
+
+  auto get_width() const -> u32 { return width; }
+  auto get_height() const -> u32 { return height; }
+  auto get_depth() const -> std::span<const f32> { return depth; }
+  auto get_triangle_count() const -> usize { return triangles.size(); }
+
+private:
+  // Edge functions `a * x + b * y + c` are pre-divided by the triangle area, so inside
+  // pixels have all three non-negative and they are the barycentrics.
+  struct Triangle {
+    f32 edge_a[3] = {};
+    f32 edge_b[3] = {};
+    f32 edge_c[3] = {};
+    f32 inv_w[3] = {};
+    i32 min_x = 0;
+    i32 min_y = 0;
+    i32 max_x = 0;
+    i32 max_y = 0;
+  };
+
+  struct RasterizeTask;
+  struct CullTask;
+
+  u32 width = 0;
+  u32 height = 0;
+  glm::mat4 projection_view = {};
+  std::vector<f32> depth = {};
+  std::vector<Triangle> triangles = {};
+  std::vector<glm::vec4> projected = {};
+
+  auto rasterize_rows(u32 begin_row, u32 end_row) -> void;
+  static auto rasterize_triangle_scalar(const Triangle& triangle, std::span<f32> depth, u32 width, i32 begin_row,
+                                        i32 end_row) -> void;
+};
+} // namespace ox
@@ -1,17 +1,11 @@
 #pragma once
 
+#include "Memory/SlotMap.hpp"
 #include "Utils/OxMath.hpp"
+#include "Utils/Random.hpp"
 
 namespace ox {
-class Texture;
-
-struct Particle {
-  glm::vec3 position = glm::vec3(0.0f);
-  glm::vec3 rotation = glm::vec3(0.0f);
-  glm::vec3 size = glm::vec3(1.0f);
-  glm::vec4 color = glm::vec4(1.0f);
-  float life_remaining = 0.0f;
-};
+enum class ParticleEmitterID : u64 { Invalid = std::numeric_limits<u64>::max() };
 
 template <typename T>
 struct OverLifetimeModule {
@@ -22,7 +16,7 @@ struct OverLifetimeModule {
   OverLifetimeModule() : start(), end() {}
   OverLifetimeModule(const T& start_, const T& end_) : start(start_), end(end_) {}
 
-  T evaluate(float factor) { return glm::lerp(end, start, factor); }
+  T evaluate(float factor) const { return glm::lerp(end, start, factor); }
 };
 
 template <typename T>
@@ -36,7 +30,7 @@ struct BySpeedModule {
   BySpeedModule() : start(), end() {}
   BySpeedModule(const T& start_, const T& end_) : start(start_), end(end_) {}
 
-  T evaluate(float speed) {
+  T evaluate(float speed) const {
     float factor = math::inverse_lerp_clamped(min_speed, max_speed, speed);
     return glm::lerp(end, start, factor);
   }
@@ -49,13 +43,15 @@ struct ParticleProperties {
   float start_lifetime = 3.0f;
   glm::vec3 start_velocity = glm::vec3(0.0f, 2.0f, 0.0f);
   glm::vec4 start_color = glm::vec4(1.0f);
-  glm::vec3 start_size = glm::vec3(1.0f);
-  glm::vec3 start_rotation = glm::vec3(0.0f);
+  glm::vec2 start_size = glm::vec2(1.0f);
+  // Particles are camera facing quads, rotations are around the view direction in radians.
+  float start_rotation = 0.0f;
   float gravity_modifier = 0.0f;
   float simulation_speed = 1.0f;
   bool play_on_awake = true;
   uint32_t max_particles = 1000;
 
+  // Particles per second and per unit moved.
   uint32_t rate_over_time = 10;
   uint32_t rate_over_distance = 0;
   uint32_t burst_count = 0;
@@ -64,44 +60,145 @@ struct ParticleProperties {
   glm::vec3 position_start = glm::vec3(-0.2f, 0.0f, 0.0f);
   glm::vec3 position_end = glm::vec3(0.2f, 0.0f, 0.0f);
 
-  OverLifetimeModule<glm::vec3> velocity_over_lifetime;
+  OverLifetimeModule<glm::vec3> velocity_over_lifetime = {glm::vec3(1.0f), glm::vec3(1.0f)};
   OverLifetimeModule<glm::vec3> force_over_lifetime;
   OverLifetimeModule<glm::vec4> color_over_lifetime = {{0.8f, 0.2f, 0.2f, 0.0f}, {0.2f, 0.2f, 0.75f, 1.0f}};
   BySpeedModule<glm::vec4> color_by_speed = {{0.8f, 0.2f, 0.2f, 0.0f}, {0.2f, 0.2f, 0.75f, 1.0f}};
-  OverLifetimeModule<glm::vec3> size_over_lifetime = {glm::vec3(0.2f), glm::vec3(1.0f)};
-  BySpeedModule<glm::vec3> size_by_speed = {glm::vec3(0.2f), glm::vec3(1.0f)};
-  OverLifetimeModule<glm::vec3> rotation_over_lifetime;
-  BySpeedModule<glm::vec3> rotation_by_speed;
+  OverLifetimeModule<glm::vec2> size_over_lifetime = {glm::vec2(0.2f), glm::vec2(1.0f)};
+  BySpeedModule<glm::vec2> size_by_speed = {glm::vec2(0.2f), glm::vec2(1.0f)};
+  OverLifetimeModule<float> rotation_over_lifetime;
+  BySpeedModule<float> rotation_by_speed;
+};
+
+// Particles of one emitter, one array per attribute so consecutive particles can be loaded
+// into SIMD lanes directly. Alive particles are packed into [0, count), dying ones are
+// replaced by the last alive particle, so nothing ever iterates dead slots.
+struct ParticleBuffer {
+  std::vector<f32> position_x = {};
+  std::vector<f32> position_y = {};
+  std::vector<f32> position_z = {};
+  std::vector<f32> velocity_x = {};
+  std::vector<f32> velocity_y = {};
+  std::vector<f32> velocity_z = {};
+  // Remaining seconds.
+  std::vector<f32> life = {};
+  u32 count = 0;
+
+  auto capacity() const -> u32 { return static_cast<u32>(life.size()); }
+  // Drops the particles past `capacity_` when shrinking.
+  auto set_capacity(u32 capacity_) -> void;
+  auto clear() -> void { count = 0; }
+  // False when the buffer is full.
+  auto push(const glm::vec3& position, const glm::vec3& velocity, f32 life_) -> bool;
+  // Compacts particles without life left, returns how many were removed.
+  auto remove_dead() -> u32;
+};
+
+// Everything `simulate` needs, resolved from the properties once per emitter and step.
+// Disabled modules resolve to identity values so the kernel never branches on them.
+struct ParticleSimulateParams {
+  f32 delta_time = 0.0f;
+  f32 inv_lifetime = 0.0f;
+  // Force at the start and end of a particle's life, gravity included.
+  glm::vec3 force_start = {};
+  glm::vec3 force_end = {};
+  // Velocity scale at the start and end of a particle's life.
+  glm::vec3 velocity_scale_start = glm::vec3(1.0f);
+  glm::vec3 velocity_scale_end = glm::vec3(1.0f);
+};
+
+// GPU layout of one camera facing quad, `size` is the full width and height.
+struct ParticleInstance {
+  alignas(4) glm::vec4 color = {};
+  alignas(4) glm::vec3 position = {};
+  alignas(4) f32 rotation = 0.0f;
+  alignas(4) glm::vec2 size = {};
+  alignas(4) glm::vec2 padding = {};
+};
 
-  std::shared_ptr<Texture> texture = nullptr;
+struct ParticleStats {
+  u32 emitter_count = 0;
+  u32 particle_count = 0;
+  // Per update.
+  u32 emitted_count = 0;
+  u32 killed_count = 0;
 };
 
+namespace particles {
+auto get_simulate_params(const ParticleProperties& properties, f32 delta_time) -> ParticleSimulateParams;
+
+// Scalar reference of `simulate`.
+auto simulate_scalar(ParticleBuffer& buffer, const ParticleSimulateParams& params, u32 begin, u32 end) -> void;
+// Ages particles [begin, end), applies forces and moves them. Four particles are stepped at
+// once where SSE2 is available, results match `simulate_scalar` up to rounding.
+auto simulate(ParticleBuffer& buffer, const ParticleSimulateParams& params, u32 begin, u32 end) -> void;
+
+// Color, size and rotation of every alive particle, appended to `instances`.
+auto write_instances(const ParticleBuffer& buffer,
+                     const ParticleProperties& properties,
+                     std::vector<ParticleInstance>& instances) -> void;
+} // namespace particles
+
+// Owns the emitters of one scene. Every update emits and simulates all emitters in parallel on
+// the task scheduler, each emitter is stepped by one task with its own random state, so
+// results don't depend on which worker picked it up.
 class ParticleSystem {
 public:
-  ParticleSystem();
+  ParticleSystem() = default;
+  ~ParticleSystem() = default;
 
-  void play();
-  void stop(bool force = false);
-  void on_update(float deltaTime, const glm::vec3& position);
-  void on_render() const;
+  ParticleSystem(const ParticleSystem&) = delete;
+  auto operator=(const ParticleSystem&) -> ParticleSystem& = delete;
 
-  ParticleProperties& get_properties() { return properties; }
-  const ParticleProperties& get_properties() const { return properties; }
-  uint32_t get_active_particle_count() const { return active_particle_count; }
+  auto create_emitter(const ParticleProperties& properties, const glm::vec3& position, u64 seed = 0)
+      -> ParticleEmitterID;
+  auto destroy_emitter(ParticleEmitterID emitter_id) -> void;
+  auto reset() -> void;
 
-private:
-  void emit(const glm::vec3& position, uint32_t count = 1);
+  auto set_properties(ParticleEmitterID emitter_id, const ParticleProperties& properties) -> void;
+  // World position particles are emitted from, the distance moved drives `rate_over_distance`.
+  auto set_position(ParticleEmitterID emitter_id, const glm::vec3& position) -> void;
+
+  auto play(ParticleEmitterID emitter_id) -> void;
+  // Stops emitting, `force` also kills the particles that are still alive.
+  auto stop(ParticleEmitterID emitter_id, bool force = false) -> void;
+  auto is_playing(ParticleEmitterID emitter_id) -> bool;
+  auto get_particle_count(ParticleEmitterID emitter_id) -> u32;
 
-  std::vector<Particle> particles;
-  uint32_t pool_index = 0;
-  ParticleProperties properties;
+  auto update(f32 delta_time) -> void;
+  // Quads of every alive particle as of the last update.
+  auto collect(std::vector<ParticleInstance>& instances) -> void;
 
-  float system_time = 0.0f;
-  float burst_time = 0.0f;
-  float spawn_time = 0.0f;
-  glm::vec3 last_spawned_position = glm::vec3(0.0f);
+  auto get_stats() const -> const ParticleStats& { return stats; }
 
-  uint32_t active_particle_count = 0;
-  bool playing = false;
+private:
+  struct Emitter {
+    ParticleProperties properties = {};
+    ParticleBuffer particles = {};
+    FastRandom random = {};
+    std::vector<ParticleInstance> instances = {};
+
+    glm::vec3 position = {};
+    glm::vec3 last_position = {};
+    f32 system_time = 0.0f;
+    // Fractional particles carried over to the next update.
+    f32 spawn_accumulator = 0.0f;
+    f32 distance_accumulator = 0.0f;
+    f32 burst_time = 0.0f;
+    bool playing = false;
+
+    // Per update.
+    u32 emitted_count = 0;
+    u32 killed_count = 0;
+
+    auto emit(u32 count) -> void;
+    auto update(f32 delta_time) -> void;
+  };
+
+  struct UpdateTask;
+
+  SlotMap<Emitter, ParticleEmitterID> emitters = {};
+  std::vector<Emitter*> update_list = {};
+  ParticleStats stats = {};
 };
 } // namespace ox
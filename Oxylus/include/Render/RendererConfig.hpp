@@ -19,6 +19,30 @@ inline AutoCVar_Int cvar_freeze_culling_frustum("rr.freeze_culling_frustum", "fr
 inline AutoCVar_Int cvar_draw_camera_frustum("rr.draw_camera_frustum", "draw camera frustum", 0);
 inline AutoCVar_Int cvar_debug_view("rr.debug_view", "0: None, 1: Triangles, 2: Meshlets, 3: Overdraw, 4: Albdeo, 5: Normal, 6: Emissive, 7: Metallic, 8: Roughness, 9: Occlusion", 0);
 
+inline AutoCVar_Int cvar_lod_enable("rr.lod_enable", "select mesh LODs by their projected error", 1);
+inline AutoCVar_Float cvar_lod_error_pixels("rr.lod_error_pixels", "max screen space error of a mesh LOD in pixels", 1.0f);
+inline AutoCVar_Float cvar_lod_hysteresis("rr.lod_hysteresis", "fraction of the LOD error threshold kept as a band before coarsening", 0.25f);
+
+inline AutoCVar_Int cvar_cpu_frustum_culling("rr.cpu_frustum_culling", "cull mesh instances against the camera frustum before emitting meshlets", 1);
+
+inline AutoCVar_Int cvar_occlusion_culling("rr.occlusion_culling", "cull mesh instances behind occluder meshes with a CPU depth buffer", 0);
+inline AutoCVar_Int cvar_occlusion_width("rr.occlusion_width", "CPU occlusion buffer width", 256);
+inline AutoCVar_Int cvar_occlusion_height("rr.occlusion_height", "CPU occlusion buffer height", 128);
+
+inline AutoCVar_Int cvar_clustered_lights("rr.clustered_lights", "shade point and spot lights through per cluster light lists", 1);
+
+inline AutoCVar_Int cvar_shadows("rr.shadows", "render light shadows into a cached shadow atlas", 1);
+inline AutoCVar_Int cvar_shadow_atlas_size("rr.shadow_atlas_size", "shadow atlas edge length in texels", 4096);
+inline AutoCVar_Int cvar_shadow_max_lights("rr.shadow_max_lights", "max point and spot lights with shadows, the most important ones on screen are picked", 16);
+inline AutoCVar_Float cvar_shadow_hysteresis("rr.shadow_hysteresis", "importance band a shadowed light has to leave before it changes resolution or loses its shadow", 0.25f);
+inline AutoCVar_Float cvar_shadow_distance("rr.shadow_distance", "radius around the camera covered by the sun shadow", 50.0f);
+inline AutoCVar_Float cvar_shadow_depth_bias("rr.shadow_depth_bias", "shadow depth bias", 0.0001f);
+inline AutoCVar_Float cvar_shadow_normal_bias("rr.shadow_normal_bias", "shadow receiver offset along the normal in world units", 0.05f);
+
+inline AutoCVar_Int cvar_quantize_vertices("rr.quantize_vertices", "quantize mesh vertex streams at load: 16 bit positions, octahedral normals, half uvs", 1);
+
+inline AutoCVar_Int cvar_pipelined_extract("rr.pipelined_extract", "prepare render data on the render thread, one frame behind simulation", 0);
+
 inline AutoCVar_Int cvar_reload_render_pipeline("rr.reload_render_pipeline", "reload current scene's render pipeline", 0);
 
 inline AutoCVar_Int cvar_ssr_enable("pp.ssr", "use ssr", 1);
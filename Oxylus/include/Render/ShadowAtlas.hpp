@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Render/InstanceCulling.hpp"
+
+namespace ox {
+// Identifies a shadow view across frames, point lights have one view per cube face.
+struct ShadowViewKey {
+  u64 light = 0;
+  u32 face = 0;
+
+  auto operator==(const ShadowViewKey&) const -> bool = default;
+};
+
+struct ShadowViewRequest {
+  ShadowViewKey key = {};
+  // Edge length in texels, a power of two.
+  u32 resolution = 0;
+  glm::mat4 view_projection = {};
+};
+
+struct ShadowAtlasView {
+  ShadowViewKey key = {};
+  u32 requested_resolution = 0;
+  glm::mat4 view_projection = {};
+  // Square rect in atlas texels, `size` is zero when the view didn't fit.
+  u32 x = 0;
+  u32 y = 0;
+  u32 size = 0;
+  // Contents must be rendered again this frame.
+  bool dirty = true;
+};
+
+// Packs square shadow views into one atlas and decides which of them can keep last
+// frame's contents. Rects live in a quadtree, views that keep their resolution keep their
+// rect when others are added, removed or resized. A view is rendered again when it's new,
+// moved in the atlas, its projection changed or a caster moved inside it.
+class ShadowAtlas {
+public:
+  ShadowAtlas() = default;
+  ~ShadowAtlas() = default;
+
+  // Views come out in request order. `moved_bounds` are world boxes of casters that moved
+  // since the last update, both where they were and where they are now.
+  auto update(std::span<const ShadowViewRequest> requests, const InstanceBounds& moved_bounds) -> void;
+  // Every view is rendered again on the next update, e.g. when casters were added or removed.
+  auto invalidate() -> void { invalidated = true; }
+  // Only the view with `key` is rendered again on the next update, e.g. when the frame that
+  // should have rendered it didn't.
+  auto invalidate(const ShadowViewKey& key) -> void { invalidated_keys.emplace(key); }
+
+  // Changing the size invalidates the atlas.
+  auto set_size(u32 size_) -> void;
+  auto get_size() const -> u32 { return size; }
+  auto get_views() const -> std::span<const ShadowAtlasView> { return views; }
+  // View of the last update with `key`, nullptr when it wasn't requested.
+  auto find_view(const ShadowViewKey& key) const -> const ShadowAtlasView*;
+  auto get_dirty_count() const -> u32 { return dirty_count; }
+  // Right shift applied to every requested resolution so the views fit.
+  auto get_resolution_shift() const -> u32 { return resolution_shift; }
+
+private:
+  struct ViewKeyHash {
+    using is_avalanching = void;
+    auto operator()(const ShadowViewKey& key) const noexcept -> u64;
+  };
+
+  // Leaves are either free or taken by one view, split nodes have four children.
+  struct Node {
+    u32 first_child = 0;
+    bool taken = false;
+  };
+
+  u32 size = 4096;
+  bool invalidated = true;
+  bool resized = true;
+  u32 dirty_count = 0;
+  u32 resolution_shift = 0;
+  std::vector<ShadowAtlasView> views = {};
+  std::vector<ShadowAtlasView> previous_views = {};
+  using ViewIndices = ankerl::unordered_dense::map<ShadowViewKey, u32, ViewKeyHash>;
+  ViewIndices indices = {};
+  ViewIndices previous_indices = {};
+  ankerl::unordered_dense::set<ShadowViewKey, ViewKeyHash> invalidated_keys = {};
+  std::vector<Node> nodes = {};
+  std::vector<u32> pack_order = {};
+
+  auto pack(std::span<const ShadowViewRequest> requests) -> void;
+  auto split(u32 node) -> void;
+  // Takes the free square `rect_size` at x, y, false when any of it is already taken.
+  auto insert(u32 node, u32 x, u32 y, u32 node_size, u32 rect_x, u32 rect_y, u32 rect_size) -> bool;
+  auto allocate(u32 node, u32 x, u32 y, u32 node_size, u32 rect_size, ShadowAtlasView& view) -> bool;
+};
+
+namespace shadow_atlas {
+constexpr static auto MIN_RESOLUTION = 64_u32;
+constexpr static auto CUBE_FACE_COUNT = 6_u32;
+
+// Projected radius of a light's sphere relative to half the screen height, clamped to
+// [0, 1]. Zero when the sphere is outside `frustum`, one when the camera is inside it.
+auto get_screen_importance(const CullFrustum& frustum,
+                           const glm::vec3& camera_position,
+                           f32 projection_scale,
+                           const glm::vec3& center,
+                           f32 radius) -> f32;
+// `max_resolution` scaled by importance, rounded down to a power of two. With a
+// `previous_resolution` the importance has to move `hysteresis` past a step before the
+// resolution follows, so lights hovering around one don't repack the atlas every frame.
+auto select_resolution(u32 max_resolution, f32 importance, u32 previous_resolution = 0, f32 hysteresis = 0.0f)
+    -> u32;
+
+// Reversed depth and flipped y like the camera, so the shadow pass shares its conventions.
+auto get_spot_view_projection(const glm::vec3& position, const glm::vec3& direction, f32 range, f32 outer_cone_angle)
+    -> glm::mat4;
+// Faces in +x, -x, +y, -y, +z, -z order.
+auto get_point_view_projection(const glm::vec3& position, f32 range, u32 face) -> glm::mat4;
+// Orthographic view of the sphere around `center`, `direction` points towards the light.
+// The view is snapped to whole texels, so it only changes when `center` crosses one.
+auto get_directional_view_projection(const glm::vec3& direction, const glm::vec3& center, f32 radius, u32 resolution)
+    -> glm::mat4;
+} // namespace shadow_atlas
+} // namespace ox
@@ -4,6 +4,7 @@
 
 #include "Audio/AudioEngine.hpp"
 #include "Core/UUID.hpp"
+#include "Render/ParticleSystem.hpp"
 #include "Render/Utils/RectPacker.hpp"
 #include "Utils/OxMath.hpp"
 
@@ -65,6 +66,7 @@ ECS_COMPONENT_BEGIN(MeshComponent)
   ECS_COMPONENT_MEMBER(mesh_uuid, UUID, {})
   ECS_COMPONENT_MEMBER(mesh_index, u32, {})
   ECS_COMPONENT_MEMBER(cast_shadows, bool, true)
+  ECS_COMPONENT_MEMBER(occluder, bool, false)
 
 #ifndef ECS_REFLECT_TYPES
   AABB aabb = {};
@@ -180,7 +182,62 @@ ECS_COMPONENT_BEGIN(CameraComponent)
 ECS_COMPONENT_END();
 
 ECS_COMPONENT_BEGIN(ParticleSystemComponent)
-    ECS_COMPONENT_MEMBER(placeholder, u32, 0) // so warnings shut up for now
+  ECS_COMPONENT_MEMBER(duration, f32, 3.0f)
+  ECS_COMPONENT_MEMBER(looping, bool, true)
+  ECS_COMPONENT_MEMBER(start_delay, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(start_lifetime, f32, 3.0f)
+  ECS_COMPONENT_MEMBER(start_velocity, glm::vec3, {0.0f, 2.0f, 0.0f})
+  ECS_COMPONENT_MEMBER(start_color, glm::vec4, {1.0f, 1.0f, 1.0f, 1.0f})
+  ECS_COMPONENT_MEMBER(start_size, glm::vec2, {1.0f, 1.0f})
+  ECS_COMPONENT_MEMBER(start_rotation, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(gravity_modifier, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(simulation_speed, f32, 1.0f)
+  ECS_COMPONENT_MEMBER(play_on_awake, bool, true)
+  ECS_COMPONENT_MEMBER(max_particles, u32, 1000)
+
+  ECS_COMPONENT_MEMBER(rate_over_time, u32, 10)
+  ECS_COMPONENT_MEMBER(rate_over_distance, u32, 0)
+  ECS_COMPONENT_MEMBER(burst_count, u32, 0)
+  ECS_COMPONENT_MEMBER(burst_time, f32, 1.0f)
+  ECS_COMPONENT_MEMBER(position_start, glm::vec3, {-0.2f, 0.0f, 0.0f})
+  ECS_COMPONENT_MEMBER(position_end, glm::vec3, {0.2f, 0.0f, 0.0f})
+
+  // Modules are flattened, the component serializer only knows plain members.
+  ECS_COMPONENT_MEMBER(velocity_over_lifetime, bool, false)
+  ECS_COMPONENT_MEMBER(velocity_over_lifetime_start, glm::vec3, {1.0f, 1.0f, 1.0f})
+  ECS_COMPONENT_MEMBER(velocity_over_lifetime_end, glm::vec3, {1.0f, 1.0f, 1.0f})
+  ECS_COMPONENT_MEMBER(force_over_lifetime, bool, false)
+  ECS_COMPONENT_MEMBER(force_over_lifetime_start, glm::vec3, {0.0f, 0.0f, 0.0f})
+  ECS_COMPONENT_MEMBER(force_over_lifetime_end, glm::vec3, {0.0f, 0.0f, 0.0f})
+  ECS_COMPONENT_MEMBER(color_over_lifetime, bool, false)
+  ECS_COMPONENT_MEMBER(color_over_lifetime_start, glm::vec4, {0.8f, 0.2f, 0.2f, 0.0f})
+  ECS_COMPONENT_MEMBER(color_over_lifetime_end, glm::vec4, {0.2f, 0.2f, 0.75f, 1.0f})
+  ECS_COMPONENT_MEMBER(color_by_speed, bool, false)
+  ECS_COMPONENT_MEMBER(color_by_speed_start, glm::vec4, {0.8f, 0.2f, 0.2f, 0.0f})
+  ECS_COMPONENT_MEMBER(color_by_speed_end, glm::vec4, {0.2f, 0.2f, 0.75f, 1.0f})
+  ECS_COMPONENT_MEMBER(color_by_speed_min_speed, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(color_by_speed_max_speed, f32, 1.0f)
+  ECS_COMPONENT_MEMBER(size_over_lifetime, bool, false)
+  ECS_COMPONENT_MEMBER(size_over_lifetime_start, glm::vec2, {0.2f, 0.2f})
+  ECS_COMPONENT_MEMBER(size_over_lifetime_end, glm::vec2, {1.0f, 1.0f})
+  ECS_COMPONENT_MEMBER(size_by_speed, bool, false)
+  ECS_COMPONENT_MEMBER(size_by_speed_start, glm::vec2, {0.2f, 0.2f})
+  ECS_COMPONENT_MEMBER(size_by_speed_end, glm::vec2, {1.0f, 1.0f})
+  ECS_COMPONENT_MEMBER(size_by_speed_min_speed, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(size_by_speed_max_speed, f32, 1.0f)
+  ECS_COMPONENT_MEMBER(rotation_over_lifetime, bool, false)
+  ECS_COMPONENT_MEMBER(rotation_over_lifetime_start, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(rotation_over_lifetime_end, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(rotation_by_speed, bool, false)
+  ECS_COMPONENT_MEMBER(rotation_by_speed_start, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(rotation_by_speed_end, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(rotation_by_speed_min_speed, f32, 0.0f)
+  ECS_COMPONENT_MEMBER(rotation_by_speed_max_speed, f32, 1.0f)
+
+#ifndef ECS_REFLECT_TYPES
+  // Only valid while the scene is running.
+  ParticleEmitterID emitter_id = ParticleEmitterID::Invalid;
+#endif
 ECS_COMPONENT_END();
 
 ECS_COMPONENT_BEGIN(LightComponent)
@@ -381,8 +438,14 @@ ECS_COMPONENT_BEGIN(AudioSourceComponent)
   ECS_COMPONENT_MEMBER(cone_outer_gain, f32, 0.0f)
 
   ECS_COMPONENT_MEMBER(doppler_factor, f32, 1.0f)
+  ECS_COMPONENT_MEMBER(priority, i32, 0)
 
   ECS_COMPONENT_MEMBER(audio_source, UUID, {})
+
+#ifndef ECS_REFLECT_TYPES
+  // Only valid while the scene is running.
+  AudioVoiceID voice_id = AudioVoiceID::Invalid;
+#endif
 ECS_COMPONENT_END();
 
 ECS_COMPONENT_BEGIN(AudioListenerComponent)
@@ -6,8 +6,10 @@
 #include <Jolt/Physics/Body/Body.h>
 #include <Jolt/Physics/Collision/ContactListener.h>
 
+#include "Audio/AudioSourceTracker.hpp"
 #include "Core/UUID.hpp"
 #include "Memory/SlotMap.hpp"
+#include "Render/ParticleSystem.hpp"
 #include "Render/RenderPipeline.hpp"
 #include "Scene/ECSModule/Core.hpp"
 #include "Scene/SceneGPU.hpp"
@@ -31,6 +33,8 @@ struct ankerl::unordered_dense::hash<flecs::entity> {
 };
 
 namespace ox {
+class LuaSystem;
+class LuaQueryCache;
 class Physics3DContactListener;
 class Physics3DBodyActivationListener;
 
@@ -59,6 +63,9 @@ public:
   ankerl::unordered_dense::map<flecs::entity, GPU::TransformID> entity_transforms_map = {};
   ankerl::unordered_dense::map<std::pair<UUID, usize>, std::vector<GPU::TransformID>> rendering_meshes_map = {};
 
+  // Emitters of `ParticleSystemComponent`s, only populated while the scene is running.
+  ParticleSystem particle_system = {};
+
   explicit Scene(const std::shared_ptr<RenderPipeline>& render_pipeline = nullptr);
   explicit Scene(const std::string& name);
 
@@ -95,16 +102,13 @@ public:
 
   auto set_dirty(this Scene& self, flecs::entity entity) -> void;
 
+  // Component layouts and cached queries handed out to scripts.
+  auto get_lua_queries(this Scene& self) -> LuaQueryCache&;
+
   // Physics interfaces
-  auto on_contact_added(const JPH::Body& body1,
-                        const JPH::Body& body2,
-                        const JPH::ContactManifold& manifold,
-                        const JPH::ContactSettings& settings) -> void;
-  auto on_contact_persisted(const JPH::Body& body1,
-                            const JPH::Body& body2,
-                            const JPH::ContactManifold& manifold,
-                            const JPH::ContactSettings& settings) -> void;
-  auto on_contact_removed(const JPH::SubShapeIDPair& sub_shape_pair) -> void;
+  // Delivers contacts recorded during the last physics step as one batch to
+  // `physics_events` observers and to the `on_contacts` function of scripts.
+  auto dispatch_contact_events() -> void;
 
   auto on_body_activated(const JPH::BodyID& body_id, JPH::uint64 body_user_data) -> void;
   auto on_body_deactivated(const JPH::BodyID& body_id, JPH::uint64 body_user_data) -> void;
@@ -122,12 +126,22 @@ public:
 private:
   bool running = false;
 
+  // Sources whose component or world transform changed while running.
+  AudioSourceTracker audio_sources = {};
+
   auto add_transform(this Scene& self, flecs::entity entity) -> GPU::TransformID;
   auto remove_transform(this Scene& self, flecs::entity entity) -> void;
+  // Hands the marked sources' parameters to their voices.
+  auto update_audio_sources(this Scene& self) -> void;
 
   // Renderer
   std::shared_ptr<RenderPipeline> _render_pipeline = nullptr;
 
+  // Scripting
+  ankerl::unordered_dense::map<LuaSystem*, std::vector<flecs::entity>> script_update_batches = {};
+  std::vector<std::pair<LuaSystem*, flecs::entity>> isolated_script_jobs = {};
+  std::unique_ptr<LuaQueryCache> lua_query_cache = nullptr;
+
   // Physics
   Physics3DContactListener* contact_listener_3d;
   Physics3DBodyActivationListener* body_activation_listener_3d;
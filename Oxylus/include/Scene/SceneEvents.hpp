@@ -7,40 +7,14 @@
 #include <Jolt/Physics/Collision/ContactListener.h>
 // clang-format on
 
-namespace ox::SceneEvents {
-struct OnContactAddedEvent {
-  const JPH::Body& body1;
-  const JPH::Body& body2;
-  const JPH::ContactManifold& manifold;
-  const JPH::ContactSettings& settings;
-  OnContactAddedEvent(const JPH::Body& body1_,
-                      const JPH::Body& body2_,
-                      const JPH::ContactManifold& manifold_,
-                      const JPH::ContactSettings& settings_)
-      : body1(body1_),
-        body2(body2_),
-        manifold(manifold_),
-        settings(settings_) {}
-};
+#include "Physics/ContactEvents.hpp"
 
-struct OnContactPersistedEvent {
-  const JPH::Body& body1;
-  const JPH::Body& body2;
-  const JPH::ContactManifold& manifold;
-  const JPH::ContactSettings& settings;
-  OnContactPersistedEvent(const JPH::Body& body1_,
-                          const JPH::Body& body2_,
-                          const JPH::ContactManifold& manifold_,
-                          const JPH::ContactSettings& settings_)
-      : body1(body1_),
-        body2(body2_),
-        manifold(manifold_),
-        settings(settings_) {}
-};
-
-struct OnContactRemovedEvent {
-  const JPH::SubShapeIDPair& sub_shape_pair;
-  OnContactRemovedEvent(const JPH::SubShapeIDPair& sub_shape_pair_) : sub_shape_pair(sub_shape_pair_) {}
+namespace ox::SceneEvents {
+// Every contact added, persisted or removed during the last physics step,
+// emitted once after the step in a deterministic order.
+struct OnContactEventsBatch {
+  std::span<const ContactEvent> events;
+  OnContactEventsBatch(std::span<const ContactEvent> events_) : events(events_) {}
 };
 
 struct OnBodyActivatedEvent {
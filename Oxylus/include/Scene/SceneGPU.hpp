@@ -29,8 +29,9 @@ enum class CullFlags : u32 {
   MeshletFrustum = 1 << 0,
   TriangleBackFace = 1 << 1,
   MicroTriangles = 1 << 2,
+  MeshletCone = 1 << 3,
 
-  All = MeshletFrustum | TriangleBackFace | MicroTriangles,
+  All = MeshletFrustum | TriangleBackFace | MicroTriangles | MeshletCone,
 };
 
 struct Meshlet {
@@ -43,13 +44,26 @@ struct Meshlet {
 struct MeshletBounds {
   alignas(4) glm::vec3 aabb_min = {};
   alignas(4) glm::vec3 aabb_max = {};
+  alignas(4) glm::vec3 sphere_center = {};
+  alignas(4) f32 sphere_radius = 0.0f;
+  // Normal cone, every triangle faces away from viewers inside the cone behind `cone_apex`.
+  alignas(4) glm::vec3 cone_apex = {};
+  alignas(4) glm::vec3 cone_axis = {};
+  alignas(4) f32 cone_cutoff = 1.0f;
 };
 
+// Selected LOD of a primitive instance that was culled on the CPU, matches no meshlet.
+constexpr static auto CULLED_LOD = ~0_u32;
+
 struct MeshletInstance {
   alignas(4) u32 mesh_index = 0;
   alignas(4) u32 material_index = 0;
   alignas(4) u32 transform_index = 0;
   alignas(4) u32 meshlet_index = 0;
+  // Every LOD is listed, the meshlet is only drawn while `lod_index` is the level selected
+  // for its (mesh, transform, primitive) this frame.
+  alignas(4) u32 primitive_instance_index = 0;
+  alignas(4) u32 lod_index = 0;
 };
 
 struct Mesh {
@@ -60,6 +74,12 @@ struct Mesh {
   alignas(8) u64 meshlets = 0;
   alignas(8) u64 meshlet_bounds = 0;
   alignas(8) u64 local_triangle_indices = 0;
+  // Set instead of the float streams above when the mesh is quantized.
+  alignas(8) u64 quantized_positions = 0;
+  alignas(8) u64 quantized_normals = 0;
+  alignas(8) u64 quantized_texture_coords = 0;
+  alignas(4) glm::vec3 position_min = {};
+  alignas(4) glm::vec3 position_extent = {};
 };
 
 enum class MaterialFlag : u32 {
@@ -140,6 +160,51 @@ struct Sun {
   alignas(4) f32 intensity = 10.0f;
 };
 
+enum class LightType : u32 {
+  Point = 0,
+  Spot,
+};
+
+struct Light {
+  alignas(4) glm::vec3 position = {};
+  alignas(4) f32 range = 0.0f;
+  // Color multiplied by intensity.
+  alignas(4) glm::vec3 color = {};
+  alignas(4) LightType type = LightType::Point;
+  alignas(4) glm::vec3 direction = {};
+  // Spot falloff as `saturate(dot(-L, direction) * spot_scale + spot_offset)`.
+  alignas(4) f32 spot_scale = 0.0f;
+  alignas(4) f32 spot_offset = 1.0f;
+  // First shadow view, point lights use six consecutive ones. ~0 without shadows.
+  alignas(4) u32 shadow_view = ~0_u32;
+};
+
+struct LightClusters {
+  alignas(8) u64 lights = 0;
+  // (offset, count) into `indices` per cluster.
+  alignas(8) u64 ranges = 0;
+  alignas(8) u64 indices = 0;
+  alignas(4) glm::uvec3 grid_size = {};
+  alignas(4) u32 light_count = 0;
+  // Depth slice of a pixel is `log(depth) * slice_scale + slice_bias`.
+  alignas(4) f32 slice_scale = 0.0f;
+  alignas(4) f32 slice_bias = 0.0f;
+};
+
+struct ShadowView {
+  alignas(4) glm::mat4 view_projection = {};
+  // Rect in atlas texels as (x, y, width, height), empty when the view didn't fit.
+  alignas(4) glm::vec4 atlas_rect = {};
+};
+
+struct Shadows {
+  alignas(8) u64 views = 0;
+  alignas(4) u32 view_count = 0;
+  alignas(4) u32 sun_view = ~0_u32;
+  alignas(4) f32 depth_bias = 0.0f;
+  alignas(4) f32 normal_bias = 0.0f;
+};
+
 constexpr static f32 CAMERA_SCALE_UNIT = 0.01f;
 constexpr static f32 INV_CAMERA_SCALE_UNIT = 1.0f / CAMERA_SCALE_UNIT;
 constexpr static f32 PLANET_RADIUS_OFFSET = 0.001f;
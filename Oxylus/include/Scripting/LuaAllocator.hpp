@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Oxylus.hpp"
+
+namespace ox {
+struct LuaAllocatorStats {
+  // Live bytes requested by Lua, this is the size of the Lua heap.
+  usize used_bytes = 0;
+  usize peak_bytes = 0;
+  // Bytes held by pool pages, used or not.
+  usize reserved_bytes = 0;
+  u64 allocation_count = 0;
+  // Monotonic, every byte ever handed out. Used to attribute allocations in the profiler.
+  u64 total_allocated_bytes = 0;
+  // Allocations too big for the pools that went to the heap.
+  u64 heap_allocation_count = 0;
+};
+
+// `lua_Alloc` backend for a single Lua state. Short lived small blocks (math userdata,
+// closures, short strings, small tables) are served from per size class free lists
+// carved out of larger pages, so temporaries in script loops don't hit malloc. Lua
+// passes the old block size on every call, which means blocks need no header.
+// Not thread safe, every Lua state needs its own instance.
+class LuaAllocator {
+public:
+  constexpr static usize SIZE_CLASS_GRANULARITY = 16;
+  constexpr static usize MAX_POOLED_SIZE = 256;
+  constexpr static usize SIZE_CLASS_COUNT = MAX_POOLED_SIZE / SIZE_CLASS_GRANULARITY;
+  constexpr static usize PAGE_SIZE = ox::kib_to_bytes(64_sz);
+
+  LuaAllocator() = default;
+  ~LuaAllocator();
+
+  LuaAllocator(const LuaAllocator&) = delete;
+  auto operator=(const LuaAllocator&) -> LuaAllocator& = delete;
+
+  // Matches `lua_Alloc`, `user_data` must point to a LuaAllocator.
+  static auto lua_alloc(void* user_data, void* ptr, usize old_size, usize new_size) -> void*;
+
+  auto get_stats() const -> const LuaAllocatorStats& { return stats; }
+
+private:
+  struct FreeBlock {
+    FreeBlock* next = nullptr;
+  };
+
+  FreeBlock* free_lists[SIZE_CLASS_COUNT] = {};
+  std::vector<u8*> pages = {};
+  u8* page_cursor = nullptr;
+  u8* page_end = nullptr;
+  LuaAllocatorStats stats = {};
+
+  static auto get_size_class(usize size) -> usize { return (size - 1) / SIZE_CLASS_GRANULARITY; }
+
+  auto allocate(usize size) -> void*;
+  auto reallocate(void* ptr, usize old_size, usize new_size) -> void*;
+  auto deallocate(void* ptr, usize size) -> void;
+};
+} // namespace ox
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Oxylus.hpp"
+
+namespace ox::lua_bytecode_cache {
+// On-disk cache files are this header followed by the bytecode. Lua only checks the version
+// and number formats of a binary chunk, a truncated or corrupted body is undefined behaviour
+// once it runs. So the header carries a checksum of the bytecode and the hash and size of
+// the source it was compiled from, and both are verified before the chunk is loaded.
+struct Header {
+  u32 magic = 0;
+  u32 lua_version = 0;
+  u64 source_hash = 0;
+  u64 source_size = 0;
+  u64 bytecode_hash = 0;
+  u64 bytecode_size = 0;
+};
+
+constexpr static auto MAGIC = 0x4342584f_u32; // "OXBC"
+
+auto encode(std::string_view source, std::string_view bytecode) -> std::vector<u8>;
+
+// Bytecode stored in `file`, empty unless the file is intact and was compiled from `source`
+// by this Lua version.
+auto decode(std::span<const u8> file, std::string_view source) -> std::string_view;
+} // namespace ox::lua_bytecode_cache
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Utils/CVars.hpp"
+
+namespace ox {
+namespace LuaCVar {
+// clang-format off
+inline AutoCVar_Float cvar_gc_budget_ms("lua.gc_budget_ms", "time the lua garbage collector may use per frame in milliseconds", 1.0f);
+inline AutoCVar_Int cvar_gc_step_kb("lua.gc_step_kb", "work done by a single incremental gc step, in kilobytes of allocation", 16);
+inline AutoCVar_Int cvar_gc_pause("lua.gc_pause", "heap growth in percent since the last finished cycle before a new cycle starts", 200);
+inline AutoCVar_Int cvar_gc_generational("lua.gc_generational", "use lua's generational collector, a minor collection runs once the heap grew by lua.gc_minor_kb", 0);
+inline AutoCVar_Int cvar_gc_minor_kb("lua.gc_minor_kb", "heap growth in kilobytes that triggers a minor collection in generational mode", 1024);
+// clang-format on
+} // namespace LuaCVar
+} // namespace ox
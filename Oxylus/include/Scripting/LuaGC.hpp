@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Oxylus.hpp"
+
+struct lua_State;
+
+namespace ox {
+class LuaAllocator;
+
+struct LuaGCStats {
+  usize heap_bytes = 0;
+  f64 last_frame_millis = 0.0;
+  // Worst single frame since startup.
+  f64 max_frame_millis = 0.0;
+  u32 last_frame_steps = 0;
+  u64 cycle_count = 0;
+  bool generational = false;
+};
+
+// Drives the garbage collector of one Lua state in per frame time slices, Lua's own pacing
+// is turned off. Budget, step size, pause and mode come from the `lua.gc_*` cvars.
+class LuaGC {
+public:
+  // `allocator` backs `state` and reports its heap size.
+  LuaGC(lua_State* state_, const LuaAllocator* allocator_);
+
+  // Once per frame.
+  auto step() -> void;
+  // Runs a full collection at the start of the next step instead of in the middle of a frame.
+  auto request_full_gc() -> void { full_gc_requested = true; }
+
+  auto get_stats() const -> const LuaGCStats& { return stats; }
+
+private:
+  lua_State* state = nullptr;
+  const LuaAllocator* allocator = nullptr;
+
+  LuaGCStats stats = {};
+  bool full_gc_requested = false;
+  bool cycle_running = false;
+  // Heap size when the last cycle (or minor collection) finished, used for pacing.
+  usize cycle_end_bytes = 0;
+
+  auto set_mode(bool generational) -> void;
+  auto get_heap_bytes() const -> usize;
+};
+} // namespace ox
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Core/ESystem.hpp"
+#include "Scripting/LuaAllocator.hpp"
+#include "Scripting/LuaGC.hpp"
+#include "Scripting/LuaProfiler.hpp"
+#include "Scripting/LuaWorkerPool.hpp"
 
 #include <sol/state.hpp>
 
@@ -10,11 +14,44 @@ public:
   auto init() -> std::expected<void, std::string> override;
   auto deinit() -> std::expected<void, std::string> override;
 
+  // Drives the garbage collector, Lua's own pacing is turned off.
+  auto on_update() -> void override;
+
   sol::state* get_state() const { return _state.get(); }
 
+  // Loads the chunk of a script file without running it. Bytecode is cached in
+  // memory and on disk keyed by a hash of the source, so unchanged scripts are
+  // only parsed once and cold starts skip parsing too. Cache files are only loaded
+  // after their checksum and source hash are verified.
+  auto load_script_chunk(const std::string& path) -> sol::load_result;
+
+  auto get_bytecode_cache_dir() const -> const std::string& { return bytecode_cache_dir; }
+
+  auto get_allocator_stats() const -> const LuaAllocatorStats& { return allocator->get_stats(); }
+  auto get_gc_stats() const -> const LuaGCStats& { return gc->get_stats(); }
+
+  // Worker states for isolated scripts, created on first use.
+  auto get_worker_pool() -> LuaWorkerPool&;
+
+  auto get_profiler() -> LuaProfiler& { return profiler; }
+  auto start_profiler(i32 instruction_interval = LuaProfiler::DEFAULT_INTERVAL) -> void;
+
+  // Runs a full collection at the start of the next update instead of in the middle of a frame.
+  auto request_full_gc() -> void { gc->request_full_gc(); }
+
 private:
+  // Must outlive the state.
+  std::unique_ptr<LuaAllocator> allocator = nullptr;
   std::unique_ptr<sol::state> _state = nullptr;
 
+  std::string bytecode_cache_dir = {};
+  ankerl::unordered_dense::map<u64, std::string> bytecode_cache = {};
+
+  std::unique_ptr<LuaWorkerPool> worker_pool = nullptr;
+  LuaProfiler profiler = {};
+
+  std::unique_ptr<LuaGC> gc = nullptr;
+
   void bind_log() const;
 };
 } // namespace ox
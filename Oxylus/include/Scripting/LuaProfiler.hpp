@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Oxylus.hpp"
+
+struct lua_State;
+struct lua_Debug;
+
+namespace ox {
+class LuaAllocator;
+
+struct LuaProfileLine {
+  std::string script = {};
+  std::string source = {};
+  std::string function = {};
+  i32 line = 0;
+  f64 millis = 0.0;
+  u64 samples = 0;
+  u64 alloc_bytes = 0;
+  u64 alloc_count = 0;
+};
+
+struct LuaProfileScript {
+  std::string script = {};
+  f64 millis = 0.0;
+  u64 calls = 0;
+  u64 alloc_bytes = 0;
+  u64 alloc_count = 0;
+};
+
+// Sampling profiler for the main Lua state. A count hook fires every `interval`
+// VM instructions and charges the time and allocations since the previous sample
+// to the line that is running. Time spent in engine functions called from Lua is
+// charged to the calling line. Script callbacks are wrapped in a `Scope`, which
+// gives exact per script totals and keeps time outside of Lua from leaking into
+// the first sample of the next call.
+class LuaProfiler {
+public:
+  class Scope {
+  public:
+    // No-op when `profiler_` is null or not running.
+    Scope(LuaProfiler* profiler_, const std::string& script);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    auto operator=(const Scope&) -> Scope& = delete;
+
+  private:
+    LuaProfiler* profiler = nullptr;
+    u32 previous_script = 0;
+    std::chrono::steady_clock::time_point start = {};
+    u64 start_alloc_bytes = 0;
+    u64 start_alloc_count = 0;
+  };
+
+  constexpr static i32 DEFAULT_INTERVAL = 1000;
+
+  LuaProfiler() = default;
+  ~LuaProfiler();
+
+  auto start(lua_State* L, const LuaAllocator* allocator, i32 interval = DEFAULT_INTERVAL) -> void;
+  auto stop() -> void;
+  auto reset() -> void;
+
+  auto is_running() const -> bool { return state != nullptr; }
+  auto get_interval() const -> i32 { return instruction_interval; }
+
+  // Sorted by time, most expensive first.
+  auto get_lines() const -> std::vector<LuaProfileLine>;
+  auto get_scripts() const -> std::vector<LuaProfileScript>;
+
+  // Writes per line results as CSV.
+  auto export_csv(const std::string& path) const -> bool;
+
+private:
+  struct LineKey {
+    u32 script = 0;
+    const void* source = nullptr;
+    i32 line = 0;
+
+    auto operator==(const LineKey&) const -> bool = default;
+  };
+
+  struct LineKeyHash {
+    using is_avalanching = void;
+    auto operator()(const LineKey& key) const noexcept -> u64;
+  };
+
+  lua_State* state = nullptr;
+  const LuaAllocator* allocator = nullptr;
+  i32 instruction_interval = DEFAULT_INTERVAL;
+
+  // Index 0 is reserved for code that runs outside of any script callback.
+  std::vector<LuaProfileScript> scripts = {};
+  ankerl::unordered_dense::map<std::string, u32> script_indices = {};
+  ankerl::unordered_dense::map<LineKey, LuaProfileLine, LineKeyHash> lines = {};
+
+  u32 current_script = 0;
+  option<LineKey> last_line = nullopt;
+  std::chrono::steady_clock::time_point last_sample_time = {};
+  u64 last_alloc_bytes = 0;
+  u64 last_alloc_count = 0;
+
+  static auto hook(lua_State* L, lua_Debug* ar) -> void;
+
+  auto get_script_index(const std::string& script) -> u32;
+  auto begin_sample_window() -> void;
+  // Charges the open window to the last sampled line, used when a callback starts or ends.
+  auto flush_pending() -> void;
+  auto take_sample(lua_State* L, lua_Debug* ar) -> void;
+  auto charge(LuaProfileLine& line, bool is_sample) -> void;
+};
+} // namespace ox
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <flecs.h>
+#include <sol/forward.hpp>
+
+#include "Oxylus.hpp"
+
+namespace ox {
+class Scene;
+
+// Reflected member of a component, resolved once from its flecs::Struct.
+struct ComponentField {
+  enum class Type : u32 { Bool = 0, F32, I32, U32, I64, U64, Vec2, Vec3, Vec4, Quat, Unsupported };
+
+  Type type = Type::Unsupported;
+  u32 offset = 0;
+};
+
+auto get_field_size(ComponentField::Type type) -> usize;
+// Conversions between reflected members and Lua values, shared by the bindings and the script workers.
+auto component_field_to_lua(lua_State* L, ComponentField::Type type, const u8* ptr) -> sol::object;
+auto lua_to_component_field(ComponentField::Type type, u8* ptr, const sol::object& value) -> bool;
+
+struct ComponentLayout {
+  flecs::entity component = {};
+  usize size = 0;
+  ankerl::unordered_dense::map<std::string, ComponentField> fields = {};
+
+  auto find_field(std::string_view name) const -> option<ComponentField>;
+};
+
+// Strided view over one member of one query term inside a single table. Shared
+// components (stride 0) are exposed as a column where every row aliases the same value.
+// Writes go straight into the table and do not emit OnSet events.
+struct LuaQueryColumn {
+  u8* data = nullptr;
+  usize stride = 0;
+  u32 count = 0;
+  ComponentField::Type type = ComponentField::Type::Unsupported;
+
+  // `index` is 1-based to match Lua.
+  template <typename T>
+  auto at(u32 index) const -> T* {
+    if (index == 0 || index > count)
+      return nullptr;
+
+    return reinterpret_cast<T*>(data + stride * (index - 1));
+  }
+};
+
+class LuaQuery;
+struct LuaQueryChunk {
+  const LuaQuery* query = nullptr;
+  flecs::iter* iter = nullptr;
+
+  auto count() const -> u32 { return static_cast<u32>(iter->count()); }
+  auto entity(u32 index) const -> flecs::entity;
+  auto column(u32 term, std::string_view field_name) const -> LuaQueryColumn;
+  // Emits OnSet for the term on every row, needed after writing components that
+  // observers react to (e.g. TransformComponent). The events are queued and only
+  // reach observers once `each_chunk` returns.
+  auto mark_modified(u32 term) const -> void;
+};
+
+// Cached flecs query over components looked up by name. Scripts iterate it one table
+// (chunk) at a time and read or write member columns directly, so the per entity cost
+// is plain memory access instead of a usertype per component.
+class LuaQuery {
+public:
+  LuaQuery(flecs::world& world_, std::vector<const ComponentLayout*> layouts_);
+  ~LuaQuery();
+
+  LuaQuery(const LuaQuery&) = delete;
+  auto operator=(const LuaQuery&) -> LuaQuery& = delete;
+
+  // The world is deferred while iterating. Observers triggered by `mark_modified` or by
+  // other changes `fn` makes can't move rows of the table it is writing to, they run
+  // once the iteration is done.
+  template <typename FuncT>
+  auto each_chunk(const FuncT& fn) const -> void {
+    ZoneScoped;
+
+    ecs_defer_begin(world);
+    query.run([&](flecs::iter& it) {
+      while (it.next()) {
+        const LuaQueryChunk chunk = {.query = this, .iter = &it};
+        if (!fn(chunk)) {
+          it.fini();
+          return;
+        }
+      }
+    });
+    ecs_defer_end(world);
+  }
+
+  auto get_term_count() const -> u32 { return static_cast<u32>(layouts.size()); }
+  auto get_layout(u32 term) const -> const ComponentLayout* { return layouts[term]; }
+  auto get_entity_count() const -> u32 { return static_cast<u32>(query.count()); }
+
+private:
+  flecs::world_t* world = nullptr;
+  flecs::query<> query = {};
+  std::vector<const ComponentLayout*> layouts = {};
+};
+
+// Binds the Query, QueryChunk and QueryColumn usertypes. Part of the component bindings,
+// separate so headless benchmarks can run query scripts without a scene.
+auto bind_lua_query_types(sol::state* state) -> void;
+
+// Per scene cache of component layouts and script queries. Queries are keyed by their
+// component list and live as long as the scene, so scripts can ask for them every frame.
+// Layout lookups are thread safe, queries are main thread only.
+class LuaQueryCache {
+public:
+  explicit LuaQueryCache(Scene* scene_) : scene(scene_) {}
+
+  auto find_component(std::string_view name) -> flecs::entity;
+  auto get_layout(flecs::entity component) -> const ComponentLayout*;
+  auto get_layout(std::string_view component_name) -> const ComponentLayout*;
+  auto get_query(std::span<const std::string> component_names) -> LuaQuery*;
+
+private:
+  Scene* scene = nullptr;
+  std::mutex layout_mutex = {};
+  ankerl::unordered_dense::map<flecs::entity_t, std::unique_ptr<ComponentLayout>> layouts = {};
+  ankerl::unordered_dense::map<std::string, std::unique_ptr<LuaQuery>> queries = {};
+};
+} // namespace ox
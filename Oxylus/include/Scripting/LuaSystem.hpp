@@ -5,6 +5,7 @@
 #include <vuk/Types.hpp>
 
 #include "Oxylus.hpp"
+#include "Scripting/LuaProfiler.hpp"
 
 namespace JPH {
 class ContactSettings;
@@ -14,39 +15,77 @@ class Body;
 
 namespace ox {
 class Scene;
+struct ContactEvent;
 
 enum class ScriptID : u64 { Invalid = std::numeric_limits<u64>::max() };
 class LuaSystem {
 public:
   LuaSystem() = default;
   explicit LuaSystem(std::string path);
+  // Runs `source` in `state` instead of the app's Lua state, without the bytecode cache or
+  // the profiler. Lets scripts run without an app, e.g. in benchmarks. `reload` runs `source` again.
+  LuaSystem(sol::state& state, std::string path, std::string_view source);
   ~LuaSystem() = default;
 
   auto load(const std::string& path) -> void;
   auto reload() -> void;
 
+  // `scene` may be null when there is no scene, `scene` and `world` are left unset then.
   auto bind_globals(Scene* scene, flecs::entity entity, f32 delta_time) const -> void;
 
-  auto on_init(Scene* scene, flecs::entity entity) -> void;
+  // Reloads every distinct script once, in order of first use, and runs `on_init` for each
+  // entity. A script shared by N entities is loaded once, not N times. Returns how many
+  // scripts were reloaded.
+  static auto start_scripts(Scene* scene,
+                            std::span<const std::pair<LuaSystem*, flecs::entity>> scripts,
+                            f32 delta_time) -> u32;
+
+  auto on_init(Scene* scene, flecs::entity entity, f32 delta_time) -> void;
   auto on_update(f32 delta_time) -> void;
+  // Single call with every entity using this script, per entity state is up to the script.
+  auto on_update_batch(Scene* scene, const std::vector<flecs::entity>& entities, f32 delta_time) -> void;
+  auto has_batch_update() const -> bool { return on_update_batch_func != nullptr; }
+  // Updates every entity using this script. `on_update_batch` takes precedence, a script that
+  // defines it never gets `on_update` calls. Otherwise `on_update` runs once per entity.
+  auto update_entities(Scene* scene, const std::vector<flecs::entity>& entities, f32 delta_time) -> void;
   auto on_fixed_update(float delta_time) -> void;
   auto on_release(Scene* scene, flecs::entity entity) -> void;
+  // Called once per physics step with every contact event of that step.
+  auto on_contacts(Scene* scene, const std::vector<ContactEvent>& events) -> void;
   auto on_render(vuk::Extent3D extent, vuk::Format format) -> void;
 
   auto get_path() const -> const std::string& { return file_path; }
 
+  // Scripts that set `isolated = true` promise to not share globals and to only touch the
+  // ECS through the deferred `ecs` commands, their `on_update` runs on worker Lua states.
+  auto is_isolated() const -> bool { return isolated; }
+  auto get_bytecode() const -> const std::string& { return bytecode; }
+  // Changes every time the script is (re)loaded, lets worker states drop stale copies.
+  auto get_version() const -> u64 { return version; }
+
 private:
   std::string file_path = {};
+  bool isolated = false;
+  std::string bytecode = {};
+  u64 version = 0;
   ankerl::unordered_dense::map<int, std::string> errors = {};
+  LuaProfiler* profiler = nullptr;
+  // Only set for scripts created without an app.
+  sol::state* source_state = nullptr;
+  std::string source = {};
 
   std::unique_ptr<sol::environment> environment = nullptr;
   std::unique_ptr<sol::protected_function> on_init_func = nullptr;
   std::unique_ptr<sol::protected_function> on_release_func = nullptr;
   std::unique_ptr<sol::protected_function> on_update_func = nullptr;
+  std::unique_ptr<sol::protected_function> on_update_batch_func = nullptr;
   std::unique_ptr<sol::protected_function> on_render_func = nullptr;
   std::unique_ptr<sol::protected_function> on_fixed_update_func = nullptr;
+  std::unique_ptr<sol::protected_function> on_contacts_func = nullptr;
 
   void init_script(const std::string& path);
+  void init_environment(sol::state& state, sol::load_result load_result);
+  auto profile_scope() const -> LuaProfiler::Scope;
   void check_result(const sol::protected_function_result& result, const char* func_name);
 };
 } // namespace ox
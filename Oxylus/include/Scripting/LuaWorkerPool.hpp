@@ -0,0 +1,83 @@
+#pragma once
+
+#include <flecs.h>
+#include <sol/environment.hpp>
+#include <sol/state.hpp>
+
+#include "Scripting/LuaAllocator.hpp"
+#include "Scripting/LuaQuery.hpp"
+
+namespace ox {
+class Scene;
+class LuaSystem;
+
+// ECS change recorded by an isolated script, applied on the main thread after the parallel phase.
+struct LuaCommand {
+  enum class Type : u32 { SetField = 0, Add, Remove, Destroy, Create };
+
+  Type type = Type::SetField;
+  // Position of the issuing job and of the command within it, the merge order.
+  u32 job_index = 0;
+  u32 sequence = 0;
+  flecs::entity_t entity = 0;
+  flecs::entity_t component = 0;
+  ComponentField field = {};
+  alignas(16) u8 value[16] = {};
+  std::string name = {};
+};
+
+using LuaIsolatedJob = std::pair<LuaSystem*, flecs::entity>;
+
+// One Lua state per task scheduler thread for scripts marked `isolated`. Workers load their
+// own copy of each script from its bytecode and only see math, logging and the `ecs` table:
+//   ecs.get(entity, component, field)         -- reads the value as of the start of the phase
+//   ecs.set(entity, component, field, value)  -- deferred
+//   ecs.add / ecs.remove(entity, component)   -- deferred
+//   ecs.destroy(entity), ecs.create(name)     -- deferred
+// Commands are merged in job order, so the result doesn't depend on which worker ran what.
+class LuaWorkerPool {
+public:
+  explicit LuaWorkerPool(u32 worker_count);
+  ~LuaWorkerPool() = default;
+
+  LuaWorkerPool(const LuaWorkerPool&) = delete;
+  auto operator=(const LuaWorkerPool&) -> LuaWorkerPool& = delete;
+
+  // Runs `on_update` of every job on the task scheduler, then applies the recorded commands.
+  auto run(Scene* scene, std::span<const LuaIsolatedJob> jobs, f32 delta_time) -> void;
+  // Drops every script environment, e.g. when play mode stops.
+  auto reset() -> void;
+
+  auto get_worker_count() const -> u32 { return static_cast<u32>(workers.size()); }
+
+private:
+  struct WorkerScript {
+    u64 version = 0;
+    std::unique_ptr<sol::environment> environment = nullptr;
+    std::unique_ptr<sol::protected_function> on_update_func = nullptr;
+  };
+
+  struct Worker {
+    // Must outlive the state.
+    std::unique_ptr<LuaAllocator> allocator = nullptr;
+    std::unique_ptr<sol::state> state = nullptr;
+    ankerl::unordered_dense::map<const LuaSystem*, WorkerScript> scripts = {};
+    std::vector<LuaCommand> commands = {};
+
+    // Context of the job that is running.
+    Scene* scene = nullptr;
+    u32 job_index = 0;
+    u32 sequence = 0;
+  };
+
+  struct UpdateTask;
+
+  std::vector<std::unique_ptr<Worker>> workers = {};
+  std::vector<LuaCommand> merged_commands = {};
+
+  static auto init_worker(Worker& worker) -> void;
+  static auto get_script(Worker& worker, const LuaSystem* script) -> WorkerScript*;
+  static auto run_job(Worker& worker, const LuaIsolatedJob& job, u32 job_index, f32 delta_time) -> void;
+  auto apply_commands(Scene* scene) -> void;
+};
+} // namespace ox
@@ -25,6 +25,9 @@ public:
 
   void wait_task(const ITaskSet* set) const { task_scheduler->WaitforTask(set); }
 
+  // Threads the scheduler didn't create have to register before adding or waiting on tasks.
+  void register_current_thread() const;
+
   void wait_for_all();
 
 private:
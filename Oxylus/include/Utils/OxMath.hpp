@@ -34,6 +34,16 @@ inline glm::vec2 float32x3_to_oct(glm::vec3 v) {
   return (v.z <= 0.0f) ? ((1.0f - glm::abs(glm::vec2{p.y, p.x})) * sign_not_zero(p)) : p;
 }
 
+inline glm::vec3 oct_to_float32x3(glm::vec2 e) {
+  glm::vec3 v = glm::vec3(e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+  if (v.z < 0.0f) {
+    const glm::vec2 xy = (1.0f - glm::abs(glm::vec2{v.y, v.x})) * sign_not_zero(glm::vec2{v.x, v.y});
+    v.x = xy.x;
+    v.y = xy.y;
+  }
+  return glm::normalize(v);
+}
+
 constexpr uint32_t previous_power2(uint32_t x) {
   uint32_t v = 1;
   while ((v << 1) < x) {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include "Core/Types.hpp"
 
 namespace ox {
@@ -7,7 +9,15 @@ class Timer;
 
 class Timestep {
 public:
+  // Time in milliseconds and sleep of the frame limiter. Empty ones use the high resolution
+  // timer and the OS sleep, tests pass a simulated clock to check pacing deterministically.
+  struct Clock {
+    std::function<f64()> now = {};
+    std::function<void(f64 millis)> sleep = {};
+  };
+
   Timestep();
+  explicit Timestep(Clock clock_);
   ~Timestep();
 
   auto on_update(this Timestep& self) -> void;
@@ -21,6 +31,18 @@ public:
   auto set_max_frame_time(this Timestep& self, f64 value) -> void { self.max_frame_time = 1000.0 / value; }
   auto reset_max_frame_time(this Timestep& self) -> void { self.max_frame_time = -1.0; }
 
+  // Frame limiter stats of the last frame, in milliseconds.
+  auto get_sleep_millis(this const Timestep& self) -> f64 { return self.sleep_time; }
+  auto get_spin_millis(this const Timestep& self) -> f64 { return self.spin_time; }
+  // How far the frame overshot `max_frame_time`.
+  auto get_pacing_error_millis(this const Timestep& self) -> f64 { return self.pacing_error; }
+
+  // Frames start at most this late while the OS sleep wakes up within its usual overshoot,
+  // the rest of the wait is spun with a yield per iteration.
+  constexpr static f64 PACING_TOLERANCE_MILLIS = 0.25;
+  // Upper bound of the spin, a scheduler waking up later than this shows up as pacing error.
+  constexpr static f64 MAX_SPIN_MILLIS = 2.0;
+
   explicit operator float() const { return (float)timestep; }
 
 private:
@@ -29,6 +51,21 @@ private:
   f64 elapsed = 0;
   f64 max_frame_time = -1.0;
 
+  f64 sleep_time = 0;
+  f64 spin_time = 0;
+  f64 pacing_error = 0;
+
+  // How late the OS sleep wakes up, as exponential moving mean and variance so the
+  // estimate follows changes in system load. The limiter spins for mean + stddev.
+  f64 sleep_overshoot = 0.5;
+  f64 overshoot_mean = 0.5;
+  f64 overshoot_variance = 0.0;
+
+  auto wait_until(this Timestep& self, f64 target_time) -> void;
+  auto now(this const Timestep& self) -> f64;
+  auto sleep(this const Timestep& self, f64 millis) -> void;
+
+  Clock clock = {};
   Timer* timer = nullptr;
 };
 } // namespace ox
@@ -4,11 +4,14 @@
 #include <vuk/Types.hpp>
 #include <vuk/vsl/Core.hpp>
 
+#include "Asset/MeshLOD.hpp"
+#include "Asset/MeshOptimizer.hpp"
 #include "Asset/ParserGLTF.hpp"
 #include "Core/App.hpp"
 #include "Core/FileSystem.hpp"
 #include "Memory/Hasher.hpp"
 #include "Memory/Stack.hpp"
+#include "Render/RendererConfig.hpp"
 #include "Render/Vulkan/VkContext.hpp"
 #include "Scene/SceneGPU.hpp"
 #include "Scripting/LuaSystem.hpp"
@@ -820,40 +823,99 @@ auto AssetManager::load_mesh(const UUID& uuid) -> bool {
   std::vector<GPU::MeshletBounds> model_meshlet_bounds = {};
   std::vector<u8> model_local_triangle_indices = {};
 
-  for (const auto& gltf_mesh : mesh->meshes) {
+  // Per primitive scratch, elements are moved out at the end of each iteration
+  // so keeping them outside of the loop lets us reuse their allocations.
+  auto raw_meshlets = std::vector<meshopt_Meshlet>();
+  auto meshlets = std::vector<GPU::Meshlet>();
+  auto meshlet_bounds = std::vector<GPU::MeshletBounds>();
+  auto meshlet_indices = std::vector<u32>();
+  auto local_triangle_indices = std::vector<u8>();
+  auto lod_levels = std::vector<mesh_lod::Level>();
+  auto occluder_remap = std::vector<u32>();
+  // Offset and count of the vertices of every mesh in `model_vertex_positions`.
+  auto mesh_vertex_ranges = std::vector<glm::uvec2>();
+
+  for (auto& gltf_mesh : mesh->meshes) {
+    const auto mesh_vertex_offset = static_cast<u32>(model_vertex_positions.size());
+    auto mesh_bb_min = glm::vec3(std::numeric_limits<f32>::max());
+    auto mesh_bb_max = glm::vec3(std::numeric_limits<f32>::lowest());
+
     for (auto primitive_index : gltf_mesh.primitive_indices) {
       ZoneNamedN(z, "GPU Meshlet Generation", true);
 
       auto& primitive = mesh->primitives[primitive_index];
       auto vertex_offset = model_vertex_positions.size();
-      auto index_offset = model_indices.size();
-      auto triangle_offset = model_local_triangle_indices.size();
-      auto meshlet_offset = model_meshlets.size();
 
       auto raw_indices = std::span(gltf_callbacks.indices.data() + primitive.index_offset, primitive.index_count);
       auto raw_vertex_positions = std::span(gltf_callbacks.vertex_positions.data() + primitive.vertex_offset,
                                             primitive.vertex_count);
       auto raw_vertex_normals = std::span(gltf_callbacks.vertex_normals.data() + primitive.vertex_offset,
                                           primitive.vertex_count);
+      auto raw_vertex_texcoords = gltf_callbacks.vertex_texcoords.empty()
+                                      ? std::span<glm::vec2>()
+                                      : std::span(gltf_callbacks.vertex_texcoords.data() + primitive.vertex_offset,
+                                                  primitive.vertex_count);
+
+      // Meshlets are built from consecutive triangles, so cache friendly input also
+      // gives them better vertex reuse and tighter bounds.
+      mesh_optimizer::optimize_primitive(raw_indices, raw_vertex_positions, raw_vertex_normals, raw_vertex_texcoords);
+
+      for (const auto& position : raw_vertex_positions) {
+        mesh_bb_min = glm::min(mesh_bb_min, position);
+        mesh_bb_max = glm::max(mesh_bb_max, position);
+      }
+
+      {
+        ZoneNamedN(z2, "Build LOD Chain", true);
+        lod_levels = mesh_lod::build_lod_chain(raw_indices, raw_vertex_positions);
+      }
 
-      auto meshlets = std::vector<GPU::Meshlet>();
-      auto meshlet_bounds = std::vector<GPU::MeshletBounds>();
-      auto meshlet_indices = std::vector<u32>();
-      auto local_triangle_indices = std::vector<u8>();
       {
+        // The full mesh, simplified levels move the surface by up to their error and could
+        // hide instances standing right in front of the real one.
+        occluder_remap.assign(raw_vertex_positions.size(), ~0_u32);
+        for (const auto index : raw_indices) {
+          auto& remapped = occluder_remap[index];
+          if (remapped == ~0_u32) {
+            remapped = static_cast<u32>(gltf_mesh.occluder_positions.size());
+            gltf_mesh.occluder_positions.push_back(raw_vertex_positions[index]);
+          }
+          gltf_mesh.occluder_indices.push_back(remapped);
+        }
+      }
+
+      primitive.local_triangle_indices_offset = static_cast<u32>(model_local_triangle_indices.size());
+      primitive.lods.clear();
+      for (usize lod_index = 0; lod_index <= lod_levels.size(); lod_index++) {
         ZoneNamedN(z2, "Build Meshlets", true);
+
+        // Every level indexes the same vertices, only the meshlets differ.
+        const auto lod_indices = lod_index == 0 ? std::span<const u32>(raw_indices)
+                                                : std::span<const u32>(lod_levels[lod_index - 1].indices);
+        const auto lod_error = lod_index == 0 ? 0.0f : lod_levels[lod_index - 1].error;
+
+        auto index_offset = model_indices.size();
+        auto triangle_offset = model_local_triangle_indices.size();
+        auto meshlet_offset = model_meshlets.size();
+
+        raw_meshlets.clear();
+        meshlets.clear();
+        meshlet_bounds.clear();
+        meshlet_indices.clear();
+        local_triangle_indices.clear();
+
         // Worst case count
         auto max_meshlets = meshopt_buildMeshletsBound(
-            raw_indices.size(), Mesh::MAX_MESHLET_INDICES, Mesh::MAX_MESHLET_PRIMITIVES);
-        auto raw_meshlets = std::vector<meshopt_Meshlet>(max_meshlets);
+            lod_indices.size(), Mesh::MAX_MESHLET_INDICES, Mesh::MAX_MESHLET_PRIMITIVES);
+        raw_meshlets.resize(max_meshlets);
         meshlet_indices.resize(max_meshlets * Mesh::MAX_MESHLET_INDICES);
         local_triangle_indices.resize(max_meshlets * Mesh::MAX_MESHLET_PRIMITIVES * 3);
         auto meshlet_count = meshopt_buildMeshlets( //
             raw_meshlets.data(),
             meshlet_indices.data(),
             local_triangle_indices.data(),
-            raw_indices.data(),
-            raw_indices.size(),
+            lod_indices.data(),
+            lod_indices.size(),
             reinterpret_cast<f32*>(raw_vertex_positions.data()),
             raw_vertex_positions.size(),
             sizeof(glm::vec3),
@@ -886,18 +948,43 @@ auto AssetManager::load_mesh(const UUID& uuid) -> bool {
           meshlet.triangle_count = raw_meshlet.triangle_count;
           meshlet_aabb.aabb_min = meshlet_bb_min;
           meshlet_aabb.aabb_max = meshlet_bb_max;
+
+          const auto bounds = meshopt_computeMeshletBounds( //
+              &meshlet_indices[raw_meshlet.vertex_offset],
+              &local_triangle_indices[raw_meshlet.triangle_offset],
+              raw_meshlet.triangle_count,
+              reinterpret_cast<f32*>(raw_vertex_positions.data()),
+              raw_vertex_positions.size(),
+              sizeof(glm::vec3));
+          meshlet_aabb.sphere_center = glm::make_vec3(bounds.center);
+          meshlet_aabb.sphere_radius = bounds.radius;
+          meshlet_aabb.cone_apex = glm::make_vec3(bounds.cone_apex);
+          meshlet_aabb.cone_axis = glm::make_vec3(bounds.cone_axis);
+          meshlet_aabb.cone_cutoff = bounds.cone_cutoff;
         }
 
-        primitive.meshlet_count = static_cast<u32>(meshlet_count);
-        primitive.meshlet_offset = static_cast<u32>(meshlet_offset);
-        primitive.local_triangle_indices_offset = static_cast<u32>(triangle_offset);
+        primitive.lods.push_back({
+            .meshlet_offset = static_cast<u32>(meshlet_offset),
+            .meshlet_count = static_cast<u32>(meshlet_count),
+            .error = lod_error,
+        });
+
+        std::ranges::move(meshlet_indices, std::back_inserter(model_indices));
+        std::ranges::move(meshlets, std::back_inserter(model_meshlets));
+        std::ranges::move(meshlet_bounds, std::back_inserter(model_meshlet_bounds));
+        std::ranges::move(local_triangle_indices, std::back_inserter(model_local_triangle_indices));
       }
 
       std::ranges::move(raw_vertex_positions, std::back_inserter(model_vertex_positions));
-      std::ranges::move(meshlet_indices, std::back_inserter(model_indices));
-      std::ranges::move(meshlets, std::back_inserter(model_meshlets));
-      std::ranges::move(meshlet_bounds, std::back_inserter(model_meshlet_bounds));
-      std::ranges::move(local_triangle_indices, std::back_inserter(model_local_triangle_indices));
+    }
+
+    mesh_vertex_ranges.emplace_back(mesh_vertex_offset,
+                                    static_cast<u32>(model_vertex_positions.size()) - mesh_vertex_offset);
+
+    if (!gltf_mesh.primitive_indices.empty()) {
+      gltf_mesh.bounds_center = (mesh_bb_min + mesh_bb_max) * 0.5f;
+      gltf_mesh.bounds_radius = glm::length(mesh_bb_max - mesh_bb_min) * 0.5f;
+      gltf_mesh.bounds_extent = (mesh_bb_max - mesh_bb_min) * 0.5f;
     }
   }
 
@@ -908,20 +995,73 @@ auto AssetManager::load_mesh(const UUID& uuid) -> bool {
   mesh->indices = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly, ox::size_bytes(model_indices));
   context.wait_on(context.upload_staging(std::span(model_indices), *mesh->indices));
 
-  mesh->vertex_positions = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
-                                                         ox::size_bytes(model_vertex_positions));
-  context.wait_on(context.upload_staging(std::span(model_vertex_positions), *mesh->vertex_positions));
+  const auto float_vertex_bytes = ox::size_bytes(model_vertex_positions) +
+                                  ox::size_bytes(gltf_callbacks.vertex_normals) +
+                                  ox::size_bytes(gltf_callbacks.vertex_texcoords);
+
+  mesh->quantized_vertices = static_cast<bool>(RendererCVar::cvar_quantize_vertices.get());
+  if (mesh->quantized_vertices) {
+    ZoneNamedN(z, "Quantize Vertices", true);
+
+    auto quantized_positions = std::vector<glm::uvec2>(model_vertex_positions.size());
+    for (const auto& [gltf_mesh, vertex_range] : std::views::zip(mesh->meshes, mesh_vertex_ranges)) {
+      const auto positions = std::span(model_vertex_positions).subspan(vertex_range.x, vertex_range.y);
+      gltf_mesh.position_bounds = mesh_quantization::get_position_bounds(positions);
+      for (const auto& [position, encoded] :
+           std::views::zip(positions, std::span(quantized_positions).subspan(vertex_range.x, vertex_range.y))) {
+        encoded = mesh_quantization::encode_position(position, gltf_mesh.position_bounds);
+      }
+    }
+
+    auto quantized_normals = std::vector<u32>(gltf_callbacks.vertex_normals.size());
+    for (const auto& [normal, encoded] : std::views::zip(gltf_callbacks.vertex_normals, quantized_normals)) {
+      encoded = mesh_quantization::encode_normal(normal);
+    }
+
+    auto quantized_tex_coords = std::vector<u32>(gltf_callbacks.vertex_texcoords.size());
+    for (const auto& [tex_coord, encoded] : std::views::zip(gltf_callbacks.vertex_texcoords, quantized_tex_coords)) {
+      encoded = mesh_quantization::encode_tex_coord(tex_coord);
+    }
 
-  mesh->vertex_normals = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
-                                                       ox::size_bytes(gltf_callbacks.vertex_normals));
-  context.wait_on(context.upload_staging(std::span(gltf_callbacks.vertex_normals), *mesh->vertex_normals));
+    mesh->vertex_positions = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
+                                                           ox::size_bytes(quantized_positions));
+    context.wait_on(context.upload_staging(std::span(quantized_positions), *mesh->vertex_positions));
 
-  if (!gltf_callbacks.vertex_texcoords.empty()) {
-    mesh->texture_coords = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
-                                                         ox::size_bytes(gltf_callbacks.vertex_texcoords));
-    context.wait_on(context.upload_staging(std::span(gltf_callbacks.vertex_texcoords), *mesh->texture_coords));
+    mesh->vertex_normals = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
+                                                         ox::size_bytes(quantized_normals));
+    context.wait_on(context.upload_staging(std::span(quantized_normals), *mesh->vertex_normals));
+
+    if (!quantized_tex_coords.empty()) {
+      mesh->texture_coords = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
+                                                           ox::size_bytes(quantized_tex_coords));
+      context.wait_on(context.upload_staging(std::span(quantized_tex_coords), *mesh->texture_coords));
+    }
+
+    mesh->vertex_bytes = ox::size_bytes(quantized_positions) + ox::size_bytes(quantized_normals) +
+                         ox::size_bytes(quantized_tex_coords);
+  } else {
+    mesh->vertex_positions = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
+                                                           ox::size_bytes(model_vertex_positions));
+    context.wait_on(context.upload_staging(std::span(model_vertex_positions), *mesh->vertex_positions));
+
+    mesh->vertex_normals = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
+                                                         ox::size_bytes(gltf_callbacks.vertex_normals));
+    context.wait_on(context.upload_staging(std::span(gltf_callbacks.vertex_normals), *mesh->vertex_normals));
+
+    if (!gltf_callbacks.vertex_texcoords.empty()) {
+      mesh->texture_coords = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
+                                                           ox::size_bytes(gltf_callbacks.vertex_texcoords));
+      context.wait_on(context.upload_staging(std::span(gltf_callbacks.vertex_texcoords), *mesh->texture_coords));
+    }
+
+    mesh->vertex_bytes = float_vertex_bytes;
   }
 
+  OX_LOG_INFO("Mesh {} vertex streams: {} KB ({} KB unquantized).",
+              uuid.str(),
+              mesh->vertex_bytes / 1024,
+              float_vertex_bytes / 1024);
+
   mesh->meshlets = context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly, ox::size_bytes(model_meshlets));
   context.wait_on(context.upload_staging(std::span(model_meshlets), *mesh->meshlets));
 
@@ -2,33 +2,93 @@
 
 #include <miniaudio.h>
 
+#include "Audio/AudioConfig.hpp"
 #include "Audio/AudioEngine.hpp"
 #include "Core/App.hpp"
 
 namespace ox {
 AudioSource::~AudioSource() { unload(); }
 
-auto AudioSource::load(const std::string& path) -> bool {
+AudioSource::AudioSource(AudioSource&& other) noexcept
+    : engine(other.engine),
+      _sound(std::exchange(other._sound, nullptr)),
+      path(std::move(other.path)),
+      streamed(other.streamed),
+      load_millis(other.load_millis) {}
+
+auto AudioSource::operator=(AudioSource&& other) noexcept -> AudioSource& {
+  if (this != &other) {
+    unload();
+    engine = other.engine;
+    _sound = std::exchange(other._sound, nullptr);
+    path = std::move(other.path);
+    streamed = other.streamed;
+    load_millis = other.load_millis;
+  }
+
+  return *this;
+}
+
+auto AudioSource::load(const std::string& path_) -> bool {
+  return load(path_, App::get_system<AudioEngine>(EngineSystems::AudioEngine)->get_engine());
+}
+
+auto AudioSource::load(const std::string& path_, ma_engine* engine_) -> bool {
   ZoneScoped;
 
+  const auto start = std::chrono::steady_clock::now();
+
+  path = path_;
+  std::error_code error = {};
+  const auto file_size = std::filesystem::file_size(path, error);
+  const auto stream_min_bytes = static_cast<u64>(glm::max(AudioCVar::cvar_stream_min_kb.get(), 0)) * 1024;
+  streamed = !error && file_size >= stream_min_bytes;
+
+  engine = engine_;
   _sound = new ma_sound;
-  auto* engine = App::get_system<AudioEngine>(EngineSystems::AudioEngine)->get_engine();
   const ma_result result = ma_sound_init_from_file(
-      engine, path.c_str(), MA_SOUND_FLAG_NO_SPATIALIZATION, nullptr, nullptr, _sound);
+      engine, path.c_str(), get_flags() | MA_SOUND_FLAG_NO_SPATIALIZATION, nullptr, nullptr, _sound);
   if (result != MA_SUCCESS) {
     OX_LOG_ERROR("Failed to load sound: {}", path);
+    delete _sound;
+    _sound = nullptr;
     return false;
   }
 
+  load_millis = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+  TracyPlot("Audio Load Time", load_millis);
+
   return true;
 }
 
 auto AudioSource::unload() -> void {
   ZoneScoped;
 
+  if (!_sound)
+    return;
+
   ma_sound_uninit(_sound);
   delete _sound;
+  _sound = nullptr;
 }
 
 auto AudioSource::get_source() -> ma_sound* { return _sound; }
+
+auto AudioSource::init_instance(ma_sound* sound) const -> bool {
+  ZoneScoped;
+
+  if (!_sound)
+    return false;
+
+  // Streams can't be copied, they need their own decoder and pages.
+  const auto result = streamed ? ma_sound_init_from_file(engine, path.c_str(), get_flags(), nullptr, nullptr, sound)
+                               : ma_sound_init_copy(engine, _sound, 0, nullptr, sound);
+
+  return result == MA_SUCCESS;
+}
+
+auto AudioSource::get_flags() const -> u32 {
+  // Only waits for the decoder to open so the length is known, the data loads on the job threads.
+  return (streamed ? MA_SOUND_FLAG_STREAM : MA_SOUND_FLAG_DECODE) | MA_SOUND_FLAG_ASYNC | MA_SOUND_FLAG_WAIT_INIT;
+}
 } // namespace ox
@@ -0,0 +1,91 @@
+#include "Asset/MeshLOD.hpp"
+
+#include <meshoptimizer.h>
+
+namespace ox::mesh_lod {
+auto build_lod_chain(std::span<const u32> indices, std::span<const glm::vec3> positions, const BuildInfo& info)
+    -> std::vector<Level> {
+  ZoneScoped;
+
+  auto levels = std::vector<Level>();
+  if (indices.empty() || positions.empty())
+    return levels;
+
+  const auto* vertex_positions = reinterpret_cast<const f32*>(positions.data());
+  // meshoptimizer reports errors relative to the mesh extents.
+  const auto error_scale = meshopt_simplifyScale(vertex_positions, positions.size(), sizeof(glm::vec3));
+
+  auto source = indices;
+  f32 accumulated_error = 0.0f;
+  while (levels.size() + 1 < info.max_levels) {
+    const auto target_index_count = static_cast<usize>(static_cast<f32>(source.size()) * info.reduction) / 3 * 3;
+    if (target_index_count < info.min_index_count)
+      break;
+
+    auto level_indices = std::vector<u32>(source.size());
+    f32 result_error = 0.0f;
+    const auto index_count = meshopt_simplify(level_indices.data(),
+                                              source.data(),
+                                              source.size(),
+                                              vertex_positions,
+                                              positions.size(),
+                                              sizeof(glm::vec3),
+                                              target_index_count,
+                                              info.max_error,
+                                              0,
+                                              &result_error);
+    if (index_count == 0 || static_cast<f32>(index_count) > static_cast<f32>(source.size()) * info.min_progress)
+      break;
+
+    level_indices.resize(index_count);
+    // Each level is simplified from the previous one, so the errors add up.
+    accumulated_error += result_error * error_scale;
+    levels.push_back({.indices = std::move(level_indices), .error = accumulated_error});
+    source = levels.back().indices;
+  }
+
+  return levels;
+}
+
+auto get_projection_scale(const glm::mat4& projection, f32 viewport_height) -> f32 {
+  // projection[1][1] is 1 / tan(fov / 2) for perspective and 2 / height for orthographic projections.
+  return glm::abs(projection[1][1]) * viewport_height * 0.5f;
+}
+
+auto get_projected_error(f32 world_error, const glm::vec3& center, f32 radius, const SelectInfo& info) -> f32 {
+  if (info.orthographic)
+    return world_error * info.projection_scale;
+
+  const auto distance = glm::max(glm::distance(center, info.camera_position) - radius, 0.0001f);
+  return world_error / distance * info.projection_scale;
+}
+
+auto select_lod(std::span<const Mesh::LOD> lods,
+                const glm::mat4& world,
+                const glm::vec3& bounds_center,
+                f32 bounds_radius,
+                const SelectInfo& info,
+                u32 previous_lod) -> u32 {
+  if (lods.size() <= 1)
+    return 0;
+
+  const auto scale = glm::max(glm::length(glm::vec3(world[0])),
+                              glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+  const auto center = glm::vec3(world * glm::vec4(bounds_center, 1.0f));
+  const auto radius = bounds_radius * scale;
+
+  const auto coarsen_threshold = info.error_threshold_pixels * (1.0f - info.hysteresis);
+
+  // Errors only grow along the chain.
+  auto selected = 0_u32;
+  for (u32 i = 1; i < lods.size(); i++) {
+    const auto threshold = previous_lod != NO_PREVIOUS_LOD && i > previous_lod ? coarsen_threshold
+                                                                               : info.error_threshold_pixels;
+    if (get_projected_error(lods[i].error * scale, center, radius, info) > threshold)
+      break;
+    selected = i;
+  }
+
+  return selected;
+}
+} // namespace ox::mesh_lod
@@ -0,0 +1,48 @@
+#include "Asset/MeshOptimizer.hpp"
+
+#include <meshoptimizer.h>
+
+namespace ox::mesh_optimizer {
+constexpr static auto CACHE_SIZE = 16_u32;
+// Overdraw may cost this much extra vertex cache efficiency.
+constexpr static auto OVERDRAW_THRESHOLD = 1.05f;
+
+auto optimize_primitive(std::span<u32> indices,
+                        std::span<glm::vec3> positions,
+                        std::span<glm::vec3> normals,
+                        std::span<glm::vec2> tex_coords) -> usize {
+  ZoneScoped;
+
+  if (indices.empty() || positions.empty())
+    return 0;
+
+  meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), positions.size());
+  meshopt_optimizeOverdraw(indices.data(),
+                           indices.data(),
+                           indices.size(),
+                           reinterpret_cast<const f32*>(positions.data()),
+                           positions.size(),
+                           sizeof(glm::vec3),
+                           OVERDRAW_THRESHOLD);
+
+  auto remap = std::vector<u32>(positions.size());
+  const auto vertex_count = meshopt_optimizeVertexFetchRemap(
+      remap.data(), indices.data(), indices.size(), positions.size());
+  meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+  meshopt_remapVertexBuffer(positions.data(), positions.data(), positions.size(), sizeof(glm::vec3), remap.data());
+  if (normals.size() == positions.size())
+    meshopt_remapVertexBuffer(normals.data(), normals.data(), normals.size(), sizeof(glm::vec3), remap.data());
+  if (tex_coords.size() == positions.size())
+    meshopt_remapVertexBuffer(tex_coords.data(), tex_coords.data(), tex_coords.size(), sizeof(glm::vec2), remap.data());
+
+  // Unreferenced vertices are moved to the end, they keep stale data but are never fetched.
+  return vertex_count;
+}
+
+auto get_acmr(std::span<const u32> indices, usize vertex_count) -> f32 {
+  if (indices.empty())
+    return 0.0f;
+
+  return meshopt_analyzeVertexCache(indices.data(), indices.size(), vertex_count, CACHE_SIZE, 0, 0).acmr;
+}
+} // namespace ox::mesh_optimizer
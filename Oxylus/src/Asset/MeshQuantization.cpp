@@ -0,0 +1,53 @@
+#include "Asset/MeshQuantization.hpp"
+
+#include <glm/packing.hpp>
+
+#include "Utils/OxMath.hpp"
+
+namespace ox::mesh_quantization {
+auto get_position_bounds(std::span<const glm::vec3> positions) -> PositionBounds {
+  if (positions.empty())
+    return {};
+
+  auto bb_min = glm::vec3(std::numeric_limits<f32>::max());
+  auto bb_max = glm::vec3(std::numeric_limits<f32>::lowest());
+  for (const auto& position : positions) {
+    bb_min = glm::min(bb_min, position);
+    bb_max = glm::max(bb_max, position);
+  }
+
+  return {.min = bb_min, .extent = bb_max - bb_min};
+}
+
+auto encode_position(const glm::vec3& position, const PositionBounds& bounds) -> glm::uvec2 {
+  // Flat axes would divide by zero, any value decodes to `min` there.
+  const auto inv_extent = glm::vec3(bounds.extent.x > 0.0f ? 1.0f / bounds.extent.x : 0.0f,
+                                    bounds.extent.y > 0.0f ? 1.0f / bounds.extent.y : 0.0f,
+                                    bounds.extent.z > 0.0f ? 1.0f / bounds.extent.z : 0.0f);
+  const auto normalized = glm::clamp((position - bounds.min) * inv_extent, 0.0f, 1.0f);
+  const auto q = glm::uvec3(glm::round(normalized * 65535.0f));
+
+  return {math::pack_u16(static_cast<u16>(q.x), static_cast<u16>(q.y)), q.z};
+}
+
+auto decode_position(const glm::uvec2& encoded, const PositionBounds& bounds) -> glm::vec3 {
+  const auto q = glm::vec3(math::unpack_u32_low(encoded.x),
+                           math::unpack_u32_high(encoded.x),
+                           math::unpack_u32_low(encoded.y));
+  return bounds.min + q * (1.0f / 65535.0f) * bounds.extent;
+}
+
+auto encode_normal(const glm::vec3& normal) -> u32 {
+  const auto length = glm::length(normal);
+  if (length == 0.0f)
+    return glm::packSnorm2x16(glm::vec2(0.0f));
+
+  return glm::packSnorm2x16(math::float32x3_to_oct(normal / length));
+}
+
+auto decode_normal(u32 encoded) -> glm::vec3 { return math::oct_to_float32x3(glm::unpackSnorm2x16(encoded)); }
+
+auto encode_tex_coord(const glm::vec2& tex_coord) -> u32 { return glm::packHalf2x16(tex_coord); }
+
+auto decode_tex_coord(u32 encoded) -> glm::vec2 { return glm::unpackHalf2x16(encoded); }
+} // namespace ox::mesh_quantization
@@ -4,6 +4,10 @@
 
 #include <miniaudio.h>
 
+#include "Audio/AudioConfig.hpp"
+#include "Core/App.hpp"
+#include "Memory/Tracking.hpp"
+
 namespace ox {
 static ma_attenuation_model get_attenuation_model(const AudioEngine::AttenuationModelType model) {
   switch (model) {
@@ -16,25 +20,80 @@ static ma_attenuation_model get_attenuation_model(const AudioEngine::Attenuation
   return ma_attenuation_model_none;
 }
 
+static void* audio_malloc(usize size, void*) { return memory::tracked_alloc(memory::Subsystem::Audio, size); }
+
+static void* audio_realloc(void* ptr, usize size, void*) {
+  return memory::tracked_realloc(memory::Subsystem::Audio, ptr, size);
+}
+
+static void audio_free(void* ptr, void*) { memory::tracked_free(memory::Subsystem::Audio, ptr); }
+
 auto AudioEngine::init() -> std::expected<void, std::string> {
   ZoneScoped;
+
+  const ma_allocation_callbacks allocation_callbacks = {
+      .pUserData = nullptr,
+      .onMalloc = audio_malloc,
+      .onRealloc = audio_realloc,
+      .onFree = audio_free,
+  };
+
+  if (AudioCVar::cvar_null_backend.get()) {
+    ma_backend backends[] = {ma_backend_null};
+    auto context_config = ma_context_config_init();
+    context_config.allocationCallbacks = allocation_callbacks;
+
+    context = new ma_context();
+    if (ma_context_init(backends, 1, &context_config, context) != MA_SUCCESS)
+      return std::unexpected{"ma_context_init failed!"};
+  }
+
+  // Decoding and stream paging happen on the resource manager's job threads. Decoded files
+  // are cached by path and ref-counted, every sound of the same file shares one PCM buffer.
+  auto resource_manager_config = ma_resource_manager_config_init();
+  resource_manager_config.allocationCallbacks = allocation_callbacks;
+  resource_manager_config.decodedFormat = ma_format_f32;
+  resource_manager_config.jobThreadCount = static_cast<u32>(glm::max(AudioCVar::cvar_job_threads.get(), 1));
+
+  resource_manager = new ma_resource_manager();
+  if (ma_resource_manager_init(&resource_manager_config, resource_manager) != MA_SUCCESS)
+    return std::unexpected{"ma_resource_manager_init failed!"};
+
   ma_engine_config config = ma_engine_config_init();
   config.listenerCount = 1;
+  config.pContext = context;
+  config.pResourceManager = resource_manager;
+  config.allocationCallbacks = allocation_callbacks;
 
   engine = new ma_engine();
   const ma_result result = ma_engine_init(&config, engine);
   if (result != MA_SUCCESS)
     return std::unexpected{"ma_engine_init failed!"};
 
+  voice_manager.init(this);
+
   return {};
 }
 
 auto AudioEngine::deinit() -> std::expected<void, std::string> {
+  voice_manager.deinit();
   ma_engine_uninit(engine);
   delete engine;
+  ma_resource_manager_uninit(resource_manager);
+  delete resource_manager;
+  if (context) {
+    ma_context_uninit(context);
+    delete context;
+  }
   return {};
 }
 
+auto AudioEngine::on_update() -> void {
+  ZoneScoped;
+
+  voice_manager.update(App::get_timestep().get_seconds());
+}
+
 auto AudioEngine::get_engine() const -> ma_engine* { return engine; }
 
 auto AudioEngine::play_source(ma_sound* sound) -> void {
@@ -0,0 +1,21 @@
+#include "Audio/AudioSourceTracker.hpp"
+
+#include "Scene/ECSModule/Core.hpp"
+
+namespace ox {
+auto AudioSourceTracker::mark_dirty(flecs::entity entity) -> void {
+  // Already visited entities had their children marked too.
+  if (!visited.emplace(entity.id()).second)
+    return;
+
+  if (entity.has<AudioSourceComponent>())
+    dirty_sources.emplace_back(entity);
+
+  entity.children([this](flecs::entity child) { mark_dirty(child); });
+}
+
+auto AudioSourceTracker::clear() -> void {
+  dirty_sources.clear();
+  visited.clear();
+}
+} // namespace ox
@@ -0,0 +1,437 @@
+#include "Audio/AudioVoiceManager.hpp"
+
+#include <miniaudio.h>
+
+#include "Asset/AudioSource.hpp"
+#include "Audio/AudioConfig.hpp"
+#include "Audio/AudioEngine.hpp"
+
+namespace ox {
+// Same curves miniaudio uses, so ranking agrees with what is heard.
+static auto estimate_gain(const AudioVoiceParams& params, const glm::vec3& listener_position) -> f32 {
+  if (!params.spatialization)
+    return params.volume;
+
+  const auto min_distance = glm::max(params.min_distance, 0.0001f);
+  const auto max_distance = glm::max(params.max_distance, min_distance);
+  const auto distance = glm::clamp(glm::distance(params.position, listener_position), min_distance, max_distance);
+
+  auto gain = 1.0f;
+  switch (static_cast<AudioEngine::AttenuationModelType>(params.attenuation_model)) {
+    case AudioEngine::AttenuationModelType::None: break;
+    case AudioEngine::AttenuationModelType::Inverse:
+      gain = min_distance / (min_distance + params.roll_off * (distance - min_distance));
+      break;
+    case AudioEngine::AttenuationModelType::Linear:
+      if (max_distance > min_distance)
+        gain = 1.0f - params.roll_off * (distance - min_distance) / (max_distance - min_distance);
+      break;
+    case AudioEngine::AttenuationModelType::Exponential:
+      gain = glm::pow(distance / min_distance, -params.roll_off);
+      break;
+  }
+
+  return params.volume * glm::clamp(gain, params.min_gain, params.max_gain);
+}
+
+auto AudioVoiceParams::diff(const AudioVoiceParams& other) const -> AudioVoiceDirty {
+  auto dirty = AudioVoiceDirty::None;
+  if (attenuation_model != other.attenuation_model)
+    dirty |= AudioVoiceDirty::Attenuation;
+  if (volume != other.volume)
+    dirty |= AudioVoiceDirty::Volume;
+  if (pitch != other.pitch)
+    dirty |= AudioVoiceDirty::Pitch;
+  if (looping != other.looping)
+    dirty |= AudioVoiceDirty::Looping;
+  if (spatialization != other.spatialization)
+    dirty |= AudioVoiceDirty::Spatialization;
+  if (roll_off != other.roll_off)
+    dirty |= AudioVoiceDirty::RollOff;
+  if (min_gain != other.min_gain || max_gain != other.max_gain)
+    dirty |= AudioVoiceDirty::Gain;
+  if (min_distance != other.min_distance || max_distance != other.max_distance)
+    dirty |= AudioVoiceDirty::Distance;
+  if (cone_inner_angle != other.cone_inner_angle || cone_outer_angle != other.cone_outer_angle ||
+      cone_outer_gain != other.cone_outer_gain)
+    dirty |= AudioVoiceDirty::Cone;
+  if (doppler_factor != other.doppler_factor)
+    dirty |= AudioVoiceDirty::Doppler;
+  if (position != other.position)
+    dirty |= AudioVoiceDirty::Position;
+  if (direction != other.direction)
+    dirty |= AudioVoiceDirty::Direction;
+
+  return dirty;
+}
+
+auto AudioVoiceManager::init(AudioEngine* audio_engine) -> void { engine = audio_engine; }
+
+auto AudioVoiceManager::deinit() -> void {
+  ZoneScoped;
+
+  for (usize i = 0; i < voices.capacity(); i++) {
+    if (auto* voice = voices.slot_from_index(i); voice && voice->sound) {
+      ma_sound_uninit(voice->sound);
+      delete voice->sound;
+      voice->sound = nullptr;
+    }
+  }
+
+  voices.reset();
+  dirty_voices.clear();
+  playing_voices.clear();
+  stats = {};
+}
+
+auto AudioVoiceManager::create_voice(const AudioSource& source, const AudioVoiceParams& params, i32 priority)
+    -> AudioVoiceID {
+  ZoneScoped;
+
+  auto* sound = new ma_sound;
+  if (!source.init_instance(sound)) {
+    OX_LOG_ERROR("Failed to create audio voice!");
+    delete sound;
+    return AudioVoiceID::Invalid;
+  }
+
+  f32 length_seconds = 0.0f;
+  ma_sound_get_length_in_seconds(sound, &length_seconds);
+
+  const auto voice_id = voices.create_slot({
+      .sound = sound,
+      .params = params,
+      .dirty = AudioVoiceDirty::All,
+      .priority = priority,
+      .length_seconds = length_seconds,
+  });
+  apply_params(*voices.slot(voice_id));
+
+  return voice_id;
+}
+
+auto AudioVoiceManager::destroy_voice(AudioVoiceID voice_id) -> void {
+  ZoneScoped;
+
+  auto* voice = voices.slot(voice_id);
+  if (!voice)
+    return;
+
+  if (voice->is_real)
+    needs_rank = true;
+
+  if (voice->sound) {
+    ma_sound_uninit(voice->sound);
+    delete voice->sound;
+    voice->sound = nullptr;
+  }
+
+  // Queued ids go stale with the slot version and are skipped.
+  voices.destroy_slot(voice_id);
+}
+
+auto AudioVoiceManager::set_params(AudioVoiceID voice_id, const AudioVoiceParams& params) -> void {
+  auto* voice = voices.slot(voice_id);
+  if (!voice)
+    return;
+
+  const auto dirty = voice->params.diff(params);
+  if (dirty == AudioVoiceDirty::None)
+    return;
+
+  voice->params = params;
+  mark_dirty(voice_id, *voice, dirty);
+}
+
+auto AudioVoiceManager::set_priority(AudioVoiceID voice_id, i32 priority) -> void {
+  auto* voice = voices.slot(voice_id);
+  if (!voice || voice->priority == priority)
+    return;
+
+  voice->priority = priority;
+  if (voice->state == State::Playing)
+    needs_rank = true;
+}
+
+auto AudioVoiceManager::play(AudioVoiceID voice_id) -> void {
+  ZoneScoped;
+
+  auto* voice = voices.slot(voice_id);
+  if (!voice)
+    return;
+
+  voice->state = State::Playing;
+  voice->cursor_seconds = 0.0;
+  voice->cursor_time = time;
+  if (voice->is_real) {
+    ma_sound_seek_to_pcm_frame(voice->sound, 0);
+    ma_sound_start(voice->sound);
+  }
+
+  mark_playing(voice_id, *voice);
+}
+
+auto AudioVoiceManager::pause(AudioVoiceID voice_id) -> void {
+  ZoneScoped;
+
+  auto* voice = voices.slot(voice_id);
+  if (!voice || voice->state != State::Playing)
+    return;
+
+  if (voice->is_real) {
+    make_virtual(*voice);
+  } else {
+    voice->cursor_seconds = get_virtual_cursor(*voice);
+    voice->cursor_time = time;
+  }
+
+  voice->state = State::Paused;
+  needs_rank = true;
+}
+
+auto AudioVoiceManager::unpause(AudioVoiceID voice_id) -> void {
+  auto* voice = voices.slot(voice_id);
+  if (!voice || voice->state != State::Paused)
+    return;
+
+  voice->state = State::Playing;
+  voice->cursor_time = time;
+  mark_playing(voice_id, *voice);
+}
+
+auto AudioVoiceManager::stop(AudioVoiceID voice_id) -> void {
+  ZoneScoped;
+
+  auto* voice = voices.slot(voice_id);
+  if (!voice || voice->state == State::Stopped)
+    return;
+
+  if (voice->is_real) {
+    ma_sound_stop(voice->sound);
+    voice->is_real = false;
+  }
+
+  voice->state = State::Stopped;
+  voice->cursor_seconds = 0.0;
+  needs_rank = true;
+}
+
+auto AudioVoiceManager::is_playing(AudioVoiceID voice_id) -> bool {
+  const auto* voice = voices.slot(voice_id);
+  return voice && voice->state == State::Playing;
+}
+
+auto AudioVoiceManager::is_virtual(AudioVoiceID voice_id) -> bool {
+  const auto* voice = voices.slot(voice_id);
+  return voice && voice->state == State::Playing && !voice->is_real;
+}
+
+auto AudioVoiceManager::update(f64 delta_time) -> void {
+  ZoneScoped;
+
+  time += delta_time;
+  stats.parameter_updates = 0;
+  stats.virtualized_count = 0;
+  stats.resumed_count = 0;
+
+  // Voices that aren't mixed keep their dirty bits until they become real.
+  for (const auto voice_id : dirty_voices) {
+    auto* voice = voices.slot(voice_id);
+    if (!voice)
+      continue;
+
+    voice->is_queued_dirty = false;
+    if (voice->is_real)
+      apply_params(*voice);
+  }
+  dirty_voices.clear();
+
+  const auto rank_interval = static_cast<f64>(AudioCVar::cvar_rank_interval_ms.get()) * 0.001;
+  if (needs_rank || (!playing_voices.empty() && time - last_rank_time >= rank_interval)) {
+    const auto listener_position = ma_engine_listener_get_position(engine->get_engine(), 0);
+    rank_voices({listener_position.x, listener_position.y, listener_position.z});
+  }
+
+  stats.voice_count = static_cast<u32>(voices.size());
+
+  TracyPlot("Audio Real Voices", static_cast<i64>(stats.real_count));
+  TracyPlot("Audio Virtual Voices", static_cast<i64>(stats.virtual_count));
+  TracyPlot("Audio Parameter Updates", static_cast<i64>(stats.parameter_updates));
+}
+
+auto AudioVoiceManager::mark_dirty(AudioVoiceID voice_id, Voice& voice, AudioVoiceDirty dirty) -> void {
+  voice.dirty |= dirty;
+  if (!voice.is_queued_dirty) {
+    voice.is_queued_dirty = true;
+    dirty_voices.push_back(voice_id);
+  }
+}
+
+auto AudioVoiceManager::mark_playing(AudioVoiceID voice_id, Voice& voice) -> void {
+  if (!voice.is_queued_playing) {
+    voice.is_queued_playing = true;
+    playing_voices.push_back(voice_id);
+  }
+
+  needs_rank = true;
+}
+
+auto AudioVoiceManager::apply_params(Voice& voice) -> void {
+  ZoneScoped;
+
+  if (voice.dirty == AudioVoiceDirty::None)
+    return;
+
+  auto* sound = voice.sound;
+  const auto& params = voice.params;
+  const auto dirty = voice.dirty;
+  if (dirty & AudioVoiceDirty::Attenuation)
+    engine->set_source_attenuation_model(sound,
+                                         static_cast<AudioEngine::AttenuationModelType>(params.attenuation_model));
+  if (dirty & AudioVoiceDirty::Volume)
+    engine->set_source_volume(sound, params.volume);
+  if (dirty & AudioVoiceDirty::Pitch)
+    engine->set_source_pitch(sound, params.pitch);
+  if (dirty & AudioVoiceDirty::Looping)
+    engine->set_source_looping(sound, params.looping);
+  if (dirty & AudioVoiceDirty::Spatialization)
+    engine->set_source_spatialization(sound, params.spatialization);
+  if (dirty & AudioVoiceDirty::RollOff)
+    engine->set_source_roll_off(sound, params.roll_off);
+  if (dirty & AudioVoiceDirty::Gain) {
+    engine->set_source_min_gain(sound, params.min_gain);
+    engine->set_source_max_gain(sound, params.max_gain);
+  }
+  if (dirty & AudioVoiceDirty::Distance) {
+    engine->set_source_min_distance(sound, params.min_distance);
+    engine->set_source_max_distance(sound, params.max_distance);
+  }
+  if (dirty & AudioVoiceDirty::Cone)
+    engine->set_source_cone(sound, params.cone_inner_angle, params.cone_outer_angle, params.cone_outer_gain);
+  if (dirty & AudioVoiceDirty::Doppler)
+    engine->set_source_doppler_factor(sound, params.doppler_factor);
+  if (dirty & AudioVoiceDirty::Position)
+    engine->set_source_position(sound, params.position);
+  if (dirty & AudioVoiceDirty::Direction)
+    engine->set_source_direction(sound, params.direction);
+
+  voice.dirty = AudioVoiceDirty::None;
+  stats.parameter_updates += 1;
+}
+
+auto AudioVoiceManager::get_virtual_cursor(const Voice& voice) const -> f64 {
+  return voice.cursor_seconds + (time - voice.cursor_time) * static_cast<f64>(voice.params.pitch);
+}
+
+auto AudioVoiceManager::make_real(Voice& voice) -> bool {
+  ZoneScoped;
+
+  auto cursor = get_virtual_cursor(voice);
+  if (voice.length_seconds > 0.0) {
+    if (voice.params.looping)
+      cursor = std::fmod(cursor, voice.length_seconds);
+    else if (cursor >= voice.length_seconds)
+      return false;
+  }
+
+  apply_params(voice);
+
+  u32 sample_rate = 0;
+  ma_sound_get_data_format(voice.sound, nullptr, nullptr, &sample_rate, nullptr, 0);
+  ma_sound_seek_to_pcm_frame(voice.sound, static_cast<ma_uint64>(cursor * static_cast<f64>(sample_rate)));
+  ma_sound_start(voice.sound);
+  voice.is_real = true;
+
+  return true;
+}
+
+auto AudioVoiceManager::make_virtual(Voice& voice) -> void {
+  ZoneScoped;
+
+  f32 cursor = 0.0f;
+  ma_sound_get_cursor_in_seconds(voice.sound, &cursor);
+  ma_sound_stop(voice.sound);
+  voice.cursor_seconds = cursor;
+  voice.cursor_time = time;
+  voice.is_real = false;
+}
+
+auto AudioVoiceManager::rank_voices(const glm::vec3& listener_position) -> void {
+  ZoneScoped;
+
+  rank_entries.clear();
+  for (const auto voice_id : playing_voices) {
+    auto* voice = voices.slot(voice_id);
+    if (!voice)
+      continue;
+
+    if (voice->length_seconds <= 0.0) {
+      f32 length_seconds = 0.0f;
+      ma_sound_get_length_in_seconds(voice->sound, &length_seconds);
+      voice->length_seconds = length_seconds;
+    }
+
+    if (voice->state == State::Playing) {
+      // Finished one shots leave the playing set here, real ones are stopped by miniaudio itself.
+      const auto finished = voice->is_real
+                                ? static_cast<bool>(ma_sound_at_end(voice->sound))
+                                : !voice->params.looping && voice->length_seconds > 0.0 &&
+                                      get_virtual_cursor(*voice) >= voice->length_seconds;
+      if (finished) {
+        voice->state = State::Stopped;
+        voice->is_real = false;
+        voice->cursor_seconds = 0.0;
+      }
+    }
+
+    if (voice->state != State::Playing) {
+      voice->is_queued_playing = false;
+      continue;
+    }
+
+    rank_entries.push_back({
+        .voice_id = voice_id,
+        .voice = voice,
+        .priority = voice->priority,
+        .audibility = estimate_gain(voice->params, listener_position),
+    });
+  }
+
+  std::ranges::sort(rank_entries, [](const RankEntry& lhs, const RankEntry& rhs) {
+    if (lhs.priority != rhs.priority)
+      return lhs.priority > rhs.priority;
+    return lhs.audibility > rhs.audibility;
+  });
+
+  const auto max_voices = static_cast<u32>(glm::max(AudioCVar::cvar_max_voices.get(), 0));
+  const auto min_gain = AudioCVar::cvar_virtual_gain.get();
+  u32 real_count = 0;
+  playing_voices.clear();
+  for (auto& entry : rank_entries) {
+    auto& voice = *entry.voice;
+    const auto should_be_real = real_count < max_voices && entry.audibility >= min_gain;
+    if (should_be_real && !voice.is_real) {
+      if (!make_real(voice)) {
+        // A one shot that ran out while virtual.
+        voice.state = State::Stopped;
+        voice.cursor_seconds = 0.0;
+        voice.is_queued_playing = false;
+        continue;
+      }
+      stats.resumed_count += 1;
+    } else if (!should_be_real && voice.is_real) {
+      make_virtual(voice);
+      stats.virtualized_count += 1;
+    }
+
+    real_count += voice.is_real ? 1 : 0;
+    playing_voices.push_back(entry.voice_id);
+  }
+
+  stats.playing_count = static_cast<u32>(playing_voices.size());
+  stats.real_count = real_count;
+  stats.virtual_count = stats.playing_count - real_count;
+  last_rank_time = time;
+  needs_rank = false;
+}
+} // namespace ox
@@ -9,6 +9,7 @@
 #include "Core/Input.hpp"
 #include "Core/Layer.hpp"
 #include "Core/VFS.hpp"
+#include "Memory/FrameArena.hpp"
 #include "Modules/ModuleRegistry.hpp"
 #include "Physics/Physics.hpp"
 #include "Render/RendererConfig.hpp"
@@ -197,6 +198,8 @@ void App::run() {
 
     timestep.on_update();
 
+    memory::get_frame_arena().begin_frame();
+
     window.poll(window_callbacks);
 
     auto swapchain_attachment = vk_context->new_frame();
@@ -0,0 +1,100 @@
+#include "Memory/FrameArena.hpp"
+
+#include "OS/OS.hpp"
+
+namespace ox::memory {
+FrameArena::FrameArena(usize capacity_) : capacity(capacity_), resource(this) {
+  ZoneScoped;
+
+  for (auto& buffer : buffers) {
+    buffer.data = static_cast<u8*>(os::mem_reserve(capacity));
+    os::mem_commit(buffer.data, capacity);
+  }
+}
+
+FrameArena::~FrameArena() {
+  ZoneScoped;
+
+  for (auto& buffer : buffers) {
+    os::mem_release(buffer.data, capacity);
+    buffer.data = nullptr;
+  }
+}
+
+auto FrameArena::begin_frame() -> void {
+  ZoneScoped;
+
+  last_frame_stats = {
+      .allocation_count = allocation_count.exchange(0, std::memory_order_relaxed),
+      .allocated_bytes = allocated_bytes.exchange(0, std::memory_order_relaxed),
+      .overflow_count = overflow_count.exchange(0, std::memory_order_relaxed),
+      .overflow_bytes = overflow_bytes.exchange(0, std::memory_order_relaxed),
+  };
+
+  peak_bytes = ox::max(peak_bytes, get_used_bytes());
+
+  TracyPlot("Frame Arena Bytes", static_cast<i64>(last_frame_stats.allocated_bytes));
+  TracyPlot("Frame Arena Overflow Bytes", static_cast<i64>(last_frame_stats.overflow_bytes));
+
+  frame_index += 1;
+  current_buffer().offset.store(0, std::memory_order_relaxed);
+}
+
+auto FrameArena::alloc(usize size, usize alignment) -> void* {
+  auto& buffer = current_buffer();
+  const auto base = reinterpret_cast<uptr>(buffer.data);
+
+  auto offset = buffer.offset.load(std::memory_order_relaxed);
+  usize aligned_offset = 0;
+  usize new_offset = 0;
+  do {
+    aligned_offset = ox::align_up(base + offset, alignment) - base;
+    new_offset = aligned_offset + size;
+    if (new_offset > capacity) {
+      overflow_count.fetch_add(1, std::memory_order_relaxed);
+      overflow_bytes.fetch_add(size, std::memory_order_relaxed);
+      return nullptr;
+    }
+  } while (!buffer.offset.compare_exchange_weak(offset, new_offset, std::memory_order_relaxed));
+
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+  return buffer.data + aligned_offset;
+}
+
+auto FrameArena::owns(const void* ptr) const -> bool {
+  const auto* p = static_cast<const u8*>(ptr);
+  for (const auto& buffer : buffers) {
+    if (p >= buffer.data && p < buffer.data + capacity)
+      return true;
+  }
+
+  return false;
+}
+
+auto FrameArena::get_used_bytes() const -> usize { return current_buffer().offset.load(std::memory_order_relaxed); }
+
+auto FrameArena::Resource::do_allocate(usize bytes, usize alignment) -> void* {
+  if (auto* ptr = arena->alloc(bytes, alignment))
+    return ptr;
+
+  return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+auto FrameArena::Resource::do_deallocate(void* ptr, usize bytes, usize alignment) -> void {
+  if (arena->owns(ptr))
+    return;
+
+  std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+}
+
+auto FrameArena::Resource::do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool {
+  return this == &other;
+}
+
+auto get_frame_arena() -> FrameArena& {
+  static FrameArena arena;
+  return arena;
+}
+} // namespace ox::memory
@@ -6,15 +6,16 @@ namespace ox::memory {
 ThreadStack::ThreadStack() {
   ZoneScoped;
 
-  constexpr static usize stack_size = ox::mib_to_bytes(32);
-  ptr = static_cast<u8*>(os::mem_reserve(stack_size));
-  os::mem_commit(ptr, stack_size);
+  begin = static_cast<u8*>(os::mem_reserve(STACK_SIZE));
+  os::mem_commit(begin, STACK_SIZE);
+  end = begin + STACK_SIZE;
+  ptr = begin;
 }
 
 ThreadStack::~ThreadStack() {
   ZoneScoped;
 
-  os::mem_release(ptr);
+  os::mem_release(begin, STACK_SIZE);
 }
 
 ScopedStack::ScopedStack() {
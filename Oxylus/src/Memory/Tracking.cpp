@@ -0,0 +1,88 @@
+#include "Memory/Tracking.hpp"
+
+#include <cstring>
+
+namespace ox::memory {
+struct AllocationHeader {
+  usize size = 0;
+  u32 offset = 0;
+  u32 alignment = 0;
+};
+
+static SubsystemStats subsystem_stats[std::to_underlying(Subsystem::Count)] = {};
+
+static auto get_header(const void* ptr) -> AllocationHeader* {
+  return reinterpret_cast<AllocationHeader*>(reinterpret_cast<uptr>(ptr) - sizeof(AllocationHeader));
+}
+
+auto subsystem_to_sv(Subsystem subsystem) -> std::string_view {
+  switch (subsystem) {
+    case Subsystem::General    : return "General";
+    case Subsystem::Physics    : return "Physics";
+    case Subsystem::PhysicsTemp: return "PhysicsTemp";
+    case Subsystem::Lua        : return "Lua";
+    case Subsystem::Audio      : return "Audio";
+    case Subsystem::Count      : return "";
+    default                    : return {};
+  }
+}
+
+auto get_subsystem_stats(Subsystem subsystem) -> SubsystemStats& {
+  return subsystem_stats[std::to_underlying(subsystem)];
+}
+
+auto tracked_alloc(Subsystem subsystem, usize size, usize alignment) -> void* {
+  alignment = ox::max(alignment, alignof(AllocationHeader));
+
+  auto* raw = static_cast<u8*>(std::malloc(size + alignment + sizeof(AllocationHeader)));
+  if (!raw)
+    return nullptr;
+
+  auto* ptr = ox::align_up(raw + sizeof(AllocationHeader), alignment);
+  auto* header = get_header(ptr);
+  header->size = size;
+  header->offset = static_cast<u32>(ptr - raw);
+  header->alignment = static_cast<u32>(alignment);
+
+  auto& stats = get_subsystem_stats(subsystem);
+  const auto current = stats.current_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  stats.allocation_count.fetch_add(1, std::memory_order_relaxed);
+  auto peak = stats.peak_bytes.load(std::memory_order_relaxed);
+  while (current > peak && !stats.peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+  }
+
+  TracyAllocN(ptr, size, subsystem_to_sv(subsystem).data());
+
+  return ptr;
+}
+
+auto tracked_realloc(Subsystem subsystem, void* ptr, usize new_size) -> void* {
+  if (!ptr)
+    return tracked_alloc(subsystem, new_size);
+
+  const auto* header = get_header(ptr);
+  auto* new_ptr = tracked_alloc(subsystem, new_size, header->alignment);
+  if (new_ptr) {
+    std::memcpy(new_ptr, ptr, ox::min(header->size, new_size));
+  }
+  tracked_free(subsystem, ptr);
+
+  return new_ptr;
+}
+
+auto tracked_free(Subsystem subsystem, void* ptr) -> void {
+  if (!ptr)
+    return;
+
+  const auto* header = get_header(ptr);
+  auto& stats = get_subsystem_stats(subsystem);
+  stats.current_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+  stats.free_count.fetch_add(1, std::memory_order_relaxed);
+
+  TracyFreeN(ptr, subsystem_to_sv(subsystem).data());
+
+  std::free(static_cast<u8*>(ptr) - header->offset);
+}
+
+auto tracked_size(const void* ptr) -> usize { return ptr ? get_header(ptr)->size : 0; }
+} // namespace ox::memory
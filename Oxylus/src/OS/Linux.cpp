@@ -1,9 +1,11 @@
+#include <errno.h>
 #include <sys/file.h>
 #include <sys/inotify.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
 #include <sys/sysinfo.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "OS/OS.hpp"
@@ -35,4 +37,18 @@ auto os::mem_decommit(void* data, u64 size) -> void {
   madvise(data, size, MADV_DONTNEED);
   mprotect(data, size, PROT_NONE);
 }
+
+auto os::thread_sleep(f64 milliseconds) -> void {
+  if (milliseconds <= 0.0)
+    return;
+
+  // Absolute deadline so a signal interrupting the sleep doesn't restart it.
+  timespec deadline = {};
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  const auto nanoseconds = deadline.tv_nsec + static_cast<i64>(milliseconds * 1'000'000.0);
+  deadline.tv_sec += nanoseconds / 1'000'000'000;
+  deadline.tv_nsec = nanoseconds % 1'000'000'000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+  }
+}
 } // namespace ox
@@ -4,6 +4,7 @@
   #define WIN32_LEAN_AND_MEAN
 #endif
 #include <Windows.h>
+#include <timeapi.h>
 
 namespace ox {
 auto os::mem_page_size() -> u64 {
@@ -37,4 +38,29 @@ auto os::mem_decommit(void* data, [[maybe_unused]] u64 size) -> void {
 
   VirtualFree(data, 0, MEM_DECOMMIT | MEM_RELEASE);
 }
+
+auto os::thread_sleep(f64 milliseconds) -> void {
+  if (milliseconds <= 0.0)
+    return;
+
+  // High resolution timers exist since Windows 10 1803. Without them waitable timers follow
+  // the global timer resolution, which is 15.6ms unless raised to 1ms.
+  thread_local HANDLE timer = [] {
+    auto* handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!handle) {
+      [[maybe_unused]] static const auto period = timeBeginPeriod(1);
+      handle = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+    return handle;
+  }();
+
+  // Relative due time in 100ns units.
+  LARGE_INTEGER due_time = {};
+  due_time.QuadPart = -static_cast<LONGLONG>(milliseconds * 10'000.0);
+  if (timer && SetWaitableTimer(timer, &due_time, 0, nullptr, nullptr, FALSE)) {
+    WaitForSingleObject(timer, INFINITE);
+  } else {
+    Sleep(static_cast<DWORD>(milliseconds));
+  }
+}
 } // namespace ox
@@ -0,0 +1,80 @@
+#include "Physics/ContactEvents.hpp"
+
+#include <atomic>
+
+namespace ox {
+static std::atomic<u64> next_stream_id = 1;
+
+auto get_contact_sort_key(const ContactEvent& event) -> ContactSortKey {
+  return {
+      .type_body1 = static_cast<u64>(std::to_underlying(event.type)) << 32 | event.body1.GetIndexAndSequenceNumber(),
+      .body2_sub_shape1 = static_cast<u64>(event.body2.GetIndexAndSequenceNumber()) << 32 | event.sub_shape1.GetValue(),
+      .sub_shape2 = event.sub_shape2.GetValue(),
+  };
+}
+
+ContactEventStream::ContactEventStream() : stream_id(next_stream_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+auto ContactEventStream::get_thread_buffer() -> ThreadBuffer& {
+  struct ThreadCache {
+    u64 stream_id = 0;
+    ThreadBuffer* buffer = nullptr;
+  };
+  thread_local ThreadCache cache = {};
+
+  if (cache.stream_id == stream_id) {
+    return *cache.buffer;
+  }
+
+  std::lock_guard lock(registry_mutex);
+  const auto thread_id = std::this_thread::get_id();
+  auto it = std::ranges::find_if(thread_buffers, [thread_id](const auto& b) { return b->thread_id == thread_id; });
+  if (it == thread_buffers.end()) {
+    auto& buffer = thread_buffers.emplace_back(std::make_unique<ThreadBuffer>());
+    buffer->thread_id = thread_id;
+    it = thread_buffers.end() - 1;
+  }
+
+  cache = {.stream_id = stream_id, .buffer = it->get()};
+  return *cache.buffer;
+}
+
+auto ContactEventStream::record(const ContactEvent& event) -> void { get_thread_buffer().events.push_back(event); }
+
+auto ContactEventStream::flush() -> std::vector<ContactEvent>& {
+  ZoneScoped;
+
+  merged.clear();
+
+  {
+    std::lock_guard lock(registry_mutex);
+    usize count = 0;
+    for (const auto& buffer : thread_buffers) {
+      count += buffer->events.size();
+    }
+
+    merged.reserve(count);
+    for (auto& buffer : thread_buffers) {
+      merged.insert(merged.end(), buffer->events.begin(), buffer->events.end());
+      buffer->events.clear();
+    }
+  }
+
+  // Sorting the small keys and gathering once moves much less memory than sorting events.
+  sort_entries.resize(merged.size());
+  for (usize i = 0; i < merged.size(); i++) {
+    sort_entries[i] = {.key = get_contact_sort_key(merged[i]), .event_index = static_cast<u32>(i)};
+  }
+  std::ranges::sort(sort_entries);
+
+  batch.clear();
+  batch.reserve(merged.size());
+  for (const auto& entry : sort_entries) {
+    batch.push_back(merged[entry.event_index]);
+  }
+
+  TracyPlot("Physics Contact Events", static_cast<i64>(batch.size()));
+
+  return batch;
+}
+} // namespace ox
@@ -2,11 +2,21 @@
 
 #include <cstdarg>
 
+#include "Core/App.hpp"
+#include "Jolt/Physics/Body/BodyLock.h"
 #include "Jolt/Physics/Body/BodyManager.h"
 #include "Jolt/Physics/Collision/CastResult.h"
+#include "Jolt/Physics/Collision/CollideShape.h"
+#include "Jolt/Physics/Collision/NarrowPhaseQuery.h"
 #include "Jolt/Physics/Collision/RayCast.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Collision/Shape/CapsuleShape.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+#include "Jolt/Physics/Collision/ShapeCast.h"
 #include "Jolt/RegisterTypes.h"
+#include "Memory/Tracking.hpp"
 #include "Physics/RayCast.hpp"
+#include "Thread/TaskScheduler.hpp"
 #include "Utils/OxMath.hpp"
 
 namespace ox {
@@ -20,6 +30,95 @@ static void TraceImpl(const char* inFMT, ...) {
   OX_LOG_INFO("{}", buffer);
 }
 
+#ifndef JPH_DISABLE_CUSTOM_ALLOCATOR
+static void* jolt_allocate(size_t inSize) { return memory::tracked_alloc(memory::Subsystem::Physics, inSize); }
+
+static void* jolt_reallocate(void* inBlock, [[maybe_unused]] size_t inOldSize, size_t inNewSize) {
+  return memory::tracked_realloc(memory::Subsystem::Physics, inBlock, inNewSize);
+}
+
+static void jolt_free(void* inBlock) { memory::tracked_free(memory::Subsystem::Physics, inBlock); }
+
+static void* jolt_aligned_allocate(size_t inSize, size_t inAlignment) {
+  return memory::tracked_alloc(memory::Subsystem::Physics, inSize, inAlignment);
+}
+
+static void jolt_aligned_free(void* inBlock) { memory::tracked_free(memory::Subsystem::Physics, inBlock); }
+#endif
+
+// Accepts object layers whose bit is set in the entity layer mask.
+class LayerMaskFilter final : public JPH::ObjectLayerFilter {
+public:
+  explicit LayerMaskFilter(const Physics::EntityLayer mask_) : mask(mask_) {}
+
+  bool ShouldCollide(JPH::ObjectLayer inLayer) const override { return (BIT(inLayer) & mask) != 0; }
+
+private:
+  Physics::EntityLayer mask;
+};
+
+template <typename FnT>
+struct PhysicsQueryTask : ITaskSet {
+  const FnT& query_fn;
+
+  PhysicsQueryTask(const u32 query_count, const FnT& fn) : query_fn(fn) {
+    this->m_SetSize = query_count;
+    this->m_MinRange = Physics::QUERY_BATCH_SIZE;
+  }
+
+  void ExecuteRange(const enki::TaskSetPartition range, u32 threadNum) override {
+    for (u32 i = range.start; i < range.end; ++i) {
+      query_fn(i);
+    }
+  }
+};
+
+template <typename FnT>
+static void dispatch_queries(const u32 query_count, const FnT& fn) {
+  ZoneScoped;
+
+  const auto* task_scheduler = App::get_system<TaskScheduler>(EngineSystems::TaskScheduler);
+  if (query_count < Physics::PARALLEL_QUERY_THRESHOLD || !task_scheduler) {
+    for (u32 i = 0; i < query_count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  auto task = PhysicsQueryTask<FnT>(query_count, fn);
+  task_scheduler->schedule_task(&task);
+  task_scheduler->wait_task(&task);
+}
+
+// Builds the query shape on the stack and passes it to `fn`.
+template <typename FnT>
+static void with_query_shape(const QueryShape& query_shape, const FnT& fn) {
+  switch (query_shape.type) {
+    case QueryShape::Type::Sphere: {
+      JPH::SphereShape shape(glm::max(0.001f, query_shape.radius));
+      shape.SetEmbedded();
+      fn(&shape);
+    } break;
+    case QueryShape::Type::Box: {
+      const auto half_extents = glm::max(query_shape.half_extents, glm::vec3(0.001f));
+      const auto convex_radius = glm::min(JPH::cDefaultConvexRadius, glm::compMin(half_extents));
+      JPH::BoxShape shape(math::to_jolt(half_extents), convex_radius);
+      shape.SetEmbedded();
+      fn(&shape);
+    } break;
+    case QueryShape::Type::Capsule: {
+      JPH::CapsuleShape shape(glm::max(0.001f, query_shape.half_height), glm::max(0.001f, query_shape.radius));
+      shape.SetEmbedded();
+      fn(&shape);
+    } break;
+  }
+}
+
+static JPH::Mat44 query_transform(const glm::vec3& position, const glm::quat& rotation) {
+  return JPH::Mat44::sRotationTranslation(JPH::Quat(rotation.x, rotation.y, rotation.z, rotation.w),
+                                          math::to_jolt(position));
+}
+
 #ifdef JPH_ENABLE_ASSERTS
 static bool AssertFailedImpl(const char* inExpression, const char* inMessage, const char* inFile, JPH::uint inLine) {
   OX_LOG_ERROR("{0}:{1}:{2} {3}", inFile, inLine, inExpression, inMessage != nullptr ? inMessage : "");
@@ -28,8 +127,13 @@ static bool AssertFailedImpl(const char* inExpression, const char* inMessage, co
 #endif
 
 auto Physics::init() -> std::expected<void, std::string> {
-  // TODO: Override default allocators with Oxylus allocators.
-  JPH::RegisterDefaultAllocator();
+#ifndef JPH_DISABLE_CUSTOM_ALLOCATOR
+  JPH::Allocate = jolt_allocate;
+  JPH::Reallocate = jolt_reallocate;
+  JPH::Free = jolt_free;
+  JPH::AlignedAllocate = jolt_aligned_allocate;
+  JPH::AlignedFree = jolt_aligned_free;
+#endif
 
   // Install callbacks
   JPH::Trace = TraceImpl;
@@ -42,7 +146,7 @@ auto Physics::init() -> std::expected<void, std::string> {
 
   debug_renderer = new PhysicsDebugRenderer();
 
-  temp_allocator = new JPH::TempAllocatorImpl(10 * 1024 * 1024);
+  temp_allocator = new PhysicsTempAllocator(INITIAL_TEMP_ALLOCATOR_SIZE);
 
   job_system = new JPH::JobSystemThreadPool();
   job_system->Init(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, (int)std::thread::hardware_concurrency() - 1);
@@ -76,6 +180,11 @@ void Physics::step(float physicsTs) {
   OX_CHECK_NULL(physics_system, "Physics system not initialized");
 
   physics_system->Update(physicsTs, 1, temp_allocator, job_system);
+  temp_allocator->grow_to_fit();
+
+  TracyPlot("Physics Memory",
+            static_cast<i64>(memory::get_subsystem_stats(memory::Subsystem::Physics).current_bytes.load()));
+  TracyPlot("Physics Temp Memory", static_cast<i64>(temp_allocator->get_high_water_mark()));
 }
 
 void Physics::debug_draw() {
@@ -93,4 +202,138 @@ JPH::AllHitCollisionCollector<JPH::RayCastBodyCollector> Physics::cast_ray(const
 
   return collector;
 }
+
+auto Physics::cast_rays(std::span<const RayCast> rays, std::span<QueryHit> hits, EntityLayer layer_mask) const
+    -> void {
+  ZoneScoped;
+  OX_CHECK_NULL(physics_system, "Physics system not initialized");
+  OX_CHECK_GE(hits.size(), rays.size());
+
+  const auto& narrow_phase = physics_system->GetNarrowPhaseQuery();
+  const auto& lock_interface = physics_system->GetBodyLockInterface();
+  const auto layer_filter = LayerMaskFilter(layer_mask);
+
+  dispatch_queries(static_cast<u32>(rays.size()), [&](const u32 i) {
+    const auto& ray_cast = rays[i];
+    auto& hit = hits[i];
+    hit = {};
+
+    const JPH::RRayCast ray{math::to_jolt(ray_cast.get_origin()), math::to_jolt(ray_cast.get_direction())};
+    JPH::RayCastResult result = {};
+    if (!narrow_phase.CastRay(ray, result, {}, layer_filter))
+      return;
+
+    const JPH::BodyLockRead lock(lock_interface, result.mBodyID);
+    if (!lock.Succeeded())
+      return;
+
+    const auto& body = lock.GetBody();
+    const auto position = ray.GetPointOnRay(result.mFraction);
+    hit.hit = true;
+    hit.body_id = result.mBodyID;
+    hit.user_data = body.GetUserData();
+    hit.fraction = result.mFraction;
+    hit.position = math::from_jolt(position);
+    hit.normal = math::from_jolt(body.GetWorldSpaceSurfaceNormal(result.mSubShapeID2, position));
+  });
+}
+
+auto Physics::cast_shapes(std::span<const ShapeCast> casts, std::span<QueryHit> hits, EntityLayer layer_mask) const
+    -> void {
+  ZoneScoped;
+  OX_CHECK_NULL(physics_system, "Physics system not initialized");
+  OX_CHECK_GE(hits.size(), casts.size());
+
+  const auto& narrow_phase = physics_system->GetNarrowPhaseQuery();
+  const auto& lock_interface = physics_system->GetBodyLockInterface();
+  const auto layer_filter = LayerMaskFilter(layer_mask);
+
+  dispatch_queries(static_cast<u32>(casts.size()), [&](const u32 i) {
+    const auto& cast = casts[i];
+    auto& hit = hits[i];
+    hit = {};
+
+    with_query_shape(cast.shape, [&](const JPH::Shape* shape) {
+      const auto shape_cast = JPH::RShapeCast::sFromWorldTransform(shape,
+                                                                   JPH::Vec3::sReplicate(1.0f),
+                                                                   query_transform(cast.origin, cast.rotation),
+                                                                   math::to_jolt(cast.direction));
+      JPH::ShapeCastSettings settings = {};
+      settings.mBackFaceModeTriangles = JPH::EBackFaceMode::IgnoreBackFaces;
+      settings.mBackFaceModeConvex = JPH::EBackFaceMode::IgnoreBackFaces;
+
+      JPH::ClosestHitCollisionCollector<JPH::CastShapeCollector> collector = {};
+      narrow_phase.CastShape(shape_cast, settings, JPH::RVec3::sZero(), collector, {}, layer_filter);
+      if (!collector.HadHit())
+        return;
+
+      const auto& result = collector.mHit;
+      const JPH::BodyLockRead lock(lock_interface, result.mBodyID2);
+      if (!lock.Succeeded())
+        return;
+
+      hit.hit = true;
+      hit.body_id = result.mBodyID2;
+      hit.user_data = lock.GetBody().GetUserData();
+      hit.fraction = result.mFraction;
+      hit.position = math::from_jolt(result.mContactPointOn2);
+      hit.normal = math::from_jolt(-result.mPenetrationAxis.NormalizedOr(JPH::Vec3::sZero()));
+    });
+  });
+}
+
+auto Physics::overlap(std::span<const OverlapQuery> queries,
+                      std::span<QueryHit> hits,
+                      std::span<u32> hit_counts,
+                      const u32 max_hits_per_query,
+                      EntityLayer layer_mask) const -> void {
+  ZoneScoped;
+  OX_CHECK_NULL(physics_system, "Physics system not initialized");
+  OX_CHECK_GE(hits.size(), queries.size() * max_hits_per_query);
+  OX_CHECK_GE(hit_counts.size(), queries.size());
+
+  const auto& narrow_phase = physics_system->GetNarrowPhaseQuery();
+  const auto& lock_interface = physics_system->GetBodyLockInterface();
+  const auto layer_filter = LayerMaskFilter(layer_mask);
+
+  dispatch_queries(static_cast<u32>(queries.size()), [&](const u32 i) {
+    const auto& query = queries[i];
+    auto query_hits = hits.subspan(static_cast<usize>(i) * max_hits_per_query, max_hits_per_query);
+    hit_counts[i] = 0;
+
+    with_query_shape(query.shape, [&](const JPH::Shape* shape) {
+      JPH::CollideShapeSettings settings = {};
+      settings.mBackFaceMode = JPH::EBackFaceMode::IgnoreBackFaces;
+
+      JPH::AllHitCollisionCollector<JPH::CollideShapeCollector> collector = {};
+      narrow_phase.CollideShape(shape,
+                                JPH::Vec3::sReplicate(1.0f),
+                                query_transform(query.position, query.rotation),
+                                settings,
+                                JPH::RVec3::sZero(),
+                                collector,
+                                {},
+                                layer_filter);
+
+      u32 count = 0;
+      for (const auto& result : collector.mHits) {
+        if (count >= max_hits_per_query)
+          break;
+
+        const JPH::BodyLockRead lock(lock_interface, result.mBodyID2);
+        if (!lock.Succeeded())
+          continue;
+
+        auto& hit = query_hits[count++];
+        hit.hit = true;
+        hit.body_id = result.mBodyID2;
+        hit.user_data = lock.GetBody().GetUserData();
+        hit.fraction = 0.0f;
+        hit.position = math::from_jolt(result.mContactPointOn2);
+        hit.normal = math::from_jolt(-result.mPenetrationAxis.NormalizedOr(JPH::Vec3::sZero()));
+      }
+      hit_counts[i] = count;
+    });
+  });
+}
 } // namespace ox
@@ -2,8 +2,10 @@
 
 #include <Jolt/Physics/Body/Body.h>
 
+#include "Memory/Tracking.hpp"
 #include "Physics/PhysicsMaterial.hpp"
 #include "Scene/Scene.hpp"
+#include "Utils/OxMath.hpp"
 
 bool ObjectLayerPairFilterImpl::ShouldCollide(JPH::ObjectLayer inObject1, JPH::ObjectLayer inObject2) const {
   using namespace JPH;
@@ -61,6 +63,63 @@ void Physics3DBodyActivationListener::OnBodyDeactivated(const JPH::BodyID& inBod
   /* Body Deactivated */
 }
 
+PhysicsTempAllocator::PhysicsTempAllocator(const size_t initial_size) : capacity(initial_size) {
+  base = static_cast<u8*>(memory::tracked_alloc(memory::Subsystem::PhysicsTemp, capacity, JPH_RVECTOR_ALIGNMENT));
+}
+
+PhysicsTempAllocator::~PhysicsTempAllocator() {
+  OX_ASSERT(top == 0);
+  memory::tracked_free(memory::Subsystem::PhysicsTemp, base);
+}
+
+void* PhysicsTempAllocator::Allocate(const JPH::uint inSize) {
+  if (inSize == 0)
+    return nullptr;
+
+  const auto aligned_size = ox::align_up(static_cast<size_t>(inSize), JPH_RVECTOR_ALIGNMENT);
+  in_use += aligned_size;
+  high_water_mark = ox::max(high_water_mark, in_use);
+
+  if (top + aligned_size <= capacity) {
+    auto* ptr = base + top;
+    top += aligned_size;
+    return ptr;
+  }
+
+  overflow_count++;
+  return memory::tracked_alloc(memory::Subsystem::PhysicsTemp, aligned_size, JPH_RVECTOR_ALIGNMENT);
+}
+
+void PhysicsTempAllocator::Free(void* inAddress, const JPH::uint inSize) {
+  if (inAddress == nullptr)
+    return;
+
+  const auto aligned_size = ox::align_up(static_cast<size_t>(inSize), JPH_RVECTOR_ALIGNMENT);
+  in_use -= aligned_size;
+
+  if (owns(inAddress)) {
+    top -= aligned_size;
+    OX_ASSERT(base + top == inAddress, "Physics temp allocations must be freed in LIFO order");
+  } else {
+    memory::tracked_free(memory::Subsystem::PhysicsTemp, inAddress);
+  }
+}
+
+auto PhysicsTempAllocator::grow_to_fit() -> bool {
+  if (high_water_mark <= capacity || top != 0)
+    return false;
+
+  // Leave some headroom so a slowly growing workload doesn't reallocate every step.
+  const auto new_capacity = ox::align_up(high_water_mark + high_water_mark / 4, ox::kib_to_bytes(64_sz));
+  memory::tracked_free(memory::Subsystem::PhysicsTemp, base);
+  base = static_cast<u8*>(memory::tracked_alloc(memory::Subsystem::PhysicsTemp, new_capacity, JPH_RVECTOR_ALIGNMENT));
+  capacity = new_capacity;
+
+  OX_LOG_INFO("Physics temp allocator grown to {} KiB", capacity / 1024);
+
+  return true;
+}
+
 void Physics3DContactListener::GetFrictionAndRestitution(const JPH::Body& inBody,
                                                          const JPH::SubShapeID& inSubShapeID,
                                                          float& outFriction,
@@ -112,7 +171,7 @@ void Physics3DContactListener::OnContactAdded(const JPH::Body& inBody1,
 
   OverrideContactSettings(inBody1, inBody2, inManifold, ioSettings);
 
-  _scene->on_contact_added(inBody1, inBody2, inManifold, ioSettings);
+  event_stream.record(make_contact_event(ContactEvent::Type::Added, inBody1, inBody2, inManifold, ioSettings));
 }
 
 void Physics3DContactListener::OnContactPersisted(const JPH::Body& inBody1,
@@ -123,13 +182,44 @@ void Physics3DContactListener::OnContactPersisted(const JPH::Body& inBody1,
 
   OverrideContactSettings(inBody1, inBody2, inManifold, ioSettings);
 
-  _scene->on_contact_persisted(inBody1, inBody2, inManifold, ioSettings);
+  event_stream.record(make_contact_event(ContactEvent::Type::Persisted, inBody1, inBody2, inManifold, ioSettings));
 }
 
 void Physics3DContactListener::OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) {
   ZoneScoped;
 
-  _scene->on_contact_removed(inSubShapePair);
+  event_stream.record({
+      .type = ContactEvent::Type::Removed,
+      .body1 = inSubShapePair.GetBody1ID(),
+      .body2 = inSubShapePair.GetBody2ID(),
+      .sub_shape1 = inSubShapePair.GetSubShapeID1(),
+      .sub_shape2 = inSubShapePair.GetSubShapeID2(),
+  });
+}
+
+auto Physics3DContactListener::make_contact_event(ContactEvent::Type type,
+                                                  const JPH::Body& inBody1,
+                                                  const JPH::Body& inBody2,
+                                                  const JPH::ContactManifold& inManifold,
+                                                  const JPH::ContactSettings& inSettings) -> ContactEvent {
+  const auto point_count = static_cast<u32>(inManifold.mRelativeContactPointsOn1.size());
+  const auto position = point_count > 0 ? inManifold.GetWorldSpaceContactPointOn1(0) : inManifold.mBaseOffset;
+
+  return {
+      .type = type,
+      .body1 = inBody1.GetID(),
+      .body2 = inBody2.GetID(),
+      .sub_shape1 = inManifold.mSubShapeID1,
+      .sub_shape2 = inManifold.mSubShapeID2,
+      .user_data1 = inBody1.GetUserData(),
+      .user_data2 = inBody2.GetUserData(),
+      .position = math::from_jolt(JPH::Vec3(position)),
+      .normal = math::from_jolt(inManifold.mWorldSpaceNormal),
+      .penetration_depth = inManifold.mPenetrationDepth,
+      .contact_point_count = point_count,
+      .combined_friction = inSettings.mCombinedFriction,
+      .combined_restitution = inSettings.mCombinedRestitution,
+  };
 }
 
 } // namespace ox
@@ -1,79 +1,336 @@
 ﻿#include "Render/DebugRenderer.hpp"
 
-#include <vuk/vsl/Core.hpp>
-
-#include "Core/App.hpp"
 #include "Utils/OxMath.hpp"
-#include "Render/Vulkan/VkContext.hpp"
 
 namespace ox {
 DebugRenderer* DebugRenderer::instance = nullptr;
 
+// Thread lists remember the renderer they were registered with by its generation, so a
+// renderer created after `release` never sees lists of the previous one.
+static std::atomic<u64> debug_renderer_generation = 0;
+
+void DebugRenderer::DebugDrawList::clear() {
+  debug_lines.clear();
+  debug_points.clear();
+  debug_triangles.clear();
+  geometry_instances.clear();
+}
+
+void DebugRenderer::DebugDrawList::append(DebugDrawList& other) {
+  debug_lines.insert(debug_lines.end(), other.debug_lines.begin(), other.debug_lines.end());
+  debug_points.insert(debug_points.end(), other.debug_points.begin(), other.debug_points.end());
+  debug_triangles.insert(debug_triangles.end(), other.debug_triangles.begin(), other.debug_triangles.end());
+  geometry_instances.insert(
+      geometry_instances.end(), other.geometry_instances.begin(), other.geometry_instances.end());
+  other.clear();
+}
+
 void DebugRenderer::init() {
   ZoneScoped;
   if (instance)
     return;
 
   instance = new DebugRenderer();
+  instance->generation = ++debug_renderer_generation;
+
+  // Unit shapes drawn often enough to be worth instancing.
+  constexpr auto CIRCLE_SEGMENTS = 32;
+  auto sphere_lines = std::vector<Line>();
+  for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+    const auto a0 = glm::two_pi<float>() * float(i) / float(CIRCLE_SEGMENTS);
+    const auto a1 = glm::two_pi<float>() * float(i + 1) / float(CIRCLE_SEGMENTS);
+    const auto p0 = glm::vec2(glm::cos(a0), glm::sin(a0));
+    const auto p1 = glm::vec2(glm::cos(a1), glm::sin(a1));
+    sphere_lines.push_back({{p0.x, p0.y, 0.0f}, {p1.x, p1.y, 0.0f}, glm::vec4(1.0f)});
+    sphere_lines.push_back({{p0.x, 0.0f, p0.y}, {p1.x, 0.0f, p1.y}, glm::vec4(1.0f)});
+    sphere_lines.push_back({{0.0f, p0.x, p0.y}, {0.0f, p1.x, p1.y}, glm::vec4(1.0f)});
+  }
+  instance->unit_sphere = create_geometry(sphere_lines, {});
+
+  auto box_lines = std::vector<Line>();
+  for (int axis = 0; axis < 3; axis++) {
+    for (int corner = 0; corner < 4; corner++) {
+      auto p0 = glm::vec3(-1.0f);
+      p0[(axis + 1) % 3] = (corner & 1) ? 1.0f : -1.0f;
+      p0[(axis + 2) % 3] = (corner & 2) ? 1.0f : -1.0f;
+      auto p1 = p0;
+      p1[axis] = 1.0f;
+      box_lines.push_back({p0, p1, glm::vec4(1.0f)});
+    }
+  }
+  instance->unit_box = create_geometry(box_lines, {});
+}
 
-  std::vector<uint32_t> indices = {};
-  indices.resize(MAX_LINE_INDICES);
+void DebugRenderer::release() {
+  delete instance;
+  instance = nullptr;
+}
 
-  for (uint32_t i = 0; i < MAX_LINE_INDICES; i++) {
-    indices[i] = i;
+void DebugRenderer::reset(bool clear_depth_tested) {
+  ZoneScoped;
+  std::lock_guard lock(instance->thread_lists_mutex);
+  for (auto& thread_list : instance->thread_lists) {
+    std::lock_guard list_lock(thread_list->mutex);
+    thread_list->draw_list.clear();
+    if (clear_depth_tested)
+      thread_list->draw_list_depth_tested.clear();
   }
+}
 
-  auto [i_buff, i_buff_fut] = create_buffer(*App::get_vkcontext().superframe_allocator,
-                                            vuk::MemoryUsage::eCPUtoGPU,
-                                            vuk::DomainFlagBits::eTransferOnGraphics,
-                                            std::span(indices));
+auto DebugRenderer::get_thread_list() -> ThreadDrawList& {
+  thread_local ThreadDrawList* thread_list = nullptr;
+  thread_local u64 thread_generation = 0;
 
-  auto compiler = vuk::Compiler{};
-  i_buff_fut.wait(*App::get_vkcontext().superframe_allocator, compiler);
+  if (thread_generation != instance->generation) {
+    std::lock_guard lock(instance->thread_lists_mutex);
+    thread_list = instance->thread_lists.emplace_back(std::make_unique<ThreadDrawList>()).get();
+    thread_generation = instance->generation;
+  }
 
-  instance->debug_renderer_context.index_buffer = std::move(i_buff);
+  return *thread_list;
 }
 
-void DebugRenderer::release() {
-  delete instance;
-  instance = nullptr;
+void DebugRenderer::collect(DrawData& data) {
+  ZoneScoped;
+
+  auto& collected = instance->collected;
+  auto& collected_depth_tested = instance->collected_depth_tested;
+  collected.clear();
+  collected_depth_tested.clear();
+  {
+    std::lock_guard lock(instance->thread_lists_mutex);
+    for (auto& thread_list : instance->thread_lists) {
+      std::lock_guard list_lock(thread_list->mutex);
+      collected.append(thread_list->draw_list);
+      collected_depth_tested.append(thread_list->draw_list_depth_tested);
+    }
+  }
+
+  data.vertices.clear();
+  data.instances.clear();
+  data.batches.clear();
+  data.instances.push_back({.transform = glm::mat4(1.0f), .color = glm::vec4(1.0f)});
+
+  const auto push_vertex = [&data](const glm::vec3& position, const glm::vec4& color) {
+    data.vertices.push_back({.position = position, .color = glm::packUnorm4x8(color)});
+  };
+
+  const auto push_batch = [&data](Topology topology, bool depth_tested, u32 first_vertex) {
+    const auto vertex_count = static_cast<u32>(data.vertices.size()) - first_vertex;
+    if (vertex_count != 0) {
+      data.batches.push_back({
+          .topology = topology,
+          .depth_tested = depth_tested,
+          .first_vertex = first_vertex,
+          .vertex_count = vertex_count,
+          .first_instance = 0,
+          .instance_count = 1,
+      });
+    }
+  };
+
+  for (auto* list : {&collected, &collected_depth_tested}) {
+    const auto depth_tested = list == &collected_depth_tested;
+
+    auto first_vertex = static_cast<u32>(data.vertices.size());
+    for (const auto& line : list->debug_lines) {
+      push_vertex(line.p1, line.col);
+      push_vertex(line.p2, line.col);
+    }
+    // Points are drawn as a small cross.
+    for (const auto& point : list->debug_points) {
+      for (int axis = 0; axis < 3; axis++) {
+        auto offset = glm::vec3(0.0f);
+        offset[axis] = point.size;
+        push_vertex(point.p1 - offset, point.col);
+        push_vertex(point.p1 + offset, point.col);
+      }
+    }
+    push_batch(Topology::Lines, depth_tested, first_vertex);
+
+    first_vertex = static_cast<u32>(data.vertices.size());
+    for (const auto& tri : list->debug_triangles) {
+      push_vertex(tri.p1, tri.col);
+      push_vertex(tri.p2, tri.col);
+      push_vertex(tri.p3, tri.col);
+    }
+    push_batch(Topology::Triangles, depth_tested, first_vertex);
+  }
+
+  {
+    std::lock_guard lock(instance->geometry_mutex);
+    instance->compact_geometry();
+
+    // Instances of the same geometry and mode are drawn with one instanced draw.
+    for (auto* list : {&collected, &collected_depth_tested}) {
+      const auto depth_tested = list == &collected_depth_tested;
+      std::ranges::stable_sort(list->geometry_instances, [](const GeometryInstance& a, const GeometryInstance& b) {
+        return std::tie(a.geometry, a.wireframe) < std::tie(b.geometry, b.wireframe);
+      });
+
+      for (usize i = 0; i < list->geometry_instances.size();) {
+        const auto& first = list->geometry_instances[i];
+        auto end = i + 1;
+        while (end < list->geometry_instances.size() && list->geometry_instances[end].geometry == first.geometry &&
+               list->geometry_instances[end].wireframe == first.wireframe) {
+          end++;
+        }
+
+        const auto geometry_index = std::to_underlying(first.geometry);
+        if (geometry_index < instance->geometries.size() && instance->geometries[geometry_index].alive) {
+          const auto& geometry = instance->geometries[geometry_index];
+          const auto lines = first.wireframe || geometry.triangle_vertex_count == 0;
+          const auto vertex_count = lines ? geometry.line_vertex_count : geometry.triangle_vertex_count;
+          if (vertex_count != 0) {
+            data.batches.push_back({
+                .topology = lines ? Topology::Lines : Topology::Triangles,
+                .depth_tested = depth_tested,
+                .retained = true,
+                .first_vertex = lines ? geometry.line_offset : geometry.triangle_offset,
+                .vertex_count = vertex_count,
+                .first_instance = static_cast<u32>(data.instances.size()),
+                .instance_count = static_cast<u32>(end - i),
+            });
+            for (usize j = i; j < end; j++) {
+              const auto& geometry_instance = list->geometry_instances[j];
+              data.instances.push_back({.transform = geometry_instance.transform, .color = geometry_instance.color});
+            }
+          }
+        }
+
+        i = end;
+      }
+    }
+
+    if (data.geometry_version != instance->geometry_version) {
+      data.geometry_vertices = instance->geometry_vertices;
+      data.geometry_version = instance->geometry_version;
+    }
+  }
+
+  TracyPlot("Debug Vertices", static_cast<i64>(data.vertices.size()));
+  TracyPlot("Debug Instances", static_cast<i64>(data.instances.size()));
+  TracyPlot("Debug Batches", static_cast<i64>(data.batches.size()));
 }
 
-void DebugRenderer::reset(bool clear_depth_tested) {
+DebugGeometryID DebugRenderer::create_geometry(std::span<const Line> lines, std::span<const Triangle> triangles) {
+  ZoneScoped;
+  std::lock_guard lock(instance->geometry_mutex);
+
+  auto& vertices = instance->geometry_vertices;
+  const auto push_vertex = [&vertices](const glm::vec3& position, const glm::vec4& color) {
+    vertices.push_back({.position = position, .color = glm::packUnorm4x8(color)});
+  };
+
+  auto geometry = Geometry{.alive = true};
+  geometry.line_offset = static_cast<u32>(vertices.size());
+  for (const auto& line : lines) {
+    push_vertex(line.p1, line.col);
+    push_vertex(line.p2, line.col);
+  }
+  for (const auto& tri : triangles) {
+    push_vertex(tri.p1, tri.col);
+    push_vertex(tri.p2, tri.col);
+    push_vertex(tri.p2, tri.col);
+    push_vertex(tri.p3, tri.col);
+    push_vertex(tri.p3, tri.col);
+    push_vertex(tri.p1, tri.col);
+  }
+  geometry.line_vertex_count = static_cast<u32>(vertices.size()) - geometry.line_offset;
+
+  geometry.triangle_offset = static_cast<u32>(vertices.size());
+  for (const auto& tri : triangles) {
+    push_vertex(tri.p1, tri.col);
+    push_vertex(tri.p2, tri.col);
+    push_vertex(tri.p3, tri.col);
+  }
+  geometry.triangle_vertex_count = static_cast<u32>(vertices.size()) - geometry.triangle_offset;
+
+  auto index = 0_u32;
+  if (!instance->free_geometries.empty()) {
+    index = instance->free_geometries.back();
+    instance->free_geometries.pop_back();
+    instance->geometries[index] = geometry;
+  } else {
+    index = static_cast<u32>(instance->geometries.size());
+    instance->geometries.push_back(geometry);
+  }
+
+  instance->geometry_version += 1;
+
+  return static_cast<DebugGeometryID>(index);
+}
+
+void DebugRenderer::destroy_geometry(DebugGeometryID id) {
+  if (!instance || id == DebugGeometryID::Invalid)
+    return;
+
+  std::lock_guard lock(instance->geometry_mutex);
+  auto& geometry = instance->geometries[std::to_underlying(id)];
+  if (!geometry.alive)
+    return;
+
+  // Vertices are only reclaimed by `compact_geometry`, destroying many geometries at once
+  // (i.e. unloading a scene) stays linear.
+  geometry.alive = false;
+  instance->dead_geometry_vertices += geometry.line_vertex_count + geometry.triangle_vertex_count;
+  instance->free_geometries.push_back(std::to_underlying(id));
+}
+
+void DebugRenderer::compact_geometry() {
+  if (dead_geometry_vertices * 2 <= geometry_vertices.size())
+    return;
+
   ZoneScoped;
-  instance->draw_list.debug_lines.clear();
-  instance->draw_list.debug_points.clear();
 
-  if (clear_depth_tested) {
-    instance->draw_list_depth_tested.debug_lines.clear();
-    instance->draw_list_depth_tested.debug_points.clear();
+  auto compacted = std::vector<DrawVertex>();
+  compacted.reserve(geometry_vertices.size() - dead_geometry_vertices);
+  for (auto& geometry : geometries) {
+    if (!geometry.alive)
+      continue;
+
+    // Lines and triangles of a geometry are stored back to back.
+    const auto begin = geometry_vertices.begin() + geometry.line_offset;
+    const auto new_offset = static_cast<u32>(compacted.size());
+    compacted.insert(compacted.end(), begin, begin + geometry.line_vertex_count + geometry.triangle_vertex_count);
+    geometry.line_offset = new_offset;
+    geometry.triangle_offset = new_offset + geometry.line_vertex_count;
   }
+
+  geometry_vertices = std::move(compacted);
+  dead_geometry_vertices = 0;
+  geometry_version += 1;
+}
+
+void DebugRenderer::draw_geometry(
+    DebugGeometryID id, const glm::mat4& transform, const glm::vec4& color, bool wireframe, bool depth_tested) {
+  if (id == DebugGeometryID::Invalid)
+    return;
+
+  auto& thread_list = get_thread_list();
+  std::lock_guard lock(thread_list.mutex);
+  thread_list.get(depth_tested)
+      .geometry_instances.push_back({.geometry = id, .wireframe = wireframe, .transform = transform, .color = color});
 }
 
 void DebugRenderer::draw_point(const glm::vec3& pos, float point_radius, const glm::vec4& color, bool depth_tested) {
-  ZoneScoped;
-  if (depth_tested)
-    instance->draw_list_depth_tested.debug_points.emplace_back(Point{pos, color, point_radius});
-  else
-    instance->draw_list.debug_points.emplace_back(Point{pos, color, point_radius});
+  auto& thread_list = get_thread_list();
+  std::lock_guard lock(thread_list.mutex);
+  thread_list.get(depth_tested).debug_points.emplace_back(Point{pos, color, point_radius});
 }
 
 void DebugRenderer::draw_line(
     const glm::vec3& start, const glm::vec3& end, float line_width, const glm::vec4& color, bool depth_tested) {
-  ZoneScoped;
-  if (depth_tested)
-    instance->draw_list_depth_tested.debug_lines.emplace_back(Line{start, end, color});
-  else
-    instance->draw_list.debug_lines.emplace_back(Line{start, end, color});
+  auto& thread_list = get_thread_list();
+  std::lock_guard lock(thread_list.mutex);
+  thread_list.get(depth_tested).debug_lines.emplace_back(Line{start, end, color});
 }
 
 void DebugRenderer::draw_triangle(
     const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, const glm::vec4& color, bool depth_tested) {
-  ZoneScoped;
-  if (depth_tested)
-    instance->draw_list_depth_tested.debug_triangles.emplace_back(Triangle{v0, v1, v2, color});
-  else
-    instance->draw_list.debug_triangles.emplace_back(Triangle{v0, v1, v2, color});
+  auto& thread_list = get_thread_list();
+  std::lock_guard lock(thread_list.mutex);
+  thread_list.get(depth_tested).debug_triangles.emplace_back(Triangle{v0, v1, v2, color});
 }
 
 void DebugRenderer::draw_circle(int num_verts,
@@ -98,9 +355,8 @@ void DebugRenderer::draw_circle(int num_verts,
 }
 
 void DebugRenderer::draw_sphere(float radius, const glm::vec3& position, const glm::vec4& color, bool depth_tested) {
-  draw_circle(20, radius, position, glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)), color, depth_tested);
-  draw_circle(20, radius, position, glm::quat(glm::vec3(90.0f, 0.0f, 0.0f)), color, depth_tested);
-  draw_circle(20, radius, position, glm::quat(glm::vec3(0.0f, 90.0f, 90.0f)), color, depth_tested);
+  const auto transform = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(radius));
+  draw_geometry(instance->unit_sphere, transform, color, true, depth_tested);
 }
 
 void draw_arc(int num_verts,
@@ -216,20 +472,8 @@ DebugRenderer::draw_aabb(const AABB& aabb, const glm::vec4& color, bool corners_
 
   // Draw edges
   if (!corners_only) {
-    draw_line(luu, uuu, width, color, depth_tested);
-    draw_line(lul, uul, width, color, depth_tested);
-    draw_line(llu, ulu, width, color, depth_tested);
-    draw_line(lll, ull, width, color, depth_tested);
-
-    draw_line(lul, lll, width, color, depth_tested);
-    draw_line(uul, ull, width, color, depth_tested);
-    draw_line(luu, llu, width, color, depth_tested);
-    draw_line(uuu, ulu, width, color, depth_tested);
-
-    draw_line(lll, llu, width, color, depth_tested);
-    draw_line(ull, ulu, width, color, depth_tested);
-    draw_line(lul, luu, width, color, depth_tested);
-    draw_line(uul, uuu, width, color, depth_tested);
+    const auto transform = glm::scale(glm::translate(glm::mat4(1.0f), aabb.get_center()), aabb.get_extents() * 0.5f);
+    draw_geometry(instance->unit_box, transform, color, true, depth_tested);
   } else {
     draw_line(luu, luu + (uuu - luu) * 0.25f, width, color, depth_tested);
     draw_line(luu + (uuu - luu) * 0.75f, uuu, width, color, depth_tested);
@@ -305,49 +549,15 @@ DebugRenderer::draw_ray(const RayCast& ray, const glm::vec4& color, const float
   draw_line(ray.get_origin(), ray.get_origin() + ray.get_direction() * distance, 1.0f, color, depth_tested);
 }
 
-std::pair<std::vector<Vertex>, uint32_t> DebugRenderer::get_vertices_from_lines(const std::vector<Line>& lines) {
-  std::vector<Vertex> vertices = {};
-  vertices.reserve(lines.size() * 2);
-  uint32_t indices = 0;
-
-  for (const auto& line : lines) {
-    // store color in normals for simplicity
-    vertices.emplace_back(
-        Vertex{.position = line.p1, .normal = glm::packSnorm2x16(math::float32x3_to_oct(line.col)), .uv = {}});
-    vertices.emplace_back(
-        Vertex{.position = line.p2, .normal = glm::packSnorm2x16(math::float32x3_to_oct(line.col)), .uv = {}});
-
-    indices += 2;
-  }
-
-  return {vertices, indices};
-}
-
-std::pair<std::vector<Vertex>, uint32_t>
-DebugRenderer::get_vertices_from_triangles(const std::vector<Triangle>& triangles) {
-  std::vector<Vertex> vertices = {};
-  vertices.reserve(triangles.size() * 3);
-  uint32_t indices = 0;
-
-  for (const auto& tri : triangles) {
-    // store color in normals for simplicity
-    vertices.emplace_back(
-        Vertex{.position = tri.p1, .normal = glm::packSnorm2x16(math::float32x3_to_oct(tri.col)), .uv = {}});
-    vertices.emplace_back(
-        Vertex{.position = tri.p2, .normal = glm::packSnorm2x16(math::float32x3_to_oct(tri.col)), .uv = {}});
-    vertices.emplace_back(
-        Vertex{.position = tri.p3, .normal = glm::packSnorm2x16(math::float32x3_to_oct(tri.col)), .uv = {}});
-
-    indices += 3;
-  }
-
-  return {vertices, indices};
-}
-
 // ----------------------
 // Physics Debug Renderer
 
-PhysicsDebugRenderer::PhysicsDebugRenderer() { DebugRenderer::Initialize(); }
+PhysicsDebugRenderer::PhysicsDebugRenderer() {
+  // Physics starts before the app sets up the debug renderer and Jolt creates its shape
+  // batches right here. Initializing twice is a no-op.
+  ox::DebugRenderer::init();
+  DebugRenderer::Initialize();
+}
 
 void PhysicsDebugRenderer::DrawLine(JPH::RVec3Arg inFrom, JPH::RVec3Arg inTo, JPH::ColorArg inColor) {
   ox::DebugRenderer::draw_line(
@@ -364,17 +574,22 @@ void PhysicsDebugRenderer::DrawTriangle(
 }
 
 JPH::DebugRenderer::Batch PhysicsDebugRenderer::CreateTriangleBatch(const Triangle* inTriangles, int inTriangleCount) {
-  TriangleBatch* pBatch = new TriangleBatch;
-  pBatch->triangles.reserve(inTriangleCount);
+  ZoneScoped;
+
+  auto triangles = std::vector<ox::DebugRenderer::Triangle>();
+  triangles.reserve(inTriangleCount);
 
   for (int i = 0; i < inTriangleCount; ++i) {
-    auto& t = pBatch->triangles.emplace_back();
+    auto& t = triangles.emplace_back();
     t.p1 = math::from_jolt(JPH::Vec3{inTriangles[i].mV[0].mPosition});
     t.p2 = math::from_jolt(JPH::Vec3{inTriangles[i].mV[1].mPosition});
     t.p3 = math::from_jolt(JPH::Vec3{inTriangles[i].mV[2].mPosition});
     t.col = math::from_jolt(inTriangles[i].mV[0].mColor.ToVec4());
   }
 
+  TriangleBatch* pBatch = new TriangleBatch;
+  pBatch->geometry = ox::DebugRenderer::create_geometry({}, triangles);
+
   return pBatch;
 }
 
@@ -382,15 +597,17 @@ JPH::DebugRenderer::Batch PhysicsDebugRenderer::CreateTriangleBatch(const Vertex
                                                                     int inVertexCount,
                                                                     const u32* inIndices,
                                                                     int inIndexCount) {
+  ZoneScoped;
+
   const u32 numTris = inIndexCount / 3;
 
-  TriangleBatch* pBatch = new TriangleBatch;
-  pBatch->triangles.reserve(numTris);
+  auto triangles = std::vector<ox::DebugRenderer::Triangle>();
+  triangles.reserve(numTris);
 
   u32 index = 0;
 
   for (u32 i = 0; i < numTris; ++i) {
-    auto& t = pBatch->triangles.emplace_back();
+    auto& t = triangles.emplace_back();
     t.p1 = math::from_jolt(JPH::Vec3{inVertices[inIndices[index + 0]].mPosition});
     t.p2 = math::from_jolt(JPH::Vec3{inVertices[inIndices[index + 1]].mPosition});
     t.p3 = math::from_jolt(JPH::Vec3{inVertices[inIndices[index + 2]].mPosition});
@@ -399,6 +616,9 @@ JPH::DebugRenderer::Batch PhysicsDebugRenderer::CreateTriangleBatch(const Vertex
     index += 3;
   }
 
+  TriangleBatch* pBatch = new TriangleBatch;
+  pBatch->geometry = ox::DebugRenderer::create_geometry({}, triangles);
+
   return pBatch;
 }
 
@@ -424,44 +644,10 @@ void PhysicsDebugRenderer::DrawGeometry(JPH::RMat44Arg inModelMatrix,
   const glm::mat4 trans = reinterpret_cast<const glm::mat4&>(inModelMatrix);
   const glm::vec4 color = math::from_jolt(inModelColor.ToVec4());
 
-  // TODO: currently only renders into not depth tested list...
-  auto debug_renderer = ox::DebugRenderer::get_instance();
-
-  if (inDrawMode == JPH::DebugRenderer::EDrawMode::Solid) {
-    if (inCullMode == JPH::DebugRenderer::ECullMode::CullBackFace || inCullMode == JPH::DebugRenderer::ECullMode::Off) {
-      for (u32 t = 0; t < pBatch->triangles.size(); ++t) {
-        auto& tri = debug_renderer->draw_list.debug_triangles.emplace_back();
-        tri.col = pBatch->triangles[t].col * color;
-        tri.p1 = trans * glm::vec4(pBatch->triangles[t].p1, 1.f);
-        tri.p2 = trans * glm::vec4(pBatch->triangles[t].p2, 1.f);
-        tri.p3 = trans * glm::vec4(pBatch->triangles[t].p3, 1.f);
-      }
-    }
-
-    if (inCullMode == JPH::DebugRenderer::ECullMode::CullFrontFace ||
-        inCullMode == JPH::DebugRenderer::ECullMode::Off) {
-      for (u32 t = 0; t < pBatch->triangles.size(); ++t) {
-        auto& tri = debug_renderer->draw_list.debug_triangles.emplace_back();
-        tri.col = pBatch->triangles[t].col * color;
-        tri.p1 = trans * glm::vec4(pBatch->triangles[t].p1, 1.f);
-        tri.p2 = trans * glm::vec4(pBatch->triangles[t].p3, 1.f);
-        tri.p3 = trans * glm::vec4(pBatch->triangles[t].p2, 1.f);
-      }
-    }
-  } else {
-    for (u32 t = 0; t < pBatch->triangles.size(); ++t) {
-      const auto& tri = pBatch->triangles[t];
-      const auto col = pBatch->triangles[t].col * color;
-
-      const glm::vec3 v0 = trans * glm::vec4(tri.p1, 1.0f);
-      const glm::vec3 v1 = trans * glm::vec4(tri.p2, 1.0f);
-      const glm::vec3 v2 = trans * glm::vec4(tri.p3, 1.0f);
-
-      debug_renderer->draw_list.debug_lines.emplace_back(ox::DebugRenderer::Line{v0, v1, col});
-      debug_renderer->draw_list.debug_lines.emplace_back(ox::DebugRenderer::Line{v1, v2, col});
-      debug_renderer->draw_list.debug_lines.emplace_back(ox::DebugRenderer::Line{v2, v0, col});
-    }
-  }
+  // The batch is referenced, not copied. Debug geometry is drawn without face culling, so
+  // the cull mode doesn't matter.
+  ox::DebugRenderer::draw_geometry(
+      pBatch->geometry, trans, color, inDrawMode == JPH::DebugRenderer::EDrawMode::Wireframe, draw_depth_tested);
 }
 
 void PhysicsDebugRenderer::DrawText3D(JPH::RVec3Arg inPosition,
@@ -9,17 +9,23 @@
 #include <vuk/vsl/Core.hpp>
 
 #include "Asset/AssetManager.hpp"
+#include "Asset/MeshLOD.hpp"
 #include "Asset/Texture.hpp"
 #include "Core/App.hpp"
 #include "Core/VFS.hpp"
+#include "Memory/FrameArena.hpp"
 #include "Render/Camera.hpp"
 #include "Render/DebugRenderer.hpp"
+#include "Render/LightClustering.hpp"
 #include "Render/RendererConfig.hpp"
+#include "Render/ShadowAtlas.hpp"
 #include "Render/Slang/Slang.hpp"
 #include "Render/Utils/VukCommon.hpp"
 #include "Render/Vulkan/VkContext.hpp"
 #include "Scene/ECSModule/Core.hpp"
 #include "Scene/SceneGPU.hpp"
+#include "Thread/TaskScheduler.hpp"
+#include "Thread/ThreadManager.hpp"
 #include "Utils/Profiler.hpp"
 
 namespace ox {
@@ -121,6 +127,33 @@ auto EasyRenderPipeline::init(VkContext& vk_context) -> void {
   slang.create_pipeline(
       runtime, "brdf", dslci_01, {.path = shaders_dir + "/passes/brdf.slang", .entry_points = {"vs_main", "fs_main"}});
 
+  // --- Shadows ---
+  slang.create_pipeline(
+      runtime,
+      "shadow_depth",
+      {},
+      {.path = shaders_dir + "/passes/shadow_depth.slang", .entry_points = {"vs_main", "fs_main"}});
+
+  slang.create_pipeline(
+      runtime,
+      "shadow_clear",
+      {},
+      {.path = shaders_dir + "/passes/shadow_clear.slang", .entry_points = {"vs_main", "fs_main"}});
+
+  // --- Particles ---
+  slang.create_pipeline(
+      runtime,
+      "particles",
+      {},
+      {.path = shaders_dir + "/passes/particles.slang", .entry_points = {"vs_main", "fs_main"}});
+
+  // --- Debug ---
+  slang.create_pipeline(
+      runtime,
+      "debug_draw",
+      {},
+      {.path = shaders_dir + "/passes/debug_draw.slang", .entry_points = {"vs_main", "fs_main"}});
+
   //  ── FFX ─────────────────────────────────────────────────────────────
   // slang.create_pipeline(runtime, "hiz", {}, {.path = shaders_dir + "/passes/hiz.slang", .entry_points =
   // {"cs_main"}});
@@ -259,7 +292,7 @@ auto EasyRenderPipeline::init(VkContext& vk_context) -> void {
   this->exposure_buffer = vk_context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly, sizeof(GPU::HistogramLuminance));
 }
 
-auto EasyRenderPipeline::deinit() -> void {}
+auto EasyRenderPipeline::deinit() -> void { this->wait_for_render_thread(); }
 
 auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& render_info)
     -> vuk::Value<vuk::ImageAttachment> {
@@ -268,8 +301,34 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
   auto* asset_man = App::get_asset_manager();
 
   bool rebuild_transforms = false;
+
+  // on_update doesn't run every frame (ie. while simulating in editor), keep frame data
+  // alive by moving it into the current frame buffer before the arena recycles it.
+  auto& frame_arena = memory::get_frame_arena();
+  if (this->frame_data_index != frame_arena.get_frame_index()) {
+    auto* frame_resource = frame_arena.get_resource();
+    if (frame_arena.is_alive(this->frame_data_index)) {
+      this->dirty_transforms = std::pmr::vector<GPU::TransformID>(
+          this->dirty_transforms.begin(), this->dirty_transforms.end(), frame_resource);
+      this->dirty_transform_values = std::pmr::vector<GPU::Transforms>(
+          this->dirty_transform_values.begin(), this->dirty_transform_values.end(), frame_resource);
+      this->render_queue_2d.assign(this->render_queue_2d);
+    } else {
+      this->dirty_transforms = std::pmr::vector<GPU::TransformID>(frame_resource);
+      this->dirty_transform_values = std::pmr::vector<GPU::Transforms>(frame_resource);
+      this->render_queue_2d.init();
+      rebuild_transforms = !this->published_transforms.empty();
+    }
+
+    this->frame_data_index = frame_arena.get_frame_index();
+  }
+
+  // Only holds when the members were constructed on the arena, move assignment doesn't carry
+  // polymorphic allocators over and would copy every frame's data into the heap instead.
+  OX_ASSERT(this->dirty_transforms.get_allocator().resource() == frame_arena.get_resource());
+
   auto buffer_size = this->transforms_buffer ? this->transforms_buffer->size : 0;
-  if (ox::size_bytes(this->transforms) > buffer_size) {
+  if (ox::size_bytes(this->published_transforms) > buffer_size) {
     if (this->transforms_buffer->buffer != VK_NULL_HANDLE) {
       // Device wait here is important, do not remove it. Why?
       // We are using ONE transform buffer for all frames, if
@@ -280,7 +339,7 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
     }
 
     this->transforms_buffer = vk_context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
-                                                               ox::size_bytes(this->transforms));
+                                                               ox::size_bytes(this->published_transforms));
 
     rebuild_transforms = true;
   }
@@ -291,17 +350,17 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
   }
 
   if (rebuild_transforms) {
-    transforms_buffer_value = vk_context.upload_staging(this->transforms, std::move(transforms_buffer_value));
+    transforms_buffer_value = vk_context.upload_staging(this->published_transforms, std::move(transforms_buffer_value));
   } else if (!this->dirty_transforms.empty()) {
     auto transform_count = this->dirty_transforms.size();
     auto new_transforms_size_bytes = transform_count * sizeof(GPU::Transforms);
     auto upload_buffer = vk_context.alloc_transient_buffer(vuk::MemoryUsage::eCPUonly, new_transforms_size_bytes);
     auto* dst_transform_ptr = reinterpret_cast<GPU::Transforms*>(upload_buffer->mapped_ptr);
-    auto upload_offsets = std::vector<u64>(transform_count);
+    auto upload_offsets = std::pmr::vector<u64>(transform_count, frame_arena.get_resource());
 
-    for (const auto& [dirty_transform_id, offset] : std::views::zip(this->dirty_transforms, upload_offsets)) {
+    for (const auto& [dirty_transform_id, transform, offset] :
+         std::views::zip(this->dirty_transforms, this->dirty_transform_values, upload_offsets)) {
       auto index = SlotMap_decode_id(dirty_transform_id).index;
-      const auto& transform = this->transforms[index];
       std::memcpy(dst_transform_ptr, &transform, sizeof(GPU::Transforms));
       offset = index * sizeof(GPU::Transforms);
       dst_transform_ptr++;
@@ -330,8 +389,6 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
       vk_context, *this->descriptor_set_01, BindlessID::SampledImages);
   this->descriptor_set_01->commit(*vk_context.runtime);
 
-  render_queue_2d.update();
-  render_queue_2d.sort();
   auto vertex_buffer_2d = vk_context.scratch_buffer(std::span(render_queue_2d.sprite_data));
 
   const vuk::Extent3D sky_view_lut_extent = {.width = 312, .height = 192, .depth = 1};
@@ -350,6 +407,37 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
     sun_buffer = vk_context.scratch_buffer(this->sun);
   }
 
+  // Scratch buffers are host visible, the lists are read through their addresses.
+  auto light_clusters_data = this->light_clusters;
+  if (light_clusters_data.light_count != 0) {
+    light_clusters_data.lights = vk_context.scratch_buffer(std::span(this->lights))->device_address;
+    light_clusters_data.ranges = vk_context.scratch_buffer(std::span(this->light_cluster_ranges))->device_address;
+    if (!this->light_cluster_indices.empty())
+      light_clusters_data.indices = vk_context.scratch_buffer(std::span(this->light_cluster_indices))->device_address;
+  }
+  auto light_clusters_buffer = vk_context.scratch_buffer(light_clusters_data);
+
+  auto shadows_data = this->shadows;
+  if (!this->shadow_views.empty())
+    shadows_data.views = vk_context.scratch_buffer(std::span(this->shadow_views))->device_address;
+  auto shadows_buffer = vk_context.scratch_buffer(shadows_data);
+
+  // Cached views keep their depth across frames, only dirty rects are rendered again.
+  // Nothing packed yet before the first prepared frame.
+  const auto shadow_atlas_size = ox::max(this->shadow_atlas_size, shadow_atlas::MIN_RESOLUTION);
+  const auto shadow_atlas_extent = vuk::Extent3D{.width = shadow_atlas_size, .height = shadow_atlas_size, .depth = 1};
+  if (this->shadow_atlas_view.get_extent() != shadow_atlas_extent) {
+    if (this->shadow_atlas_view) {
+      this->shadow_atlas_view.destroy();
+    }
+
+    this->shadow_atlas_view.create(
+        {}, {.preset = Preset::eRTT2DUnmipped, .format = vuk::Format::eD32Sfloat, .extent = shadow_atlas_extent});
+    this->shadow_atlas_view.set_name("shadow_atlas");
+    this->shadow_atlas_access = vuk::eNone;
+  }
+  auto shadow_atlas_attachment = this->shadow_atlas_view.acquire("shadow_atlas", this->shadow_atlas_access);
+
   const auto final_attachment_ia = vuk::ImageAttachment{
       .usage = vuk::ImageUsageFlagBits::eSampled | vuk::ImageUsageFlagBits::eColorAttachment,
       .extent = render_info.extent,
@@ -386,38 +474,40 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
   const auto debug_view = static_cast<GPU::DebugView>(RendererCVar::cvar_debug_view.get());
   const f32 debug_heatmap_scale = 5.0;
   const auto debugging = debug_view != GPU::DebugView::None;
+  const auto shading = !debugging && atmosphere.has_value() && sun.has_value();
 
   // --- 3D Pass ---
-  if (!this->gpu_meshes.empty() && !this->gpu_meshlet_instances.empty()) {
+  if (this->instances && !this->instances->gpu_meshes.empty() && !this->instances->gpu_meshlet_instances.empty()) {
+    const auto& instances = *this->instances;
     const auto cull_flags = GPU::CullFlags::All; // TODO: Configurable
 
     buffer_size = this->meshes_buffer ? this->meshes_buffer->size : 0;
-    if (ox::size_bytes(this->gpu_meshes) > buffer_size) {
+    if (ox::size_bytes(instances.gpu_meshes) > buffer_size) {
       if (this->meshes_buffer->buffer != VK_NULL_HANDLE) {
         vk_context.wait();
         this->meshes_buffer.reset();
       }
 
       this->meshes_buffer = vk_context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
-                                                             ox::size_bytes(this->gpu_meshes));
+                                                             ox::size_bytes(instances.gpu_meshes));
     }
 
     buffer_size = this->meshlet_instances_buffer ? this->meshlet_instances_buffer->size : 0;
-    if (ox::size_bytes(this->gpu_meshlet_instances) > buffer_size) {
+    if (ox::size_bytes(instances.gpu_meshlet_instances) > buffer_size) {
       if (this->meshlet_instances_buffer->buffer != VK_NULL_HANDLE) {
         vk_context.wait();
         this->meshlet_instances_buffer.reset();
       }
 
       this->meshlet_instances_buffer = vk_context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly,
-                                                                        ox::size_bytes(this->gpu_meshlet_instances));
+                                                                        ox::size_bytes(instances.gpu_meshlet_instances));
     }
 
     vuk::Value<vuk::Buffer> meshes_buffer_value;
     vuk::Value<vuk::Buffer> meshlet_instances_buffer_value;
     if (this->meshes_dirty) {
-      meshes_buffer_value = vk_context.upload_staging(std::span(this->gpu_meshes), *this->meshes_buffer);
-      meshlet_instances_buffer_value = vk_context.upload_staging(std::span(this->gpu_meshlet_instances),
+      meshes_buffer_value = vk_context.upload_staging(std::span(instances.gpu_meshes), *this->meshes_buffer);
+      meshlet_instances_buffer_value = vk_context.upload_staging(std::span(instances.gpu_meshlet_instances),
                                                                  *this->meshlet_instances_buffer);
       this->meshes_dirty = false;
     } else {
@@ -426,6 +516,95 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
           "meshlet_instances_buffer", *this->meshlet_instances_buffer, vuk::Access::eNone);
     }
 
+    // --- Shadow Atlas ---
+    // Only when the atlas is sampled below, otherwise the pass would be dropped from the
+    // graph and the rects it was supposed to refresh would be left stale.
+    if (shading && !this->shadow_dirty_views.empty()) {
+      struct DirtyView {
+        u32 view_index = 0;
+        vuk::Rect2D rect = {};
+        // Range of the view's casters in the meshlet list.
+        glm::uvec2 meshlets = {};
+      };
+
+      auto dirty_views = std::vector<DirtyView>();
+      for (const auto& [view_index, range] : std::views::zip(this->shadow_dirty_views, this->shadow_dirty_ranges)) {
+        if (view_index >= this->shadow_views.size())
+          continue;
+
+        const auto& rect = this->shadow_views[view_index].atlas_rect;
+        dirty_views.push_back({
+            .view_index = view_index,
+            .rect = vuk::Rect2D::absolute(static_cast<i32>(rect.x),
+                                          static_cast<i32>(rect.y),
+                                          static_cast<u32>(rect.z),
+                                          static_cast<u32>(rect.w)),
+            .meshlets = range,
+        });
+      }
+
+      // Views without casters in them are only cleared.
+      auto shadow_meshlets_buffer = this->shadow_draw_meshlets.empty()
+                                        ? vk_context.scratch_buffer(0_u32)
+                                        : vk_context.scratch_buffer(std::span(this->shadow_draw_meshlets));
+      auto shadow_views_buffer = vk_context.scratch_buffer(std::span(this->shadow_views));
+      this->shadow_dirty_views.clear();
+      this->shadow_dirty_ranges.clear();
+      this->shadow_draw_meshlets.clear();
+
+      std::tie(shadow_atlas_attachment, meshlet_instances_buffer_value, transforms_buffer_value, meshes_buffer_value) =
+          vuk::make_pass( //
+              "shadow atlas",
+              [dirty_views = std::move(dirty_views)](vuk::CommandBuffer& cmd_list,
+                                                     VUK_IA(vuk::eDepthStencilRW) atlas,
+                                                     VUK_BA(vuk::eVertexRead) meshlet_indices,
+                                                     VUK_BA(vuk::eVertexRead) meshlet_instances,
+                                                     VUK_BA(vuk::eVertexRead) transforms_,
+                                                     VUK_BA(vuk::eVertexRead) meshes,
+                                                     VUK_BA(vuk::eVertexRead) views) {
+                for (const auto& view : dirty_views) {
+                  cmd_list //
+                      .bind_graphics_pipeline("shadow_clear")
+                      .set_rasterization({})
+                      .set_depth_stencil({.depthTestEnable = true,
+                                          .depthWriteEnable = true,
+                                          .depthCompareOp = vuk::CompareOp::eAlways})
+                      .set_dynamic_state(vuk::DynamicStateFlagBits::eViewport |
+                                         vuk::DynamicStateFlagBits::eScissor)
+                      .set_viewport(0, view.rect)
+                      .set_scissor(0, view.rect)
+                      .draw(3, 1, 0, 0);
+
+                  if (view.meshlets.y == 0)
+                    continue;
+
+                  // No face culling, single sided geometry still has to cast.
+                  cmd_list //
+                      .bind_graphics_pipeline("shadow_depth")
+                      .set_rasterization({})
+                      .set_depth_stencil({.depthTestEnable = true,
+                                          .depthWriteEnable = true,
+                                          .depthCompareOp = vuk::CompareOp::eGreaterOrEqual})
+                      .push_constants(vuk::ShaderStageFlagBits::eVertex,
+                                      0,
+                                      PushConstants(meshlet_indices->device_address + view.meshlets.x * sizeof(u32),
+                                                    meshlet_instances->device_address,
+                                                    meshes->device_address,
+                                                    transforms_->device_address,
+                                                    views->device_address,
+                                                    view.view_index))
+                      .draw(view.meshlets.y * Mesh::MAX_MESHLET_PRIMITIVES * 3, 1, 0, 0);
+                }
+
+                return std::make_tuple(atlas, meshlet_instances, transforms_, meshes);
+              })(std::move(shadow_atlas_attachment),
+                 std::move(shadow_meshlets_buffer),
+                 std::move(meshlet_instances_buffer_value),
+                 std::move(transforms_buffer_value),
+                 std::move(meshes_buffer_value),
+                 std::move(shadow_views_buffer));
+    }
+
     const auto square_extent = vuk::Extent3D{
         .width = std::bit_floor(render_info.extent.width),
         .height = std::bit_floor(render_info.extent.height),
@@ -442,11 +621,14 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
     }
     auto hiz_attachment = this->hiz_view.acquire("hiz", vuk::eNone);
 
-    const auto meshlet_instance_count = static_cast<u32>(this->gpu_meshlet_instances.size());
+    const auto meshlet_instance_count = static_cast<u32>(instances.gpu_meshlet_instances.size());
+    // Only meshlets of the selected LODs of visible instances can pass the GPU culling.
+    const auto visible_meshlet_count = ox::max(this->visible_meshlet_count, 1_u32);
 
     auto cull_triangles_cmd_buffer = vk_context.scratch_buffer<vuk::DispatchIndirectCommand>({.x = 0, .y = 1, .z = 1});
     auto visible_meshlet_instances_indices_buffer = vk_context.alloc_transient_buffer(
-        vuk::MemoryUsage::eGPUonly, meshlet_instance_count * sizeof(u32));
+        vuk::MemoryUsage::eGPUonly, visible_meshlet_count * sizeof(u32));
+    auto primitive_instance_lods_buffer = vk_context.scratch_buffer(std::span(this->primitive_instance_lods));
 
     std::tie(cull_triangles_cmd_buffer,
              visible_meshlet_instances_indices_buffer,
@@ -459,6 +641,7 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
                                  VUK_BA(vuk::eComputeWrite) cull_triangles_cmd,
                                  VUK_BA(vuk::eComputeWrite) visible_meshlet_instances_indices,
                                  VUK_BA(vuk::eComputeRead) meshlet_instances,
+                                 VUK_BA(vuk::eComputeRead) primitive_instance_lods,
                                  VUK_BA(vuk::eComputeRead) transforms_,
                                  VUK_BA(vuk::eComputeRead) meshes,
                                  VUK_BA(vuk::eComputeRead) camera) {
@@ -469,6 +652,7 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
                               PushConstants(cull_triangles_cmd->device_address,
                                             visible_meshlet_instances_indices->device_address,
                                             meshlet_instances->device_address,
+                                            primitive_instance_lods->device_address,
                                             transforms_->device_address,
                                             meshes->device_address,
                                             camera->device_address,
@@ -480,13 +664,14 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
         })(std::move(cull_triangles_cmd_buffer),
            std::move(visible_meshlet_instances_indices_buffer),
            std::move(meshlet_instances_buffer_value),
+           std::move(primitive_instance_lods_buffer),
            std::move(transforms_buffer_value),
            std::move(meshes_buffer_value),
            std::move(camera_buffer));
 
     auto draw_command_buffer = vk_context.scratch_buffer<vuk::DrawIndexedIndirectCommand>({.instanceCount = 1});
     auto reordered_indices_buffer = vk_context.alloc_transient_buffer(
-        vuk::MemoryUsage::eGPUonly, meshlet_instance_count * Mesh::MAX_MESHLET_PRIMITIVES * 3 * sizeof(u32));
+        vuk::MemoryUsage::eGPUonly, visible_meshlet_count * Mesh::MAX_MESHLET_PRIMITIVES * 3 * sizeof(u32));
 
     std::tie(hiz_attachment,
              draw_command_buffer,
@@ -793,8 +978,9 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
            std::move(material_buffer),
            std::move(visbuffer_data_attachment));
 
-    if (!debugging && atmosphere.has_value() && sun.has_value()) {
+    if (shading) {
       // --- BRDF ---
+      this->shadow_atlas_access = vuk::eFragmentSampled;
       auto brdf_pass = vuk::make_pass(
           "brdf",
           []( //
@@ -803,6 +989,9 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
               VUK_BA(vuk::eFragmentRead) atmosphere_,
               VUK_BA(vuk::eFragmentRead) sun_,
               VUK_BA(vuk::eFragmentRead) camera,
+              VUK_BA(vuk::eFragmentRead) light_clusters_,
+              VUK_BA(vuk::eFragmentRead) shadows_,
+              VUK_IA(vuk::eFragmentSampled) shadow_atlas,
               VUK_IA(vuk::eFragmentSampled) sky_transmittance_lut,
               VUK_IA(vuk::eFragmentSampled) sky_multiscatter_lut,
               VUK_IA(vuk::eFragmentSampled) depth,
@@ -841,10 +1030,15 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
                 .bind_image(0, 6, normal)
                 .bind_image(0, 7, emissive)
                 .bind_image(0, 8, metallic_roughness_occlusion)
+                .bind_image(0, 9, shadow_atlas)
                 .push_constants(
                     vuk::ShaderStageFlagBits::eFragment,
                     0,
-                    PushConstants(atmosphere_->device_address, sun_->device_address, camera->device_address))
+                    PushConstants(atmosphere_->device_address,
+                                  sun_->device_address,
+                                  camera->device_address,
+                                  light_clusters_->device_address,
+                                  shadows_->device_address))
                 .draw(3, 1, 0, 0);
             return std::make_tuple(dst, atmosphere_, sun_, camera, sky_transmittance_lut, sky_multiscatter_lut, depth);
           });
@@ -859,6 +1053,9 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
                                              std::move(atmosphere_buffer),
                                              std::move(sun_buffer),
                                              std::move(camera_buffer),
+                                             std::move(light_clusters_buffer),
+                                             std::move(shadows_buffer),
+                                             std::move(shadow_atlas_attachment),
                                              std::move(sky_transmittance_lut_attachment),
                                              std::move(sky_multiscatter_lut_attachment),
                                              std::move(depth_attachment),
@@ -1120,6 +1317,46 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
            std::move(depth_attachment));
   }
 
+  // --- Particles ---
+  if (!this->particles.empty() && !debugging) {
+    const auto particles_address = vk_context.scratch_buffer(std::span(this->particles))->device_address;
+
+    std::tie(final_attachment, depth_attachment, camera_buffer) = vuk::make_pass(
+        "particles",
+        [particles_address, particle_count = static_cast<u32>(this->particles.size())](
+            vuk::CommandBuffer& cmd_list,
+            VUK_IA(vuk::eColorWrite) dst,
+            VUK_IA(vuk::eDepthStencilRead) depth,
+            VUK_BA(vuk::eVertexRead) camera) {
+          // Additive, so particles don't need to be sorted.
+          vuk::PipelineColorBlendAttachmentState blend_info = {
+              .blendEnable = true,
+              .srcColorBlendFactor = vuk::BlendFactor::eSrcAlpha,
+              .dstColorBlendFactor = vuk::BlendFactor::eOne,
+              .colorBlendOp = vuk::BlendOp::eAdd,
+              .srcAlphaBlendFactor = vuk::BlendFactor::eZero,
+              .dstAlphaBlendFactor = vuk::BlendFactor::eOne,
+              .alphaBlendOp = vuk::BlendOp::eAdd,
+          };
+
+          cmd_list //
+              .bind_graphics_pipeline("particles")
+              .set_rasterization({.cullMode = vuk::CullModeFlagBits::eNone})
+              .set_depth_stencil({.depthTestEnable = true,
+                                  .depthWriteEnable = false,
+                                  .depthCompareOp = vuk::CompareOp::eGreaterOrEqual})
+              .set_color_blend(dst, blend_info)
+              .set_dynamic_state(vuk::DynamicStateFlagBits::eViewport | vuk::DynamicStateFlagBits::eScissor)
+              .set_viewport(0, vuk::Rect2D::framebuffer())
+              .set_scissor(0, vuk::Rect2D::framebuffer())
+              .push_constants(
+                  vuk::ShaderStageFlagBits::eVertex, 0, PushConstants(particles_address, camera->device_address))
+              .draw(6, particle_count, 0, 0);
+
+          return std::make_tuple(dst, depth, camera);
+        })(std::move(final_attachment), std::move(depth_attachment), std::move(camera_buffer));
+  }
+
   if (!debugging) {
     PassConfig pass_config_flags = PassConfig::None;
     if (static_cast<bool>(RendererCVar::cvar_bloom_enable.get()))
@@ -1305,16 +1542,156 @@ auto EasyRenderPipeline::on_render(VkContext& vk_context, const RenderInfo& rend
            std::move(exposure_buffer_value));
   }
 
+  // --- Debug Draw ---
+  if (static_cast<bool>(RendererCVar::cvar_enable_debug_renderer.get()) && !this->debug_draw.batches.empty() &&
+      !this->debug_draw.geometry_vertices.empty()) {
+    buffer_size = this->debug_geometry_buffer ? this->debug_geometry_buffer->size : 0;
+    if (ox::size_bytes(this->debug_draw.geometry_vertices) > buffer_size) {
+      if (this->debug_geometry_buffer->buffer != VK_NULL_HANDLE) {
+        vk_context.wait();
+        this->debug_geometry_buffer.reset();
+      }
+
+      this->debug_geometry_buffer = vk_context.allocate_buffer_super(
+          vuk::MemoryUsage::eGPUonly, ox::size_bytes(this->debug_draw.geometry_vertices));
+      this->debug_geometry_dirty = true;
+    }
+
+    auto debug_geometry_buffer_value = vuk::Value<vuk::Buffer>{};
+    if (this->debug_geometry_dirty) {
+      debug_geometry_buffer_value = vk_context.upload_staging(std::span(this->debug_draw.geometry_vertices),
+                                                              *this->debug_geometry_buffer);
+      this->debug_geometry_dirty = false;
+    } else {
+      debug_geometry_buffer_value = vuk::acquire_buf(
+          "debug_geometry_buffer", *this->debug_geometry_buffer, vuk::Access::eNone);
+    }
+
+    // Immediate vertices and instances change every frame and are read from scratch memory.
+    const auto vertices_address = this->debug_draw.vertices.empty()
+                                      ? 0_u64
+                                      : vk_context.scratch_buffer(std::span(this->debug_draw.vertices))->device_address;
+    const auto instances_address = vk_context.scratch_buffer(std::span(this->debug_draw.instances))->device_address;
+
+    std::tie(result_attachment, depth_attachment, camera_buffer) = vuk::make_pass(
+        "debug draw",
+        [batches = this->debug_draw.batches, vertices_address, instances_address](
+            vuk::CommandBuffer& cmd_list,
+            VUK_IA(vuk::eColorWrite) dst,
+            VUK_IA(vuk::eDepthStencilRead) depth,
+            VUK_BA(vuk::eVertexRead) camera,
+            VUK_BA(vuk::eVertexRead) geometry_vertices) {
+          for (const auto& batch : batches) {
+            const auto topology = batch.topology == DebugRenderer::Topology::Lines
+                                      ? vuk::PrimitiveTopology::eLineList
+                                      : vuk::PrimitiveTopology::eTriangleList;
+            cmd_list //
+                .bind_graphics_pipeline("debug_draw")
+                .set_primitive_topology(topology)
+                .set_rasterization({.cullMode = vuk::CullModeFlagBits::eNone})
+                .set_depth_stencil({.depthTestEnable = batch.depth_tested,
+                                    .depthWriteEnable = false,
+                                    .depthCompareOp = vuk::CompareOp::eGreaterOrEqual})
+                .set_color_blend(dst, vuk::BlendPreset::eAlphaBlend)
+                .set_dynamic_state(vuk::DynamicStateFlagBits::eViewport | vuk::DynamicStateFlagBits::eScissor)
+                .set_viewport(0, vuk::Rect2D::framebuffer())
+                .set_scissor(0, vuk::Rect2D::framebuffer())
+                .push_constants(vuk::ShaderStageFlagBits::eVertex,
+                                0,
+                                PushConstants(batch.retained ? geometry_vertices->device_address : vertices_address,
+                                              instances_address,
+                                              camera->device_address,
+                                              batch.first_vertex,
+                                              batch.first_instance))
+                .draw(batch.vertex_count, batch.instance_count, 0, 0);
+          }
+
+          return std::make_tuple(dst, depth, camera);
+        })(std::move(result_attachment),
+           std::move(depth_attachment),
+           std::move(camera_buffer),
+           std::move(debug_geometry_buffer_value));
+  }
+
   return result_attachment;
 }
 
 auto EasyRenderPipeline::on_update(ox::Scene* scene) -> void {
   ZoneScoped;
 
+  this->transforms = scene->transforms.slots_unsafe();
+
+  this->wait_for_render_thread();
+
+  auto& packet = this->frame_packets[this->frame_packet_index];
+  this->extract(scene, packet);
+
+  if (!static_cast<bool>(RendererCVar::cvar_pipelined_extract.get())) {
+    if (this->frame_packet_in_flight) {
+      // Pipelining was just turned off, the packet prepared last frame was never published.
+      // Publishing replaces the dirty transforms, so this packet carries the ones it doesn't
+      // overwrite itself.
+      auto& pending = this->frame_packets[this->frame_packet_index ^ 1];
+      if (this->published_packet_index != (this->frame_packet_index ^ 1))
+        this->publish(pending);
+
+      auto current_ids = packet.dirty_transforms;
+      std::ranges::sort(current_ids);
+      for (const auto& [transform_id, value] :
+           std::views::zip(pending.dirty_transforms, pending.dirty_transform_values)) {
+        if (!std::ranges::binary_search(current_ids, transform_id)) {
+          packet.dirty_transforms.push_back(transform_id);
+          packet.dirty_transform_values.push_back(value);
+        }
+      }
+
+      this->frame_packet_in_flight = false;
+    }
+
+    this->prepare(packet);
+    this->publish(packet);
+    return;
+  }
+
+  // Frame N renders the packet prepared during frame N - 1 while its own packet is
+  // prepared on the render thread. Costs one frame of latency, simulation is untouched.
+  if (this->frame_packet_in_flight) {
+    // The first pipelined frame already published its packet itself.
+    if (this->published_packet_index != (this->frame_packet_index ^ 1))
+      this->publish(this->frame_packets[this->frame_packet_index ^ 1]);
+    ThreadManager::get()->render_thread.queue_job([this, &packet] {
+      // Culling and occlusion are split over the task scheduler from here.
+      App::get_system<TaskScheduler>(EngineSystems::TaskScheduler)->register_current_thread();
+      this->prepare(packet);
+    });
+  } else {
+    // Nothing was prepared last frame, don't present an empty one.
+    this->prepare(packet);
+    this->publish(packet);
+  }
+
+  this->frame_packet_in_flight = true;
+  this->frame_packet_index ^= 1;
+}
+
+auto EasyRenderPipeline::extract(Scene* scene, FramePacket& packet) -> void {
+  ZoneScoped;
+
   auto* asset_man = App::get_asset_manager();
 
-  this->transforms = scene->transforms.slots_unsafe();
-  this->dirty_transforms = scene->dirty_transforms;
+  packet.dirty_transforms.assign(scene->dirty_transforms.begin(), scene->dirty_transforms.end());
+  packet.dirty_transform_values.resize(packet.dirty_transforms.size());
+  for (const auto& [transform_id, value] : std::views::zip(packet.dirty_transforms, packet.dirty_transform_values)) {
+    value = this->transforms[SlotMap_decode_id(transform_id).index];
+  }
+
+  // prepare keeps its own copy, the scene's transforms belong to the next frame by the time
+  // it runs. Added slots and reused ones of new instances are only covered by a full copy.
+  packet.transforms.clear();
+  if (scene->meshes_dirty || this->transforms.size() != this->extracted_transform_count) {
+    packet.transforms.assign(this->transforms.begin(), this->transforms.end());
+    this->extracted_transform_count = this->transforms.size();
+  }
 
   CameraComponent current_camera = {};
   CameraComponent frozen_camera = {};
@@ -1340,125 +1717,218 @@ auto EasyRenderPipeline::on_update(ox::Scene* scene) -> void {
         current_camera = c;
       });
 
-  CameraComponent cam = freeze_culling ? frozen_camera : current_camera;
-
-  this->camera_data = GPU::CameraData{
-      .position = glm::vec4(cam.position, 0.0f),
-      .projection = cam.get_projection_matrix(),
-      .inv_projection = cam.get_inv_projection_matrix(),
-      .view = cam.get_view_matrix(),
-      .inv_view = cam.get_inv_view_matrix(),
-      .projection_view = cam.get_projection_matrix() * cam.get_view_matrix(),
-      .inv_projection_view = cam.get_inverse_projection_view(),
-      .previous_projection = cam.get_projection_matrix(),
-      .previous_inv_projection = cam.get_inv_projection_matrix(),
-      .previous_view = cam.get_view_matrix(),
-      .previous_inv_view = cam.get_inv_view_matrix(),
-      .previous_projection_view = cam.get_projection_matrix() * cam.get_view_matrix(),
-      .previous_inv_projection_view = cam.get_inverse_projection_view(),
-      .temporalaa_jitter = cam.jitter,
-      .temporalaa_jitter_prev = cam.jitter_prev,
-      .near_clip = cam.near_clip,
-      .far_clip = cam.far_clip,
-      .fov = cam.fov,
-      .output_index = 0,
+  packet.camera = freeze_culling ? frozen_camera : current_camera;
+  const auto& cam = packet.camera;
+
+  packet.settings = PrepareSettings{
+      .clustered_lights = static_cast<bool>(RendererCVar::cvar_clustered_lights.get()),
+      .cpu_frustum_culling = static_cast<bool>(RendererCVar::cvar_cpu_frustum_culling.get()),
+      .occlusion_culling = static_cast<bool>(RendererCVar::cvar_occlusion_culling.get()),
+      .occlusion_width = static_cast<u32>(RendererCVar::cvar_occlusion_width.get()),
+      .occlusion_height = static_cast<u32>(RendererCVar::cvar_occlusion_height.get()),
+      .lod_enable = static_cast<bool>(RendererCVar::cvar_lod_enable.get()),
+      .lod_error_pixels = RendererCVar::cvar_lod_error_pixels.get(),
+      .lod_hysteresis = glm::clamp(RendererCVar::cvar_lod_hysteresis.get(), 0.0f, 1.0f),
+      .viewport_height = static_cast<f32>(this->camera_data.resolution.y),
+      .shadows = static_cast<bool>(RendererCVar::cvar_shadows.get()),
+      .shadow_distance = RendererCVar::cvar_shadow_distance.get(),
+      .shadow_depth_bias = RendererCVar::cvar_shadow_depth_bias.get(),
+      .shadow_normal_bias = RendererCVar::cvar_shadow_normal_bias.get(),
+      .shadow_hysteresis = glm::clamp(RendererCVar::cvar_shadow_hysteresis.get(), 0.0f, 1.0f),
+      .shadow_max_lights = static_cast<usize>(ox::max(RendererCVar::cvar_shadow_max_lights.get(), 0)),
+      .shadow_atlas_size = std::bit_floor(
+          static_cast<u32>(glm::clamp(RendererCVar::cvar_shadow_atlas_size.get(), 512, 16384))),
   };
 
-  math::calc_frustum_planes(camera_data.projection_view, camera_data.frustum_planes);
-
   option<GPU::Atmosphere> atmosphere_data = nullopt;
   option<GPU::Sun> sun_data = nullopt;
+  packet.lights.clear();
+  packet.shadow_casters.clear();
+  packet.sun_shadow_caster.reset();
 
   scene->world
       .query_builder<const TransformComponent, const LightComponent>() //
       .build()
-      .each(
-          [&sun_data, &atmosphere_data, cam](flecs::entity e, const TransformComponent& tc, const LightComponent& lc) {
-            if (lc.type == LightComponent::LightType::Directional) {
-              auto& sund = sun_data.emplace();
-              sund.direction.x = glm::cos(tc.rotation.x) * glm::sin(tc.rotation.y);
-              sund.direction.y = glm::sin(tc.rotation.x) * glm::sin(tc.rotation.y);
-              sund.direction.z = glm::cos(tc.rotation.y);
-              sund.intensity = lc.intensity;
-            }
+      .each([&sun_data, &atmosphere_data, &packet, scene, cam](
+                flecs::entity e, const TransformComponent& tc, const LightComponent& lc) {
+        if (lc.type == LightComponent::LightType::Directional) {
+          auto& sund = sun_data.emplace();
+          sund.direction.x = glm::cos(tc.rotation.x) * glm::sin(tc.rotation.y);
+          sund.direction.y = glm::sin(tc.rotation.x) * glm::sin(tc.rotation.y);
+          sund.direction.z = glm::cos(tc.rotation.y);
+          sund.intensity = lc.intensity;
+          if (lc.cast_shadows)
+            packet.sun_shadow_caster = ShadowCaster{.entity = e.id(), .resolution = lc.shadow_map_res};
+          else
+            packet.sun_shadow_caster.reset();
+        } else if (lc.range > 0.0f && lc.intensity > 0.0f) {
+          auto world = glm::mat4(1.0f);
+          if (const auto transform_id = scene->get_entity_transform_id(e))
+            world = scene->get_entity_transform(*transform_id)->world;
+
+          auto& light = packet.lights.emplace_back();
+          light.position = glm::vec3(world[3]);
+          light.range = lc.range;
+          light.color = lc.color * lc.intensity;
+          if (lc.type == LightComponent::LightType::Spot) {
+            const auto cos_outer = glm::cos(lc.outer_cone_angle);
+            const auto cos_inner = glm::cos(ox::min(lc.inner_cone_angle, lc.outer_cone_angle));
+            light.type = GPU::LightType::Spot;
+            light.direction = glm::normalize(-glm::vec3(world[2]));
+            light.spot_scale = 1.0f / ox::max(cos_inner - cos_outer, 1e-4f);
+            light.spot_offset = -cos_outer * light.spot_scale;
+          }
 
-            if (e.has<AtmosphereComponent>()) {
-              const auto& atmos_info = *e.get<AtmosphereComponent>();
-              auto& atmos = atmosphere_data.emplace();
-              atmos.rayleigh_scatter = atmos_info.rayleigh_scattering * 1e-3f;
-              atmos.rayleigh_density = atmos_info.rayleigh_density;
-              atmos.mie_scatter = atmos_info.mie_scattering * 1e-3f;
-              atmos.mie_density = atmos_info.mie_density;
-              atmos.mie_extinction = atmos_info.mie_extinction * 1e-3f;
-              atmos.mie_asymmetry = atmos_info.mie_asymmetry;
-              atmos.ozone_absorption = atmos_info.ozone_absorption * 1e-3f;
-              atmos.ozone_height = atmos_info.ozone_height;
-              atmos.ozone_thickness = atmos_info.ozone_thickness;
-              atmos.aerial_perspective_start_km = atmos_info.aerial_perspective_start_km;
-
-              f32 eye_altitude = cam.position.y * GPU::CAMERA_SCALE_UNIT;
-              eye_altitude += atmos.planet_radius + GPU::PLANET_RADIUS_OFFSET;
-              atmos.eye_position = glm::vec3(0.0f, eye_altitude, 0.0f);
-            }
-          });
+          if (lc.cast_shadows) {
+            packet.shadow_casters.push_back({
+                .entity = e.id(),
+                .light_index = static_cast<u32>(packet.lights.size() - 1),
+                .resolution = lc.shadow_map_res,
+                .outer_cone_angle = lc.outer_cone_angle,
+            });
+          }
+        }
 
-  this->atmosphere = atmosphere_data;
-  this->sun = sun_data;
+        if (e.has<AtmosphereComponent>()) {
+          const auto& atmos_info = *e.get<AtmosphereComponent>();
+          auto& atmos = atmosphere_data.emplace();
+          atmos.rayleigh_scatter = atmos_info.rayleigh_scattering * 1e-3f;
+          atmos.rayleigh_density = atmos_info.rayleigh_density;
+          atmos.mie_scatter = atmos_info.mie_scattering * 1e-3f;
+          atmos.mie_density = atmos_info.mie_density;
+          atmos.mie_extinction = atmos_info.mie_extinction * 1e-3f;
+          atmos.mie_asymmetry = atmos_info.mie_asymmetry;
+          atmos.ozone_absorption = atmos_info.ozone_absorption * 1e-3f;
+          atmos.ozone_height = atmos_info.ozone_height;
+          atmos.ozone_thickness = atmos_info.ozone_thickness;
+          atmos.aerial_perspective_start_km = atmos_info.aerial_perspective_start_km;
+
+          f32 eye_altitude = cam.position.y * GPU::CAMERA_SCALE_UNIT;
+          eye_altitude += atmos.planet_radius + GPU::PLANET_RADIUS_OFFSET;
+          atmos.eye_position = glm::vec3(0.0f, eye_altitude, 0.0f);
+        }
+      });
 
-  if (scene->meshes_dirty) {
-    this->meshes_dirty = true;
+  packet.atmosphere = atmosphere_data;
+  packet.sun = sun_data;
 
-    this->gpu_meshes.clear();
-    this->gpu_meshlet_instances.clear();
+  // Mesh instances only reference transform slots and need the asset manager, they are
+  // rebuilt here and only when meshes are added or removed. Every LOD gets its meshlets
+  // listed once, so culling and LOD changes don't touch the uploaded lists.
+  if (scene->meshes_dirty) {
+    ZoneNamedN(z, "Build Mesh Instances", true);
 
+    auto instances = std::make_shared<MeshInstances>();
     for (const auto& [rendering_mesh, transform_ids] : scene->rendering_meshes_map) {
       auto* model = asset_man->get_mesh(rendering_mesh.first);
       const auto& mesh = model->meshes[rendering_mesh.second];
 
       // Per mesh info
-      auto mesh_offset = static_cast<u32>(this->gpu_meshes.size());
-      auto& gpu_mesh = this->gpu_meshes.emplace_back();
+      auto mesh_offset = static_cast<u32>(instances->gpu_meshes.size());
+      auto& gpu_mesh = instances->gpu_meshes.emplace_back();
       gpu_mesh.indices = model->indices->device_address;
-      gpu_mesh.vertex_positions = model->vertex_positions->device_address;
-      gpu_mesh.vertex_normals = model->vertex_normals->device_address;
-      gpu_mesh.texture_coords = model->texture_coords->device_address;
+      if (model->quantized_vertices) {
+        gpu_mesh.quantized_positions = model->vertex_positions->device_address;
+        gpu_mesh.quantized_normals = model->vertex_normals->device_address;
+        gpu_mesh.quantized_texture_coords = model->texture_coords->device_address;
+        gpu_mesh.position_min = mesh.position_bounds.min;
+        gpu_mesh.position_extent = mesh.position_bounds.extent;
+      } else {
+        gpu_mesh.vertex_positions = model->vertex_positions->device_address;
+        gpu_mesh.vertex_normals = model->vertex_normals->device_address;
+        gpu_mesh.texture_coords = model->texture_coords->device_address;
+      }
       gpu_mesh.local_triangle_indices = model->local_triangle_indices->device_address;
       gpu_mesh.meshlet_bounds = model->meshlet_bounds->device_address;
       gpu_mesh.meshlets = model->meshlets->device_address;
 
       // Instancing
       for (const auto transform_id : transform_ids) {
+        const auto mesh_instance = static_cast<u32>(instances->transform_indices.size());
+        const auto transform_index = SlotMap_decode_id(transform_id).index;
+        instances->local_bounds.push_back(mesh.bounds_center, mesh.bounds_extent);
+        instances->bounds_radius.push_back(mesh.bounds_radius);
+        instances->transform_indices.push_back(transform_index);
+        instances->first_primitives.push_back(static_cast<u32>(instances->primitive_instances.size()));
+        instances->first_shadow_meshlets.push_back(static_cast<u32>(instances->shadow_meshlet_indices.size()));
+
         for (const auto primitive_index : mesh.primitive_indices) {
-          auto& primitive = model->primitives[primitive_index];
-          for (u32 meshlet_index = 0; meshlet_index < primitive.meshlet_count; meshlet_index++) {
-            auto& meshlet_instance = gpu_meshlet_instances.emplace_back();
-            meshlet_instance.mesh_index = mesh_offset;
-            meshlet_instance.material_index = primitive.material_index;
-            meshlet_instance.transform_index = SlotMap_decode_id(transform_id).index;
-            meshlet_instance.meshlet_index = meshlet_index + primitive.meshlet_offset;
+          const auto& primitive = model->primitives[primitive_index];
+          const auto primitive_instance = static_cast<u32>(instances->primitive_instances.size());
+          instances->primitive_instances.push_back({
+              .mesh_instance = mesh_instance,
+              .first_lod = static_cast<u32>(instances->primitive_lods.size()),
+              .lod_count = static_cast<u32>(primitive.lods.size()),
+          });
+
+          for (u32 lod_index = 0; lod_index < primitive.lods.size(); lod_index++) {
+            const auto& lod = primitive.lods[lod_index];
+            instances->primitive_lods.push_back(lod);
+            for (u32 meshlet_index = 0; meshlet_index < lod.meshlet_count; meshlet_index++) {
+              if (lod_index == 0)
+                instances->shadow_meshlet_indices.push_back(static_cast<u32>(instances->gpu_meshlet_instances.size()));
+
+              instances->gpu_meshlet_instances.push_back({
+                  .mesh_index = mesh_offset,
+                  .material_index = primitive.material_index,
+                  .transform_index = transform_index,
+                  .meshlet_index = meshlet_index + lod.meshlet_offset,
+                  .primitive_instance_index = primitive_instance,
+                  .lod_index = lod_index,
+              });
+            }
           }
         }
       }
     }
+    instances->first_primitives.push_back(static_cast<u32>(instances->primitive_instances.size()));
+    instances->first_shadow_meshlets.push_back(static_cast<u32>(instances->shadow_meshlet_indices.size()));
 
+    this->mesh_instances = std::move(instances);
     scene->meshes_dirty = false;
   }
 
-  this->render_queue_2d.init();
+  packet.instances = this->mesh_instances;
+
+  packet.occluders.clear();
+  if (packet.settings.cpu_frustum_culling && packet.settings.occlusion_culling) {
+    scene->world
+        .query_builder<const MeshComponent>() //
+        .build()
+        .each([this, asset_man, scene, &packet](flecs::entity e, const MeshComponent& mc) {
+          if (!mc.occluder)
+            return;
+
+          const auto transform_id = scene->get_entity_transform_id(e);
+          auto* model = asset_man->get_mesh(mc.mesh_uuid);
+          if (!transform_id || !model || mc.mesh_index >= model->meshes.size())
+            return;
+
+          const auto& mesh = model->meshes[mc.mesh_index];
+          packet.occluders.push_back({
+              .positions = mesh.occluder_positions,
+              .indices = mesh.occluder_indices,
+              .world = this->transforms[SlotMap_decode_id(*transform_id).index].world,
+          });
+        });
+  }
+
+  packet.sprites.clear();
 
   scene->world
       .query_builder<const TransformComponent, const SpriteComponent>() //
       .build()
-      .each([asset_man, &scene, &cam, &rq2d = this->render_queue_2d](
+      .each([asset_man, &scene, &sprites = packet.sprites](
                 flecs::entity e, const TransformComponent& tc, const SpriteComponent& comp) {
-        const auto distance = glm::distance(glm::vec3(0.f, 0.f, cam.position.z), glm::vec3(0.f, 0.f, tc.position.z));
         if (auto* material = asset_man->get_asset(comp.material)) {
           if (auto transform_id = scene->get_entity_transform_id(e)) {
-            rq2d.add(comp,
-                     tc.position.y,
-                     SlotMap_decode_id(*transform_id).index,
-                     SlotMap_decode_id(material->material_id).index,
-                     distance);
+            sprites.push_back({
+                .transform_id = SlotMap_decode_id(*transform_id).index,
+                .material_id = SlotMap_decode_id(material->material_id).index,
+                .flags = RenderQueue2D::get_flags(comp),
+                .position_y = tc.position.y,
+                .position_z = tc.position.z,
+            });
           } else {
             OX_LOG_WARN("No registered transform for sprite entity: {}", e.name().c_str());
           }
@@ -1478,6 +1948,458 @@ auto EasyRenderPipeline::on_update(ox::Scene* scene) -> void {
         i.ev100_bias = c.ev100_bias;
       });
 
-  this->histogram_info = hist_info;
+  packet.histogram_info = hist_info;
+
+  scene->particle_system.collect(packet.particles);
+
+  // Last, so draws made while extracting (i.e. the frozen frustum) are part of this frame.
+  if (static_cast<bool>(RendererCVar::cvar_enable_debug_renderer.get())) {
+    DebugRenderer::collect(packet.debug_draw);
+  } else {
+    DebugRenderer::reset();
+    packet.debug_draw.batches.clear();
+  }
+}
+
+auto EasyRenderPipeline::prepare(FramePacket& packet) -> void {
+  ZoneScoped;
+
+  apply_transforms(this->prepared_transforms, packet);
+
+  const auto& cam = packet.camera;
+
+  packet.camera_data = GPU::CameraData{
+      .position = glm::vec4(cam.position, 0.0f),
+      .projection = cam.get_projection_matrix(),
+      .inv_projection = cam.get_inv_projection_matrix(),
+      .view = cam.get_view_matrix(),
+      .inv_view = cam.get_inv_view_matrix(),
+      .projection_view = cam.get_projection_matrix() * cam.get_view_matrix(),
+      .inv_projection_view = cam.get_inverse_projection_view(),
+      .previous_projection = cam.get_projection_matrix(),
+      .previous_inv_projection = cam.get_inv_projection_matrix(),
+      .previous_view = cam.get_view_matrix(),
+      .previous_inv_view = cam.get_inv_view_matrix(),
+      .previous_projection_view = cam.get_projection_matrix() * cam.get_view_matrix(),
+      .previous_inv_projection_view = cam.get_inverse_projection_view(),
+      .temporalaa_jitter = cam.jitter,
+      .temporalaa_jitter_prev = cam.jitter_prev,
+      .near_clip = cam.near_clip,
+      .far_clip = cam.far_clip,
+      .fov = cam.fov,
+      .output_index = 0,
+  };
+
+  math::calc_frustum_planes(packet.camera_data.projection_view, packet.camera_data.frustum_planes);
+
+  {
+    ZoneNamedN(z, "Bin Lights", true);
+
+    const auto view = cam.get_view_matrix();
+    const auto projection = cam.get_projection_matrix();
+    auto grid = LightClusterGrid{
+        .near_clip = cam.near_clip,
+        .far_clip = cam.far_clip,
+        .projection_scale = {projection[0][0], projection[1][1]},
+        .orthographic = cam.projection == CameraComponent::Projection::Orthographic,
+    };
+
+    this->light_spheres.clear();
+    if (packet.settings.clustered_lights) {
+      for (const auto& light : packet.lights) {
+        // Spot lights are binned with the sphere of their range, the cone is left to the shader.
+        this->light_spheres.push_back(glm::vec3(view * glm::vec4(light.position, 1.0f)), light.range);
+      }
+    } else {
+      packet.lights.clear();
+    }
+
+    light_clustering::bin_lights_parallel(grid, this->light_spheres, this->light_cluster_list);
+
+    packet.light_cluster_ranges.assign(this->light_cluster_list.ranges.begin(), this->light_cluster_list.ranges.end());
+    packet.light_cluster_indices.assign(this->light_cluster_list.indices.begin(),
+                                        this->light_cluster_list.indices.end());
+    packet.light_clusters = grid.to_gpu();
+    packet.light_clusters.light_count = static_cast<u32>(packet.lights.size());
+  }
+
+  const auto instances_changed = packet.instances != this->prepared_instances;
+  if (instances_changed) {
+    this->prepared_instances = packet.instances;
+    // Nothing to keep a hysteresis band against yet.
+    this->selected_lods.assign(packet.instances ? packet.instances->primitive_instances.size() : 0,
+                               GPU::CULLED_LOD);
+  }
+
+  this->prepare_instances(packet);
+  this->prepare_shadows(packet, instances_changed);
+
+  auto& rq2d = packet.render_queue_2d;
+  rq2d.clear();
+  for (const auto& sprite : packet.sprites) {
+    const auto distance = glm::distance(glm::vec3(0.f, 0.f, cam.position.z), glm::vec3(0.f, 0.f, sprite.position_z));
+    rq2d.add(sprite.flags, sprite.position_y, sprite.transform_id, sprite.material_id, distance);
+  }
+
+  rq2d.update();
+  rq2d.sort();
+}
+
+auto EasyRenderPipeline::prepare_instances(FramePacket& packet) -> void {
+  ZoneScoped;
+
+  packet.primitive_instance_lods.clear();
+  packet.visible_meshlet_count = 0;
+  if (!packet.instances)
+    return;
+
+  const auto& cam = packet.camera;
+  const auto& settings = packet.settings;
+  const auto& instances = *packet.instances;
+  const auto instance_count = instances.transform_indices.size();
+  this->instance_visibility.resize(instance_count);
+
+  const auto select_info = mesh_lod::SelectInfo{
+      .camera_position = cam.position,
+      .projection_scale = mesh_lod::get_projection_scale(cam.get_projection_matrix(), settings.viewport_height),
+      .error_threshold_pixels = settings.lod_error_pixels,
+      .hysteresis = settings.lod_hysteresis,
+      .orthographic = cam.projection == CameraComponent::Projection::Orthographic,
+  };
+
+  // Levels of the primitives of instances [begin, end), run by the workers right after
+  // culling them. The previous selection is still in `selected_lods`.
+  const auto select_lods = [&](usize begin, usize end) {
+    const auto& local = instances.local_bounds;
+    for (usize i = begin; i < end; i++) {
+      const auto visible = this->instance_visibility[i] != 0;
+      const auto& world = this->prepared_transforms[instances.transform_indices[i]].world;
+      const auto center = glm::vec3(local.center_x[i], local.center_y[i], local.center_z[i]);
+      for (auto p = instances.first_primitives[i]; p < instances.first_primitives[i + 1]; p++) {
+        auto& selected_lod = this->selected_lods[p];
+        if (!visible) {
+          selected_lod = GPU::CULLED_LOD;
+        } else if (!settings.lod_enable || settings.viewport_height <= 0.0f) {
+          // The first frame doesn't know its resolution yet.
+          selected_lod = 0;
+        } else {
+          const auto& primitive_instance = instances.primitive_instances[p];
+          const auto lods = std::span(instances.primitive_lods)
+                                .subspan(primitive_instance.first_lod, primitive_instance.lod_count);
+          const auto previous_lod = selected_lod == GPU::CULLED_LOD ? mesh_lod::NO_PREVIOUS_LOD : selected_lod;
+          selected_lod = mesh_lod::select_lod(
+              lods, world, center, instances.bounds_radius[i], select_info, previous_lod);
+        }
+      }
+    }
+  };
+
+  if (settings.cpu_frustum_culling) {
+    auto projection_view = packet.camera_data.projection_view;
+    auto frustum = CullFrustum{};
+    math::calc_frustum_planes(projection_view, frustum.planes);
+    instance_culling::cull_parallel(instances.local_bounds,
+                                    instances.transform_indices,
+                                    this->prepared_transforms,
+                                    this->instance_world_bounds,
+                                    std::span(&frustum, 1),
+                                    this->instance_visibility,
+                                    select_lods);
+
+    // Needs the world bounds from the frustum pass.
+    if (settings.occlusion_culling) {
+      ZoneNamedN(z, "Occlusion Culling", true);
+
+      packet.occlusion_buffer.begin_frame(projection_view, settings.occlusion_width, settings.occlusion_height);
+      for (const auto& occluder : packet.occluders) {
+        packet.occlusion_buffer.add_occluder(occluder.positions, occluder.indices, occluder.world);
+      }
+      packet.occlusion_buffer.rasterize();
+      packet.occlusion_buffer.cull_instances(this->instance_world_bounds, this->instance_visibility, 1_u8);
+    }
+  } else {
+    std::ranges::fill(this->instance_visibility, 1_u8);
+    select_lods(0, instance_count);
+  }
+
+  // Occluded instances drop the level picked for them while culling.
+  for (usize i = 0; i < instance_count; i++) {
+    for (auto p = instances.first_primitives[i]; p < instances.first_primitives[i + 1]; p++) {
+      auto& selected_lod = this->selected_lods[p];
+      if (this->instance_visibility[i] == 0)
+        selected_lod = GPU::CULLED_LOD;
+      if (selected_lod != GPU::CULLED_LOD)
+        packet.visible_meshlet_count += instances.primitive_lods[instances.primitive_instances[p].first_lod +
+                                                                 selected_lod]
+                                            .meshlet_count;
+    }
+  }
+  packet.primitive_instance_lods.assign(this->selected_lods.begin(), this->selected_lods.end());
+
+  TracyPlot("Visible Mesh Instances",
+            static_cast<i64>(std::ranges::count_if(this->instance_visibility, [](u8 v) { return v != 0; })));
+  TracyPlot("Meshlet Instances", static_cast<i64>(packet.visible_meshlet_count));
+}
+
+auto EasyRenderPipeline::prepare_shadows(FramePacket& packet, bool instances_changed) -> void {
+  ZoneScoped;
+
+  const auto& cam = packet.camera;
+  const auto& settings = packet.settings;
+
+  packet.shadow_views.clear();
+  packet.shadow_view_keys.clear();
+  packet.shadow_dirty_views.clear();
+  packet.shadow_dirty_ranges.clear();
+  packet.shadow_draw_meshlets.clear();
+  packet.shadows = GPU::Shadows{
+      .depth_bias = settings.shadow_depth_bias,
+      .normal_bias = settings.shadow_normal_bias,
+  };
+
+  if (settings.shadows) {
+    // Old and new boxes of casters that moved, a view only has to be rendered again when
+    // one of them touches it.
+    static const auto no_instances = MeshInstances{};
+    const auto& instances = packet.instances ? *packet.instances : no_instances;
+    const auto instance_count = instances.transform_indices.size();
+    this->shadow_moved_bounds.clear();
+    if (instances_changed || this->shadow_caster_bounds.size() != instance_count) {
+      this->shadow_caster_bounds.resize(instance_count);
+      instance_culling::transform_bounds(instances.local_bounds,
+                                         instances.transform_indices,
+                                         this->prepared_transforms,
+                                         this->shadow_caster_bounds,
+                                         0,
+                                         instance_count);
+      this->shadow_atlas.invalidate();
+    } else if (!packet.dirty_transforms.empty()) {
+      const auto push_bounds = [this](usize i) {
+        const auto& bounds = this->shadow_caster_bounds;
+        this->shadow_moved_bounds.push_back({bounds.center_x[i], bounds.center_y[i], bounds.center_z[i]},
+                                            {bounds.extent_x[i], bounds.extent_y[i], bounds.extent_z[i]});
+      };
+
+      this->moved_transform_flags.assign(this->prepared_transforms.size(), 0_u8);
+      for (const auto transform_id : packet.dirty_transforms) {
+        this->moved_transform_flags[SlotMap_decode_id(transform_id).index] = 1_u8;
+      }
+
+      for (usize i = 0; i < instance_count; i++) {
+        if (this->moved_transform_flags[instances.transform_indices[i]] == 0)
+          continue;
+
+        push_bounds(i);
+        instance_culling::transform_bounds(instances.local_bounds,
+                                           instances.transform_indices,
+                                           this->prepared_transforms,
+                                           this->shadow_caster_bounds,
+                                           i,
+                                           i + 1);
+        push_bounds(i);
+      }
+    }
+
+    this->shadow_view_requests.clear();
+
+    if (packet.sun_shadow_caster.has_value() && packet.sun.has_value()) {
+      // Snapped to the texels the view actually got last frame.
+      const auto resolution = std::bit_floor(
+          ox::max(packet.sun_shadow_caster->resolution, shadow_atlas::MIN_RESOLUTION));
+      const auto snap_resolution = ox::max(resolution >> this->shadow_atlas.get_resolution_shift(),
+                                           shadow_atlas::MIN_RESOLUTION);
+      packet.shadows.sun_view = static_cast<u32>(this->shadow_view_requests.size());
+      this->shadow_view_requests.push_back({
+          .key = {.light = packet.sun_shadow_caster->entity},
+          .resolution = resolution,
+          .view_projection = shadow_atlas::get_directional_view_projection(
+              packet.sun->direction, cam.position, settings.shadow_distance, snap_resolution),
+      });
+    }
+
+    // Point and spot lights are all dropped when clustered shading is off.
+    auto& shadow_casters = packet.shadow_casters;
+    std::erase_if(shadow_casters,
+                  [&packet](const ShadowCaster& caster) { return caster.light_index >= packet.lights.size(); });
+
+    auto frustum = CullFrustum{};
+    math::calc_frustum_planes(packet.camera_data.projection_view, frustum.planes);
+    const auto projection_scale = glm::abs(cam.get_projection_matrix()[1][1]);
+    for (auto& caster : shadow_casters) {
+      const auto& light = packet.lights[caster.light_index];
+      caster.importance = shadow_atlas::get_screen_importance(
+          frustum, cam.position, projection_scale, light.position, light.range);
+      // Lights close in importance don't take turns at the last shadowed slot.
+      const auto* previous = this->shadow_atlas.find_view({.light = caster.entity});
+      caster.priority = previous ? caster.importance * (1.0f + settings.shadow_hysteresis) : caster.importance;
+    }
+
+    // Most important lights first, the atlas drops views from the back when it's full.
+    std::erase_if(shadow_casters, [](const ShadowCaster& caster) { return caster.importance <= 0.0f; });
+    std::ranges::stable_sort(
+        shadow_casters, [](const ShadowCaster& a, const ShadowCaster& b) { return a.priority > b.priority; });
+    if (shadow_casters.size() > settings.shadow_max_lights)
+      shadow_casters.resize(settings.shadow_max_lights);
+
+    for (const auto& caster : shadow_casters) {
+      auto& light = packet.lights[caster.light_index];
+      const auto* previous = this->shadow_atlas.find_view({.light = caster.entity});
+      const auto resolution = shadow_atlas::select_resolution(caster.resolution,
+                                                              caster.importance,
+                                                              previous ? previous->requested_resolution : 0,
+                                                              settings.shadow_hysteresis);
+      light.shadow_view = static_cast<u32>(this->shadow_view_requests.size());
+      if (light.type == GPU::LightType::Spot) {
+        this->shadow_view_requests.push_back({
+            .key = {.light = caster.entity},
+            .resolution = resolution,
+            .view_projection = shadow_atlas::get_spot_view_projection(
+                light.position, light.direction, light.range, caster.outer_cone_angle),
+        });
+      } else {
+        for (u32 face = 0; face < shadow_atlas::CUBE_FACE_COUNT; face++) {
+          this->shadow_view_requests.push_back({
+              .key = {.light = caster.entity, .face = face},
+              .resolution = resolution,
+              .view_projection = shadow_atlas::get_point_view_projection(light.position, light.range, face),
+          });
+        }
+      }
+    }
+
+    this->shadow_atlas.set_size(settings.shadow_atlas_size);
+    this->shadow_atlas.update(this->shadow_view_requests, this->shadow_moved_bounds);
+
+    const auto views = this->shadow_atlas.get_views();
+    for (u32 i = 0; i < views.size(); i++) {
+      const auto& view = views[i];
+      packet.shadow_views.push_back({
+          .view_projection = view.view_projection,
+          .atlas_rect = glm::vec4(view.x, view.y, view.size, view.size),
+      });
+      packet.shadow_view_keys.push_back(view.key);
+      if (view.dirty)
+        packet.shadow_dirty_views.push_back(i);
+    }
+    packet.shadows.view_count = static_cast<u32>(packet.shadow_views.size());
+
+    // Level 0 meshlets of the casters inside each dirty view, culled for up to
+    // `MAX_FRUSTA` views at once.
+    auto frusta = std::array<CullFrustum, instance_culling::MAX_FRUSTA>();
+    const auto dirty_views = std::span(packet.shadow_dirty_views);
+    for (usize first = 0; first < dirty_views.size(); first += instance_culling::MAX_FRUSTA) {
+      const auto batch = dirty_views.subspan(first, ox::min(instance_culling::MAX_FRUSTA, dirty_views.size() - first));
+      for (usize b = 0; b < batch.size(); b++) {
+        auto view_projection = views[batch[b]].view_projection;
+        math::calc_frustum_planes(view_projection, frusta[b].planes);
+      }
+
+      this->shadow_caster_visibility.assign(instance_count, 0_u8);
+      instance_culling::cull(this->shadow_caster_bounds,
+                             std::span(frusta).first(batch.size()),
+                             this->shadow_caster_visibility,
+                             0,
+                             instance_count);
+
+      for (usize b = 0; b < batch.size(); b++) {
+        const auto offset = static_cast<u32>(packet.shadow_draw_meshlets.size());
+        for (usize i = 0; i < instance_count; i++) {
+          if ((this->shadow_caster_visibility[i] & (1_u8 << b)) == 0)
+            continue;
+
+          const auto meshlets = std::span(instances.shadow_meshlet_indices)
+                                    .subspan(instances.first_shadow_meshlets[i],
+                                             instances.first_shadow_meshlets[i + 1] - instances.first_shadow_meshlets[i]);
+          packet.shadow_draw_meshlets.insert(packet.shadow_draw_meshlets.end(), meshlets.begin(), meshlets.end());
+        }
+        packet.shadow_dirty_ranges.emplace_back(offset, static_cast<u32>(packet.shadow_draw_meshlets.size()) - offset);
+      }
+    }
+  } else {
+    // Everything is rendered again once shadows are turned back on.
+    this->shadow_caster_bounds.clear();
+    this->shadow_atlas.invalidate();
+  }
+
+  packet.shadow_atlas_size = this->shadow_atlas.get_size();
+}
+
+auto EasyRenderPipeline::apply_transforms(std::vector<GPU::Transforms>& transforms, const FramePacket& packet)
+    -> void {
+  ZoneScoped;
+
+  if (!packet.transforms.empty())
+    transforms.assign(packet.transforms.begin(), packet.transforms.end());
+  for (const auto& [transform_id, value] : std::views::zip(packet.dirty_transforms, packet.dirty_transform_values)) {
+    const auto index = SlotMap_decode_id(transform_id).index;
+    if (index >= transforms.size())
+      transforms.resize(index + 1);
+    transforms[index] = value;
+  }
+}
+
+auto EasyRenderPipeline::publish(const FramePacket& packet) -> void {
+  ZoneScoped;
+
+  this->published_packet_index = static_cast<u32>(&packet - this->frame_packets);
+  apply_transforms(this->published_transforms, packet);
+  this->frame_data_index = memory::get_frame_arena().get_frame_index();
+  this->dirty_transforms = std::pmr::vector<GPU::TransformID>(
+      packet.dirty_transforms.begin(), packet.dirty_transforms.end(), this->dirty_transforms.get_allocator());
+  this->dirty_transform_values = std::pmr::vector<GPU::Transforms>(packet.dirty_transform_values.begin(),
+                                                                   packet.dirty_transform_values.end(),
+                                                                   this->dirty_transform_values.get_allocator());
+  this->render_queue_2d.assign(packet.render_queue_2d);
+
+  this->camera_data = packet.camera_data;
+  if (packet.instances != this->instances) {
+    this->instances = packet.instances;
+    this->meshes_dirty = true;
+  }
+  this->primitive_instance_lods = packet.primitive_instance_lods;
+  this->visible_meshlet_count = packet.visible_meshlet_count;
+  this->atmosphere = packet.atmosphere;
+  this->sun = packet.sun;
+  this->lights = packet.lights;
+  this->light_cluster_ranges = packet.light_cluster_ranges;
+  this->light_cluster_indices = packet.light_cluster_indices;
+  this->light_clusters = packet.light_clusters;
+  // Rects nobody rendered yet, e.g. while shading was off, are rendered again by a later
+  // update. View indices change with priorities every frame, only keys can be carried over.
+  for (const auto view_index : this->shadow_dirty_views) {
+    if (view_index >= this->shadow_view_keys.size())
+      continue;
+
+    const auto& key = this->shadow_view_keys[view_index];
+    const auto rendered_now = std::ranges::any_of(
+        packet.shadow_dirty_views, [&](u32 i) { return packet.shadow_view_keys[i] == key; });
+    if (!rendered_now)
+      this->shadow_atlas.invalidate(key);
+  }
+  this->shadow_views = packet.shadow_views;
+  this->shadow_view_keys = packet.shadow_view_keys;
+  this->shadow_dirty_views = packet.shadow_dirty_views;
+  this->shadow_dirty_ranges = packet.shadow_dirty_ranges;
+  this->shadow_draw_meshlets = packet.shadow_draw_meshlets;
+  this->shadows = packet.shadows;
+  this->shadow_atlas_size = packet.shadow_atlas_size;
+  this->debug_draw.vertices = packet.debug_draw.vertices;
+  this->debug_draw.instances = packet.debug_draw.instances;
+  this->debug_draw.batches = packet.debug_draw.batches;
+  if (this->debug_draw.geometry_version != packet.debug_draw.geometry_version) {
+    this->debug_draw.geometry_vertices = packet.debug_draw.geometry_vertices;
+    this->debug_draw.geometry_version = packet.debug_draw.geometry_version;
+    this->debug_geometry_dirty = true;
+  }
+  this->particles = packet.particles;
+  this->histogram_info = packet.histogram_info;
+}
+
+auto EasyRenderPipeline::wait_for_render_thread() -> void {
+  ZoneScoped;
+
+  if (this->frame_packet_in_flight) {
+    ThreadManager::get()->render_thread.wait();
+  }
 }
 } // namespace ox
@@ -0,0 +1,174 @@
+#include "Render/InstanceCulling.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <emmintrin.h>
+  #define OX_CULLING_SSE2 1
+#endif
+
+#include "Core/App.hpp"
+#include "Thread/TaskScheduler.hpp"
+
+namespace ox {
+auto InstanceBounds::resize(usize count) -> void {
+  center_x.resize(count);
+  center_y.resize(count);
+  center_z.resize(count);
+  extent_x.resize(count);
+  extent_y.resize(count);
+  extent_z.resize(count);
+}
+
+auto InstanceBounds::clear() -> void { resize(0); }
+
+auto InstanceBounds::push_back(const glm::vec3& center, const glm::vec3& extent) -> void {
+  center_x.push_back(center.x);
+  center_y.push_back(center.y);
+  center_z.push_back(center.z);
+  extent_x.push_back(extent.x);
+  extent_y.push_back(extent.y);
+  extent_z.push_back(extent.z);
+}
+
+namespace instance_culling {
+auto transform_bounds(const InstanceBounds& local,
+                      std::span<const u32> transform_indices,
+                      std::span<const GPU::Transforms> transforms,
+                      InstanceBounds& world,
+                      usize begin,
+                      usize end) -> void {
+  for (usize i = begin; i < end; i++) {
+    const auto& m = transforms[transform_indices[i]].world;
+    const auto cx = local.center_x[i];
+    const auto cy = local.center_y[i];
+    const auto cz = local.center_z[i];
+    const auto ex = local.extent_x[i];
+    const auto ey = local.extent_y[i];
+    const auto ez = local.extent_z[i];
+
+    world.center_x[i] = m[0][0] * cx + m[1][0] * cy + m[2][0] * cz + m[3][0];
+    world.center_y[i] = m[0][1] * cx + m[1][1] * cy + m[2][1] * cz + m[3][1];
+    world.center_z[i] = m[0][2] * cx + m[1][2] * cy + m[2][2] * cz + m[3][2];
+    world.extent_x[i] = glm::abs(m[0][0]) * ex + glm::abs(m[1][0]) * ey + glm::abs(m[2][0]) * ez;
+    world.extent_y[i] = glm::abs(m[0][1]) * ex + glm::abs(m[1][1]) * ey + glm::abs(m[2][1]) * ez;
+    world.extent_z[i] = glm::abs(m[0][2]) * ex + glm::abs(m[1][2]) * ey + glm::abs(m[2][2]) * ez;
+  }
+}
+
+auto is_visible(const InstanceBounds& bounds, usize index, const CullFrustum& frustum) -> bool {
+  for (const auto& plane : frustum.planes) {
+    const auto distance = plane.x * bounds.center_x[index] + plane.y * bounds.center_y[index] +
+                          plane.z * bounds.center_z[index] - plane.w;
+    const auto radius = glm::abs(plane.x) * bounds.extent_x[index] + glm::abs(plane.y) * bounds.extent_y[index] +
+                        glm::abs(plane.z) * bounds.extent_z[index];
+    if (!(distance >= -radius))
+      return false;
+  }
+
+  return true;
+}
+
+auto cull(const InstanceBounds& bounds,
+          std::span<const CullFrustum> frusta,
+          std::span<u8> visibility,
+          usize begin,
+          usize end) -> void {
+  OX_ASSERT(frusta.size() <= MAX_FRUSTA);
+
+  std::fill(visibility.data() + begin, visibility.data() + end, 0_u8);
+
+  for (usize f = 0; f < frusta.size(); f++) {
+    const auto& frustum = frusta[f];
+    const auto bit = static_cast<u8>(1 << f);
+    auto i = begin;
+
+#ifdef OX_CULLING_SSE2
+    const auto sign_mask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= end; i += 4) {
+      const auto cx = _mm_loadu_ps(&bounds.center_x[i]);
+      const auto cy = _mm_loadu_ps(&bounds.center_y[i]);
+      const auto cz = _mm_loadu_ps(&bounds.center_z[i]);
+      const auto ex = _mm_loadu_ps(&bounds.extent_x[i]);
+      const auto ey = _mm_loadu_ps(&bounds.extent_y[i]);
+      const auto ez = _mm_loadu_ps(&bounds.extent_z[i]);
+
+      auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+      for (const auto& plane : frustum.planes) {
+        const auto nx = _mm_set1_ps(plane.x);
+        const auto ny = _mm_set1_ps(plane.y);
+        const auto nz = _mm_set1_ps(plane.z);
+        const auto w = _mm_set1_ps(plane.w);
+        // Same operation order as `is_visible`, so both round identically.
+        const auto distance = _mm_sub_ps(
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_mul_ps(nz, cz)), w);
+        const auto radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign_mask, nx), ex),
+                                                  _mm_mul_ps(_mm_andnot_ps(sign_mask, ny), ey)),
+                                       _mm_mul_ps(_mm_andnot_ps(sign_mask, nz), ez));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_xor_ps(radius, sign_mask)));
+      }
+
+      const auto mask = _mm_movemask_ps(inside);
+      for (u32 lane = 0; lane < 4; lane++) {
+        if (mask & (1 << lane))
+          visibility[i + lane] |= bit;
+      }
+    }
+#endif
+
+    for (; i < end; i++) {
+      if (is_visible(bounds, i, frustum))
+        visibility[i] |= bit;
+    }
+  }
+}
+
+struct CullTask : ITaskSet {
+  const InstanceBounds* local = nullptr;
+  std::span<const u32> transform_indices = {};
+  std::span<const GPU::Transforms> transforms = {};
+  InstanceBounds* world = nullptr;
+  std::span<const CullFrustum> frusta = {};
+  std::span<u8> visibility = {};
+  const CulledRangeFn* on_culled = nullptr;
+
+  void ExecuteRange(const enki::TaskSetPartition range, u32) override {
+    ZoneScopedN("Cull Instances");
+
+    transform_bounds(*local, transform_indices, transforms, *world, range.start, range.end);
+    cull(*world, frusta, visibility, range.start, range.end);
+    if (*on_culled)
+      (*on_culled)(range.start, range.end);
+  }
+};
+
+auto cull_parallel(const InstanceBounds& local,
+                   std::span<const u32> transform_indices,
+                   std::span<const GPU::Transforms> transforms,
+                   InstanceBounds& world,
+                   std::span<const CullFrustum> frusta,
+                   std::span<u8> visibility,
+                   const CulledRangeFn& on_culled) -> void {
+  ZoneScoped;
+
+  const auto count = local.size();
+  OX_ASSERT(transform_indices.size() == count && visibility.size() == count);
+  world.resize(count);
+  if (count == 0)
+    return;
+
+  auto task = CullTask{};
+  task.local = &local;
+  task.transform_indices = transform_indices;
+  task.transforms = transforms;
+  task.world = &world;
+  task.frusta = frusta;
+  task.visibility = visibility;
+  task.on_culled = &on_culled;
+  task.m_SetSize = static_cast<u32>(count);
+  task.m_MinRange = 4096;
+
+  auto* task_scheduler = App::get_system<TaskScheduler>(EngineSystems::TaskScheduler);
+  task_scheduler->schedule_task(&task);
+  task_scheduler->wait_task(&task);
+}
+} // namespace instance_culling
+} // namespace ox
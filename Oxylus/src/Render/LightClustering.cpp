@@ -0,0 +1,340 @@
+#include "Render/LightClustering.hpp"
+
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <emmintrin.h>
+  #define OX_CULLING_SSE2 1
+#endif
+
+#include "Core/App.hpp"
+#include "Thread/TaskScheduler.hpp"
+
+namespace ox {
+auto LightSpheres::clear() -> void {
+  x.clear();
+  y.clear();
+  depth.clear();
+  radius.clear();
+}
+
+auto LightSpheres::push_back(const glm::vec3& view_position, f32 radius_) -> void {
+  x.push_back(view_position.x);
+  y.push_back(view_position.y);
+  depth.push_back(-view_position.z);
+  radius.push_back(radius_);
+}
+
+auto LightClusterGrid::get_slice_depth(u32 z) const -> f32 {
+  // Anything in front of the near plane still falls into the first slice.
+  if (z == 0)
+    return 0.0f;
+  if (z >= size.z)
+    return far_clip;
+
+  return near_clip * glm::pow(far_clip / near_clip, static_cast<f32>(z) / static_cast<f32>(size.z));
+}
+
+auto LightClusterGrid::get_cluster_bounds(u32 x, u32 y, u32 z, glm::vec3& min, glm::vec3& max) const -> void {
+  const auto depth_min = get_slice_depth(z);
+  const auto depth_max = get_slice_depth(z + 1);
+
+  const auto tile_bounds = [&](u32 tile, u32 tile_count, f32 scale, f32& lo, f32& hi) {
+    const auto a = (-1.0f + 2.0f * static_cast<f32>(tile) / static_cast<f32>(tile_count)) / scale;
+    const auto b = (-1.0f + 2.0f * static_cast<f32>(tile + 1) / static_cast<f32>(tile_count)) / scale;
+    lo = ox::min(a, b);
+    hi = ox::max(a, b);
+    if (!orthographic) {
+      // View space extent grows with depth, the extremes are at the slice's near or far end.
+      lo = ox::min(lo * depth_min, lo * depth_max);
+      hi = ox::max(hi * depth_min, hi * depth_max);
+    }
+  };
+
+  tile_bounds(x, size.x, projection_scale.x, min.x, max.x);
+  tile_bounds(y, size.y, projection_scale.y, min.y, max.y);
+  min.z = depth_min;
+  max.z = depth_max;
+}
+
+auto LightClusterGrid::to_gpu() const -> GPU::LightClusters {
+  const auto log_range = glm::log(far_clip / near_clip);
+
+  return GPU::LightClusters{
+      .grid_size = size,
+      .slice_scale = static_cast<f32>(size.z) / log_range,
+      .slice_bias = -static_cast<f32>(size.z) * glm::log(near_clip) / log_range,
+  };
+}
+
+namespace light_clustering {
+// Distance from `center` to the interval [min, max] along one axis, zero inside.
+static auto axis_distance(f32 center, f32 min, f32 max) -> f32 {
+  return ox::max(ox::max(min - center, 0.0f), center - max);
+}
+
+auto is_in_cluster(const glm::vec3& min, const glm::vec3& max, const LightSpheres& spheres, usize index) -> bool {
+  const auto dx = axis_distance(spheres.x[index], min.x, max.x);
+  const auto dy = axis_distance(spheres.y[index], min.y, max.y);
+  const auto dz = axis_distance(spheres.depth[index], min.z, max.z);
+  const auto radius = spheres.radius[index];
+
+  return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+auto bin_lights_reference(const LightClusterGrid& grid, const LightSpheres& spheres, LightClusterList& list) -> void {
+  ZoneScoped;
+
+  list.ranges.resize(grid.get_cluster_count());
+  list.indices.clear();
+  list.overflow_count = 0;
+
+  for (u32 z = 0; z < grid.size.z; z++) {
+    for (u32 y = 0; y < grid.size.y; y++) {
+      for (u32 x = 0; x < grid.size.x; x++) {
+        auto min = glm::vec3{};
+        auto max = glm::vec3{};
+        grid.get_cluster_bounds(x, y, z, min, max);
+
+        const auto offset = static_cast<u32>(list.indices.size());
+        auto count = 0_u32;
+        for (usize i = 0; i < spheres.size(); i++) {
+          if (!is_in_cluster(min, max, spheres, i))
+            continue;
+
+          if (count < MAX_LIGHTS_PER_CLUSTER) {
+            list.indices.push_back(static_cast<u32>(i));
+            count += 1;
+          } else {
+            list.overflow_count += 1;
+          }
+        }
+
+        list.ranges[grid.get_cluster_index(x, y, z)] = {offset, count};
+      }
+    }
+  }
+}
+
+// Lights overlapping the depth range of one slice. Their squared depth distance is the
+// same for every cluster of the slice, so it's computed once here.
+struct SliceLights {
+  std::vector<u32> indices = {};
+  std::vector<f32> x = {};
+  std::vector<f32> y = {};
+  std::vector<f32> depth_distance_sq = {};
+  std::vector<f32> radius_sq = {};
+
+  auto clear() -> void {
+    indices.clear();
+    x.clear();
+    y.clear();
+    depth_distance_sq.clear();
+    radius_sq.clear();
+  }
+
+  auto push_back(u32 index, f32 x_, f32 y_, f32 dz2, f32 r2) -> void {
+    indices.push_back(index);
+    x.push_back(x_);
+    y.push_back(y_);
+    depth_distance_sq.push_back(dz2);
+    radius_sq.push_back(r2);
+  }
+};
+
+static auto gather_slice_lights(const LightSpheres& spheres, f32 depth_min, f32 depth_max, SliceLights& slice)
+    -> void {
+  slice.clear();
+
+  const auto count = spheres.size();
+  usize i = 0;
+
+#ifdef OX_CULLING_SSE2
+  const auto zero = _mm_setzero_ps();
+  const auto min = _mm_set1_ps(depth_min);
+  const auto max = _mm_set1_ps(depth_max);
+  alignas(16) f32 dz2_lanes[4] = {};
+  alignas(16) f32 r2_lanes[4] = {};
+  for (; i + 4 <= count; i += 4) {
+    const auto depth = _mm_loadu_ps(&spheres.depth[i]);
+    const auto radius = _mm_loadu_ps(&spheres.radius[i]);
+    // Same operation order as `axis_distance`, so both round identically.
+    const auto dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min, depth), zero), _mm_sub_ps(depth, max));
+    const auto dz2 = _mm_mul_ps(dz, dz);
+    const auto r2 = _mm_mul_ps(radius, radius);
+    auto mask = _mm_movemask_ps(_mm_cmple_ps(dz2, r2));
+    if (mask == 0)
+      continue;
+
+    _mm_store_ps(dz2_lanes, dz2);
+    _mm_store_ps(r2_lanes, r2);
+    while (mask != 0) {
+      const auto lane = static_cast<u32>(std::countr_zero(static_cast<u32>(mask)));
+      const auto index = static_cast<u32>(i) + lane;
+      slice.push_back(index, spheres.x[index], spheres.y[index], dz2_lanes[lane], r2_lanes[lane]);
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  for (; i < count; i++) {
+    const auto dz = axis_distance(spheres.depth[i], depth_min, depth_max);
+    const auto radius = spheres.radius[i];
+    // The cluster test adds the other two axes to this, a light failing here fails there too.
+    if (dz * dz <= radius * radius)
+      slice.push_back(static_cast<u32>(i), spheres.x[i], spheres.y[i], dz * dz, radius * radius);
+  }
+}
+
+static auto bin_slice(const LightClusterGrid& grid,
+                      const LightSpheres& spheres,
+                      u32 z,
+                      SliceLights& slice,
+                      LightClusterList& list) -> u32 {
+  auto overflow_count = 0_u32;
+
+  gather_slice_lights(spheres, grid.get_slice_depth(z), grid.get_slice_depth(z + 1), slice);
+
+#ifdef OX_CULLING_SSE2
+  // Padding lanes have a negative squared radius and never pass.
+  while (slice.indices.size() % 4 != 0) {
+    slice.push_back(~0_u32, 0.0f, 0.0f, 0.0f, -1.0f);
+  }
+#endif
+
+  for (u32 y = 0; y < grid.size.y; y++) {
+    for (u32 x = 0; x < grid.size.x; x++) {
+      auto min = glm::vec3{};
+      auto max = glm::vec3{};
+      grid.get_cluster_bounds(x, y, z, min, max);
+
+      const auto cluster_index = grid.get_cluster_index(x, y, z);
+      auto* slots = list.cluster_slots.data() + static_cast<usize>(cluster_index) * MAX_LIGHTS_PER_CLUSTER;
+      auto count = 0_u32;
+      const auto add_light = [&](u32 index) {
+        if (count < MAX_LIGHTS_PER_CLUSTER)
+          slots[count++] = index;
+        else
+          overflow_count += 1;
+      };
+
+#ifdef OX_CULLING_SSE2
+      const auto zero = _mm_setzero_ps();
+      const auto min_x = _mm_set1_ps(min.x);
+      const auto min_y = _mm_set1_ps(min.y);
+      const auto max_x = _mm_set1_ps(max.x);
+      const auto max_y = _mm_set1_ps(max.y);
+      for (u32 j = 0; j < slice.indices.size(); j += 4) {
+        const auto cx = _mm_loadu_ps(&slice.x[j]);
+        const auto cy = _mm_loadu_ps(&slice.y[j]);
+        const auto dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_x, cx), zero), _mm_sub_ps(cx, max_x));
+        const auto dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_y, cy), zero), _mm_sub_ps(cy, max_y));
+        const auto distance_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                            _mm_loadu_ps(&slice.depth_distance_sq[j]));
+        auto mask = _mm_movemask_ps(_mm_cmple_ps(distance_sq, _mm_loadu_ps(&slice.radius_sq[j])));
+        while (mask != 0) {
+          add_light(slice.indices[j + static_cast<u32>(std::countr_zero(static_cast<u32>(mask)))]);
+          mask &= mask - 1;
+        }
+      }
+#else
+      for (u32 j = 0; j < slice.indices.size(); j++) {
+        const auto dx = axis_distance(slice.x[j], min.x, max.x);
+        const auto dy = axis_distance(slice.y[j], min.y, max.y);
+        if (dx * dx + dy * dy + slice.depth_distance_sq[j] <= slice.radius_sq[j])
+          add_light(slice.indices[j]);
+      }
+#endif
+
+      list.cluster_counts[cluster_index] = count;
+    }
+  }
+
+  return overflow_count;
+}
+
+struct BinTask : ITaskSet {
+  const LightClusterGrid* grid = nullptr;
+  const LightSpheres* spheres = nullptr;
+  LightClusterList* list = nullptr;
+  std::span<u32> slice_overflow = {};
+
+  void ExecuteRange(const enki::TaskSetPartition range, u32) override {
+    ZoneScopedN("Bin Lights");
+
+    auto slice = SliceLights{};
+    for (u32 z = range.start; z < range.end; z++) {
+      slice_overflow[z] = bin_slice(*grid, *spheres, z, slice, *list);
+    }
+  }
+};
+
+static auto prepare_cluster_slots(const LightClusterGrid& grid, LightClusterList& list) -> void {
+  const auto cluster_count = grid.get_cluster_count();
+  list.cluster_slots.resize(static_cast<usize>(cluster_count) * MAX_LIGHTS_PER_CLUSTER);
+  list.cluster_counts.resize(cluster_count);
+}
+
+// Clusters are compacted in index order, which is also the order of the reference.
+static auto compact_cluster_slots(const LightClusterGrid& grid,
+                                  const LightSpheres& spheres,
+                                  std::span<const u32> slice_overflow,
+                                  LightClusterList& list) -> void {
+  const auto cluster_count = grid.get_cluster_count();
+  list.ranges.resize(cluster_count);
+  list.indices.clear();
+  for (u32 i = 0; i < cluster_count; i++) {
+    const auto offset = static_cast<u32>(list.indices.size());
+    const auto count = list.cluster_counts[i];
+    const auto* slots = list.cluster_slots.data() + static_cast<usize>(i) * MAX_LIGHTS_PER_CLUSTER;
+    list.indices.insert(list.indices.end(), slots, slots + count);
+    list.ranges[i] = {offset, count};
+  }
+
+  list.overflow_count = 0;
+  for (const auto overflow : slice_overflow) {
+    list.overflow_count += overflow;
+  }
+
+  TracyPlot("Clustered Lights", static_cast<i64>(spheres.size()));
+  TracyPlot("Light Cluster Indices", static_cast<i64>(list.indices.size()));
+  TracyPlot("Light Cluster Overflow", static_cast<i64>(list.overflow_count));
+}
+
+auto bin_lights(const LightClusterGrid& grid, const LightSpheres& spheres, LightClusterList& list) -> void {
+  ZoneScoped;
+
+  prepare_cluster_slots(grid, list);
+
+  auto slice_overflow = std::vector<u32>(grid.size.z, 0);
+  auto slice = SliceLights{};
+  for (u32 z = 0; z < grid.size.z; z++) {
+    slice_overflow[z] = bin_slice(grid, spheres, z, slice, list);
+  }
+
+  compact_cluster_slots(grid, spheres, slice_overflow, list);
+}
+
+auto bin_lights_parallel(const LightClusterGrid& grid, const LightSpheres& spheres, LightClusterList& list) -> void {
+  ZoneScoped;
+
+  prepare_cluster_slots(grid, list);
+
+  auto slice_overflow = std::vector<u32>(grid.size.z, 0);
+
+  auto task = BinTask{};
+  task.grid = &grid;
+  task.spheres = &spheres;
+  task.list = &list;
+  task.slice_overflow = slice_overflow;
+  task.m_SetSize = grid.size.z;
+  task.m_MinRange = 1;
+
+  auto* task_scheduler = App::get_system<TaskScheduler>(EngineSystems::TaskScheduler);
+  task_scheduler->schedule_task(&task);
+  task_scheduler->wait_task(&task);
+
+  compact_cluster_slots(grid, spheres, slice_overflow, list);
+}
+} // namespace light_clustering
+} // namespace ox
@@ -0,0 +1,40 @@
+#include "Render/MeshletCulling.hpp"
+
+namespace ox::meshlet_culling {
+auto is_cone_culled(const GPU::MeshletBounds& bounds,
+                    const glm::mat4& world,
+                    const glm::mat3& normal_matrix,
+                    const glm::vec3& camera_position) -> bool {
+  // meshoptimizer writes a cutoff of 1 when the normals are too spread out for a cone.
+  if (bounds.cone_cutoff >= 1.0f)
+    return false;
+
+  const auto apex = glm::vec3(world * glm::vec4(bounds.cone_apex, 1.0f));
+  const auto axis = glm::normalize(normal_matrix * bounds.cone_axis);
+  const auto view = apex - camera_position;
+  const auto view_length = glm::length(view);
+  if (view_length == 0.0f)
+    return false;
+
+  return glm::dot(view / view_length, axis) >= bounds.cone_cutoff;
+}
+
+auto get_cone_rejection_rate(std::span<const GPU::MeshletBounds> bounds,
+                             const glm::mat4& world,
+                             std::span<const glm::vec3> camera_positions) -> f32 {
+  ZoneScoped;
+
+  if (bounds.empty() || camera_positions.empty())
+    return 0.0f;
+
+  const auto normal_matrix = glm::transpose(glm::inverse(glm::mat3(world)));
+  usize culled = 0;
+  for (const auto& camera_position : camera_positions) {
+    for (const auto& meshlet_bounds : bounds) {
+      culled += is_cone_culled(meshlet_bounds, world, normal_matrix, camera_position) ? 1 : 0;
+    }
+  }
+
+  return static_cast<f32>(culled) / static_cast<f32>(bounds.size() * camera_positions.size());
+}
+} // namespace ox::meshlet_culling
@@ -0,0 +1,300 @@
+#include "Render/OcclusionCulling.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <emmintrin.h>
+  #define OX_CULLING_SSE2 1
+#endif
+
+#include "Core/App.hpp"
+#include "Thread/TaskScheduler.hpp"
+
+namespace ox {
+struct OcclusionBuffer::RasterizeTask : ITaskSet {
+  OcclusionBuffer* buffer = nullptr;
+
+  void ExecuteRange(const enki::TaskSetPartition range, u32) override {
+    ZoneScopedN("Rasterize Occluders");
+
+    const auto begin_row = range.start * BAND_HEIGHT;
+    const auto end_row = ox::min(range.end * BAND_HEIGHT, buffer->height);
+    buffer->rasterize_rows(begin_row, end_row);
+  }
+};
+
+struct OcclusionBuffer::CullTask : ITaskSet {
+  const OcclusionBuffer* buffer = nullptr;
+  const InstanceBounds* bounds = nullptr;
+  std::span<u8> visibility = {};
+  u8 bit = 0;
+
+  void ExecuteRange(const enki::TaskSetPartition range, u32) override {
+    ZoneScopedN("Occlusion Queries");
+
+    for (u32 i = range.start; i < range.end; i++) {
+      if (!(visibility[i] & bit))
+        continue;
+
+      const auto center = glm::vec3(bounds->center_x[i], bounds->center_y[i], bounds->center_z[i]);
+      const auto extent = glm::vec3(bounds->extent_x[i], bounds->extent_y[i], bounds->extent_z[i]);
+      if (!buffer->is_visible(center, extent))
+        visibility[i] &= static_cast<u8>(0xFF ^ bit);
+    }
+  }
+};
+
+auto OcclusionBuffer::begin_frame(const glm::mat4& projection_view_, u32 width_, u32 height_) -> void {
+  ZoneScoped;
+
+  width = (width_ + 3) & ~3_u32;
+  height = height_;
+  projection_view = projection_view_;
+  depth.assign(static_cast<usize>(width) * height, 0.0f);
+  triangles.clear();
+}
+
+auto OcclusionBuffer::add_occluder(std::span<const glm::vec3> positions,
+                                   std::span<const u32> indices,
+                                   const glm::mat4& world) -> void {
+  ZoneScoped;
+
+  const auto transform = projection_view * world;
+  const auto screen_size = glm::vec2(static_cast<f32>(width), static_cast<f32>(height));
+
+  projected.resize(positions.size());
+  for (const auto& [position, screen] : std::views::zip(positions, projected)) {
+    const auto clip = transform * glm::vec4(position, 1.0f);
+    if (clip.w < NEAR_W) {
+      screen = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+      continue;
+    }
+
+    const auto inv_w = 1.0f / clip.w;
+    const auto ndc = glm::vec2(clip) * inv_w;
+    const auto xy = (ndc * 0.5f + 0.5f) * screen_size;
+    screen = glm::vec4(xy, inv_w, 1.0f);
+  }
+
+  for (usize i = 0; i + 2 < indices.size(); i += 3) {
+    const auto& v0 = projected[indices[i + 0]];
+    const auto& v1 = projected[indices[i + 1]];
+    const auto& v2 = projected[indices[i + 2]];
+    // Triangles crossing the near plane are dropped, that only makes occlusion weaker.
+    if (v0.w < 0.0f || v1.w < 0.0f || v2.w < 0.0f)
+      continue;
+
+    const auto area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (glm::abs(area) < 1e-8f)
+      continue;
+
+    const auto min_xy = glm::floor(glm::min(glm::vec2(v0), glm::min(glm::vec2(v1), glm::vec2(v2))));
+    const auto max_xy = glm::ceil(glm::max(glm::vec2(v0), glm::max(glm::vec2(v1), glm::vec2(v2))));
+    if (max_xy.x < 0.0f || max_xy.y < 0.0f || min_xy.x >= screen_size.x || min_xy.y >= screen_size.y)
+      continue;
+
+    // Clamped as floats first, far off screen vertices don't fit in an i32.
+    const auto clamped_min = glm::clamp(min_xy, glm::vec2(0.0f), screen_size - 1.0f);
+    const auto clamped_max = glm::clamp(max_xy, glm::vec2(0.0f), screen_size - 1.0f);
+    auto triangle = Triangle{
+        .min_x = static_cast<i32>(clamped_min.x),
+        .min_y = static_cast<i32>(clamped_min.y),
+        .max_x = static_cast<i32>(clamped_max.x),
+        .max_y = static_cast<i32>(clamped_max.y),
+    };
+
+    const auto inv_area = 1.0f / area;
+    const glm::vec4* v[3] = {&v0, &v1, &v2};
+    for (u32 e = 0; e < 3; e++) {
+      const auto& a = *v[(e + 1) % 3];
+      const auto& b = *v[(e + 2) % 3];
+      triangle.edge_a[e] = (a.y - b.y) * inv_area;
+      triangle.edge_b[e] = (b.x - a.x) * inv_area;
+      triangle.edge_c[e] = (a.x * b.y - b.x * a.y) * inv_area;
+      triangle.inv_w[e] = v[e]->z;
+    }
+
+    triangles.push_back(triangle);
+  }
+}
+
+auto OcclusionBuffer::rasterize(bool parallel) -> void {
+  ZoneScoped;
+
+  if (triangles.empty() || height == 0)
+    return;
+
+  if (!parallel) {
+    rasterize_rows(0, height);
+    return;
+  }
+
+  auto task = RasterizeTask{};
+  task.buffer = this;
+  task.m_SetSize = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+  task.m_MinRange = 1;
+
+  auto* task_scheduler = App::get_system<TaskScheduler>(EngineSystems::TaskScheduler);
+  task_scheduler->schedule_task(&task);
+  task_scheduler->wait_task(&task);
+
+  TracyPlot("Occluder Triangles", static_cast<i64>(triangles.size()));
+}
+
+auto OcclusionBuffer::rasterize_reference(std::span<f32> depth_) const -> void {
+  ZoneScoped;
+
+  OX_ASSERT(depth_.size() == depth.size());
+  std::ranges::fill(depth_, 0.0f);
+  for (const auto& triangle : triangles) {
+    rasterize_triangle_scalar(triangle, depth_, width, 0, static_cast<i32>(height));
+  }
+}
+
+auto OcclusionBuffer::rasterize_triangle_scalar(
+    const Triangle& t, std::span<f32> depth, u32 width, i32 begin_row, i32 end_row) -> void {
+  const auto row_begin = ox::max(t.min_y, begin_row);
+  const auto row_end = ox::min(t.max_y + 1, end_row);
+  for (i32 y = row_begin; y < row_end; y++) {
+    const auto py = static_cast<f32>(y) + 0.5f;
+    auto* row = depth.data() + static_cast<usize>(y) * width;
+    for (i32 x = t.min_x; x <= t.max_x; x++) {
+      const auto px = static_cast<f32>(x) + 0.5f;
+      const auto b0 = (t.edge_a[0] * px + t.edge_b[0] * py) + t.edge_c[0];
+      const auto b1 = (t.edge_a[1] * px + t.edge_b[1] * py) + t.edge_c[1];
+      const auto b2 = (t.edge_a[2] * px + t.edge_b[2] * py) + t.edge_c[2];
+      if (b0 >= 0.0f && b1 >= 0.0f && b2 >= 0.0f) {
+        const auto z = (b0 * t.inv_w[0] + b1 * t.inv_w[1]) + b2 * t.inv_w[2];
+        row[x] = ox::max(row[x], z);
+      }
+    }
+  }
+}
+
+auto OcclusionBuffer::rasterize_rows(u32 begin_row, u32 end_row) -> void {
+  const auto begin = static_cast<i32>(begin_row);
+  const auto end = static_cast<i32>(end_row);
+
+  for (const auto& t : triangles) {
+    if (t.max_y < begin || t.min_y >= end)
+      continue;
+
+#ifdef OX_CULLING_SSE2
+    const auto row_begin = ox::max(t.min_y, begin);
+    const auto row_end = ox::min(t.max_y + 1, end);
+    const auto zero = _mm_setzero_ps();
+    const auto half = _mm_set1_ps(0.5f);
+    const auto lane_offsets = _mm_setr_epi32(0, 1, 2, 3);
+    const auto min_x = _mm_set1_epi32(t.min_x - 1);
+    const auto max_x = _mm_set1_epi32(t.max_x + 1);
+    for (i32 y = row_begin; y < row_end; y++) {
+      const auto py = _mm_set1_ps(static_cast<f32>(y) + 0.5f);
+      // The y terms are constant along the row, computed the same way as the scalar path.
+      __m128 row_terms[3];
+      for (u32 e = 0; e < 3; e++) {
+        row_terms[e] = _mm_mul_ps(_mm_set1_ps(t.edge_b[e]), py);
+      }
+
+      auto* row = depth.data() + static_cast<usize>(y) * width;
+      for (i32 x = t.min_x & ~3; x <= t.max_x; x += 4) {
+        const auto xs = _mm_add_epi32(_mm_set1_epi32(x), lane_offsets);
+        const auto px = _mm_add_ps(_mm_cvtepi32_ps(xs), half);
+        auto inside = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(xs, min_x), _mm_cmplt_epi32(xs, max_x)));
+
+        __m128 b[3];
+        for (u32 e = 0; e < 3; e++) {
+          b[e] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.edge_a[e]), px), row_terms[e]),
+                            _mm_set1_ps(t.edge_c[e]));
+          inside = _mm_and_ps(inside, _mm_cmpge_ps(b[e], zero));
+        }
+
+        if (_mm_movemask_ps(inside) == 0)
+          continue;
+
+        const auto z = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(b[0], _mm_set1_ps(t.inv_w[0])), _mm_mul_ps(b[1], _mm_set1_ps(t.inv_w[1]))),
+            _mm_mul_ps(b[2], _mm_set1_ps(t.inv_w[2])));
+        // Operands ordered so equal values pick the same one as ox::max.
+        const auto current = _mm_loadu_ps(row + x);
+        const auto result = _mm_or_ps(_mm_and_ps(inside, _mm_max_ps(z, current)), _mm_andnot_ps(inside, current));
+        _mm_storeu_ps(row + x, result);
+      }
+    }
+#else
+    rasterize_triangle_scalar(t, depth, width, begin, end);
+#endif
+  }
+}
+
+auto OcclusionBuffer::is_visible(const glm::vec3& center, const glm::vec3& extent) const -> bool {
+  if (width == 0 || height == 0)
+    return true;
+
+  const auto screen_size = glm::vec2(static_cast<f32>(width), static_cast<f32>(height));
+  auto min_xy = glm::vec2(std::numeric_limits<f32>::max());
+  auto max_xy = glm::vec2(std::numeric_limits<f32>::lowest());
+  auto nearest_inv_w = 0.0f;
+  for (u32 corner = 0; corner < 8; corner++) {
+    const auto offset = glm::vec3((corner & 1) ? extent.x : -extent.x,
+                                  (corner & 2) ? extent.y : -extent.y,
+                                  (corner & 4) ? extent.z : -extent.z);
+    const auto clip = projection_view * glm::vec4(center + offset, 1.0f);
+    // Boxes reaching the camera can't be tested against the buffer.
+    if (clip.w < NEAR_W)
+      return true;
+
+    const auto inv_w = 1.0f / clip.w;
+    const auto xy = (glm::vec2(clip) * inv_w * 0.5f + 0.5f) * screen_size;
+    min_xy = glm::min(min_xy, xy);
+    max_xy = glm::max(max_xy, xy);
+    nearest_inv_w = ox::max(nearest_inv_w, inv_w);
+  }
+
+  // Off screen, frustum culling decides.
+  if (max_xy.x < 0.0f || max_xy.y < 0.0f || min_xy.x >= screen_size.x || min_xy.y >= screen_size.y)
+    return true;
+
+  const auto rect_min = glm::ivec2(glm::clamp(glm::floor(min_xy), glm::vec2(0.0f), screen_size - 1.0f));
+  const auto rect_max = glm::ivec2(glm::clamp(glm::floor(max_xy), glm::vec2(0.0f), screen_size - 1.0f));
+  const auto x0 = rect_min.x;
+  const auto y0 = rect_min.y;
+  const auto x1 = rect_max.x;
+  const auto y1 = rect_max.y;
+
+  for (i32 y = y0; y <= y1; y++) {
+    const auto* row = depth.data() + static_cast<usize>(y) * width;
+    for (i32 x = x0; x <= x1; x++) {
+      if (row[x] <= nearest_inv_w)
+        return true;
+    }
+  }
+
+  return false;
+}
+
+auto OcclusionBuffer::cull_instances(const InstanceBounds& world_bounds,
+                                     std::span<u8> visibility,
+                                     u8 bit,
+                                     bool parallel) const -> void {
+  ZoneScoped;
+
+  OX_ASSERT(visibility.size() == world_bounds.size());
+  if (visibility.empty() || triangles.empty())
+    return;
+
+  auto task = CullTask{};
+  task.buffer = this;
+  task.bounds = &world_bounds;
+  task.visibility = visibility;
+  task.bit = bit;
+  task.m_SetSize = static_cast<u32>(visibility.size());
+  task.m_MinRange = 1024;
+
+  if (!parallel) {
+    task.ExecuteRange({.start = 0, .end = task.m_SetSize}, 0);
+    return;
+  }
+
+  auto* task_scheduler = App::get_system<TaskScheduler>(EngineSystems::TaskScheduler);
+  task_scheduler->schedule_task(&task);
+  task_scheduler->wait_task(&task);
+}
+} // namespace ox
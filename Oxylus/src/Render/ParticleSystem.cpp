@@ -1,139 +1,382 @@
 #include "Render/ParticleSystem.hpp"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <emmintrin.h>
+  #define OX_PARTICLES_SSE2 1
+#endif
+
+#include "Core/App.hpp"
+#include "Thread/TaskScheduler.hpp"
+
 namespace ox {
-ParticleSystem::ParticleSystem() : particles(10000) {
-  if (properties.play_on_awake)
-    play();
+auto ParticleBuffer::set_capacity(u32 capacity_) -> void {
+  position_x.resize(capacity_);
+  position_y.resize(capacity_);
+  position_z.resize(capacity_);
+  velocity_x.resize(capacity_);
+  velocity_y.resize(capacity_);
+  velocity_z.resize(capacity_);
+  life.resize(capacity_);
+  count = ox::min(count, capacity_);
+}
 
-  // TODO: m_Properties.Texture = Texture::GetBlankImage();
+auto ParticleBuffer::push(const glm::vec3& position, const glm::vec3& velocity, f32 life_) -> bool {
+  if (count >= capacity())
+    return false;
+
+  position_x[count] = position.x;
+  position_y[count] = position.y;
+  position_z[count] = position.z;
+  velocity_x[count] = velocity.x;
+  velocity_y[count] = velocity.y;
+  velocity_z[count] = velocity.z;
+  life[count] = life_;
+  count += 1;
+
+  return true;
 }
 
-void ParticleSystem::play() {
-  system_time = 0.0f;
-  playing = true;
+auto ParticleBuffer::remove_dead() -> u32 {
+  const auto previous_count = count;
+  for (u32 i = 0; i < count;) {
+    if (life[i] > 0.0f) {
+      i++;
+      continue;
+    }
+
+    // The particle moved in from the back is tested on the next iteration.
+    count -= 1;
+    position_x[i] = position_x[count];
+    position_y[i] = position_y[count];
+    position_z[i] = position_z[count];
+    velocity_x[i] = velocity_x[count];
+    velocity_y[i] = velocity_y[count];
+    velocity_z[i] = velocity_z[count];
+    life[i] = life[count];
+  }
+
+  return previous_count - count;
 }
 
-void ParticleSystem::stop(bool force) {
-  if (force) {
-    for (auto& particle : particles)
-      particle.life_remaining = 0.0f;
+namespace particles {
+auto get_simulate_params(const ParticleProperties& properties, f32 delta_time) -> ParticleSimulateParams {
+  auto params = ParticleSimulateParams{};
+  params.delta_time = delta_time;
+  params.inv_lifetime = properties.start_lifetime > 0.0f ? 1.0f / properties.start_lifetime : 0.0f;
+
+  if (properties.force_over_lifetime.enabled) {
+    params.force_start = properties.force_over_lifetime.start;
+    params.force_end = properties.force_over_lifetime.end;
   }
+  const auto gravity = glm::vec3(0.0f, properties.gravity_modifier * -9.8f, 0.0f);
+  params.force_start += gravity;
+  params.force_end += gravity;
 
-  system_time = properties.start_delay + properties.duration;
-  playing = false;
+  if (properties.velocity_over_lifetime.enabled) {
+    params.velocity_scale_start = properties.velocity_over_lifetime.start;
+    params.velocity_scale_end = properties.velocity_over_lifetime.end;
+  }
+
+  return params;
 }
 
-void ParticleSystem::on_update(float ts, const glm::vec3& position) {
-  ZoneScoped;
-  const float simTs = ts * properties.simulation_speed;
+auto simulate_scalar(ParticleBuffer& buffer, const ParticleSimulateParams& params, u32 begin, u32 end) -> void {
+  const auto dt = params.delta_time;
+  const auto force_delta = params.force_start - params.force_end;
+  const auto scale_delta = params.velocity_scale_start - params.velocity_scale_end;
 
-  if (playing && !properties.looping)
-    system_time += simTs;
-  const float delay = properties.start_delay;
-  if (playing && (properties.looping || (system_time <= delay + properties.duration && system_time > delay))) {
-    // Emit particles in unit time
-    spawn_time += simTs;
-    if (spawn_time >= 1.0f / static_cast<float>(properties.rate_over_time)) {
-      spawn_time = 0.0f;
-      emit(position, 1);
-    }
+  for (u32 i = begin; i < end; i++) {
+    const auto life = buffer.life[i] - dt;
+    // One at birth, zero at death, like the modules expect.
+    const auto t = glm::clamp(life * params.inv_lifetime, 0.0f, 1.0f);
 
-    // Emit particles over unit distance
-    if (glm::distance2(last_spawned_position, position) > 1.0f) {
-      last_spawned_position = position;
-      emit(position, properties.rate_over_distance);
-    }
+    const auto vx = buffer.velocity_x[i] + (params.force_end.x + force_delta.x * t) * dt;
+    const auto vy = buffer.velocity_y[i] + (params.force_end.y + force_delta.y * t) * dt;
+    const auto vz = buffer.velocity_z[i] + (params.force_end.z + force_delta.z * t) * dt;
 
-    // Emit bursts of particles over time
-    burst_time += simTs;
-    if (burst_time >= properties.burst_time) {
-      burst_time = 0.0f;
-      emit(position, properties.burst_count);
-    }
+    buffer.position_x[i] += vx * (params.velocity_scale_end.x + scale_delta.x * t) * dt;
+    buffer.position_y[i] += vy * (params.velocity_scale_end.y + scale_delta.y * t) * dt;
+    buffer.position_z[i] += vz * (params.velocity_scale_end.z + scale_delta.z * t) * dt;
+    buffer.velocity_x[i] = vx;
+    buffer.velocity_y[i] = vy;
+    buffer.velocity_z[i] = vz;
+    buffer.life[i] = life;
   }
+}
 
-  // Simulate
-  active_particle_count = 0;
-  for (auto& particle : particles) {
-    if (particle.life_remaining <= 0.0f)
-      continue;
+auto simulate(ParticleBuffer& buffer, const ParticleSimulateParams& params, u32 begin, u32 end) -> void {
+  auto i = begin;
+
+#ifdef OX_PARTICLES_SSE2
+  const auto dt = _mm_set1_ps(params.delta_time);
+  const auto inv_lifetime = _mm_set1_ps(params.inv_lifetime);
+  const auto zero = _mm_setzero_ps();
+  const auto one = _mm_set1_ps(1.0f);
+  const auto force_end_x = _mm_set1_ps(params.force_end.x);
+  const auto force_end_y = _mm_set1_ps(params.force_end.y);
+  const auto force_end_z = _mm_set1_ps(params.force_end.z);
+  const auto force_delta_x = _mm_set1_ps(params.force_start.x - params.force_end.x);
+  const auto force_delta_y = _mm_set1_ps(params.force_start.y - params.force_end.y);
+  const auto force_delta_z = _mm_set1_ps(params.force_start.z - params.force_end.z);
+  const auto scale_end_x = _mm_set1_ps(params.velocity_scale_end.x);
+  const auto scale_end_y = _mm_set1_ps(params.velocity_scale_end.y);
+  const auto scale_end_z = _mm_set1_ps(params.velocity_scale_end.z);
+  const auto scale_delta_x = _mm_set1_ps(params.velocity_scale_start.x - params.velocity_scale_end.x);
+  const auto scale_delta_y = _mm_set1_ps(params.velocity_scale_start.y - params.velocity_scale_end.y);
+  const auto scale_delta_z = _mm_set1_ps(params.velocity_scale_start.z - params.velocity_scale_end.z);
 
-    particle.life_remaining -= simTs;
+  for (; i + 4 <= end; i += 4) {
+    const auto life = _mm_sub_ps(_mm_loadu_ps(&buffer.life[i]), dt);
+    const auto t = _mm_min_ps(_mm_max_ps(_mm_mul_ps(life, inv_lifetime), zero), one);
 
-    const float t = glm::clamp(particle.life_remaining / properties.start_lifetime, 0.0f, 1.0f);
+    // Same operation order as `simulate_scalar`.
+    const auto vx = _mm_add_ps(_mm_loadu_ps(&buffer.velocity_x[i]),
+                               _mm_mul_ps(_mm_add_ps(force_end_x, _mm_mul_ps(force_delta_x, t)), dt));
+    const auto vy = _mm_add_ps(_mm_loadu_ps(&buffer.velocity_y[i]),
+                               _mm_mul_ps(_mm_add_ps(force_end_y, _mm_mul_ps(force_delta_y, t)), dt));
+    const auto vz = _mm_add_ps(_mm_loadu_ps(&buffer.velocity_z[i]),
+                               _mm_mul_ps(_mm_add_ps(force_end_z, _mm_mul_ps(force_delta_z, t)), dt));
 
-    glm::vec3 velocity = properties.start_velocity;
-    if (properties.velocity_over_lifetime.enabled)
-      velocity *= properties.velocity_over_lifetime.evaluate(t);
+    const auto sx = _mm_add_ps(scale_end_x, _mm_mul_ps(scale_delta_x, t));
+    const auto sy = _mm_add_ps(scale_end_y, _mm_mul_ps(scale_delta_y, t));
+    const auto sz = _mm_add_ps(scale_end_z, _mm_mul_ps(scale_delta_z, t));
+    _mm_storeu_ps(&buffer.position_x[i],
+                  _mm_add_ps(_mm_loadu_ps(&buffer.position_x[i]), _mm_mul_ps(_mm_mul_ps(vx, sx), dt)));
+    _mm_storeu_ps(&buffer.position_y[i],
+                  _mm_add_ps(_mm_loadu_ps(&buffer.position_y[i]), _mm_mul_ps(_mm_mul_ps(vy, sy), dt)));
+    _mm_storeu_ps(&buffer.position_z[i],
+                  _mm_add_ps(_mm_loadu_ps(&buffer.position_z[i]), _mm_mul_ps(_mm_mul_ps(vz, sz), dt)));
+    _mm_storeu_ps(&buffer.velocity_x[i], vx);
+    _mm_storeu_ps(&buffer.velocity_y[i], vy);
+    _mm_storeu_ps(&buffer.velocity_z[i], vz);
+    _mm_storeu_ps(&buffer.life[i], life);
+  }
+#endif
 
-    glm::vec3 force(0.0f);
-    if (properties.force_over_lifetime.enabled)
-      force = properties.force_over_lifetime.evaluate(t);
+  simulate_scalar(buffer, params, i, end);
+}
 
-    force.y += properties.gravity_modifier * -9.8f;
-    velocity += force * simTs;
+auto write_instances(const ParticleBuffer& buffer,
+                     const ParticleProperties& properties,
+                     std::vector<ParticleInstance>& instances) -> void {
+  const auto inv_lifetime = properties.start_lifetime > 0.0f ? 1.0f / properties.start_lifetime : 0.0f;
+  const auto needs_speed = properties.color_by_speed.enabled || properties.size_by_speed.enabled ||
+                           properties.rotation_by_speed.enabled;
 
-    const float velocityMagnitude = glm::length(velocity);
+  const auto offset = instances.size();
+  instances.resize(offset + buffer.count);
+  for (u32 i = 0; i < buffer.count; i++) {
+    const auto t = glm::clamp(buffer.life[i] * inv_lifetime, 0.0f, 1.0f);
 
-    // Color
-    particle.color = properties.start_color;
+    auto speed = 0.0f;
+    if (needs_speed) {
+      auto velocity = glm::vec3(buffer.velocity_x[i], buffer.velocity_y[i], buffer.velocity_z[i]);
+      if (properties.velocity_over_lifetime.enabled)
+        velocity *= properties.velocity_over_lifetime.evaluate(t);
+      speed = glm::length(velocity);
+    }
+
+    auto& instance = instances[offset + i];
+    instance.position = glm::vec3(buffer.position_x[i], buffer.position_y[i], buffer.position_z[i]);
+
+    instance.color = properties.start_color;
     if (properties.color_over_lifetime.enabled)
-      particle.color *= properties.color_over_lifetime.evaluate(t);
+      instance.color *= properties.color_over_lifetime.evaluate(t);
     if (properties.color_by_speed.enabled)
-      particle.color *= properties.color_by_speed.evaluate(velocityMagnitude);
+      instance.color *= properties.color_by_speed.evaluate(speed);
 
-    // Size
-    particle.size = properties.start_size;
+    instance.size = properties.start_size;
     if (properties.size_over_lifetime.enabled)
-      particle.size *= properties.size_over_lifetime.evaluate(t);
+      instance.size *= properties.size_over_lifetime.evaluate(t);
     if (properties.size_by_speed.enabled)
-      particle.size *= properties.size_by_speed.evaluate(velocityMagnitude);
+      instance.size *= properties.size_by_speed.evaluate(speed);
 
-    // Rotation
-    particle.rotation = properties.start_rotation;
+    instance.rotation = properties.start_rotation;
     if (properties.rotation_over_lifetime.enabled)
-      particle.rotation += properties.rotation_over_lifetime.evaluate(t);
+      instance.rotation += properties.rotation_over_lifetime.evaluate(t);
     if (properties.rotation_by_speed.enabled)
-      particle.rotation += properties.rotation_by_speed.evaluate(velocityMagnitude);
+      instance.rotation += properties.rotation_by_speed.evaluate(speed);
+  }
+}
+} // namespace particles
 
-    particle.position += velocity * simTs;
-    ++active_particle_count;
+auto ParticleSystem::Emitter::emit(u32 count) -> void {
+  count = ox::min(count, particles.capacity() - particles.count);
+  for (u32 i = 0; i < count; i++) {
+    const auto offset = glm::vec3(random.get_float(properties.position_start.x, properties.position_end.x),
+                                  random.get_float(properties.position_start.y, properties.position_end.y),
+                                  random.get_float(properties.position_start.z, properties.position_end.z));
+    particles.push(position + offset, properties.start_velocity, properties.start_lifetime);
   }
+
+  emitted_count += count;
 }
 
-void ParticleSystem::on_render() const {
-  for (const auto& particle : particles) {
-    if (particle.life_remaining <= 0.0f)
-      continue;
+auto ParticleSystem::Emitter::update(f32 delta_time) -> void {
+  ZoneScopedN("Update Particle Emitter");
+
+  const auto sim_delta_time = delta_time * properties.simulation_speed;
+
+  // Particles emitted below start with their full life, so existing ones are stepped first.
+  const auto params = particles::get_simulate_params(properties, sim_delta_time);
+  particles::simulate(particles, params, 0, particles.count);
+  killed_count = particles.remove_dead();
+  emitted_count = 0;
+
+  if (playing && !properties.looping)
+    system_time += sim_delta_time;
+  const auto delay = properties.start_delay;
+  if (playing && (properties.looping || (system_time <= delay + properties.duration && system_time > delay))) {
+    // Fractions carry over, so rates above the frame rate emit several particles per update.
+    spawn_accumulator += sim_delta_time * static_cast<f32>(properties.rate_over_time);
+    const auto spawn_count = static_cast<u32>(spawn_accumulator);
+    spawn_accumulator -= static_cast<f32>(spawn_count);
+    emit(spawn_count);
 
-    glm::mat4 transform = glm::translate(glm::mat4(1.0f), particle.position) * glm::mat4(glm::quat(particle.rotation)) *
-                          glm::scale(glm::mat4(1.0f), particle.size);
+    if (properties.rate_over_distance > 0) {
+      distance_accumulator += glm::distance(last_position, position) * static_cast<f32>(properties.rate_over_distance);
+      const auto distance_count = static_cast<u32>(distance_accumulator);
+      distance_accumulator -= static_cast<f32>(distance_count);
+      emit(distance_count);
+    }
 
-    // Renderer::SubmitQuad(transform, m_Properties.Texture, particle.Color);
+    burst_time += sim_delta_time;
+    if (burst_time >= properties.burst_time) {
+      burst_time = 0.0f;
+      emit(properties.burst_count);
+    }
   }
+  last_position = position;
+
+  instances.clear();
+  particles::write_instances(particles, properties, instances);
 }
 
-static float RandomFloat(float min, float max) {
-  const float r = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
-  return min + r * (max - min);
+struct ParticleSystem::UpdateTask : ITaskSet {
+  std::span<Emitter*> emitters = {};
+  f32 delta_time = 0.0f;
+
+  void ExecuteRange(const enki::TaskSetPartition range, u32) override {
+    for (u32 i = range.start; i < range.end; i++) {
+      emitters[i]->update(delta_time);
+    }
+  }
+};
+
+auto ParticleSystem::create_emitter(const ParticleProperties& properties, const glm::vec3& position, u64 seed)
+    -> ParticleEmitterID {
+  ZoneScoped;
+
+  auto emitter = Emitter{};
+  emitter.properties = properties;
+  emitter.particles.set_capacity(properties.max_particles);
+  emitter.random = FastRandom(seed != 0 ? seed : Random::get_uint(), emitters.capacity());
+  emitter.position = position;
+  emitter.last_position = position;
+
+  return emitters.create_slot(std::move(emitter));
 }
 
-void ParticleSystem::emit(const glm::vec3& position, uint32_t count) {
-  if (active_particle_count >= properties.max_particles)
-    return;
+auto ParticleSystem::destroy_emitter(ParticleEmitterID emitter_id) -> void {
+  ZoneScoped;
 
-  for (uint32_t i = 0; i < count; ++i) {
-    if (++pool_index >= 10000)
-      pool_index = 0;
+  if (auto* emitter = emitters.slot(emitter_id)) {
+    // Slots are reused, don't keep the memory of a big emitter around.
+    *emitter = {};
+    emitters.destroy_slot(emitter_id);
+  }
+}
 
-    auto& particle = particles[pool_index];
+auto ParticleSystem::reset() -> void {
+  emitters.reset();
+  update_list.clear();
+  stats = {};
+}
+
+auto ParticleSystem::set_properties(ParticleEmitterID emitter_id, const ParticleProperties& properties) -> void {
+  if (auto* emitter = emitters.slot(emitter_id)) {
+    emitter->properties = properties;
+    if (emitter->particles.capacity() != properties.max_particles)
+      emitter->particles.set_capacity(properties.max_particles);
+  }
+}
+
+auto ParticleSystem::set_position(ParticleEmitterID emitter_id, const glm::vec3& position) -> void {
+  if (auto* emitter = emitters.slot(emitter_id))
+    emitter->position = position;
+}
 
-    particle.position = position;
-    particle.position.x += RandomFloat(properties.position_start.x, properties.position_end.x);
-    particle.position.y += RandomFloat(properties.position_start.y, properties.position_end.y);
-    particle.position.z += RandomFloat(properties.position_start.z, properties.position_end.z);
+auto ParticleSystem::play(ParticleEmitterID emitter_id) -> void {
+  if (auto* emitter = emitters.slot(emitter_id)) {
+    emitter->system_time = 0.0f;
+    emitter->playing = true;
+  }
+}
+
+auto ParticleSystem::stop(ParticleEmitterID emitter_id, bool force) -> void {
+  if (auto* emitter = emitters.slot(emitter_id)) {
+    if (force) {
+      emitter->particles.clear();
+      emitter->instances.clear();
+    }
+
+    emitter->system_time = emitter->properties.start_delay + emitter->properties.duration;
+    emitter->playing = false;
+  }
+}
+
+auto ParticleSystem::is_playing(ParticleEmitterID emitter_id) -> bool {
+  const auto* emitter = emitters.slot(emitter_id);
+  return emitter && emitter->playing;
+}
+
+auto ParticleSystem::get_particle_count(ParticleEmitterID emitter_id) -> u32 {
+  const auto* emitter = emitters.slot(emitter_id);
+  return emitter ? emitter->particles.count : 0;
+}
+
+auto ParticleSystem::update(f32 delta_time) -> void {
+  ZoneScoped;
+
+  update_list.clear();
+  for (usize i = 0; i < emitters.capacity(); i++) {
+    if (auto* emitter = emitters.slot_from_index(i))
+      update_list.push_back(emitter);
+  }
+
+  if (!update_list.empty()) {
+    auto task = UpdateTask{};
+    task.emitters = update_list;
+    task.delta_time = delta_time;
+    task.m_SetSize = static_cast<u32>(update_list.size());
+    task.m_MinRange = 1;
+
+    auto* task_scheduler = App::get_system<TaskScheduler>(EngineSystems::TaskScheduler);
+    task_scheduler->schedule_task(&task);
+    task_scheduler->wait_task(&task);
+  }
+
+  stats = {};
+  stats.emitter_count = static_cast<u32>(update_list.size());
+  for (const auto* emitter : update_list) {
+    stats.particle_count += emitter->particles.count;
+    stats.emitted_count += emitter->emitted_count;
+    stats.killed_count += emitter->killed_count;
+  }
+
+  TracyPlot("Particle Emitters", static_cast<i64>(stats.emitter_count));
+  TracyPlot("Particles", static_cast<i64>(stats.particle_count));
+}
+
+auto ParticleSystem::collect(std::vector<ParticleInstance>& instances) -> void {
+  ZoneScoped;
 
-    particle.life_remaining = properties.start_lifetime;
+  instances.clear();
+  instances.reserve(stats.particle_count);
+  // Emitters may have been created or destroyed since the update, so `update_list` is stale.
+  for (usize i = 0; i < emitters.capacity(); i++) {
+    if (const auto* emitter = emitters.slot_from_index(i))
+      instances.insert(instances.end(), emitter->instances.begin(), emitter->instances.end());
   }
 }
 } // namespace ox
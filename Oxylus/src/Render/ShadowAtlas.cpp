@@ -0,0 +1,306 @@
+#include "Render/ShadowAtlas.hpp"
+
+#include <bit>
+#include <numeric>
+
+#include "Utils/OxMath.hpp"
+
+namespace ox {
+auto ShadowAtlas::ViewKeyHash::operator()(const ShadowViewKey& key) const noexcept -> u64 {
+  using namespace ankerl::unordered_dense::detail;
+  return wyhash::mix(wyhash::hash(key.light), key.face);
+}
+
+auto ShadowAtlas::set_size(u32 size_) -> void {
+  if (size == size_)
+    return;
+
+  size = size_;
+  invalidated = true;
+  resized = true;
+}
+
+auto ShadowAtlas::find_view(const ShadowViewKey& key) const -> const ShadowAtlasView* {
+  const auto it = indices.find(key);
+  return it != indices.end() ? &views[it->second] : nullptr;
+}
+
+auto ShadowAtlas::update(std::span<const ShadowViewRequest> requests, const InstanceBounds& moved_bounds) -> void {
+  ZoneScoped;
+
+  std::swap(views, previous_views);
+  std::swap(indices, previous_indices);
+
+  views.resize(requests.size());
+  indices.clear();
+  for (u32 i = 0; i < requests.size(); i++) {
+    auto& view = views[i];
+    view.key = requests[i].key;
+    view.requested_resolution = requests[i].resolution;
+    view.view_projection = requests[i].view_projection;
+    indices.emplace(view.key, i);
+  }
+
+  pack(requests);
+
+  this->dirty_count = 0;
+  for (auto& view : views) {
+    if (view.size == 0) {
+      view.dirty = false;
+      continue;
+    }
+
+    view.dirty = invalidated || invalidated_keys.contains(view.key);
+    if (!view.dirty) {
+      const auto it = previous_indices.find(view.key);
+      const auto* previous = it != previous_indices.end() ? &previous_views[it->second] : nullptr;
+      view.dirty = !previous || previous->x != view.x || previous->y != view.y || previous->size != view.size ||
+                   previous->view_projection != view.view_projection;
+    }
+
+    if (!view.dirty && moved_bounds.size() != 0) {
+      auto view_projection = view.view_projection;
+      auto frustum = CullFrustum{};
+      math::calc_frustum_planes(view_projection, frustum.planes);
+      for (usize i = 0; i < moved_bounds.size() && !view.dirty; i++) {
+        view.dirty = instance_culling::is_visible(moved_bounds, i, frustum);
+      }
+    }
+
+    this->dirty_count += view.dirty ? 1 : 0;
+  }
+
+  invalidated = false;
+  invalidated_keys.clear();
+  resized = false;
+
+  TracyPlot("Shadow Views", static_cast<i64>(views.size()));
+  TracyPlot("Dirty Shadow Views", static_cast<i64>(this->dirty_count));
+}
+
+auto ShadowAtlas::pack(std::span<const ShadowViewRequest> requests) -> void {
+  ZoneScoped;
+
+  auto max_resolution = 0_u32;
+  for (const auto& request : requests) {
+    max_resolution = ox::max(max_resolution, request.resolution);
+  }
+
+  const auto get_resolution = [this, requests](usize i) {
+    const auto shifted = requests[i].resolution >> this->resolution_shift;
+    return ox::min(ox::max(shifted, shadow_atlas::MIN_RESOLUTION), size);
+  };
+
+  // Power of two squares placed largest first never leave a gap, whatever fits by area
+  // fits in the atlas. Halve every view until the largest one reaches the minimum, then
+  // drop views from the back, callers put the most important ones first.
+  auto count = requests.size();
+  this->resolution_shift = 0;
+  while (count > 0) {
+    auto area = 0_u64;
+    for (usize i = 0; i < count; i++) {
+      const auto resolution = static_cast<u64>(get_resolution(i));
+      area += resolution * resolution;
+    }
+
+    if (area <= static_cast<u64>(size) * size)
+      break;
+
+    if ((max_resolution >> this->resolution_shift) > shadow_atlas::MIN_RESOLUTION)
+      this->resolution_shift += 1;
+    else
+      count -= 1;
+  }
+
+  pack_order.resize(count);
+  std::iota(pack_order.begin(), pack_order.end(), 0_u32);
+  std::ranges::stable_sort(pack_order, [&](u32 a, u32 b) { return get_resolution(a) > get_resolution(b); });
+
+  for (auto& view : views) {
+    view.x = 0;
+    view.y = 0;
+    view.size = 0;
+  }
+
+  // Views that didn't change resolution stay where they were, only the rest is placed.
+  nodes.assign(1, Node{});
+  if (!resized) {
+    for (usize i = 0; i < count; i++) {
+      auto& view = views[i];
+      const auto it = previous_indices.find(view.key);
+      if (it == previous_indices.end())
+        continue;
+
+      const auto& previous = previous_views[it->second];
+      const auto aligned = previous.size != 0 && previous.x % previous.size == 0 && previous.y % previous.size == 0;
+      if (aligned && previous.size == get_resolution(i) &&
+          insert(0, 0, 0, size, previous.x, previous.y, previous.size)) {
+        view.x = previous.x;
+        view.y = previous.y;
+        view.size = previous.size;
+      }
+    }
+  }
+
+  auto placed = true;
+  for (const auto i : pack_order) {
+    if (views[i].size == 0 && !allocate(0, 0, 0, size, get_resolution(i), views[i])) {
+      placed = false;
+      break;
+    }
+  }
+
+  // The kept rects split the free space up too much, start over.
+  if (!placed) {
+    nodes.assign(1, Node{});
+    for (const auto i : pack_order) {
+      views[i].size = 0;
+      allocate(0, 0, 0, size, get_resolution(i), views[i]);
+    }
+  }
+}
+
+auto ShadowAtlas::split(u32 node) -> void {
+  const auto first_child = static_cast<u32>(nodes.size());
+  nodes.resize(nodes.size() + 4);
+  nodes[node].first_child = first_child;
+}
+
+auto ShadowAtlas::insert(u32 node, u32 x, u32 y, u32 node_size, u32 rect_x, u32 rect_y, u32 rect_size) -> bool {
+  if (nodes[node].taken || node_size < rect_size)
+    return false;
+
+  if (node_size == rect_size) {
+    if (nodes[node].first_child != 0 || rect_x != x || rect_y != y)
+      return false;
+
+    nodes[node].taken = true;
+    return true;
+  }
+
+  if (nodes[node].first_child == 0)
+    split(node);
+
+  const auto half = node_size / 2;
+  const auto right = rect_x >= x + half ? 1_u32 : 0_u32;
+  const auto bottom = rect_y >= y + half ? 1_u32 : 0_u32;
+  return insert(
+      nodes[node].first_child + right + 2 * bottom, x + right * half, y + bottom * half, half, rect_x, rect_y, rect_size);
+}
+
+auto ShadowAtlas::allocate(u32 node, u32 x, u32 y, u32 node_size, u32 rect_size, ShadowAtlasView& view) -> bool {
+  if (nodes[node].taken || node_size < rect_size)
+    return false;
+
+  if (nodes[node].first_child == 0) {
+    if (node_size == rect_size) {
+      nodes[node].taken = true;
+      view.x = x;
+      view.y = y;
+      view.size = rect_size;
+      return true;
+    }
+
+    split(node);
+  } else if (node_size == rect_size) {
+    return false;
+  }
+
+  const auto half = node_size / 2;
+  for (u32 child = 0; child < 4; child++) {
+    if (allocate(nodes[node].first_child + child, x + (child & 1) * half, y + (child >> 1) * half, half, rect_size, view))
+      return true;
+  }
+
+  return false;
+}
+
+namespace shadow_atlas {
+auto get_screen_importance(const CullFrustum& frustum,
+                           const glm::vec3& camera_position,
+                           f32 projection_scale,
+                           const glm::vec3& center,
+                           f32 radius) -> f32 {
+  for (const auto& plane : frustum.planes) {
+    if (glm::dot(glm::vec3(plane), center) - plane.w < -radius)
+      return 0.0f;
+  }
+
+  const auto distance = glm::distance(camera_position, center);
+  if (distance <= radius)
+    return 1.0f;
+
+  return glm::clamp(radius * projection_scale / distance, 0.0f, 1.0f);
+}
+
+auto select_resolution(u32 max_resolution, f32 importance, u32 previous_resolution, f32 hysteresis) -> u32 {
+  const auto max_res = std::bit_floor(ox::max(max_resolution, MIN_RESOLUTION));
+  const auto select = [max_res](f32 scale) {
+    const auto scaled = static_cast<u32>(static_cast<f32>(max_res) * glm::clamp(scale, 0.0f, 1.0f));
+    return glm::clamp(std::bit_floor(ox::max(scaled, 1_u32)), MIN_RESOLUTION, max_res);
+  };
+
+  const auto resolution = select(importance);
+  if (previous_resolution == 0 || resolution == previous_resolution)
+    return resolution;
+
+  if (resolution > previous_resolution)
+    return ox::max(select(importance * (1.0f - hysteresis)), ox::min(previous_resolution, max_res));
+
+  return ox::min(select(importance * (1.0f + hysteresis)), previous_resolution);
+}
+
+static auto get_up_vector(const glm::vec3& direction) -> glm::vec3 {
+  return glm::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+static auto get_perspective(f32 fov, f32 range) -> glm::mat4 {
+  auto projection = glm::perspective(fov, 1.0f, range, ox::max(range * 0.005f, 0.01f)); // reversed-z
+  projection[1][1] *= -1.0f;
+  return projection;
+}
+
+auto get_spot_view_projection(const glm::vec3& position, const glm::vec3& direction, f32 range, f32 outer_cone_angle)
+    -> glm::mat4 {
+  const auto fov = glm::clamp(outer_cone_angle * 2.0f, glm::radians(1.0f), glm::radians(170.0f));
+  const auto view = glm::lookAt(position, position + direction, get_up_vector(direction));
+  return get_perspective(fov, range) * view;
+}
+
+auto get_point_view_projection(const glm::vec3& position, f32 range, u32 face) -> glm::mat4 {
+  constexpr static glm::vec3 FACE_DIRECTIONS[CUBE_FACE_COUNT] = {
+      {1.0f, 0.0f, 0.0f},
+      {-1.0f, 0.0f, 0.0f},
+      {0.0f, 1.0f, 0.0f},
+      {0.0f, -1.0f, 0.0f},
+      {0.0f, 0.0f, 1.0f},
+      {0.0f, 0.0f, -1.0f},
+  };
+
+  const auto& direction = FACE_DIRECTIONS[face];
+  const auto view = glm::lookAt(position, position + direction, get_up_vector(direction));
+  return get_perspective(glm::radians(90.0f), range) * view;
+}
+
+auto get_directional_view_projection(const glm::vec3& direction, const glm::vec3& center, f32 radius, u32 resolution)
+    -> glm::mat4 {
+  const auto forward = -glm::normalize(direction);
+  const auto view = glm::lookAt(glm::vec3(0.0f), forward, get_up_vector(forward));
+
+  const auto texel_size = 2.0f * radius / static_cast<f32>(resolution);
+  auto light_center = glm::vec3(view * glm::vec4(center, 1.0f));
+  light_center = glm::floor(light_center / texel_size) * texel_size;
+
+  // Casters up to a few radii towards the light still throw shadows into the sphere.
+  auto projection = glm::ortho(light_center.x - radius,
+                               light_center.x + radius,
+                               light_center.y - radius,
+                               light_center.y + radius,
+                               -(light_center.z - radius),
+                               -(light_center.z + 4.0f * radius)); // reversed-z
+  projection[1][1] *= -1.0f;
+
+  return projection * view;
+}
+} // namespace shadow_atlas
+} // namespace ox
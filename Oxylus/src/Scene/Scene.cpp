@@ -31,6 +31,7 @@
 #include "Scene/ECSModule/Core.hpp"
 #include "Scene/SceneEvents.hpp"
 #include "Scripting/LuaManager.hpp"
+#include "Scripting/LuaQuery.hpp"
 #include "Utils/JsonHelpers.hpp"
 #include "Utils/JsonWriter.hpp"
 #include "Utils/Timestep.hpp"
@@ -197,13 +198,84 @@ auto ComponentDB::is_component_known(this ComponentDB& self, flecs::id component
 
 auto ComponentDB::get_components(this ComponentDB& self) -> std::span<flecs::id> { return self.components; }
 
+static auto get_audio_voice_params(const Scene& scene, flecs::entity entity, const AudioSourceComponent& ac)
+    -> AudioVoiceParams {
+  const auto world_transform = scene.get_world_transform(entity);
+  return {
+      .attenuation_model = ac.attenuation_model,
+      .volume = ac.volume,
+      .pitch = ac.pitch,
+      .looping = ac.looping,
+      .spatialization = ac.spatialization,
+      .roll_off = ac.roll_off,
+      .min_gain = ac.min_gain,
+      .max_gain = ac.max_gain,
+      .min_distance = ac.min_distance,
+      .max_distance = ac.max_distance,
+      .cone_inner_angle = ac.cone_inner_angle,
+      .cone_outer_angle = ac.cone_outer_angle,
+      .cone_outer_gain = ac.cone_outer_gain,
+      .doppler_factor = ac.doppler_factor,
+      .position = glm::vec3(world_transform[3]),
+      .direction = -glm::normalize(glm::vec3(world_transform[2])),
+  };
+}
+
+static auto get_particle_properties(const ParticleSystemComponent& pc) -> ParticleProperties {
+  auto properties = ParticleProperties{
+      .duration = pc.duration,
+      .looping = pc.looping,
+      .start_delay = pc.start_delay,
+      .start_lifetime = pc.start_lifetime,
+      .start_velocity = pc.start_velocity,
+      .start_color = pc.start_color,
+      .start_size = pc.start_size,
+      .start_rotation = pc.start_rotation,
+      .gravity_modifier = pc.gravity_modifier,
+      .simulation_speed = pc.simulation_speed,
+      .play_on_awake = pc.play_on_awake,
+      .max_particles = pc.max_particles,
+      .rate_over_time = pc.rate_over_time,
+      .rate_over_distance = pc.rate_over_distance,
+      .burst_count = pc.burst_count,
+      .burst_time = pc.burst_time,
+      .position_start = pc.position_start,
+      .position_end = pc.position_end,
+  };
+
+  properties.velocity_over_lifetime = {pc.velocity_over_lifetime_start, pc.velocity_over_lifetime_end};
+  properties.velocity_over_lifetime.enabled = pc.velocity_over_lifetime;
+  properties.force_over_lifetime = {pc.force_over_lifetime_start, pc.force_over_lifetime_end};
+  properties.force_over_lifetime.enabled = pc.force_over_lifetime;
+  properties.color_over_lifetime = {pc.color_over_lifetime_start, pc.color_over_lifetime_end};
+  properties.color_over_lifetime.enabled = pc.color_over_lifetime;
+  properties.color_by_speed = {pc.color_by_speed_start, pc.color_by_speed_end};
+  properties.color_by_speed.min_speed = pc.color_by_speed_min_speed;
+  properties.color_by_speed.max_speed = pc.color_by_speed_max_speed;
+  properties.color_by_speed.enabled = pc.color_by_speed;
+  properties.size_over_lifetime = {pc.size_over_lifetime_start, pc.size_over_lifetime_end};
+  properties.size_over_lifetime.enabled = pc.size_over_lifetime;
+  properties.size_by_speed = {pc.size_by_speed_start, pc.size_by_speed_end};
+  properties.size_by_speed.min_speed = pc.size_by_speed_min_speed;
+  properties.size_by_speed.max_speed = pc.size_by_speed_max_speed;
+  properties.size_by_speed.enabled = pc.size_by_speed;
+  properties.rotation_over_lifetime = {pc.rotation_over_lifetime_start, pc.rotation_over_lifetime_end};
+  properties.rotation_over_lifetime.enabled = pc.rotation_over_lifetime;
+  properties.rotation_by_speed = {pc.rotation_by_speed_start, pc.rotation_by_speed_end};
+  properties.rotation_by_speed.min_speed = pc.rotation_by_speed_min_speed;
+  properties.rotation_by_speed.max_speed = pc.rotation_by_speed_max_speed;
+  properties.rotation_by_speed.enabled = pc.rotation_by_speed;
+
+  return properties;
+}
+
 Scene::Scene(const std::shared_ptr<RenderPipeline>& render_pipeline) { this->init("Untitled", render_pipeline); }
 
 Scene::Scene(const std::string& name) { init(name); }
 
 Scene::~Scene() {
-  const auto* lua_manager = App::get_system<LuaManager>(EngineSystems::LuaManager);
-  lua_manager->get_state()->collect_gc();
+  auto* lua_manager = App::get_system<LuaManager>(EngineSystems::LuaManager);
+  lua_manager->request_full_gc();
 
   if (running)
     runtime_stop();
@@ -285,6 +357,44 @@ auto Scene::init(this Scene& self, const std::string& name, const std::shared_pt
         }
       });
 
+  // Voices only hear about changed sources, the voice manager forwards the fields that differ.
+  // Moved parents mark their sources in `set_dirty`, everything marked is sent once per frame.
+  self.world.observer<const TransformComponent, AudioSourceComponent>()
+      .event(flecs::OnSet)
+      .event(flecs::OnRemove)
+      .each([&self](flecs::iter& it, usize i, const TransformComponent&, AudioSourceComponent& ac) {
+        if (ac.voice_id == AudioVoiceID::Invalid)
+          return;
+
+        if (it.event() == flecs::OnSet) {
+          self.audio_sources.mark_dirty(it.entity(i));
+        } else if (it.event() == flecs::OnRemove) {
+          auto& voices = App::get_system<AudioEngine>(EngineSystems::AudioEngine)->get_voice_manager();
+          voices.destroy_voice(ac.voice_id);
+          ac.voice_id = AudioVoiceID::Invalid;
+        }
+      });
+
+  // Emitters pick up edits right away, components added while running get an emitter here too.
+  self.world.observer<const TransformComponent, ParticleSystemComponent>()
+      .event(flecs::OnSet)
+      .event(flecs::OnRemove)
+      .each([&self](flecs::iter& it, usize i, const TransformComponent&, ParticleSystemComponent& pc) {
+        if (it.event() == flecs::OnSet) {
+          if (pc.emitter_id != ParticleEmitterID::Invalid) {
+            self.particle_system.set_properties(pc.emitter_id, get_particle_properties(pc));
+          } else if (self.is_running()) {
+            const auto position = glm::vec3(self.get_world_transform(it.entity(i))[3]);
+            pc.emitter_id = self.particle_system.create_emitter(get_particle_properties(pc), position);
+            if (pc.play_on_awake)
+              self.particle_system.play(pc.emitter_id);
+          }
+        } else if (it.event() == flecs::OnRemove && pc.emitter_id != ParticleEmitterID::Invalid) {
+          self.particle_system.destroy_emitter(pc.emitter_id);
+          pc.emitter_id = ParticleEmitterID::Invalid;
+        }
+      });
+
   // Systems run order:
   // -- PreUpdate  -> Main Systems
   // -- OnUpdate   -> Physics Systems
@@ -292,14 +402,48 @@ auto Scene::init(this Scene& self, const std::string& name, const std::shared_pt
 
   // --- Main Systems ---
 
+  // Scripts that define `on_update_batch` get one call per frame with all of their entities,
+  // isolated scripts run in parallel on worker states, the rest keep the per entity `on_update` path.
   self.world.system<const LuaScriptComponent>("LuaScriptsUpdate")
       .kind(flecs::PreUpdate)
-      .each([&self](flecs::iter& it, size_t i, const LuaScriptComponent& c) {
+      .run([&self](flecs::iter& it) {
         auto* asset_man = App::get_asset_manager();
-        if (auto* script = asset_man->get_script(c.script_uuid)) {
-          script->bind_globals(&self, it.entity(i), it.delta_time());
-          script->on_update(it.delta_time());
+        for (auto& entities : self.script_update_batches | std::views::values) {
+          entities.clear();
+        }
+        self.isolated_script_jobs.clear();
+
+        f32 delta_time = 0.0f;
+        u64 entity_count = 0;
+        while (it.next()) {
+          delta_time = it.delta_time();
+          auto components = it.field<const LuaScriptComponent>(0);
+          for (auto i : it) {
+            auto* script = asset_man->get_script(components[i].script_uuid);
+            if (!script)
+              continue;
+
+            entity_count += 1;
+            if (script->is_isolated()) {
+              self.isolated_script_jobs.emplace_back(script, it.entity(i));
+            } else {
+              self.script_update_batches[script].push_back(it.entity(i));
+            }
+          }
         }
+
+        for (const auto& [script, entities] : self.script_update_batches) {
+          if (!entities.empty()) {
+            script->update_entities(&self, entities, delta_time);
+          }
+        }
+
+        if (!self.isolated_script_jobs.empty()) {
+          auto* lua_manager = App::get_system<LuaManager>(EngineSystems::LuaManager);
+          lua_manager->get_worker_pool().run(&self, self.isolated_script_jobs, delta_time);
+        }
+
+        TracyPlot("Lua Updated Entities", static_cast<i64>(entity_count));
       });
 
   self.world.system<const TransformComponent, AudioListenerComponent>("AudioListenerUpdate")
@@ -316,29 +460,6 @@ auto Scene::init(this Scene& self, const std::string& name, const std::shared_pt
         }
       });
 
-  self.world.system<const TransformComponent, AudioSourceComponent>("AudioSourceUpdate")
-      .kind(flecs::PreUpdate)
-      .each([](const flecs::entity& e, const TransformComponent& tc, const AudioSourceComponent& ac) {
-        auto* asset_man = App::get_asset_manager();
-        if (auto* audio = asset_man->get_audio(ac.audio_source)) {
-          auto* audio_engine = App::get_system<AudioEngine>(EngineSystems::AudioEngine);
-          audio_engine->set_source_attenuation_model(
-              audio->get_source(), static_cast<AudioEngine::AttenuationModelType>(ac.attenuation_model));
-          audio_engine->set_source_volume(audio->get_source(), ac.volume);
-          audio_engine->set_source_pitch(audio->get_source(), ac.pitch);
-          audio_engine->set_source_looping(audio->get_source(), ac.looping);
-          audio_engine->set_source_spatialization(audio->get_source(), ac.looping);
-          audio_engine->set_source_roll_off(audio->get_source(), ac.roll_off);
-          audio_engine->set_source_min_gain(audio->get_source(), ac.min_gain);
-          audio_engine->set_source_max_gain(audio->get_source(), ac.max_gain);
-          audio_engine->set_source_min_distance(audio->get_source(), ac.min_distance);
-          audio_engine->set_source_max_distance(audio->get_source(), ac.max_distance);
-          audio_engine->set_source_cone(
-              audio->get_source(), ac.cone_inner_angle, ac.cone_outer_angle, ac.cone_outer_gain);
-          audio_engine->set_source_doppler_factor(audio->get_source(), ac.doppler_factor);
-        }
-      });
-
   // --- Physics Systems ---
 
   // TODO: Interpolation for rigibodies.
@@ -408,6 +529,25 @@ auto Scene::init(this Scene& self, const std::string& name, const std::shared_pt
       .kind(flecs::PostUpdate)
       .each([](const TransformComponent& tc, MeshComponent& mc) {});
 
+  // Emitters are stepped together, so they can be spread over the task scheduler.
+  self.world.system<const TransformComponent, const ParticleSystemComponent>("ParticleSystemsUpdate")
+      .kind(flecs::PostUpdate)
+      .run([&self](flecs::iter& it) {
+        const auto delta_time = glm::clamp(static_cast<f32>(it.delta_time()), 0.0f, 0.25f);
+        while (it.next()) {
+          auto components = it.field<const ParticleSystemComponent>(1);
+          for (auto i : it) {
+            if (components[i].emitter_id == ParticleEmitterID::Invalid)
+              continue;
+
+            const auto position = glm::vec3(self.get_world_transform(it.entity(i))[3]);
+            self.particle_system.set_position(components[i].emitter_id, position);
+          }
+        }
+
+        self.particle_system.update(delta_time);
+      });
+
   self.world.system<SpriteComponent>("SpritesUpdate")
       .kind(flecs::PostUpdate)
       .each([](const flecs::entity entity, SpriteComponent& sprite) {
@@ -495,17 +635,46 @@ auto Scene::runtime_start() -> void {
     physics_system->OptimizeBroadPhase();
   }
 
+  // Audio
+  {
+    ZoneNamedN(z, "Audio Start", true);
+    auto& voices = App::get_system<AudioEngine>(EngineSystems::AudioEngine)->get_voice_manager();
+    world.query_builder<const TransformComponent, AudioSourceComponent>().build().each(
+        [this, &voices](flecs::entity e, const TransformComponent&, AudioSourceComponent& ac) {
+          auto* audio = App::get_asset_manager()->get_audio(ac.audio_source);
+          if (!audio)
+            return;
+
+          ac.voice_id = voices.create_voice(*audio, get_audio_voice_params(*this, e, ac), ac.priority);
+          if (ac.play_on_awake)
+            voices.play(ac.voice_id);
+        });
+  }
+
+  // Particles
+  {
+    ZoneNamedN(z, "Particles Start", true);
+    world.query_builder<const TransformComponent, ParticleSystemComponent>().build().each(
+        [this](flecs::entity e, const TransformComponent&, ParticleSystemComponent& pc) {
+          const auto position = glm::vec3(get_world_transform(e)[3]);
+          pc.emitter_id = particle_system.create_emitter(get_particle_properties(pc), position);
+          if (pc.play_on_awake)
+            particle_system.play(pc.emitter_id);
+        });
+  }
+
   // Scripting
   {
     ZoneNamedN(z, "LuaScripting/on_init", true);
+    auto* asset_man = App::get_asset_manager();
+    auto scripts = std::vector<std::pair<LuaSystem*, flecs::entity>>();
     world.query_builder<const LuaScriptComponent>().build().each(
-        [this](const flecs::entity& e, const LuaScriptComponent& c) {
-          auto* asset_man = App::get_asset_manager();
+        [asset_man, &scripts](const flecs::entity& e, const LuaScriptComponent& c) {
           if (auto* script = asset_man->get_script(c.script_uuid)) {
-            script->reload();
-            script->on_init(this, e);
+            scripts.emplace_back(script, e);
           }
         });
+    LuaSystem::start_scripts(this, scripts, static_cast<f32>(App::get_timestep().get_millis()));
   }
 }
 
@@ -553,6 +722,27 @@ auto Scene::runtime_stop() -> void {
             script->on_release(this, e);
           }
         });
+
+    App::get_system<LuaManager>(EngineSystems::LuaManager)->get_worker_pool().reset();
+  }
+
+  // Audio
+  {
+    ZoneNamedN(z, "Audio Stop", true);
+    auto& voices = App::get_system<AudioEngine>(EngineSystems::AudioEngine)->get_voice_manager();
+    world.query_builder<AudioSourceComponent>().build().each([&voices](AudioSourceComponent& ac) {
+      voices.destroy_voice(ac.voice_id);
+      ac.voice_id = AudioVoiceID::Invalid;
+    });
+    audio_sources.clear();
+  }
+
+  // Particles
+  {
+    ZoneNamedN(z, "Particles Stop", true);
+    world.query_builder<ParticleSystemComponent>().build().each(
+        [](ParticleSystemComponent& pc) { pc.emitter_id = ParticleEmitterID::Invalid; });
+    particle_system.reset();
   }
 }
 
@@ -562,6 +752,9 @@ auto Scene::runtime_update(const Timestep& delta_time) -> void {
   // TODO: Pass our delta_time?
   world.progress();
 
+  dispatch_contact_events();
+  update_audio_sources();
+
   _render_pipeline->on_update(this);
   this->dirty_transforms.clear();
 
@@ -761,6 +954,10 @@ auto Scene::set_dirty(this Scene& self, flecs::entity entity) -> void {
   gpu_transform->normal = glm::mat3(gpu_transform->world);
   self.dirty_transforms.push_back(transform_id);
 
+  // Every source below moved along, not only the ones whose own transform is set.
+  if (self.running)
+    self.audio_sources.mark_dirty(entity);
+
   // notify children
   entity.children([](flecs::entity e) {
     if (e.has<TransformComponent>()) {
@@ -769,6 +966,13 @@ auto Scene::set_dirty(this Scene& self, flecs::entity entity) -> void {
   });
 }
 
+auto Scene::get_lua_queries(this Scene& self) -> LuaQueryCache& {
+  if (!self.lua_query_cache)
+    self.lua_query_cache = std::make_unique<LuaQueryCache>(&self);
+
+  return *self.lua_query_cache;
+}
+
 auto Scene::get_entity_transform_id(flecs::entity entity) const -> option<GPU::TransformID> {
   auto it = entity_transforms_map.find(entity);
   if (it == entity_transforms_map.end())
@@ -789,6 +993,29 @@ auto Scene::add_transform(this Scene& self, flecs::entity entity) -> GPU::Transf
   return id;
 }
 
+auto Scene::update_audio_sources(this Scene& self) -> void {
+  ZoneScoped;
+
+  const auto dirty_sources = self.audio_sources.get_dirty();
+  TracyPlot("Dirty Audio Sources", static_cast<i64>(dirty_sources.size()));
+  if (!dirty_sources.empty()) {
+    auto& voices = App::get_system<AudioEngine>(EngineSystems::AudioEngine)->get_voice_manager();
+    for (const auto entity : dirty_sources) {
+      if (!entity.is_alive())
+        continue;
+
+      const auto* ac = entity.get<AudioSourceComponent>();
+      if (!ac || ac->voice_id == AudioVoiceID::Invalid)
+        continue;
+
+      voices.set_params(ac->voice_id, get_audio_voice_params(self, entity, *ac));
+      voices.set_priority(ac->voice_id, ac->priority);
+    }
+  }
+
+  self.audio_sources.clear();
+}
+
 auto Scene::remove_transform(this Scene& self, flecs::entity entity) -> void {
   ZoneScoped;
 
@@ -854,28 +1081,34 @@ auto Scene::detach_mesh(this Scene& self, flecs::entity entity, const UUID& mesh
   return true;
 }
 
-auto Scene::on_contact_added(const JPH::Body& body1,
-                             const JPH::Body& body2,
-                             const JPH::ContactManifold& manifold,
-                             const JPH::ContactSettings& settings) -> void {
+auto Scene::dispatch_contact_events() -> void {
   ZoneScoped;
 
-  physics_events.emit<SceneEvents::OnContactAddedEvent>({body1, body2, manifold, settings});
-}
+  if (!contact_listener_3d)
+    return;
 
-auto Scene::on_contact_persisted(const JPH::Body& body1,
-                                 const JPH::Body& body2,
-                                 const JPH::ContactManifold& manifold,
-                                 const JPH::ContactSettings& settings) -> void {
-  ZoneScoped;
+  auto& events = contact_listener_3d->get_event_stream().flush();
+  if (events.empty())
+    return;
 
-  physics_events.emit<SceneEvents::OnContactPersistedEvent>({body1, body2, manifold, settings});
-}
+  // Bodies of removed contacts may already be gone, resolve what's still alive.
+  const auto& body_interface = App::get_system<Physics>(EngineSystems::Physics)->get_body_interface();
+  for (auto& event : events) {
+    if (event.type == ContactEvent::Type::Removed) {
+      event.user_data1 = body_interface.GetUserData(event.body1);
+      event.user_data2 = body_interface.GetUserData(event.body2);
+    }
+  }
 
-auto Scene::on_contact_removed(const JPH::SubShapeIDPair& sub_shape_pair) -> void {
-  ZoneScoped;
+  physics_events.emit<SceneEvents::OnContactEventsBatch>({std::span<const ContactEvent>(events)});
 
-  physics_events.emit<SceneEvents::OnContactRemovedEvent>({sub_shape_pair});
+  auto* asset_man = App::get_asset_manager();
+  ankerl::unordered_dense::set<LuaSystem*> notified_scripts = {};
+  world.query_builder<const LuaScriptComponent>().build().each([&](const LuaScriptComponent& c) {
+    if (auto* script = asset_man->get_script(c.script_uuid); script && notified_scripts.insert(script).second) {
+      script->on_contacts(this, events);
+    }
+  });
 }
 
 auto Scene::on_body_activated(const JPH::BodyID& body_id, JPH::uint64 body_user_data) -> void {
@@ -0,0 +1,131 @@
+#include "Scripting/LuaAllocator.hpp"
+
+#include <cstring>
+
+#include "Memory/Tracking.hpp"
+
+namespace ox {
+LuaAllocator::~LuaAllocator() {
+  for (auto* page : pages) {
+    memory::tracked_free(memory::Subsystem::Lua, page);
+  }
+}
+
+auto LuaAllocator::lua_alloc(void* user_data, void* ptr, usize old_size, usize new_size) -> void* {
+  auto* self = static_cast<LuaAllocator*>(user_data);
+
+  // When `ptr` is null, `old_size` encodes the type of the object being created.
+  if (!ptr)
+    old_size = 0;
+
+  if (new_size == 0) {
+    self->deallocate(ptr, old_size);
+    return nullptr;
+  }
+
+  if (!ptr)
+    return self->allocate(new_size);
+
+  return self->reallocate(ptr, old_size, new_size);
+}
+
+auto LuaAllocator::allocate(usize size) -> void* {
+  stats.allocation_count += 1;
+  stats.total_allocated_bytes += size;
+  stats.used_bytes += size;
+  stats.peak_bytes = ox::max(stats.peak_bytes, stats.used_bytes);
+
+  if (size > MAX_POOLED_SIZE) {
+    stats.heap_allocation_count += 1;
+    return memory::tracked_alloc(memory::Subsystem::Lua, size);
+  }
+
+  const auto size_class = get_size_class(size);
+  if (auto* block = free_lists[size_class]) {
+    free_lists[size_class] = block->next;
+    return block;
+  }
+
+  const auto block_size = (size_class + 1) * SIZE_CLASS_GRANULARITY;
+  if (static_cast<usize>(page_end - page_cursor) < block_size) {
+    // Whatever is left of the current page is too small for this class, hand it out
+    // to the smaller classes instead of wasting it.
+    auto remaining = static_cast<usize>(page_end - page_cursor);
+    while (remaining >= SIZE_CLASS_GRANULARITY) {
+      const auto remaining_class = ox::min(remaining, MAX_POOLED_SIZE) / SIZE_CLASS_GRANULARITY - 1;
+      const auto remaining_block_size = (remaining_class + 1) * SIZE_CLASS_GRANULARITY;
+      auto* block = reinterpret_cast<FreeBlock*>(page_cursor);
+      block->next = free_lists[remaining_class];
+      free_lists[remaining_class] = block;
+      page_cursor += remaining_block_size;
+      remaining -= remaining_block_size;
+    }
+
+    auto* page = static_cast<u8*>(memory::tracked_alloc(memory::Subsystem::Lua, PAGE_SIZE, SIZE_CLASS_GRANULARITY));
+    if (!page) {
+      stats.used_bytes -= size;
+      return nullptr;
+    }
+
+    pages.push_back(page);
+    page_cursor = page;
+    page_end = page + PAGE_SIZE;
+    stats.reserved_bytes += PAGE_SIZE;
+  }
+
+  auto* block = page_cursor;
+  page_cursor += block_size;
+
+  return block;
+}
+
+auto LuaAllocator::reallocate(void* ptr, usize old_size, usize new_size) -> void* {
+  const bool old_pooled = old_size <= MAX_POOLED_SIZE;
+  const bool new_pooled = new_size <= MAX_POOLED_SIZE;
+
+  if (old_pooled && new_pooled && get_size_class(old_size) == get_size_class(new_size)) {
+    stats.used_bytes = stats.used_bytes - old_size + new_size;
+    stats.peak_bytes = ox::max(stats.peak_bytes, stats.used_bytes);
+    return ptr;
+  }
+
+  if (!old_pooled && !new_pooled) {
+    auto* new_ptr = memory::tracked_realloc(memory::Subsystem::Lua, ptr, new_size);
+    if (!new_ptr)
+      return nullptr;
+
+    stats.allocation_count += 1;
+    stats.heap_allocation_count += 1;
+    stats.total_allocated_bytes += new_size;
+    stats.used_bytes = stats.used_bytes - old_size + new_size;
+    stats.peak_bytes = ox::max(stats.peak_bytes, stats.used_bytes);
+    return new_ptr;
+  }
+
+  auto* new_ptr = allocate(new_size);
+  if (!new_ptr)
+    return nullptr;
+
+  std::memcpy(new_ptr, ptr, ox::min(old_size, new_size));
+  deallocate(ptr, old_size);
+
+  return new_ptr;
+}
+
+auto LuaAllocator::deallocate(void* ptr, usize size) -> void {
+  if (!ptr)
+    return;
+
+  stats.used_bytes -= size;
+
+  if (size > MAX_POOLED_SIZE) {
+    memory::tracked_free(memory::Subsystem::Lua, ptr);
+    return;
+  }
+
+  const auto size_class = get_size_class(size);
+  auto* block = static_cast<FreeBlock*>(ptr);
+  block->next = free_lists[size_class];
+  free_lists[size_class] = block;
+}
+} // namespace ox
@@ -0,0 +1,49 @@
+#include "Scripting/LuaBytecodeCache.hpp"
+
+#include <sol/sol.hpp>
+
+#include "Memory/Hasher.hpp"
+
+namespace ox::lua_bytecode_cache {
+auto encode(std::string_view source, std::string_view bytecode) -> std::vector<u8> {
+  const auto header = Header{
+      .magic = MAGIC,
+      .lua_version = LUA_VERSION_NUM,
+      .source_hash = fnv64_str(source),
+      .source_size = source.size(),
+      .bytecode_hash = fnv64_str(bytecode),
+      .bytecode_size = bytecode.size(),
+  };
+
+  auto file = std::vector<u8>(sizeof(Header) + bytecode.size());
+  std::memcpy(file.data(), &header, sizeof(Header));
+  std::memcpy(file.data() + sizeof(Header), bytecode.data(), bytecode.size());
+
+  return file;
+}
+
+auto decode(std::span<const u8> file, std::string_view source) -> std::string_view {
+  ZoneScoped;
+
+  if (file.size() < sizeof(Header))
+    return {};
+
+  auto header = Header{};
+  std::memcpy(&header, file.data(), sizeof(Header));
+  if (header.magic != MAGIC || header.lua_version != LUA_VERSION_NUM)
+    return {};
+
+  if (header.source_size != source.size() || header.source_hash != fnv64_str(source))
+    return {};
+
+  if (header.bytecode_size != file.size() - sizeof(Header))
+    return {};
+
+  const auto bytecode = std::string_view(reinterpret_cast<const c8*>(file.data() + sizeof(Header)),
+                                         header.bytecode_size);
+  if (header.bytecode_hash != fnv64_str(bytecode))
+    return {};
+
+  return bytecode;
+}
+} // namespace ox::lua_bytecode_cache
@@ -3,8 +3,80 @@
 #include <sol/state.hpp>
 
 #include "Scene/ECSModule/Core.hpp"
+#include "Scene/Scene.hpp"
 #include "Scripting/LuaHelpers.hpp"
+#include "Scripting/LuaQuery.hpp"
 
 namespace ox {
-void LuaBindings::bind_components(sol::state* state) {}
+// Resolves a component field of a single entity to its member pointer.
+static auto find_entity_field(Scene& scene,
+                              flecs::entity entity,
+                              std::string_view component_name,
+                              std::string_view field_name) -> std::pair<u8*, ComponentField> {
+  const auto* layout = scene.get_lua_queries().get_layout(component_name);
+  if (!layout) {
+    OX_LOG_ERROR("Unknown or non reflected component '{}'!", component_name);
+    return {};
+  }
+
+  const auto field = layout->find_field(field_name);
+  if (!field.has_value()) {
+    OX_LOG_ERROR("Component '{}' has no field named '{}'!", component_name, field_name);
+    return {};
+  }
+
+  auto* data = static_cast<u8*>(entity.get_mut(layout->component));
+  if (!data)
+    return {};
+
+  return {data + field->offset, *field};
+}
+
+void LuaBindings::bind_components(sol::state* state) {
+  ZoneScoped;
+
+  auto entity_type = state->new_usertype<flecs::entity>("Entity");
+  entity_type.set_function("id", [](const flecs::entity& self) -> u64 { return self.id(); });
+  entity_type.set_function("name", [](const flecs::entity& self) -> std::string { return self.name().c_str(); });
+  entity_type.set_function("is_alive", [](const flecs::entity& self) -> bool { return self.is_alive(); });
+
+  // Slow path, resolves the component and field by name on every call.
+  sol::table scene_type = (*state)["Scene"];
+  scene_type.set_function("get_field",
+                          [](Scene& self,
+                             flecs::entity entity,
+                             const std::string& component,
+                             const std::string& field,
+                             sol::this_state lua) -> sol::object {
+    const auto [ptr, info] = find_entity_field(self, entity, component, field);
+    if (!ptr)
+      return sol::lua_nil;
+
+    return component_field_to_lua(lua, info.type, ptr);
+  });
+  scene_type.set_function("set_field",
+                          [](Scene& self,
+                             flecs::entity entity,
+                             const std::string& component,
+                             const std::string& field,
+                             const sol::object& value) -> bool {
+    const auto [ptr, info] = find_entity_field(self, entity, component, field);
+    if (!ptr || !lua_to_component_field(info.type, ptr, value))
+      return false;
+
+    entity.modified(self.get_lua_queries().find_component(component));
+    return true;
+  });
+  scene_type.set_function("query", [](Scene& self, const sol::table& components) -> LuaQuery* {
+    std::vector<std::string> names = {};
+    names.reserve(components.size());
+    for (usize i = 1; i <= components.size(); i++) {
+      names.emplace_back(components.get<std::string>(i));
+    }
+
+    return self.get_lua_queries().get_query(names);
+  });
+
+  bind_lua_query_types(state);
+}
 } // namespace ox
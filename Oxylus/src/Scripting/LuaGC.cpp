@@ -0,0 +1,91 @@
+#include "Scripting/LuaGC.hpp"
+
+#include <sol/sol.hpp>
+
+#include "Scripting/LuaAllocator.hpp"
+#include "Scripting/LuaConfig.hpp"
+
+namespace ox {
+LuaGC::LuaGC(lua_State* state_, const LuaAllocator* allocator_) : state(state_), allocator(allocator_) {
+  set_mode(LuaCVar::cvar_gc_generational.get() != 0);
+}
+
+auto LuaGC::get_heap_bytes() const -> usize { return allocator->get_stats().used_bytes; }
+
+auto LuaGC::set_mode(bool generational) -> void {
+  ZoneScoped;
+
+#if LUA_VERSION_NUM >= 504
+  if (generational)
+    lua_gc(state, LUA_GCGEN, 0, 0);
+  else
+    lua_gc(state, LUA_GCINC, 0, 0, 0);
+#else
+  generational = false;
+#endif
+
+  // Collection only happens in `step`, allocation failures still trigger an emergency collection.
+  lua_gc(state, LUA_GCSTOP, 0);
+
+  stats.generational = generational;
+  cycle_running = false;
+  cycle_end_bytes = get_heap_bytes();
+}
+
+auto LuaGC::step() -> void {
+  ZoneScoped;
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto elapsed_millis = [start] {
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  const bool generational = LuaCVar::cvar_gc_generational.get() != 0;
+  if (generational != stats.generational)
+    set_mode(generational);
+
+  u32 steps = 0;
+  if (full_gc_requested) {
+    full_gc_requested = false;
+    lua_gc(state, LUA_GCCOLLECT, 0);
+    steps = 1;
+    cycle_running = false;
+    cycle_end_bytes = get_heap_bytes();
+    stats.cycle_count += 1;
+  } else if (stats.generational) {
+    // Minor collections only traverse young objects and can't be split, run one
+    // whenever enough was allocated since the previous one.
+    const auto minor_bytes = ox::kib_to_bytes(static_cast<usize>(ox::max(LuaCVar::cvar_gc_minor_kb.get(), 1)));
+    if (get_heap_bytes() >= cycle_end_bytes + minor_bytes) {
+      lua_gc(state, LUA_GCSTEP, 0);
+      steps = 1;
+      cycle_end_bytes = get_heap_bytes();
+      stats.cycle_count += 1;
+    }
+  } else {
+    const auto pause = static_cast<usize>(ox::max(LuaCVar::cvar_gc_pause.get(), 100));
+    if (!cycle_running && get_heap_bytes() >= cycle_end_bytes * pause / 100)
+      cycle_running = true;
+
+    // Always take at least one step so a cycle finishes eventually even with a tiny budget.
+    const auto budget_millis = static_cast<f64>(LuaCVar::cvar_gc_budget_ms.get());
+    const auto step_kb = ox::max(LuaCVar::cvar_gc_step_kb.get(), 1);
+    while (cycle_running && (steps == 0 || elapsed_millis() < budget_millis)) {
+      steps += 1;
+      if (lua_gc(state, LUA_GCSTEP, step_kb)) {
+        cycle_running = false;
+        cycle_end_bytes = get_heap_bytes();
+        stats.cycle_count += 1;
+      }
+    }
+  }
+
+  stats.heap_bytes = get_heap_bytes();
+  stats.last_frame_steps = steps;
+  stats.last_frame_millis = elapsed_millis();
+  stats.max_frame_millis = ox::max(stats.max_frame_millis, stats.last_frame_millis);
+
+  TracyPlot("Lua Heap Bytes", static_cast<i64>(stats.heap_bytes));
+  TracyPlot("Lua GC ms", stats.last_frame_millis);
+}
+} // namespace ox
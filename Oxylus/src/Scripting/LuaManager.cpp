@@ -2,6 +2,12 @@
 
 #include <sol/sol.hpp>
 
+#include "Core/App.hpp"
+#include "Core/FileSystem.hpp"
+#include "Memory/Hasher.hpp"
+#include "Scripting/LuaBytecodeCache.hpp"
+#include "Thread/TaskScheduler.hpp"
+
 #ifdef OX_LUA_BINDINGS
   #include "Scripting/LuaApplicationBindings.hpp"
   #include "Scripting/LuaAssetManagerBindings.hpp"
@@ -20,9 +26,11 @@ namespace ox {
 
 auto LuaManager::init() -> std::expected<void, std::string> {
   ZoneScoped;
-  _state = std::make_unique<sol::state>();
+  allocator = std::make_unique<LuaAllocator>();
+  _state = std::make_unique<sol::state>(sol::default_at_panic, &LuaAllocator::lua_alloc, allocator.get());
   _state->open_libraries(
       sol::lib::base, sol::lib::package, sol::lib::math, sol::lib::table, sol::lib::os, sol::lib::string);
+  gc = std::make_unique<LuaGC>(_state->lua_state(), allocator.get());
 
 #ifdef OX_LUA_BINDINGS
   bind_log();
@@ -39,12 +47,96 @@ auto LuaManager::init() -> std::expected<void, std::string> {
   LuaBindings::bind_ui(_state.get());
 #endif
 
+  bytecode_cache_dir = fs::append_paths(fs::current_path(), ".cache/scripts");
+  std::error_code ec;
+  std::filesystem::create_directories(bytecode_cache_dir, ec);
+  if (ec) {
+    OX_LOG_WARN("Couldn't create script bytecode cache directory {}: {}", bytecode_cache_dir, ec.message());
+    bytecode_cache_dir.clear();
+  }
+
   return {};
 }
 
+auto LuaManager::load_script_chunk(const std::string& path) -> sol::load_result {
+  ZoneScoped;
+
+  // Chunk name keeps the `@path` form so error messages point at the script file.
+  const auto chunk_name = "@" + path;
+  const auto source = fs::read_file(path);
+  const auto hash = fnv64_str(source);
+
+  if (auto it = bytecode_cache.find(hash); it != bytecode_cache.end()) {
+    auto result = _state->load_buffer(it->second.data(), it->second.size(), chunk_name, sol::load_mode::binary);
+    if (result.valid())
+      return result;
+
+    bytecode_cache.erase(it);
+  }
+
+  const auto cache_path = bytecode_cache_dir.empty()
+                              ? std::string{}
+                              : fs::append_paths(bytecode_cache_dir, fmt::format("{:016x}_{}.luac", hash, LUA_VERSION_NUM));
+  if (!cache_path.empty() && fs::exists(cache_path)) {
+    ZoneNamedN(z, "Load Cached Bytecode", true);
+    const auto bytes = fs::read_file_binary(cache_path);
+    // Stale, truncated or corrupt files fall through to compiling, which overwrites them.
+    if (const auto bytecode = lua_bytecode_cache::decode(bytes, source); !bytecode.empty()) {
+      auto result = _state->load_buffer(bytecode.data(), bytecode.size(), chunk_name, sol::load_mode::binary);
+      if (result.valid()) {
+        bytecode_cache.emplace(hash, std::string(bytecode));
+        return result;
+      }
+    } else {
+      OX_LOG_WARN("Ignoring invalid script bytecode cache {}", cache_path);
+    }
+  }
+
+  ZoneNamedN(z, "Compile Script", true);
+  auto result = _state->load(source, chunk_name, sol::load_mode::text);
+  if (!result.valid())
+    return result;
+
+  const sol::protected_function chunk = result;
+  const auto dumped = chunk.dump();
+  auto bytecode = std::string(dumped.as_string_view());
+
+  if (!cache_path.empty()) {
+    if (!fs::write_file_binary(cache_path, lua_bytecode_cache::encode(source, bytecode))) {
+      OX_LOG_WARN("Couldn't write script bytecode cache {}", cache_path);
+    }
+  }
+  bytecode_cache.emplace(hash, std::move(bytecode));
+
+  return result;
+}
+
+auto LuaManager::on_update() -> void {
+  ZoneScoped;
+
+  gc->step();
+}
+
+auto LuaManager::get_worker_pool() -> LuaWorkerPool& {
+  if (!worker_pool) {
+    auto* task_scheduler = App::get_system<TaskScheduler>(EngineSystems::TaskScheduler);
+    worker_pool = std::make_unique<LuaWorkerPool>(task_scheduler->get_underlying()->GetNumTaskThreads());
+  }
+
+  return *worker_pool;
+}
+
+auto LuaManager::start_profiler(i32 instruction_interval) -> void {
+  profiler.start(_state->lua_state(), allocator.get(), instruction_interval);
+}
+
 auto LuaManager::deinit() -> std::expected<void, std::string> {
+  profiler.stop();
+  worker_pool.reset();
+  gc.reset();
   _state->collect_gc();
   _state.reset();
+  allocator.reset();
 
   return {};
 }
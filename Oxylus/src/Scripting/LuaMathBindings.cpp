@@ -22,12 +22,29 @@ namespace ox::LuaBindings {
     return a + b;                                                                                                \
   }, [](const type& a, const number b) { return a + b; }, [](const number a, const type& b) { return a + b; }));
 
+// Mutate the receiver instead of returning a new value, so hot loops can reuse one
+// userdata instead of allocating a temporary per operator.
+#define SET_INPLACE_FUNCTIONS(var, type, number)                                                                 \
+  (var).set_function("copy_from", [](type& self, const type& other) { self = other; });                          \
+  (var).set_function("add", sol::overload([](type& self, const type& v) { self += v; },                          \
+                                          [](type& self, const number v) { self += v; }));                       \
+  (var).set_function("sub", sol::overload([](type& self, const type& v) { self -= v; },                          \
+                                          [](type& self, const number v) { self -= v; }));                       \
+  (var).set_function("mul", sol::overload([](type& self, const type& v) { self *= v; },                          \
+                                          [](type& self, const number v) { self *= v; }));                       \
+  (var).set_function("div", sol::overload([](type& self, const type& v) { self /= v; },                          \
+                                          [](type& self, const number v) { self /= v; }));                       \
+  (var).set_function("add_scaled", [](type& self, const type& v, const number s) { self += v * s; });
+
 void bind_math(sol::state* state) {
   ZoneScoped;
   auto vec2 = state->new_usertype<glm::vec2>("Vec2", sol::constructors<glm::vec2(float, float), glm::vec2(float)>());
   SET_TYPE_FIELD(vec2, glm::vec2, x);
   SET_TYPE_FIELD(vec2, glm::vec2, y);
   SET_MATH_FUNCTIONS(vec2, glm::vec2, float)
+  SET_INPLACE_FUNCTIONS(vec2, glm::vec2, float)
+  vec2.set_function("set", [](glm::vec2& self, float x, float y) { self = {x, y}; });
+  vec2.set_function("unpack", [](const glm::vec2& self) { return std::tuple(self.x, self.y); });
 
   auto uvec2 = state->new_usertype<glm::uvec2>(
       "UVec2", sol::constructors<glm::uvec2(uint32_t, uint32_t), glm::uvec2(uint32_t)>());
@@ -46,6 +63,9 @@ void bind_math(sol::state* state) {
   SET_TYPE_FIELD(vec3, glm::vec3, y);
   SET_TYPE_FIELD(vec3, glm::vec3, z);
   SET_MATH_FUNCTIONS(vec3, glm::vec3, float)
+  SET_INPLACE_FUNCTIONS(vec3, glm::vec3, float)
+  vec3.set_function("set", [](glm::vec3& self, float x, float y, float z) { self = {x, y, z}; });
+  vec3.set_function("unpack", [](const glm::vec3& self) { return std::tuple(self.x, self.y, self.z); });
 
   auto ivec3 = state->new_usertype<glm::ivec3>(
       "IVec3", sol::constructors<sol::types<>, sol::types<int, int, int>, glm::ivec3(int)>());
@@ -68,6 +88,9 @@ void bind_math(sol::state* state) {
   SET_TYPE_FIELD(vec4, glm::vec4, z);
   SET_TYPE_FIELD(vec4, glm::vec4, w);
   SET_MATH_FUNCTIONS(vec4, glm::vec4, float)
+  SET_INPLACE_FUNCTIONS(vec4, glm::vec4, float)
+  vec4.set_function("set", [](glm::vec4& self, float x, float y, float z, float w) { self = {x, y, z, w}; });
+  vec4.set_function("unpack", [](const glm::vec4& self) { return std::tuple(self.x, self.y, self.z, self.w); });
 
   auto ivec4 = state->new_usertype<glm::ivec4>(
       "IVec4", sol::constructors<sol::types<>, sol::types<int, int, int, int>, glm::ivec4(int)>());
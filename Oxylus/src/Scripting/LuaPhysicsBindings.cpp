@@ -6,6 +6,7 @@
 #include "Jolt/Jolt.h"
 #include "Jolt/Physics/Collision/BroadPhase/BroadPhaseQuery.h"
 #include "Jolt/Physics/Collision/CastResult.h"
+#include "Physics/ContactEvents.hpp"
 #include "Physics/Physics.hpp"
 #include "Physics/RayCast.hpp"
 #include "Scene/ECSModule/Core.hpp"
@@ -36,6 +37,104 @@ void LuaBindings::bind_physics(sol::state* state) {
       [](const JPH::AllHitCollisionCollector<JPH::RayCastBodyCollector>& collector)
           -> std::vector<JPH::BroadPhaseCastResult> { return {collector.mHits.begin(), collector.mHits.end()}; });
 
+  // -- Batched narrow phase queries ---
+  const std::initializer_list<std::pair<sol::string_view, QueryShape::Type>> query_shape_types = {
+      ENUM_FIELD(QueryShape::Type, Sphere),
+      ENUM_FIELD(QueryShape::Type, Box),
+      ENUM_FIELD(QueryShape::Type, Capsule),
+  };
+  state->new_enum<QueryShape::Type, true>("QueryShapeType", query_shape_types);
+
+  auto query_shape_type = state->new_usertype<QueryShape>("QueryShape");
+  SET_TYPE_FIELD(query_shape_type, QueryShape, type);
+  SET_TYPE_FIELD(query_shape_type, QueryShape, radius);
+  SET_TYPE_FIELD(query_shape_type, QueryShape, half_height);
+  SET_TYPE_FIELD(query_shape_type, QueryShape, half_extents);
+  SET_TYPE_FUNCTION(query_shape_type, QueryShape, sphere);
+  SET_TYPE_FUNCTION(query_shape_type, QueryShape, box);
+  SET_TYPE_FUNCTION(query_shape_type, QueryShape, capsule);
+
+  auto shape_cast_type = state->new_usertype<ShapeCast>(
+      "ShapeCast",
+      "new",
+      sol::factories([](const QueryShape& shape, const glm::vec3& origin, const glm::vec3& direction) {
+    return ShapeCast{.shape = shape, .origin = origin, .direction = direction};
+  }));
+  SET_TYPE_FIELD(shape_cast_type, ShapeCast, shape);
+  SET_TYPE_FIELD(shape_cast_type, ShapeCast, origin);
+  SET_TYPE_FIELD(shape_cast_type, ShapeCast, rotation);
+  SET_TYPE_FIELD(shape_cast_type, ShapeCast, direction);
+
+  auto overlap_query_type = state->new_usertype<OverlapQuery>(
+      "OverlapQuery", "new", sol::factories([](const QueryShape& shape, const glm::vec3& position) {
+    return OverlapQuery{.shape = shape, .position = position};
+  }));
+  SET_TYPE_FIELD(overlap_query_type, OverlapQuery, shape);
+  SET_TYPE_FIELD(overlap_query_type, OverlapQuery, position);
+  SET_TYPE_FIELD(overlap_query_type, OverlapQuery, rotation);
+
+  auto query_hit_type = state->new_usertype<QueryHit>("QueryHit");
+  SET_TYPE_FIELD(query_hit_type, QueryHit, hit);
+  SET_TYPE_FIELD(query_hit_type, QueryHit, fraction);
+  SET_TYPE_FIELD(query_hit_type, QueryHit, position);
+  SET_TYPE_FIELD(query_hit_type, QueryHit, normal);
+  query_hit_type["entity_id"] = sol::readonly_property([](const QueryHit& h) { return h.user_data; });
+
+  physics_table.set_function(
+      "cast_rays", [](const std::vector<RayCast>& rays, sol::optional<u32> layer_mask) -> std::vector<QueryHit> {
+    std::vector<QueryHit> hits(rays.size());
+    App::get_system<Physics>(EngineSystems::Physics)
+        ->cast_rays(rays, hits, static_cast<Physics::EntityLayer>(layer_mask.value_or(0xFFFF)));
+    return hits;
+  });
+  physics_table.set_function(
+      "cast_shapes", [](const std::vector<ShapeCast>& casts, sol::optional<u32> layer_mask) -> std::vector<QueryHit> {
+    std::vector<QueryHit> hits(casts.size());
+    App::get_system<Physics>(EngineSystems::Physics)
+        ->cast_shapes(casts, hits, static_cast<Physics::EntityLayer>(layer_mask.value_or(0xFFFF)));
+    return hits;
+  });
+  physics_table.set_function("overlap",
+                             [](const std::vector<OverlapQuery>& queries,
+                                sol::optional<u32> max_hits,
+                                sol::optional<u32> layer_mask) -> std::vector<std::vector<QueryHit>> {
+    const u32 max_hits_per_query = max_hits.value_or(16);
+    std::vector<QueryHit> hits(queries.size() * max_hits_per_query);
+    std::vector<u32> hit_counts(queries.size());
+    App::get_system<Physics>(EngineSystems::Physics)
+        ->overlap(queries,
+                  hits,
+                  hit_counts,
+                  max_hits_per_query,
+                  static_cast<Physics::EntityLayer>(layer_mask.value_or(0xFFFF)));
+
+    std::vector<std::vector<QueryHit>> results(queries.size());
+    for (usize i = 0; i < queries.size(); i++) {
+      const auto first = hits.begin() + static_cast<std::ptrdiff_t>(i * max_hits_per_query);
+      results[i].assign(first, first + hit_counts[i]);
+    }
+    return results;
+  });
+
+  // -- Contact events ---
+  const std::initializer_list<std::pair<sol::string_view, ContactEvent::Type>> contact_event_types = {
+      ENUM_FIELD(ContactEvent::Type, Added),
+      ENUM_FIELD(ContactEvent::Type, Persisted),
+      ENUM_FIELD(ContactEvent::Type, Removed),
+  };
+  state->new_enum<ContactEvent::Type, true>("ContactEventType", contact_event_types);
+
+  auto contact_event_type = state->new_usertype<ContactEvent>("ContactEvent");
+  SET_TYPE_FIELD(contact_event_type, ContactEvent, type);
+  SET_TYPE_FIELD(contact_event_type, ContactEvent, position);
+  SET_TYPE_FIELD(contact_event_type, ContactEvent, normal);
+  SET_TYPE_FIELD(contact_event_type, ContactEvent, penetration_depth);
+  SET_TYPE_FIELD(contact_event_type, ContactEvent, contact_point_count);
+  SET_TYPE_FIELD(contact_event_type, ContactEvent, combined_friction);
+  SET_TYPE_FIELD(contact_event_type, ContactEvent, combined_restitution);
+  contact_event_type["entity1_id"] = sol::readonly_property([](const ContactEvent& e) { return e.user_data1; });
+  contact_event_type["entity2_id"] = sol::readonly_property([](const ContactEvent& e) { return e.user_data2; });
+
   // -- Components ---
   const std::initializer_list<std::pair<sol::string_view, RigidbodyComponent::BodyType>> rigidbody_body_type = {
       ENUM_FIELD(RigidbodyComponent::BodyType, Static),
@@ -0,0 +1,208 @@
+#include "Scripting/LuaProfiler.hpp"
+
+#include <sol/sol.hpp>
+
+#include "Core/FileSystem.hpp"
+#include "Scripting/LuaAllocator.hpp"
+
+namespace ox {
+// Hooks are plain function pointers without user data, only the main state is profiled.
+static LuaProfiler* active_profiler = nullptr;
+
+LuaProfiler::Scope::Scope(LuaProfiler* profiler_, const std::string& script) {
+  if (!profiler_ || !profiler_->is_running())
+    return;
+
+  profiler = profiler_;
+  profiler->flush_pending();
+  previous_script = profiler->current_script;
+  profiler->current_script = profiler->get_script_index(script);
+
+  start = std::chrono::steady_clock::now();
+  start_alloc_bytes = profiler->allocator->get_stats().total_allocated_bytes;
+  start_alloc_count = profiler->allocator->get_stats().allocation_count;
+}
+
+LuaProfiler::Scope::~Scope() {
+  if (!profiler || !profiler->is_running())
+    return;
+
+  profiler->flush_pending();
+
+  const auto& alloc_stats = profiler->allocator->get_stats();
+  auto& script = profiler->scripts[profiler->current_script];
+  script.millis += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+  script.calls += 1;
+  script.alloc_bytes += alloc_stats.total_allocated_bytes - start_alloc_bytes;
+  script.alloc_count += alloc_stats.allocation_count - start_alloc_count;
+
+  profiler->current_script = previous_script;
+  profiler->last_line = nullopt;
+}
+
+LuaProfiler::~LuaProfiler() { stop(); }
+
+auto LuaProfiler::LineKeyHash::operator()(const LineKey& key) const noexcept -> u64 {
+  using namespace ankerl::unordered_dense::detail;
+  const auto h = wyhash::hash(static_cast<u64>(reinterpret_cast<uptr>(key.source)));
+  return wyhash::mix(h, (static_cast<u64>(key.script) << 32) | static_cast<u32>(key.line));
+}
+
+auto LuaProfiler::start(lua_State* L, const LuaAllocator* allocator_, i32 interval) -> void {
+  ZoneScoped;
+
+  if (is_running())
+    stop();
+
+  if (scripts.empty())
+    scripts.push_back({.script = "<global>"});
+
+  state = L;
+  allocator = allocator_;
+  instruction_interval = ox::max(interval, 1);
+  active_profiler = this;
+  begin_sample_window();
+
+  lua_sethook(state, &LuaProfiler::hook, LUA_MASKCOUNT, instruction_interval);
+}
+
+auto LuaProfiler::stop() -> void {
+  ZoneScoped;
+
+  if (!is_running())
+    return;
+
+  lua_sethook(state, nullptr, 0, 0);
+  state = nullptr;
+  current_script = 0;
+  last_line = nullopt;
+  if (active_profiler == this)
+    active_profiler = nullptr;
+}
+
+auto LuaProfiler::reset() -> void {
+  ZoneScoped;
+
+  scripts.clear();
+  script_indices.clear();
+  lines.clear();
+  scripts.push_back({.script = "<global>"});
+  current_script = 0;
+  last_line = nullopt;
+  begin_sample_window();
+}
+
+auto LuaProfiler::get_lines() const -> std::vector<LuaProfileLine> {
+  auto result = std::vector<LuaProfileLine>();
+  result.reserve(lines.size());
+  for (const auto& line : lines | std::views::values) {
+    result.push_back(line);
+  }
+
+  std::ranges::sort(result, std::greater{}, &LuaProfileLine::millis);
+  return result;
+}
+
+auto LuaProfiler::get_scripts() const -> std::vector<LuaProfileScript> {
+  auto result = std::vector<LuaProfileScript>();
+  for (const auto& script : scripts) {
+    if (script.calls > 0 || script.millis > 0.0)
+      result.push_back(script);
+  }
+
+  std::ranges::sort(result, std::greater{}, &LuaProfileScript::millis);
+  return result;
+}
+
+auto LuaProfiler::export_csv(const std::string& path) const -> bool {
+  ZoneScoped;
+
+  std::string csv = {};
+  for (const auto& line : get_lines()) {
+    csv += fmt::format("\"{}\",\"{}\",\"{}\",{},{:.4f},{},{},{}\n",
+                       line.script,
+                       line.function,
+                       line.source,
+                       line.line,
+                       line.millis,
+                       line.samples,
+                       line.alloc_bytes,
+                       line.alloc_count);
+  }
+
+  return fs::write_file(path, csv, "script,function,source,line,millis,samples,alloc_bytes,alloc_count");
+}
+
+auto LuaProfiler::hook(lua_State* L, lua_Debug* ar) -> void {
+  if (active_profiler && ar->event == LUA_HOOKCOUNT)
+    active_profiler->take_sample(L, ar);
+}
+
+auto LuaProfiler::get_script_index(const std::string& script) -> u32 {
+  if (const auto it = script_indices.find(script); it != script_indices.end())
+    return it->second;
+
+  const auto index = static_cast<u32>(scripts.size());
+  scripts.push_back({.script = script});
+  script_indices.emplace(script, index);
+
+  return index;
+}
+
+auto LuaProfiler::begin_sample_window() -> void {
+  last_sample_time = std::chrono::steady_clock::now();
+  if (allocator) {
+    last_alloc_bytes = allocator->get_stats().total_allocated_bytes;
+    last_alloc_count = allocator->get_stats().allocation_count;
+  }
+}
+
+auto LuaProfiler::flush_pending() -> void {
+  if (!last_line.has_value()) {
+    begin_sample_window();
+    return;
+  }
+
+  if (auto it = lines.find(*last_line); it != lines.end())
+    charge(it->second, false);
+  else
+    begin_sample_window();
+}
+
+auto LuaProfiler::take_sample(lua_State* L, lua_Debug* ar) -> void {
+  if (!lua_getinfo(L, "Sln", ar))
+    return;
+
+  const auto key = LineKey{.script = current_script, .source = ar->source, .line = ar->currentline};
+  auto it = lines.find(key);
+  if (it == lines.end()) {
+    auto function = ar->name ? std::string(ar->name) : fmt::format("<{}:{}>", ar->short_src, ar->linedefined);
+    it = lines
+             .emplace(key,
+                      LuaProfileLine{
+                          .script = scripts[current_script].script,
+                          .source = ar->short_src,
+                          .function = std::move(function),
+                          .line = ar->currentline,
+                      })
+             .first;
+  }
+
+  charge(it->second, true);
+  last_line = key;
+}
+
+auto LuaProfiler::charge(LuaProfileLine& line, bool is_sample) -> void {
+  const auto now = std::chrono::steady_clock::now();
+  const auto& alloc_stats = allocator->get_stats();
+
+  line.millis += std::chrono::duration<f64, std::milli>(now - last_sample_time).count();
+  line.samples += is_sample ? 1 : 0;
+  line.alloc_bytes += alloc_stats.total_allocated_bytes - last_alloc_bytes;
+  line.alloc_count += alloc_stats.allocation_count - last_alloc_count;
+
+  last_sample_time = now;
+  last_alloc_bytes = alloc_stats.total_allocated_bytes;
+  last_alloc_count = alloc_stats.allocation_count;
+}
+} // namespace ox
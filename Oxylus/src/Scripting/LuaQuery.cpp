@@ -0,0 +1,391 @@
+#include "Scripting/LuaQuery.hpp"
+
+#include <sol/sol.hpp>
+
+#include "Scene/Scene.hpp"
+
+namespace ox {
+static auto resolve_field_type(flecs::world& world, flecs::entity_t type) -> ComponentField::Type {
+  const auto member_type = flecs::entity(world, type);
+  if (member_type == flecs::Bool)
+    return ComponentField::Type::Bool;
+  if (member_type == flecs::F32)
+    return ComponentField::Type::F32;
+  if (member_type == flecs::I32)
+    return ComponentField::Type::I32;
+  if (member_type == flecs::U32)
+    return ComponentField::Type::U32;
+  if (member_type == flecs::I64)
+    return ComponentField::Type::I64;
+  if (member_type == flecs::U64)
+    return ComponentField::Type::U64;
+  if (member_type == world.entity<glm::vec2>())
+    return ComponentField::Type::Vec2;
+  if (member_type == world.entity<glm::vec3>())
+    return ComponentField::Type::Vec3;
+  if (member_type == world.entity<glm::vec4>())
+    return ComponentField::Type::Vec4;
+  if (member_type == world.entity<glm::quat>())
+    return ComponentField::Type::Quat;
+
+  return ComponentField::Type::Unsupported;
+}
+
+auto get_field_size(ComponentField::Type type) -> usize {
+  switch (type) {
+    case ComponentField::Type::Bool       : return sizeof(bool);
+    case ComponentField::Type::F32        : return sizeof(f32);
+    case ComponentField::Type::I32        : return sizeof(i32);
+    case ComponentField::Type::U32        : return sizeof(u32);
+    case ComponentField::Type::I64        : return sizeof(i64);
+    case ComponentField::Type::U64        : return sizeof(u64);
+    case ComponentField::Type::Vec2       : return sizeof(glm::vec2);
+    case ComponentField::Type::Vec3       : return sizeof(glm::vec3);
+    case ComponentField::Type::Vec4       : return sizeof(glm::vec4);
+    case ComponentField::Type::Quat       : return sizeof(glm::quat);
+    case ComponentField::Type::Unsupported: return 0;
+  }
+
+  return 0;
+}
+
+auto component_field_to_lua(lua_State* L, ComponentField::Type type, const u8* ptr) -> sol::object {
+  switch (type) {
+    case ComponentField::Type::Bool       : return sol::make_object(L, *reinterpret_cast<const bool*>(ptr));
+    case ComponentField::Type::F32        : return sol::make_object(L, *reinterpret_cast<const f32*>(ptr));
+    case ComponentField::Type::I32        : return sol::make_object(L, *reinterpret_cast<const i32*>(ptr));
+    case ComponentField::Type::U32        : return sol::make_object(L, *reinterpret_cast<const u32*>(ptr));
+    case ComponentField::Type::I64        : return sol::make_object(L, *reinterpret_cast<const i64*>(ptr));
+    case ComponentField::Type::U64        : return sol::make_object(L, *reinterpret_cast<const u64*>(ptr));
+    case ComponentField::Type::Vec2       : return sol::make_object(L, *reinterpret_cast<const glm::vec2*>(ptr));
+    case ComponentField::Type::Vec3       : return sol::make_object(L, *reinterpret_cast<const glm::vec3*>(ptr));
+    case ComponentField::Type::Vec4       : return sol::make_object(L, *reinterpret_cast<const glm::vec4*>(ptr));
+    case ComponentField::Type::Quat       : return sol::make_object(L, *reinterpret_cast<const glm::quat*>(ptr));
+    case ComponentField::Type::Unsupported: return sol::lua_nil;
+  }
+
+  return sol::lua_nil;
+}
+
+auto lua_to_component_field(ComponentField::Type type, u8* ptr, const sol::object& value) -> bool {
+  switch (type) {
+    case ComponentField::Type::Bool: {
+      if (!value.is<bool>())
+        return false;
+      *reinterpret_cast<bool*>(ptr) = value.as<bool>();
+      return true;
+    }
+    case ComponentField::Type::F32: {
+      if (!value.is<f64>())
+        return false;
+      *reinterpret_cast<f32*>(ptr) = static_cast<f32>(value.as<f64>());
+      return true;
+    }
+    case ComponentField::Type::I32: {
+      if (!value.is<i64>())
+        return false;
+      *reinterpret_cast<i32*>(ptr) = static_cast<i32>(value.as<i64>());
+      return true;
+    }
+    case ComponentField::Type::U32: {
+      if (!value.is<i64>())
+        return false;
+      *reinterpret_cast<u32*>(ptr) = static_cast<u32>(value.as<i64>());
+      return true;
+    }
+    case ComponentField::Type::I64: {
+      if (!value.is<i64>())
+        return false;
+      *reinterpret_cast<i64*>(ptr) = value.as<i64>();
+      return true;
+    }
+    case ComponentField::Type::U64: {
+      if (!value.is<i64>())
+        return false;
+      *reinterpret_cast<u64*>(ptr) = static_cast<u64>(value.as<i64>());
+      return true;
+    }
+    case ComponentField::Type::Vec2: {
+      if (!value.is<glm::vec2>())
+        return false;
+      *reinterpret_cast<glm::vec2*>(ptr) = value.as<glm::vec2>();
+      return true;
+    }
+    case ComponentField::Type::Vec3: {
+      if (!value.is<glm::vec3>())
+        return false;
+      *reinterpret_cast<glm::vec3*>(ptr) = value.as<glm::vec3>();
+      return true;
+    }
+    case ComponentField::Type::Vec4: {
+      if (!value.is<glm::vec4>())
+        return false;
+      *reinterpret_cast<glm::vec4*>(ptr) = value.as<glm::vec4>();
+      return true;
+    }
+    case ComponentField::Type::Quat: {
+      if (!value.is<glm::quat>())
+        return false;
+      *reinterpret_cast<glm::quat*>(ptr) = value.as<glm::quat>();
+      return true;
+    }
+    case ComponentField::Type::Unsupported: return false;
+  }
+
+  return false;
+}
+
+auto ComponentLayout::find_field(std::string_view name) const -> option<ComponentField> {
+  const auto it = fields.find(std::string(name));
+  if (it == fields.end())
+    return nullopt;
+
+  return it->second;
+}
+
+auto LuaQueryChunk::entity(u32 index) const -> flecs::entity {
+  if (index == 0 || index > count())
+    return {};
+
+  return iter->entity(index - 1);
+}
+
+auto LuaQueryChunk::column(u32 term, std::string_view field_name) const -> LuaQueryColumn {
+  if (term == 0 || term > query->get_term_count()) {
+    OX_LOG_ERROR("Query term {} is out of range!", term);
+    return {};
+  }
+
+  const auto* layout = query->get_layout(term - 1);
+  const auto field = layout->find_field(field_name);
+  if (!field.has_value()) {
+    OX_LOG_ERROR("Component '{}' has no field named '{}'!", layout->component.name().c_str(), field_name);
+    return {};
+  }
+
+  const auto field_index = static_cast<i8>(term - 1);
+  auto* data = static_cast<u8*>(ecs_field_w_size(iter->c_ptr(), layout->size, field_index));
+  if (!data)
+    return {};
+
+  return {
+      .data = data + field->offset,
+      .stride = ecs_field_is_self(iter->c_ptr(), field_index) ? layout->size : 0,
+      .count = count(),
+      .type = field->type,
+  };
+}
+
+auto LuaQueryChunk::mark_modified(u32 term) const -> void {
+  ZoneScoped;
+
+  if (term == 0 || term > query->get_term_count())
+    return;
+
+  const auto component = query->get_layout(term - 1)->component;
+  for (auto i : *iter) {
+    iter->entity(i).modified(component);
+  }
+}
+
+LuaQuery::LuaQuery(flecs::world& world_, std::vector<const ComponentLayout*> layouts_)
+    : world(world_.c_ptr()),
+      layouts(std::move(layouts_)) {
+  ZoneScoped;
+
+  auto builder = world_.query_builder<>();
+  for (const auto* layout : layouts) {
+    builder.with(layout->component);
+  }
+
+  query = builder.cached().build();
+}
+
+LuaQuery::~LuaQuery() {
+  if (query)
+    query.destruct();
+}
+
+auto LuaQueryCache::find_component(std::string_view name) -> flecs::entity {
+  ZoneScoped;
+
+  for (const auto& id : scene->component_db.get_components()) {
+    const auto component = id.entity();
+    if (std::string_view(component.name().c_str()) == name || std::string_view(component.path().c_str()) == name)
+      return component;
+  }
+
+  return {};
+}
+
+auto LuaQueryCache::get_layout(flecs::entity component) -> const ComponentLayout* {
+  ZoneScoped;
+
+  if (!component || !component.has<flecs::Struct>())
+    return nullptr;
+
+  std::lock_guard lock(layout_mutex);
+  if (const auto it = layouts.find(component.id()); it != layouts.end())
+    return it->second.get();
+
+  auto world = component.world();
+  auto layout = std::make_unique<ComponentLayout>();
+  layout->component = component;
+  layout->size = component.get<flecs::Component>()->size;
+
+  const auto* struct_data = component.get<flecs::Struct>();
+  const auto member_count = ecs_vec_count(&struct_data->members);
+  const auto* members = static_cast<const ecs_member_t*>(ecs_vec_first(&struct_data->members));
+  for (i32 i = 0; i < member_count; i++) {
+    const auto& member = members[i];
+    const auto type = resolve_field_type(world, member.type);
+    if (type == ComponentField::Type::Unsupported)
+      continue;
+
+    layout->fields.emplace(member.name, ComponentField{.type = type, .offset = static_cast<u32>(member.offset)});
+  }
+
+  return layouts.emplace(component.id(), std::move(layout)).first->second.get();
+}
+
+auto LuaQueryCache::get_layout(std::string_view component_name) -> const ComponentLayout* {
+  return get_layout(find_component(component_name));
+}
+
+auto LuaQueryCache::get_query(std::span<const std::string> component_names) -> LuaQuery* {
+  ZoneScoped;
+
+  std::string key = {};
+  for (const auto& name : component_names) {
+    key += name;
+    key += ';';
+  }
+
+  if (const auto it = queries.find(key); it != queries.end())
+    return it->second.get();
+
+  std::vector<const ComponentLayout*> query_layouts = {};
+  query_layouts.reserve(component_names.size());
+  for (const auto& name : component_names) {
+    const auto* layout = get_layout(name);
+    if (!layout) {
+      OX_LOG_ERROR("Can't query unknown or non reflected component '{}'!", name);
+      return nullptr;
+    }
+
+    query_layouts.push_back(layout);
+  }
+
+  auto query = std::make_unique<LuaQuery>(scene->world, std::move(query_layouts));
+  return queries.emplace(std::move(key), std::move(query)).first->second.get();
+}
+
+auto bind_lua_query_types(sol::state* state) -> void {
+  ZoneScoped;
+
+  auto query_type = state->new_usertype<LuaQuery>("Query", sol::no_constructor);
+  query_type.set_function("count", &LuaQuery::get_entity_count);
+  // `fn(chunk)` is called once per matched table, returning false stops the iteration.
+  query_type.set_function("each_chunk", [](const LuaQuery& self, const sol::protected_function& fn) {
+    self.each_chunk([&fn](const LuaQueryChunk& chunk) {
+      const auto result = fn.call(&chunk);
+      if (!result.valid()) {
+        const sol::error err = result;
+        OX_LOG_ERROR("Error in query chunk function: {}", err.what());
+        return false;
+      }
+
+      const sol::object ret = result;
+      return !ret.is<bool>() || ret.as<bool>();
+    });
+  });
+
+  auto chunk_type = state->new_usertype<LuaQueryChunk>("QueryChunk", sol::no_constructor);
+  chunk_type.set_function("count", &LuaQueryChunk::count);
+  chunk_type.set_function("entity", &LuaQueryChunk::entity);
+  chunk_type.set_function("column", &LuaQueryChunk::column);
+  chunk_type.set_function("mark_modified", &LuaQueryChunk::mark_modified);
+
+  // Typed accessors return and take plain numbers, so iterating a column allocates nothing.
+  // A mismatched accessor reads zeros and ignores writes.
+  auto column_type = state->new_usertype<LuaQueryColumn>("QueryColumn", sol::no_constructor);
+  column_type.set_function("count", [](const LuaQueryColumn& self) { return self.count; });
+  column_type.set_function("get", [](const LuaQueryColumn& self, u32 index, sol::this_state lua) -> sol::object {
+    const auto* ptr = self.at<const u8>(index);
+    if (!ptr)
+      return sol::lua_nil;
+
+    return component_field_to_lua(lua, self.type, ptr);
+  });
+  column_type.set_function("set", [](const LuaQueryColumn& self, u32 index, const sol::object& value) {
+    if (auto* ptr = self.at<u8>(index))
+      lua_to_component_field(self.type, ptr, value);
+  });
+  column_type.set_function("get_number", [](const LuaQueryColumn& self, u32 index) -> f64 {
+    const auto* ptr = self.at<const u8>(index);
+    if (!ptr)
+      return 0.0;
+
+    switch (self.type) {
+      case ComponentField::Type::F32: return *reinterpret_cast<const f32*>(ptr);
+      case ComponentField::Type::I32: return *reinterpret_cast<const i32*>(ptr);
+      case ComponentField::Type::U32: return *reinterpret_cast<const u32*>(ptr);
+      case ComponentField::Type::I64: return static_cast<f64>(*reinterpret_cast<const i64*>(ptr));
+      case ComponentField::Type::U64: return static_cast<f64>(*reinterpret_cast<const u64*>(ptr));
+      default                       : return 0.0;
+    }
+  });
+  column_type.set_function("set_number", [](const LuaQueryColumn& self, u32 index, f64 value) {
+    auto* ptr = self.at<u8>(index);
+    if (!ptr)
+      return;
+
+    switch (self.type) {
+      case ComponentField::Type::F32: *reinterpret_cast<f32*>(ptr) = static_cast<f32>(value); break;
+      case ComponentField::Type::I32: *reinterpret_cast<i32*>(ptr) = static_cast<i32>(value); break;
+      case ComponentField::Type::U32: *reinterpret_cast<u32*>(ptr) = static_cast<u32>(value); break;
+      case ComponentField::Type::I64: *reinterpret_cast<i64*>(ptr) = static_cast<i64>(value); break;
+      case ComponentField::Type::U64: *reinterpret_cast<u64*>(ptr) = static_cast<u64>(value); break;
+      default                       : break;
+    }
+  });
+  column_type.set_function("get_bool", [](const LuaQueryColumn& self, u32 index) -> bool {
+    const auto* ptr = self.type == ComponentField::Type::Bool ? self.at<const bool>(index) : nullptr;
+    return ptr ? *ptr : false;
+  });
+  column_type.set_function("set_bool", [](const LuaQueryColumn& self, u32 index, bool value) {
+    if (auto* ptr = self.type == ComponentField::Type::Bool ? self.at<bool>(index) : nullptr)
+      *ptr = value;
+  });
+  column_type.set_function("get_xy", [](const LuaQueryColumn& self, u32 index) -> std::tuple<f32, f32> {
+    const auto* ptr = self.type == ComponentField::Type::Vec2 ? self.at<const glm::vec2>(index) : nullptr;
+    return ptr ? std::tuple(ptr->x, ptr->y) : std::tuple(0.0f, 0.0f);
+  });
+  column_type.set_function("set_xy", [](const LuaQueryColumn& self, u32 index, f32 x, f32 y) {
+    if (auto* ptr = self.type == ComponentField::Type::Vec2 ? self.at<glm::vec2>(index) : nullptr)
+      *ptr = {x, y};
+  });
+  column_type.set_function("get_xyz", [](const LuaQueryColumn& self, u32 index) -> std::tuple<f32, f32, f32> {
+    const auto* ptr = self.type == ComponentField::Type::Vec3 ? self.at<const glm::vec3>(index) : nullptr;
+    return ptr ? std::tuple(ptr->x, ptr->y, ptr->z) : std::tuple(0.0f, 0.0f, 0.0f);
+  });
+  column_type.set_function("set_xyz", [](const LuaQueryColumn& self, u32 index, f32 x, f32 y, f32 z) {
+    if (auto* ptr = self.type == ComponentField::Type::Vec3 ? self.at<glm::vec3>(index) : nullptr)
+      *ptr = {x, y, z};
+  });
+  column_type.set_function("get_xyzw", [](const LuaQueryColumn& self, u32 index) -> std::tuple<f32, f32, f32, f32> {
+    const bool is_vec4 = self.type == ComponentField::Type::Vec4 || self.type == ComponentField::Type::Quat;
+    const auto* ptr = is_vec4 ? self.at<const f32>(index) : nullptr;
+    return ptr ? std::tuple(ptr[0], ptr[1], ptr[2], ptr[3]) : std::tuple(0.0f, 0.0f, 0.0f, 0.0f);
+  });
+  column_type.set_function("set_xyzw", [](const LuaQueryColumn& self, u32 index, f32 x, f32 y, f32 z, f32 w) {
+    const bool is_vec4 = self.type == ComponentField::Type::Vec4 || self.type == ComponentField::Type::Quat;
+    if (auto* ptr = is_vec4 ? self.at<f32>(index) : nullptr) {
+      ptr[0] = x;
+      ptr[1] = y;
+      ptr[2] = z;
+      ptr[3] = w;
+    }
+  });
+}
+} // namespace ox
@@ -6,12 +6,22 @@
 #include <sol/state.hpp>
 
 #include "Core/App.hpp"
+#include "Physics/ContactEvents.hpp"
 #include "Scene/Scene.hpp"
 #include "Scripting/LuaManager.hpp"
 
 namespace ox {
+static u64 next_script_version = 1;
+
 LuaSystem::LuaSystem(std::string path) : file_path(std::move(path)) { init_script(file_path); }
 
+LuaSystem::LuaSystem(sol::state& state, std::string path, std::string_view source_)
+    : file_path(std::move(path)),
+      source_state(&state),
+      source(source_) {
+  init_environment(state, state.load(source, "@" + file_path, sol::load_mode::text));
+}
+
 void LuaSystem::check_result(const sol::protected_function_result& result, const char* func_name) {
   if (!result.valid()) {
     const sol::error err = result;
@@ -19,6 +29,8 @@ void LuaSystem::check_result(const sol::protected_function_result& result, const
   }
 }
 
+auto LuaSystem::profile_scope() const -> LuaProfiler::Scope { return {profiler, file_path}; }
+
 void LuaSystem::init_script(const std::string& path) {
   ZoneScoped;
   if (!std::filesystem::exists(path)) {
@@ -26,18 +38,26 @@ void LuaSystem::init_script(const std::string& path) {
     return;
   }
 
-  const auto state = App::get_system<LuaManager>(EngineSystems::LuaManager)->get_state();
-  environment = std::make_unique<sol::environment>(*state, sol::create, state->globals());
+  auto* lua_manager = App::get_system<LuaManager>(EngineSystems::LuaManager);
+  profiler = &lua_manager->get_profiler();
+  init_environment(*lua_manager->get_state(), lua_manager->load_script_chunk(file_path));
+}
 
-  const auto load_file_result = state->script_file(file_path, *environment, sol::script_pass_on_error);
+void LuaSystem::init_environment(sol::state& state, sol::load_result load_result) {
+  environment = std::make_unique<sol::environment>(state, sol::create, state.globals());
+  errors.clear();
+  isolated = false;
+  bytecode.clear();
+  version = next_script_version++;
 
-  if (!load_file_result.valid()) {
-    const sol::error err = load_file_result;
+  const auto on_error = [this](const sol::error& err) {
     OX_LOG_ERROR("Failed to Execute Lua script {0}", file_path);
     OX_LOG_ERROR("Error : {0}", err.what());
     std::string error = std::string(err.what());
 
     const auto linepos = error.find(".lua:");
+    if (linepos == std::string::npos)
+      return;
     std::string error_line = error.substr(linepos + 5); //+4 .lua: + 1
     const auto linepos_end = error_line.find(':');
     error_line = error_line.substr(0, linepos_end);
@@ -45,6 +65,23 @@ void LuaSystem::init_script(const std::string& path) {
     error = error.substr(linepos + error_line.size() + linepos_end + 4); //+4 .lua:
 
     errors[line] = error;
+  };
+
+  if (!load_result.valid()) {
+    const sol::error err = load_result;
+    on_error(err);
+  } else {
+    sol::protected_function chunk = load_result;
+    sol::set_environment(*environment, chunk);
+    const auto run_result = chunk();
+    if (!run_result.valid()) {
+      const sol::error err = run_result;
+      on_error(err);
+    } else if ((*environment)["isolated"].get_or(false)) {
+      isolated = true;
+      const auto dumped = chunk.dump();
+      bytecode = std::string(dumped.as_string_view());
+    }
   }
 
   for (auto [l, e] : errors) {
@@ -59,6 +96,10 @@ void LuaSystem::init_script(const std::string& path) {
   if (!on_update_func->valid())
     on_update_func.reset();
 
+  on_update_batch_func = std::make_unique<sol::protected_function>((*environment)["on_update_batch"]);
+  if (!on_update_batch_func->valid())
+    on_update_batch_func.reset();
+
   on_fixed_update_func = std::make_unique<sol::protected_function>((*environment)["on_fixed_update"]);
   if (!on_fixed_update_func->valid())
     on_fixed_update_func.reset();
@@ -71,13 +112,33 @@ void LuaSystem::init_script(const std::string& path) {
   if (!on_release_func->valid())
     on_release_func.reset();
 
-  state->collect_gc();
+  on_contacts_func = std::make_unique<sol::protected_function>((*environment)["on_contacts"]);
+  if (!on_contacts_func->valid())
+    on_contacts_func.reset();
 }
 
-void LuaSystem::on_init(Scene* scene, flecs::entity entity) {
+auto LuaSystem::start_scripts(Scene* scene,
+                              std::span<const std::pair<LuaSystem*, flecs::entity>> scripts,
+                              f32 delta_time) -> u32 {
   ZoneScoped;
+
+  ankerl::unordered_dense::set<LuaSystem*> reloaded_scripts = {};
+  for (const auto& [script, entity] : scripts) {
+    if (reloaded_scripts.insert(script).second) {
+      script->reload();
+    }
+    script->on_init(scene, entity, delta_time);
+  }
+
+  return static_cast<u32>(reloaded_scripts.size());
+}
+
+void LuaSystem::on_init(Scene* scene, flecs::entity entity, f32 delta_time) {
+  ZoneScoped;
+  ZoneText(file_path.c_str(), file_path.size());
   if (on_init_func) {
-    bind_globals(scene, entity, static_cast<f32>(App::get_timestep().get_millis()));
+    const auto scope = profile_scope();
+    bind_globals(scene, entity, delta_time);
     const auto result = on_init_func->call();
     check_result(result, "on_init");
   }
@@ -85,15 +146,46 @@ void LuaSystem::on_init(Scene* scene, flecs::entity entity) {
 
 void LuaSystem::on_update(f32 delta_time) {
   ZoneScoped;
+  ZoneText(file_path.c_str(), file_path.size());
   if (on_update_func) {
+    const auto scope = profile_scope();
     const auto result = on_update_func->call(delta_time);
     check_result(result, "on_update");
   }
 }
 
+void LuaSystem::on_update_batch(Scene* scene, const std::vector<flecs::entity>& entities, f32 delta_time) {
+  ZoneScoped;
+  ZoneText(file_path.c_str(), file_path.size());
+  if (on_update_batch_func) {
+    const auto scope = profile_scope();
+    if (scene) {
+      (*environment)["scene"] = scene;
+      (*environment)["world"] = std::ref(scene->world);
+    }
+    (*environment)["delta_time"] = delta_time;
+    const auto result = on_update_batch_func->call(&entities, delta_time);
+    check_result(result, "on_update_batch");
+  }
+}
+
+auto LuaSystem::update_entities(Scene* scene, const std::vector<flecs::entity>& entities, f32 delta_time) -> void {
+  if (has_batch_update()) {
+    on_update_batch(scene, entities, delta_time);
+    return;
+  }
+
+  for (const auto entity : entities) {
+    bind_globals(scene, entity, delta_time);
+    on_update(delta_time);
+  }
+}
+
 void LuaSystem::on_fixed_update(float delta_time) {
   ZoneScoped;
+  ZoneText(file_path.c_str(), file_path.size());
   if (on_fixed_update_func) {
+    const auto scope = profile_scope();
     const auto result = on_fixed_update_func->call(delta_time);
     check_result(result, "on_fixed_update");
   }
@@ -101,17 +193,30 @@ void LuaSystem::on_fixed_update(float delta_time) {
 
 void LuaSystem::on_release(Scene* scene, flecs::entity entity) {
   ZoneScoped;
+  ZoneText(file_path.c_str(), file_path.size());
   if (on_release_func) {
+    const auto scope = profile_scope();
     const auto result = on_release_func->call();
     check_result(result, "on_release");
   }
+}
 
-  App::get_system<LuaManager>(EngineSystems::LuaManager)->get_state()->collect_gc();
+void LuaSystem::on_contacts(Scene* scene, const std::vector<ContactEvent>& events) {
+  ZoneScoped;
+  ZoneText(file_path.c_str(), file_path.size());
+  if (on_contacts_func) {
+    const auto scope = profile_scope();
+    (*environment)["scene"] = scene;
+    const auto result = on_contacts_func->call(&events);
+    check_result(result, "on_contacts");
+  }
 }
 
 void LuaSystem::on_render(vuk::Extent3D extent, vuk::Format format) {
   ZoneScoped;
+  ZoneText(file_path.c_str(), file_path.size());
   if (on_render_func) {
+    const auto scope = profile_scope();
     const auto result = on_render_func->call(extent, format);
     check_result(result, "on_render");
   }
@@ -132,12 +237,18 @@ void LuaSystem::reload() {
     }
   }
 
-  init_script(file_path);
+  if (source_state) {
+    init_environment(*source_state, source_state->load(source, "@" + file_path, sol::load_mode::text));
+  } else {
+    init_script(file_path);
+  }
 }
 
 void LuaSystem::bind_globals(Scene* scene, flecs::entity entity, f32 delta_time) const {
-  (*environment)["scene"] = scene;
-  (*environment)["world"] = std::ref(scene->world);
+  if (scene) {
+    (*environment)["scene"] = scene;
+    (*environment)["world"] = std::ref(scene->world);
+  }
   (*environment)["this"] = entity;
   (*environment)["delta_time"] = delta_time;
 }
@@ -0,0 +1,273 @@
+#include "Scripting/LuaWorkerPool.hpp"
+
+#include <cstring>
+#include <sol/sol.hpp>
+
+#include "Core/App.hpp"
+#include "Scene/Scene.hpp"
+#include "Scripting/LuaSystem.hpp"
+#include "Thread/TaskScheduler.hpp"
+
+#ifdef OX_LUA_BINDINGS
+  #include "Scripting/LuaMathBindings.hpp"
+#endif
+
+namespace ox {
+struct LuaWorkerPool::UpdateTask : ITaskSet {
+  LuaWorkerPool* pool = nullptr;
+  std::span<const LuaIsolatedJob> jobs = {};
+  f32 delta_time = 0.0f;
+
+  UpdateTask(LuaWorkerPool* pool_, std::span<const LuaIsolatedJob> jobs_, f32 delta_time_)
+      : pool(pool_),
+        jobs(jobs_),
+        delta_time(delta_time_) {
+    this->m_SetSize = static_cast<u32>(jobs.size());
+    this->m_MinRange = 4;
+  }
+
+  void ExecuteRange(const enki::TaskSetPartition range, u32 threadNum) override {
+    ZoneScopedN("Lua Isolated Scripts");
+
+    auto& worker = *pool->workers[threadNum];
+    for (u32 i = range.start; i < range.end; ++i) {
+      run_job(worker, jobs[i], i, delta_time);
+    }
+  }
+};
+
+LuaWorkerPool::LuaWorkerPool(u32 worker_count) {
+  ZoneScoped;
+
+  workers.resize(worker_count);
+  for (auto& worker : workers) {
+    worker = std::make_unique<Worker>();
+    init_worker(*worker);
+  }
+}
+
+auto LuaWorkerPool::run(Scene* scene, std::span<const LuaIsolatedJob> jobs, f32 delta_time) -> void {
+  ZoneScoped;
+
+  if (jobs.empty())
+    return;
+
+  // Created here so workers only ever read it.
+  scene->get_lua_queries();
+  for (auto& worker : workers) {
+    worker->scene = scene;
+    worker->commands.clear();
+  }
+
+  auto* task_scheduler = App::get_system<TaskScheduler>(EngineSystems::TaskScheduler);
+  auto task = UpdateTask(this, jobs, delta_time);
+  task_scheduler->schedule_task(&task);
+  task_scheduler->wait_task(&task);
+
+  apply_commands(scene);
+
+  TracyPlot("Lua Isolated Jobs", static_cast<i64>(jobs.size()));
+}
+
+auto LuaWorkerPool::reset() -> void {
+  ZoneScoped;
+
+  for (auto& worker : workers) {
+    worker->scripts.clear();
+    worker->commands.clear();
+    worker->scene = nullptr;
+    worker->state->collect_gc();
+  }
+}
+
+auto LuaWorkerPool::init_worker(Worker& worker) -> void {
+  ZoneScoped;
+
+  worker.allocator = std::make_unique<LuaAllocator>();
+  worker.state = std::make_unique<sol::state>(sol::default_at_panic, &LuaAllocator::lua_alloc, worker.allocator.get());
+  auto& state = *worker.state;
+  state.open_libraries(sol::lib::base, sol::lib::math, sol::lib::table, sol::lib::string);
+
+#ifdef OX_LUA_BINDINGS
+  LuaBindings::bind_math(&state);
+#endif
+
+  auto log = state.create_table("Log");
+  log.set_function("info", [](const std::string_view message) { OX_LOG_INFO("{}", message); });
+  log.set_function("warn", [](const std::string_view message) { OX_LOG_WARN("{}", message); });
+  log.set_function("error", [](const std::string_view message) { OX_LOG_ERROR("{}", message); });
+
+  auto* w = &worker;
+  const auto record = [w](LuaCommand&& command) {
+    command.job_index = w->job_index;
+    command.sequence = w->sequence++;
+    w->commands.emplace_back(std::move(command));
+  };
+
+  auto ecs = state.create_table("ecs");
+  ecs.set_function("get",
+                   [w](u64 entity,
+                       const std::string_view component,
+                       const std::string_view field,
+                       sol::this_state lua) -> sol::object {
+    const auto* layout = w->scene->get_lua_queries().get_layout(component);
+    if (!layout)
+      return sol::lua_nil;
+
+    const auto info = layout->find_field(field);
+    const auto e = flecs::entity(w->scene->world, entity);
+    if (!info.has_value() || !e.is_alive())
+      return sol::lua_nil;
+
+    const auto* data = static_cast<const u8*>(e.get(layout->component));
+    if (!data)
+      return sol::lua_nil;
+
+    return component_field_to_lua(lua, info->type, data + info->offset);
+  });
+  ecs.set_function("set",
+                   [w, record](u64 entity,
+                               const std::string_view component,
+                               const std::string_view field,
+                               const sol::object& value) -> bool {
+    const auto* layout = w->scene->get_lua_queries().get_layout(component);
+    if (!layout)
+      return false;
+
+    const auto info = layout->find_field(field);
+    if (!info.has_value())
+      return false;
+
+    auto command = LuaCommand{
+        .type = LuaCommand::Type::SetField,
+        .entity = entity,
+        .component = layout->component.id(),
+        .field = *info,
+    };
+    if (!lua_to_component_field(info->type, command.value, value))
+      return false;
+
+    record(std::move(command));
+    return true;
+  });
+  ecs.set_function("add", [w, record](u64 entity, const std::string_view component) -> bool {
+    const auto id = w->scene->get_lua_queries().find_component(component);
+    if (!id)
+      return false;
+
+    record({.type = LuaCommand::Type::Add, .entity = entity, .component = id.id()});
+    return true;
+  });
+  ecs.set_function("remove", [w, record](u64 entity, const std::string_view component) -> bool {
+    const auto id = w->scene->get_lua_queries().find_component(component);
+    if (!id)
+      return false;
+
+    record({.type = LuaCommand::Type::Remove, .entity = entity, .component = id.id()});
+    return true;
+  });
+  ecs.set_function("destroy", [record](u64 entity) { record({.type = LuaCommand::Type::Destroy, .entity = entity}); });
+  ecs.set_function("create", [record](const std::string& name) {
+    record({.type = LuaCommand::Type::Create, .name = name});
+  });
+}
+
+auto LuaWorkerPool::get_script(Worker& worker, const LuaSystem* script) -> WorkerScript* {
+  if (auto it = worker.scripts.find(script); it != worker.scripts.end() && it->second.version == script->get_version())
+    return &it->second;
+
+  ZoneScoped;
+
+  auto worker_script = WorkerScript{.version = script->get_version()};
+  const auto& bytecode = script->get_bytecode();
+  auto load_result = worker.state->load_buffer(
+      bytecode.data(), bytecode.size(), "@" + script->get_path(), sol::load_mode::binary);
+  if (!load_result.valid()) {
+    const sol::error err = load_result;
+    OX_LOG_ERROR("Failed to load isolated script {}: {}", script->get_path(), err.what());
+  } else {
+    worker_script.environment = std::make_unique<sol::environment>(
+        *worker.state, sol::create, worker.state->globals());
+    sol::protected_function chunk = load_result;
+    sol::set_environment(*worker_script.environment, chunk);
+    const auto run_result = chunk();
+    if (!run_result.valid()) {
+      const sol::error err = run_result;
+      OX_LOG_ERROR("Failed to execute isolated script {}: {}", script->get_path(), err.what());
+    } else {
+      worker_script.on_update_func = std::make_unique<sol::protected_function>(
+          (*worker_script.environment)["on_update"]);
+      if (!worker_script.on_update_func->valid())
+        worker_script.on_update_func.reset();
+    }
+  }
+
+  // Failed loads are cached too, so a broken script is reported once per version.
+  return &(worker.scripts[script] = std::move(worker_script));
+}
+
+auto LuaWorkerPool::run_job(Worker& worker, const LuaIsolatedJob& job, u32 job_index, f32 delta_time) -> void {
+  const auto& [script, entity] = job;
+  auto* worker_script = get_script(worker, script);
+  if (!worker_script || !worker_script->on_update_func)
+    return;
+
+  worker.job_index = job_index;
+  worker.sequence = 0;
+
+  auto& environment = *worker_script->environment;
+  environment["this"] = entity.id();
+  environment["delta_time"] = delta_time;
+
+  const auto result = worker_script->on_update_func->call(delta_time);
+  if (!result.valid()) {
+    const sol::error err = result;
+    OX_LOG_ERROR("Error in isolated on_update of {}: {}", script->get_path(), err.what());
+  }
+}
+
+auto LuaWorkerPool::apply_commands(Scene* scene) -> void {
+  ZoneScoped;
+
+  merged_commands.clear();
+  for (auto& worker : workers) {
+    std::ranges::move(worker->commands, std::back_inserter(merged_commands));
+    worker->commands.clear();
+  }
+
+  std::ranges::sort(merged_commands, {}, [](const LuaCommand& c) { return std::pair(c.job_index, c.sequence); });
+
+  for (auto& command : merged_commands) {
+    auto entity = flecs::entity(scene->world, command.entity);
+    switch (command.type) {
+      case LuaCommand::Type::SetField: {
+        if (!entity.is_alive())
+          break;
+        auto* data = static_cast<u8*>(entity.get_mut(command.component));
+        if (!data)
+          break;
+        std::memcpy(data + command.field.offset, command.value, get_field_size(command.field.type));
+        entity.modified(command.component);
+      } break;
+      case LuaCommand::Type::Add: {
+        if (entity.is_alive())
+          entity.add(command.component);
+      } break;
+      case LuaCommand::Type::Remove: {
+        if (entity.is_alive())
+          entity.remove(command.component);
+      } break;
+      case LuaCommand::Type::Destroy: {
+        if (entity.is_alive())
+          entity.destruct();
+      } break;
+      case LuaCommand::Type::Create: {
+        scene->create_entity(command.name);
+      } break;
+    }
+  }
+
+  TracyPlot("Lua Deferred Commands", static_cast<i64>(merged_commands.size()));
+  merged_commands.clear();
+}
+} // namespace ox
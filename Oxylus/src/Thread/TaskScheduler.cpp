@@ -5,7 +5,10 @@ namespace ox {
 auto TaskScheduler::init() -> std::expected<void, std::string> {
   ZoneScoped;
   task_scheduler = std::make_unique<enki::TaskScheduler>();
-  task_scheduler->Initialize();
+  auto config = task_scheduler->GetConfig();
+  // The render thread prepares frames with tasks of its own.
+  config.numExternalTaskThreads = 1;
+  task_scheduler->Initialize(config);
   task_sets.reserve(100);
 
   return {};
@@ -16,6 +19,11 @@ auto TaskScheduler::deinit() -> std::expected<void, std::string> {
   return {};
 }
 
+void TaskScheduler::register_current_thread() const {
+  if (task_scheduler->GetThreadNum() == enki::NO_THREAD_NUM)
+    task_scheduler->RegisterExternalTaskThread();
+}
+
 void TaskScheduler::wait_for_all() {
   task_scheduler->WaitforAll();
 
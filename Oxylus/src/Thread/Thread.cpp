@@ -17,7 +17,7 @@ Thread::~Thread() {
 void Thread::queue_job(std::function<void()> function) {
   std::lock_guard lock(queue_mutex);
   job_queue.push(std::move(function));
-  condition.notify_one();
+  condition.notify_all();
 }
 
 void Thread::wait() {
@@ -42,7 +42,7 @@ void Thread::queue_loop() {
     {
       std::lock_guard lock(queue_mutex);
       job_queue.pop();
-      condition.notify_one();
+      condition.notify_all();
     }
   }
 }
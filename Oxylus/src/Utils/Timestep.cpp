@@ -1,28 +1,76 @@
 ﻿#include "Utils/Timestep.hpp"
 
+#include "OS/OS.hpp"
 #include "Utils/Timer.hpp"
 
 namespace ox {
 Timestep::Timestep() : timestep(0.0), last_time(0.0), elapsed(0.0) { timer = new Timer(); }
 
+Timestep::Timestep(Clock clock_) : Timestep() { clock = std::move(clock_); }
+
 Timestep::~Timestep() { delete timer; }
 
 void Timestep::on_update(this Timestep& self) {
   ZoneScoped;
 
-  f64 current_time = self.timer->get_elapsed_msd();
-  f64 dt = current_time - self.last_time;
+  self.sleep_time = 0.0;
+  self.spin_time = 0.0;
+  self.pacing_error = 0.0;
 
-  {
+  if (self.max_frame_time > 0.0) {
     ZoneNamedN(z, "Sleep TimeStep to target fps", true);
-    while (dt < self.max_frame_time) {
-      current_time = self.timer->get_elapsed_msd();
-      dt = current_time - self.last_time;
-    }
+    self.wait_until(self.last_time + self.max_frame_time);
+  }
+
+  const f64 current_time = self.now();
+  if (self.max_frame_time > 0.0) {
+    self.pacing_error = ox::max(current_time - self.last_time - self.max_frame_time, 0.0);
   }
 
   self.timestep = current_time - self.last_time;
   self.last_time = current_time;
   self.elapsed += self.timestep;
+
+  TracyPlot("Frame Limiter Sleep", self.sleep_time);
+  TracyPlot("Frame Limiter Spin", self.spin_time);
+}
+
+auto Timestep::wait_until(this Timestep& self, f64 target_time) -> void {
+  // One high resolution sleep through everything but the expected wake up latency, then
+  // spin for the rest to hit the target precisely.
+  f64 current_time = self.now();
+  const f64 sleep_start = current_time;
+  const f64 sleep_duration = target_time - current_time - self.sleep_overshoot;
+  if (sleep_duration > 0.0) {
+    self.sleep(sleep_duration);
+    current_time = self.now();
+
+    constexpr f64 ALPHA = 1.0 / 32.0;
+    const f64 overshoot = ox::max(current_time - sleep_start - sleep_duration, 0.0);
+    const f64 delta = overshoot - self.overshoot_mean;
+    self.overshoot_mean += ALPHA * delta;
+    self.overshoot_variance = (1.0 - ALPHA) * (self.overshoot_variance + ALPHA * delta * delta);
+    self.sleep_overshoot = ox::min(self.overshoot_mean + std::sqrt(self.overshoot_variance), MAX_SPIN_MILLIS);
+  }
+  self.sleep_time = current_time - sleep_start;
+
+  const f64 spin_start = current_time;
+  while (current_time < target_time) {
+    std::this_thread::yield();
+    current_time = self.now();
+  }
+  self.spin_time = current_time - spin_start;
+}
+
+auto Timestep::now(this const Timestep& self) -> f64 {
+  return self.clock.now ? self.clock.now() : self.timer->get_elapsed_msd();
+}
+
+auto Timestep::sleep(this const Timestep& self, f64 millis) -> void {
+  if (self.clock.sleep) {
+    self.clock.sleep(millis);
+  } else {
+    os::thread_sleep(millis);
+  }
 }
 } // namespace ox
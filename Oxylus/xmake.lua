@@ -14,7 +14,7 @@ target("Oxylus")
     if not has_config("lua_bindings") then
         remove_files("./src/Scripting/*Bindings*")
     else
-        add_defines("OX_LUA_BINDINGS")
+        add_defines("OX_LUA_BINDINGS", { public = true })
     end
 
     if is_plat("windows") then
@@ -26,6 +26,7 @@ target("Oxylus")
         add_defines("_WIN32", { force = true, public = true  })
 
         remove_files("./src/OS/Linux*")
+        add_syslinks("winmm")
 
         add_defines("OX_PLATFORM_WINDOWS", { public = true })
     elseif is_plat("linux") then
@@ -59,6 +60,12 @@ target("Oxylus")
         elseif target:has_tool("cxx", "gcc", "gxx") then
             target:add("defines", "OX_COMPILER_GCC=1", { force = true, public = true })
         end
+
+        -- The SIMD and scalar culling and occluder rasterization must round the same, no fused multiply-adds.
+        if target:has_tool("cxx", "clang", "clangxx", "gcc", "gxx") then
+            target:fileconfig_add("./src/Render/InstanceCulling.cpp", { cxxflags = "-ffp-contract=off" })
+            target:fileconfig_add("./src/Render/OcclusionCulling.cpp", { cxxflags = "-ffp-contract=off" })
+        end
     end)
 
     add_cxxflags(
@@ -248,66 +248,45 @@ void InspectorPanel::draw_material_properties(Material* material, const UUID& ma
   }
 }
 
+// Modules are flattened in `ParticleSystemComponent`, by speed modules also pass their speed range.
 template <typename T>
-static void draw_particle_over_lifetime_module(const std::string_view module_name,
-                                               OverLifetimeModule<T>& property_module,
-                                               bool color = false,
-                                               bool rotation = false) {
+static void draw_particle_module(const std::string_view module_name,
+                                 bool& enabled,
+                                 T& start,
+                                 T& end,
+                                 f32* min_speed = nullptr,
+                                 f32* max_speed = nullptr,
+                                 bool color = false) {
   static constexpr ImGuiTreeNodeFlags TREE_FLAGS = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth |
                                                    ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_Framed |
                                                    ImGuiTreeNodeFlags_FramePadding;
 
   if (ImGui::TreeNodeEx(module_name.data(), TREE_FLAGS, "%s", module_name.data())) {
     UI::begin_properties();
-    UI::texture_property("Enabled", &property_module.enabled);
-
-    if (rotation) {
-      T degrees = glm::degrees(property_module.start);
-      if (UI::property_vector("Start", degrees))
-        property_module.start = glm::radians(degrees);
-
-      degrees = glm::degrees(property_module.end);
-      if (UI::property_vector("End", degrees))
-        property_module.end = glm::radians(degrees);
+    UI::property("Enabled", &enabled);
+
+    if constexpr (std::is_same_v<T, f32>) {
+      // Rotations
+      f32 degrees = glm::degrees(start);
+      if (UI::property("Start", &degrees))
+        start = glm::radians(degrees);
+
+      degrees = glm::degrees(end);
+      if (UI::property("End", &degrees))
+        end = glm::radians(degrees);
+    } else if (color) {
+      UI::property_vector("Start", start, true);
+      UI::property_vector("End", end, true);
     } else {
-      UI::property_vector("Start", property_module.start, color);
-      UI::property_vector("End", property_module.end, color);
+      UI::property_vector("Start", start, false, false, nullptr, 0.1f, 0.0f, 0.0f);
+      UI::property_vector("End", end, false, false, nullptr, 0.1f, 0.0f, 0.0f);
     }
 
-    UI::end_properties();
-
-    ImGui::TreePop();
-  }
-}
-
-template <typename T>
-static void draw_particle_by_speed_module(const std::string_view module_name,
-                                          BySpeedModule<T>& property_module,
-                                          bool color = false,
-                                          bool rotation = false) {
-  static constexpr ImGuiTreeNodeFlags TREE_FLAGS = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth |
-                                                   ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_Framed |
-                                                   ImGuiTreeNodeFlags_FramePadding;
-
-  if (ImGui::TreeNodeEx(module_name.data(), TREE_FLAGS, "%s", module_name.data())) {
-    UI::begin_properties();
-    UI::texture_property("Enabled", &property_module.enabled);
-
-    if (rotation) {
-      T degrees = glm::degrees(property_module.start);
-      if (UI::property_vector("Start", degrees))
-        property_module.start = glm::radians(degrees);
-
-      degrees = glm::degrees(property_module.end);
-      if (UI::property_vector("End", degrees))
-        property_module.end = glm::radians(degrees);
-    } else {
-      UI::property_vector("Start", property_module.start, color);
-      UI::property_vector("End", property_module.end, color);
+    if (min_speed && max_speed) {
+      UI::property("Min Speed", min_speed);
+      UI::property("Max Speed", max_speed);
     }
 
-    UI::texture_property("Min Speed", &property_module.min_speed);
-    UI::texture_property("Max Speed", &property_module.max_speed);
     UI::end_properties();
     ImGui::TreePop();
   }
@@ -388,6 +367,7 @@ void InspectorPanel::draw_components(const flecs::entity entity) {
         UI::input_text("Mesh UUID", &mesh_uuid_str, ImGuiInputTextFlags_ReadOnly);
         UI::text("Mesh Index", std::to_string(component.mesh_index));
         UI::property("Cast shadows", &component.cast_shadows);
+        UI::property("Occluder", &component.occluder);
         UI::end_properties();
 
         auto load_event = w->entity("ox_mesh_material_load_event");
@@ -554,6 +534,7 @@ void InspectorPanel::draw_components(const flecs::entity entity) {
         if (UI::property("Looping", &component.looping))
           audio_engine->set_source_looping(audio_asset->get_source(), component.looping);
         UI::property("Play On Awake", &component.play_on_awake);
+        UI::property("Priority", &component.priority);
         UI::end_properties();
 
         ImGui::Spacing();
@@ -604,6 +585,9 @@ void InspectorPanel::draw_components(const flecs::entity entity) {
           ImGui::Unindent();
         }
         UI::end_properties();
+
+        // Lets a running voice see the edits, fields that didn't change are filtered by the voice manager.
+        e.modified<AudioSourceComponent>();
       });
 
   draw_component<AudioListenerComponent>(
@@ -946,62 +930,98 @@ void InspectorPanel::draw_components(const flecs::entity entity) {
         }
       });
 
-#if 0
   draw_component<ParticleSystemComponent>(
-      "Particle System Component", entity, [](const ParticleSystemComponent& component, flecs::entity e) {
-    auto& props = component.system->get_properties();
-
-    ImGui::Text("Active Particles Count: %u", component.system->get_active_particle_count());
-    ImGui::BeginDisabled(props.looping);
-    if (UI::button(StringUtils::from_char8_t(ICON_MDI_PLAY)))
-      component.system->play();
-    ImGui::SameLine();
-    if (UI::button(StringUtils::from_char8_t(ICON_MDI_STOP)))
-      component.system->stop();
-    ImGui::EndDisabled();
+      " Particle System Component",
+      entity,
+      [scene = _scene](ParticleSystemComponent& component, flecs::entity e) {
+        auto& particle_system = scene->particle_system;
+
+        // Emitters only exist while the scene is running.
+        ImGui::Text("Active Particles: %u", particle_system.get_particle_count(component.emitter_id));
+        ImGui::BeginDisabled(component.emitter_id == ParticleEmitterID::Invalid);
+        if (UI::button(StringUtils::from_char8_t(ICON_MDI_PLAY "Play ")))
+          particle_system.play(component.emitter_id);
+        ImGui::SameLine();
+        if (UI::button(StringUtils::from_char8_t(ICON_MDI_STOP "Stop ")))
+          particle_system.stop(component.emitter_id);
+        ImGui::EndDisabled();
 
-    ImGui::Separator();
+        ImGui::Separator();
 
-    UI::begin_properties();
-    UI::texture_property("Duration", &props.duration);
-    if (UI::texture_property("Looping", &props.looping)) {
-      if (props.looping)
-        component.system->play();
-    }
-    UI::texture_property("Start Delay", &props.start_delay);
-    UI::texture_property("Start Lifetime", &props.start_lifetime);
-    UI::property_vector("Start Velocity", props.start_velocity);
-    UI::property_vector("Start Color", props.start_color, true);
-    UI::property_vector("Start Size", props.start_size);
-    UI::property_vector("Start Rotation", props.start_rotation);
-    UI::texture_property("Gravity Modifier", &props.gravity_modifier);
-    UI::texture_property("Simulation Speed", &props.simulation_speed);
-    UI::texture_property("Play On Awake", &props.play_on_awake);
-    UI::texture_property("Max Particles", &props.max_particles);
-    UI::end_properties();
+        UI::begin_properties();
+        UI::property("Duration", &component.duration);
+        UI::property("Looping", &component.looping);
+        UI::property("Start Delay", &component.start_delay);
+        UI::property("Start Lifetime", &component.start_lifetime);
+        UI::property_vector("Start Velocity", component.start_velocity, false, false, nullptr, 0.1f, 0.0f, 0.0f);
+        UI::property_vector("Start Color", component.start_color, true);
+        UI::property_vector("Start Size", component.start_size, false, false, nullptr, 0.1f, 0.0f, 0.0f);
+        f32 degrees = glm::degrees(component.start_rotation);
+        if (UI::property("Start Rotation", &degrees))
+          component.start_rotation = glm::radians(degrees);
+        UI::property("Gravity Modifier", &component.gravity_modifier);
+        UI::property("Simulation Speed", &component.simulation_speed);
+        UI::property("Play On Awake", &component.play_on_awake);
+        UI::property("Max Particles", &component.max_particles);
+        UI::end_properties();
 
-    ImGui::Separator();
+        ImGui::Separator();
 
-    UI::begin_properties();
-    UI::texture_property("Rate Over Time", &props.rate_over_time);
-    UI::texture_property("Rate Over Distance", &props.rate_over_distance);
-    UI::texture_property("Burst Count", &props.burst_count);
-    UI::texture_property("Burst Time", &props.burst_time);
-    UI::property_vector("Position Start", props.position_start);
-    UI::property_vector("Position End", props.position_end);
-    // OxUI::Property("Texture", props.Texture); //TODO:
-    UI::end_properties();
+        UI::begin_properties();
+        UI::property("Rate Over Time", &component.rate_over_time);
+        UI::property("Rate Over Distance", &component.rate_over_distance);
+        UI::property("Burst Count", &component.burst_count);
+        UI::property("Burst Time", &component.burst_time);
+        UI::property_vector("Position Start", component.position_start, false, false, nullptr, 0.1f, 0.0f, 0.0f);
+        UI::property_vector("Position End", component.position_end, false, false, nullptr, 0.1f, 0.0f, 0.0f);
+        UI::end_properties();
 
-    draw_particle_over_lifetime_module("Velocity Over Lifetime", props.velocity_over_lifetime);
-    draw_particle_over_lifetime_module("Force Over Lifetime", props.force_over_lifetime);
-    draw_particle_over_lifetime_module("Color Over Lifetime", props.color_over_lifetime, true);
-    draw_particle_by_speed_module("Color By Speed", props.color_by_speed, true);
-    draw_particle_over_lifetime_module("Size Over Lifetime", props.size_over_lifetime);
-    draw_particle_by_speed_module("Size By Speed", props.size_by_speed);
-    draw_particle_over_lifetime_module("Rotation Over Lifetime", props.rotation_over_lifetime, false, true);
-    draw_particle_by_speed_module("Rotation By Speed", props.rotation_by_speed, false, true);
-});
-#endif
+        draw_particle_module("Velocity Over Lifetime",
+                             component.velocity_over_lifetime,
+                             component.velocity_over_lifetime_start,
+                             component.velocity_over_lifetime_end);
+        draw_particle_module("Force Over Lifetime",
+                             component.force_over_lifetime,
+                             component.force_over_lifetime_start,
+                             component.force_over_lifetime_end);
+        draw_particle_module("Color Over Lifetime",
+                             component.color_over_lifetime,
+                             component.color_over_lifetime_start,
+                             component.color_over_lifetime_end,
+                             nullptr,
+                             nullptr,
+                             true);
+        draw_particle_module("Color By Speed",
+                             component.color_by_speed,
+                             component.color_by_speed_start,
+                             component.color_by_speed_end,
+                             &component.color_by_speed_min_speed,
+                             &component.color_by_speed_max_speed,
+                             true);
+        draw_particle_module("Size Over Lifetime",
+                             component.size_over_lifetime,
+                             component.size_over_lifetime_start,
+                             component.size_over_lifetime_end);
+        draw_particle_module("Size By Speed",
+                             component.size_by_speed,
+                             component.size_by_speed_start,
+                             component.size_by_speed_end,
+                             &component.size_by_speed_min_speed,
+                             &component.size_by_speed_max_speed);
+        draw_particle_module("Rotation Over Lifetime",
+                             component.rotation_over_lifetime,
+                             component.rotation_over_lifetime_start,
+                             component.rotation_over_lifetime_end);
+        draw_particle_module("Rotation By Speed",
+                             component.rotation_by_speed,
+                             component.rotation_by_speed_start,
+                             component.rotation_by_speed_end,
+                             &component.rotation_by_speed_min_speed,
+                             &component.rotation_by_speed_max_speed);
+
+        // Lets a running emitter see the edits.
+        e.modified<ParticleSystemComponent>();
+      });
 }
 
 void InspectorPanel::draw_asset_info(Asset* asset) {
@@ -3,6 +3,13 @@
 #include <icons/IconsMaterialDesignIcons.h>
 #include <imgui.h>
 
+#include "Core/App.hpp"
+#include "Core/FileSystem.hpp"
+#include "Memory/FrameArena.hpp"
+#include "Memory/Tracking.hpp"
+#include "Physics/Physics.hpp"
+#include "Scripting/LuaManager.hpp"
+
 namespace ox {
 StatisticsPanel::StatisticsPanel() : EditorPanel("Statistics", ICON_MDI_CLIPBOARD_TEXT, false) {}
 
@@ -17,6 +24,10 @@ void StatisticsPanel::on_render(vuk::Extent3D extent, vuk::Format format) {
         renderer_tab();
         ImGui::EndTabItem();
       }
+      if (ImGui::BeginTabItem("Scripts")) {
+        scripts_tab();
+        ImGui::EndTabItem();
+      }
 
       ImGui::EndTabBar();
     }
@@ -25,6 +36,53 @@ void StatisticsPanel::on_render(vuk::Extent3D extent, vuk::Format format) {
 }
 
 void StatisticsPanel::memory_tab() const {
+  constexpr auto to_mb = [](const u64 bytes) { return static_cast<f64>(bytes) / 1024.0 / 1024.0; };
+
+  for (u32 i = 0; i < std::to_underlying(memory::Subsystem::Count); i++) {
+    const auto subsystem = static_cast<memory::Subsystem>(i);
+    const auto& stats = memory::get_subsystem_stats(subsystem);
+    ImGui::SeparatorText(memory::subsystem_to_sv(subsystem).data());
+    ImGui::Text("Current Usage: %.3f mb", to_mb(stats.current_bytes.load()));
+    ImGui::Text("Peak Usage: %.3f mb", to_mb(stats.peak_bytes.load()));
+    ImGui::Text("Allocations: %llu", static_cast<unsigned long long>(stats.allocation_count.load()));
+    ImGui::Text("Frees: %llu", static_cast<unsigned long long>(stats.free_count.load()));
+  }
+
+  if (const auto* physics = App::get_system<Physics>(EngineSystems::Physics)) {
+    if (const auto* temp_allocator = physics->get_temp_allocator()) {
+      ImGui::SeparatorText("Physics Temp Allocator");
+      ImGui::Text("Capacity: %.3f mb", to_mb(temp_allocator->get_capacity()));
+      ImGui::Text("High Water Mark: %.3f mb", to_mb(temp_allocator->get_high_water_mark()));
+      ImGui::Text("Overflows: %llu", static_cast<unsigned long long>(temp_allocator->get_overflow_count()));
+    }
+  }
+
+  const auto& frame_arena = memory::get_frame_arena();
+  const auto& frame_stats = frame_arena.get_stats();
+  ImGui::SeparatorText("Frame Arena");
+  ImGui::Text("Capacity: %.3f mb", to_mb(frame_arena.get_capacity()));
+  ImGui::Text("Peak Usage: %.3f mb", to_mb(frame_arena.get_peak_bytes()));
+  ImGui::Text("Last Frame Usage: %.3f mb", to_mb(frame_stats.allocated_bytes));
+  ImGui::Text("Heap Allocations Avoided: %llu", static_cast<unsigned long long>(frame_stats.allocation_count));
+  ImGui::Text("Overflows: %llu (%.3f mb)",
+              static_cast<unsigned long long>(frame_stats.overflow_count),
+              to_mb(frame_stats.overflow_bytes));
+
+  if (const auto* lua_manager = App::get_system<LuaManager>(EngineSystems::LuaManager)) {
+    const auto& allocator_stats = lua_manager->get_allocator_stats();
+    const auto& gc_stats = lua_manager->get_gc_stats();
+    ImGui::SeparatorText("Lua");
+    ImGui::Text("Heap: %.3f mb", to_mb(gc_stats.heap_bytes));
+    ImGui::Text("Peak Heap: %.3f mb", to_mb(allocator_stats.peak_bytes));
+    ImGui::Text("Pool Pages: %.3f mb", to_mb(allocator_stats.reserved_bytes));
+    ImGui::Text("Allocations: %llu (%llu from heap)",
+                static_cast<unsigned long long>(allocator_stats.allocation_count),
+                static_cast<unsigned long long>(allocator_stats.heap_allocation_count));
+    ImGui::Text("GC Mode: %s", gc_stats.generational ? "Generational" : "Incremental");
+    ImGui::Text("GC Last Frame: %.3f ms (%u steps)", gc_stats.last_frame_millis, gc_stats.last_frame_steps);
+    ImGui::Text("GC Worst Frame: %.3f ms", gc_stats.max_frame_millis);
+    ImGui::Text("GC Cycles: %llu", static_cast<unsigned long long>(gc_stats.cycle_count));
+  }
 #if 0
     static bool showInMegabytes;
     ImGui::Checkbox("Show in megabytes", &showInMegabytes);
@@ -75,5 +133,98 @@ void StatisticsPanel::renderer_tab() {
   ImGui::Text("FPS: %lf", static_cast<double>(avg));
   const double fps = (1.0 / static_cast<double>(avg)) * 1000.0;
   ImGui::Text("Frame time (ms): %lf", fps);
+
+  const auto& timestep = App::get_timestep();
+  if (timestep.get_max_frame_time() > 0.0) {
+    ImGui::SeparatorText("Frame Limiter");
+    ImGui::Text("Sleep (ms): %lf", timestep.get_sleep_millis());
+    ImGui::Text("Spin (ms): %lf", timestep.get_spin_millis());
+    ImGui::Text("Pacing error (ms): %lf", timestep.get_pacing_error_millis());
+  }
+}
+
+void StatisticsPanel::scripts_tab() {
+  auto* lua_manager = App::get_system<LuaManager>(EngineSystems::LuaManager);
+  if (!lua_manager)
+    return;
+
+  auto& profiler = lua_manager->get_profiler();
+  if (profiler.is_running()) {
+    if (ImGui::Button("Stop"))
+      profiler.stop();
+  } else {
+    if (ImGui::Button("Start"))
+      lua_manager->start_profiler(profiler_interval);
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Reset"))
+    profiler.reset();
+  ImGui::SameLine();
+  if (ImGui::Button("Export CSV")) {
+    const auto path = fs::append_paths(fs::current_path(), "lua_profile.csv");
+    if (profiler.export_csv(path))
+      OX_LOG_INFO("Exported Lua profile to {}", path);
+    else
+      OX_LOG_ERROR("Couldn't export Lua profile to {}", path);
+  }
+
+  ImGui::BeginDisabled(profiler.is_running());
+  ImGui::SetNextItemWidth(120.0f);
+  ImGui::InputInt("Sample Interval (instructions)", &profiler_interval);
+  profiler_interval = ox::max(profiler_interval, 1);
+  ImGui::EndDisabled();
+
+  constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+                               ImGuiTableFlags_Resizable;
+
+  ImGui::SeparatorText("Scripts");
+  if (ImGui::BeginTable("LuaProfilerScripts", 4, table_flags, ImVec2(0.0f, 150.0f))) {
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Script");
+    ImGui::TableSetupColumn("Time (ms)");
+    ImGui::TableSetupColumn("Calls");
+    ImGui::TableSetupColumn("Allocated (kb)");
+    ImGui::TableHeadersRow();
+    for (const auto& script : profiler.get_scripts()) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(fs::get_file_name(script.script).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", script.millis);
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", static_cast<unsigned long long>(script.calls));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f", static_cast<f64>(script.alloc_bytes) / 1024.0);
+    }
+    ImGui::EndTable();
+  }
+
+  ImGui::SeparatorText("Lines");
+  if (ImGui::BeginTable("LuaProfilerLines", 6, table_flags)) {
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Function");
+    ImGui::TableSetupColumn("Source");
+    ImGui::TableSetupColumn("Line");
+    ImGui::TableSetupColumn("Time (ms)");
+    ImGui::TableSetupColumn("Samples");
+    ImGui::TableSetupColumn("Allocated (kb)");
+    ImGui::TableHeadersRow();
+    for (const auto& line : profiler.get_lines()) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(line.function.c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(line.source.c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%d", line.line);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", line.millis);
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", static_cast<unsigned long long>(line.samples));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f", static_cast<f64>(line.alloc_bytes) / 1024.0);
+    }
+    ImGui::EndTable();
+  }
 }
 } // namespace ox
@@ -12,8 +12,10 @@ public:
 private:
   float fps_values[50] = {};
   std::vector<float> frame_times{};
+  int profiler_interval = 1000;
 
   void memory_tab() const;
   void renderer_tab();
+  void scripts_tab();
 };
 } // namespace ox
@@ -0,0 +1,155 @@
+#include "Test.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <miniaudio.h>
+#include <thread>
+#include <vector>
+
+#include "Asset/AudioSource.hpp"
+#include "Audio/AudioConfig.hpp"
+#include "Audio/AudioEngine.hpp"
+#include "Memory/Tracking.hpp"
+
+namespace ox {
+constexpr static auto CLIP_SAMPLE_RATE = 48000_u32;
+constexpr static auto CLIP_CHANNELS = 2_u32;
+// Three seconds, about 560 KiB as 16 bit PCM and twice that once decoded to f32.
+constexpr static auto CLIP_FRAMES = CLIP_SAMPLE_RATE * 3;
+constexpr static auto CLIP_DECODED_BYTES = static_cast<u64>(CLIP_FRAMES) * CLIP_CHANNELS * sizeof(f32);
+
+// 16 bit PCM sine wave.
+static auto write_clip(const std::filesystem::path& path) -> void {
+  auto samples = std::vector<i16>(CLIP_FRAMES * CLIP_CHANNELS);
+  for (u32 i = 0; i < CLIP_FRAMES; i++) {
+    const auto value = static_cast<i16>(std::sin(static_cast<f32>(i) * 0.05f) * 8000.0f);
+    samples[i * 2] = value;
+    samples[i * 2 + 1] = value;
+  }
+
+  const auto data_size = static_cast<u32>(samples.size() * sizeof(i16));
+  auto file = std::ofstream(path, std::ios::binary);
+  const auto write_u32 = [&file](u32 v) { file.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+  const auto write_u16 = [&file](u16 v) { file.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+  file.write("RIFF", 4);
+  write_u32(36 + data_size);
+  file.write("WAVEfmt ", 8);
+  write_u32(16);
+  write_u16(1);
+  write_u16(CLIP_CHANNELS);
+  write_u32(CLIP_SAMPLE_RATE);
+  write_u32(CLIP_SAMPLE_RATE * CLIP_CHANNELS * sizeof(i16));
+  write_u16(CLIP_CHANNELS * sizeof(i16));
+  write_u16(16);
+  file.write("data", 4);
+  write_u32(data_size);
+  file.write(reinterpret_cast<const char*>(samples.data()), data_size);
+}
+
+// Audio engine on miniaudio's null backend with its own clip file, `audio.stream_min_kb`
+// decides whether the clip is decoded or streamed.
+struct AudioTestEngine {
+  i32 null_backend = AudioCVar::cvar_null_backend.get();
+  i32 stream_min_kb = AudioCVar::cvar_stream_min_kb.get();
+  AudioEngine engine = {};
+  std::filesystem::path clip_path = std::filesystem::temp_directory_path() / "ox_audio_source_test.wav";
+
+  explicit AudioTestEngine(bool streamed) {
+    AudioCVar::cvar_null_backend.set(1);
+    AudioCVar::cvar_stream_min_kb.set(streamed ? 0 : 1024 * 1024);
+    OX_CHECK(engine.init().has_value());
+    write_clip(clip_path);
+  }
+
+  ~AudioTestEngine() {
+    engine.deinit();
+    std::filesystem::remove(clip_path);
+    AudioCVar::cvar_null_backend.set(null_backend);
+    AudioCVar::cvar_stream_min_kb.set(stream_min_kb);
+  }
+
+  // Sources loading in the background are done once their data source stops being busy.
+  static auto wait_until_loaded(AudioSource& source) -> void {
+    auto* data_source = static_cast<ma_resource_manager_data_source*>(ma_sound_get_data_source(source.get_source()));
+    while (ma_resource_manager_data_source_result(data_source) == MA_BUSY) {
+      std::this_thread::yield();
+    }
+  }
+
+  auto load(std::vector<AudioSource>& sources, u32 count) -> void {
+    for (u32 i = 0; i < count; i++) {
+      auto& source = sources.emplace_back();
+      OX_CHECK(source.load(clip_path.string(), engine.get_engine()));
+    }
+    for (auto& source : sources) {
+      wait_until_loaded(source);
+    }
+  }
+};
+
+static auto get_audio_bytes() -> u64 {
+  return memory::get_subsystem_stats(memory::Subsystem::Audio).current_bytes.load();
+}
+
+OX_TEST(audio_sources_share_decoded_clip) {
+  auto test_engine = AudioTestEngine(false);
+  const auto base_bytes = get_audio_bytes();
+
+  auto sources = std::vector<AudioSource>();
+  test_engine.load(sources, 1);
+  OX_CHECK(!sources[0].is_streamed());
+  const auto one_bytes = get_audio_bytes() - base_bytes;
+  OX_CHECK(one_bytes >= CLIP_DECODED_BYTES);
+
+  // Every other source of the clip only adds its own sound, not another copy of the PCM.
+  test_engine.load(sources, 31);
+  const auto all_bytes = get_audio_bytes() - base_bytes;
+  OX_CHECK(all_bytes - one_bytes < CLIP_DECODED_BYTES / 2);
+
+  // Instances share it as well.
+  auto instance = ma_sound{};
+  OX_CHECK(sources[0].init_instance(&instance));
+  OX_CHECK(get_audio_bytes() - base_bytes - all_bytes < CLIP_DECODED_BYTES / 2);
+  ma_sound_uninit(&instance);
+}
+
+OX_TEST(audio_sources_stream_big_clips) {
+  auto test_engine = AudioTestEngine(true);
+  auto sources = std::vector<AudioSource>();
+  test_engine.load(sources, 2);
+  for (const auto& source : sources) {
+    OX_CHECK(source.is_streamed());
+  }
+}
+
+// Memory and load time of many sources playing one clip, decoded once and shared against
+// streamed per source.
+OX_BENCHMARK(audio_source_loading) {
+  for (const auto streamed : {false, true}) {
+    for (const auto count : {1_u32, 16_u32, 64_u32}) {
+      auto test_engine = AudioTestEngine(streamed);
+      const auto base_bytes = get_audio_bytes();
+
+      auto sources = std::vector<AudioSource>();
+      sources.reserve(count);
+      const auto start = test::now_millis();
+      test_engine.load(sources, count);
+      const auto loaded_millis = test::now_millis() - start;
+
+      auto main_thread_millis = 0.0;
+      for (const auto& source : sources) {
+        main_thread_millis += source.get_load_millis();
+      }
+
+      fmt::println("  {:<8} {:>3} sources: {:>8} KiB audio memory, {:.3f} ms on the main thread, "
+                   "{:.3f} ms until loaded",
+                   streamed ? "streamed" : "decoded",
+                   count,
+                   (get_audio_bytes() - base_bytes) / 1024,
+                   main_thread_millis,
+                   loaded_millis);
+    }
+  }
+}
+} // namespace ox
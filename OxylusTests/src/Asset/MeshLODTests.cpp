@@ -0,0 +1,138 @@
+#include "Test.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "Asset/MeshLOD.hpp"
+
+namespace ox {
+// Height field with enough curvature that every simplification step costs some error.
+static auto make_grid(u32 size, std::vector<glm::vec3>& positions, std::vector<u32>& indices) -> void {
+  for (u32 y = 0; y <= size; y++) {
+    for (u32 x = 0; x <= size; x++) {
+      const auto fx = static_cast<f32>(x) / static_cast<f32>(size);
+      const auto fy = static_cast<f32>(y) / static_cast<f32>(size);
+      positions.emplace_back(fx, fy, 0.1f * std::sin(fx * 12.0f) * std::cos(fy * 9.0f));
+    }
+  }
+
+  for (u32 y = 0; y < size; y++) {
+    for (u32 x = 0; x < size; x++) {
+      const auto i = y * (size + 1) + x;
+      indices.insert(indices.end(), {i, i + 1, i + size + 1, i + 1, i + size + 2, i + size + 1});
+    }
+  }
+}
+
+OX_TEST(mesh_lod_chain_shrinks_and_accumulates_error) {
+  auto positions = std::vector<glm::vec3>();
+  auto indices = std::vector<u32>();
+  make_grid(64, positions, indices);
+
+  const auto levels = mesh_lod::build_lod_chain(indices, positions);
+  OX_CHECK(!levels.empty());
+  // Level 0 is the input and isn't returned.
+  OX_CHECK(levels.size() < Mesh::MAX_LODS);
+
+  auto previous_index_count = indices.size();
+  auto previous_error = 0.0f;
+  for (const auto& level : levels) {
+    OX_CHECK(level.indices.size() % 3 == 0);
+    OX_CHECK(level.indices.size() < previous_index_count);
+    OX_CHECK(level.error >= previous_error);
+    for (const auto index : level.indices) {
+      OX_CHECK(index < positions.size());
+    }
+
+    previous_index_count = level.indices.size();
+    previous_error = level.error;
+  }
+}
+
+OX_TEST(mesh_lod_chain_of_empty_mesh) {
+  OX_CHECK(mesh_lod::build_lod_chain({}, {}).empty());
+}
+
+// Unit sphere at the origin, levels become acceptable at a distance of 11, 41 and 161 with
+// 1000 pixels of projection scale and a 1 pixel threshold.
+static const auto TEST_LODS = std::vector<Mesh::LOD>{
+    {.meshlet_offset = 0, .meshlet_count = 8, .error = 0.0f},
+    {.meshlet_offset = 8, .meshlet_count = 4, .error = 0.01f},
+    {.meshlet_offset = 12, .meshlet_count = 2, .error = 0.04f},
+    {.meshlet_offset = 14, .meshlet_count = 1, .error = 0.16f},
+};
+
+static auto select_at(f32 distance, f32 hysteresis = 0.0f, u32 previous_lod = mesh_lod::NO_PREVIOUS_LOD) -> u32 {
+  const auto info = mesh_lod::SelectInfo{
+      .camera_position = glm::vec3(0.0f, 0.0f, distance),
+      .projection_scale = 1000.0f,
+      .error_threshold_pixels = 1.0f,
+      .hysteresis = hysteresis,
+  };
+
+  return mesh_lod::select_lod(TEST_LODS, glm::mat4(1.0f), glm::vec3(0.0f), 1.0f, info, previous_lod);
+}
+
+OX_TEST(mesh_lod_select_by_distance) {
+  OX_CHECK(select_at(0.5f) == 0);
+  OX_CHECK(select_at(5.0f) == 0);
+  OX_CHECK(select_at(20.0f) == 1);
+  OX_CHECK(select_at(100.0f) == 2);
+  OX_CHECK(select_at(1000.0f) == 3);
+
+  // A single level is always selected.
+  const auto info = mesh_lod::SelectInfo{.projection_scale = 1000.0f};
+  OX_CHECK(mesh_lod::select_lod(std::span(TEST_LODS).first(1), glm::mat4(1.0f), glm::vec3(0.0f), 1.0f, info) == 0);
+}
+
+OX_TEST(mesh_lod_select_accounts_for_scale) {
+  // Twice the size doubles both the error and the radius.
+  auto world = glm::mat4(1.0f);
+  world[0][0] = world[1][1] = world[2][2] = 2.0f;
+  const auto info = mesh_lod::SelectInfo{
+      .camera_position = glm::vec3(0.0f, 0.0f, 15.0f),
+      .projection_scale = 1000.0f,
+  };
+
+  OX_CHECK(mesh_lod::select_lod(TEST_LODS, glm::mat4(1.0f), glm::vec3(0.0f), 1.0f, info) == 1);
+  OX_CHECK(mesh_lod::select_lod(TEST_LODS, world, glm::vec3(0.0f), 1.0f, info) == 0);
+}
+
+OX_TEST(mesh_lod_select_orthographic_ignores_distance) {
+  auto info = mesh_lod::SelectInfo{.projection_scale = 20.0f, .orthographic = true};
+  for (const auto distance : {1.0f, 100.0f, 10000.0f}) {
+    info.camera_position = glm::vec3(0.0f, 0.0f, distance);
+    // 0.04 * 20 pixels pass, 0.16 * 20 don't.
+    OX_CHECK(mesh_lod::select_lod(TEST_LODS, glm::mat4(1.0f), glm::vec3(0.0f), 1.0f, info) == 2);
+  }
+}
+
+OX_TEST(mesh_lod_select_hysteresis) {
+  // Level 1 passes the threshold at 11 but only passes the 0.75 band at 14.33.
+  OX_CHECK(select_at(12.0f, 0.25f) == 1);
+  OX_CHECK(select_at(12.0f, 0.25f, 0) == 0);
+  OX_CHECK(select_at(12.0f, 0.25f, 1) == 1);
+  OX_CHECK(select_at(15.0f, 0.25f, 0) == 1);
+
+  // Going finer doesn't wait for the band.
+  OX_CHECK(select_at(8.0f, 0.25f, 1) == 0);
+  OX_CHECK(select_at(30.0f, 0.25f, 2) == 1);
+
+  // Moving back and forth around the threshold settles on one level.
+  auto lod = select_at(10.0f, 0.25f);
+  for (const auto distance : {10.5f, 11.5f, 12.5f, 11.2f, 12.9f, 11.1f}) {
+    const auto next = select_at(distance, 0.25f, lod);
+    OX_CHECK(next == 0);
+    lod = next;
+  }
+}
+
+OX_TEST(mesh_lod_projection_scale) {
+  // 90 degrees vertical field of view, 1 / tan(45) = 1.
+  auto projection = glm::mat4(1.0f);
+  OX_CHECK(std::abs(mesh_lod::get_projection_scale(projection, 1000.0f) - 500.0f) < 1e-3f);
+
+  projection[1][1] = -2.0f;
+  OX_CHECK(std::abs(mesh_lod::get_projection_scale(projection, 1000.0f) - 1000.0f) < 1e-3f);
+}
+} // namespace ox
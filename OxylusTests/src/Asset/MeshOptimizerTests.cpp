@@ -0,0 +1,283 @@
+#include "Test.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <meshoptimizer.h>
+
+#include "Asset/Mesh.hpp"
+#include "Asset/MeshOptimizer.hpp"
+#include "Asset/ParserGLTF.hpp"
+#include "Render/MeshletCulling.hpp"
+
+namespace ox {
+struct TestPrimitive {
+  u32 vertex_offset = 0;
+  u32 vertex_count = 0;
+  u32 index_offset = 0;
+  u32 index_count = 0;
+};
+
+struct TestMesh {
+  std::string name = {};
+  std::vector<glm::vec3> positions = {};
+  std::vector<glm::vec3> normals = {};
+  std::vector<u32> indices = {};
+  std::vector<TestPrimitive> primitives = {};
+};
+
+// Height field with its triangles in random order, the worst case for the vertex cache.
+static auto make_shuffled_grid(u32 size, u32 seed) -> TestMesh {
+  auto mesh = TestMesh{.name = fmt::format("shuffled {0}x{0} grid", size)};
+  for (u32 y = 0; y <= size; y++) {
+    for (u32 x = 0; x <= size; x++) {
+      const auto fx = static_cast<f32>(x) / static_cast<f32>(size);
+      const auto fy = static_cast<f32>(y) / static_cast<f32>(size);
+      mesh.positions.emplace_back(fx, fy, 0.1f * std::sin(fx * 12.0f) * std::cos(fy * 9.0f));
+      mesh.normals.emplace_back(0.0f, 0.0f, 1.0f);
+    }
+  }
+
+  auto triangles = std::vector<std::array<u32, 3>>();
+  for (u32 y = 0; y < size; y++) {
+    for (u32 x = 0; x < size; x++) {
+      const auto i = y * (size + 1) + x;
+      triangles.push_back({i, i + 1, i + size + 1});
+      triangles.push_back({i + 1, i + size + 2, i + size + 1});
+    }
+  }
+
+  auto rng = std::mt19937(seed);
+  std::ranges::shuffle(triangles, rng);
+  for (const auto& triangle : triangles) {
+    mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+  }
+
+  mesh.primitives.push_back({
+      .vertex_count = static_cast<u32>(mesh.positions.size()),
+      .index_count = static_cast<u32>(mesh.indices.size()),
+  });
+
+  return mesh;
+}
+
+static auto load_gltf_mesh(const std::filesystem::path& path) -> ox::option<TestMesh> {
+  auto mesh = TestMesh{.name = path.filename().string()};
+  auto on_new_primitive = [](void* user_data,
+                             u32,
+                             u32,
+                             u32 vertex_offset,
+                             u32 vertex_count,
+                             u32 index_offset,
+                             u32 index_count) {
+    auto* info = static_cast<TestMesh*>(user_data);
+    info->positions.resize(info->positions.size() + vertex_count);
+    info->normals.resize(info->normals.size() + vertex_count);
+    info->indices.resize(info->indices.size() + index_count);
+    info->primitives.push_back({
+        .vertex_offset = vertex_offset,
+        .vertex_count = vertex_count,
+        .index_offset = index_offset,
+        .index_count = index_count,
+    });
+  };
+  auto on_access_index = [](void* user_data, u32, u64 offset, u32 index) {
+    static_cast<TestMesh*>(user_data)->indices[offset] = index;
+  };
+  auto on_access_position = [](void* user_data, u32, u64 offset, glm::vec3 position) {
+    static_cast<TestMesh*>(user_data)->positions[offset] = position;
+  };
+  auto on_access_normal = [](void* user_data, u32, u64 offset, glm::vec3 normal) {
+    static_cast<TestMesh*>(user_data)->normals[offset] = normal;
+  };
+
+  const auto info = GLTFMeshInfo::parse(path,
+                                        {.user_data = &mesh,
+                                         .on_new_primitive = on_new_primitive,
+                                         .on_access_index = on_access_index,
+                                         .on_access_position = on_access_position,
+                                         .on_access_normal = on_access_normal});
+  if (!info.has_value())
+    return ox::nullopt;
+
+  return mesh;
+}
+
+// Triangles as position triples, rotated so the smallest position comes first. Winding is kept.
+static auto get_triangles(std::span<const u32> indices, std::span<const glm::vec3> positions)
+    -> std::vector<std::array<f32, 9>> {
+  auto triangles = std::vector<std::array<f32, 9>>();
+  for (usize i = 0; i < indices.size(); i += 3) {
+    auto corners = std::array{positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]]};
+    const auto less = [](const glm::vec3& a, const glm::vec3& b) {
+      return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+    };
+    std::ranges::rotate(corners, std::ranges::min_element(corners, less));
+
+    auto& triangle = triangles.emplace_back();
+    for (usize corner = 0; corner < 3; corner++) {
+      triangle[corner * 3 + 0] = corners[corner].x;
+      triangle[corner * 3 + 1] = corners[corner].y;
+      triangle[corner * 3 + 2] = corners[corner].z;
+    }
+  }
+
+  std::ranges::sort(triangles);
+  return triangles;
+}
+
+OX_TEST(mesh_optimizer_keeps_triangles) {
+  auto mesh = make_shuffled_grid(32, 17);
+  // An unreferenced vertex ends up after the referenced ones.
+  mesh.positions.emplace_back(5.0f, 5.0f, 5.0f);
+  mesh.normals.emplace_back(1.0f, 0.0f, 0.0f);
+  // Tex coords follow the positions, so the remap of every stream can be checked.
+  auto tex_coords = std::vector<glm::vec2>();
+  for (const auto& position : mesh.positions) {
+    tex_coords.emplace_back(position.x, position.y);
+  }
+
+  const auto triangles_before = get_triangles(mesh.indices, mesh.positions);
+  const auto acmr_before = mesh_optimizer::get_acmr(mesh.indices, mesh.positions.size());
+
+  const auto vertex_count = mesh_optimizer::optimize_primitive(mesh.indices, mesh.positions, mesh.normals, tex_coords);
+  OX_CHECK(vertex_count == mesh.positions.size() - 1);
+  OX_CHECK(std::ranges::all_of(mesh.indices, [&](u32 index) { return index < vertex_count; }));
+  for (usize i = 0; i < vertex_count; i++) {
+    OX_CHECK(tex_coords[i].x == mesh.positions[i].x && tex_coords[i].y == mesh.positions[i].y);
+  }
+
+  OX_CHECK(get_triangles(mesh.indices, mesh.positions) == triangles_before);
+  OX_CHECK(mesh_optimizer::get_acmr(mesh.indices, vertex_count) < acmr_before * 0.5f);
+}
+
+OX_TEST(mesh_optimizer_empty_primitive) {
+  OX_CHECK(mesh_optimizer::optimize_primitive({}, {}, {}, {}) == 0);
+  OX_CHECK(mesh_optimizer::get_acmr({}, 0) == 0.0f);
+}
+
+// Load time statistics of every .gltf and .glb file in the directory named by OX_MESH_CORPUS,
+// or of a generated grid without it. Meshlets are built the same way load_mesh builds level 0.
+OX_BENCHMARK(mesh_optimizer_corpus_report) {
+  auto corpus = std::vector<TestMesh>();
+  if (const auto* directory = std::getenv("OX_MESH_CORPUS")) {
+    auto paths = std::vector<std::filesystem::path>();
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+      const auto extension = entry.path().extension();
+      if (entry.is_regular_file() && (extension == ".gltf" || extension == ".glb"))
+        paths.push_back(entry.path());
+    }
+
+    std::ranges::sort(paths);
+    for (const auto& path : paths) {
+      if (auto mesh = load_gltf_mesh(path); mesh.has_value())
+        corpus.push_back(std::move(*mesh));
+      else
+        fmt::println("  {}: failed to load", path.string());
+    }
+  } else {
+    fmt::println("  OX_MESH_CORPUS isn't set, reporting a generated mesh.");
+    corpus.push_back(make_shuffled_grid(256, 3));
+  }
+
+  auto raw_meshlets = std::vector<meshopt_Meshlet>();
+  auto meshlet_indices = std::vector<u32>();
+  auto local_triangle_indices = std::vector<u8>();
+  for (auto& mesh : corpus) {
+    // Triangle weighted sums.
+    auto acmr_before = 0.0;
+    auto acmr_after = 0.0;
+    auto triangle_count = 0_sz;
+    auto meshlet_bounds = std::vector<GPU::MeshletBounds>();
+    auto optimize_millis = 0.0;
+
+    for (const auto& primitive : mesh.primitives) {
+      const auto indices = std::span(mesh.indices).subspan(primitive.index_offset, primitive.index_count);
+      const auto positions = std::span(mesh.positions).subspan(primitive.vertex_offset, primitive.vertex_count);
+      const auto normals = std::span(mesh.normals).subspan(primitive.vertex_offset, primitive.vertex_count);
+      if (indices.empty())
+        continue;
+
+      const auto primitive_triangles = static_cast<f64>(indices.size() / 3);
+      acmr_before += mesh_optimizer::get_acmr(indices, positions.size()) * primitive_triangles;
+
+      const auto start = test::now_millis();
+      const auto vertex_count = mesh_optimizer::optimize_primitive(indices, positions, normals, {});
+      optimize_millis += test::now_millis() - start;
+
+      acmr_after += mesh_optimizer::get_acmr(indices, vertex_count) * primitive_triangles;
+      triangle_count += indices.size() / 3;
+
+      const auto max_meshlets = meshopt_buildMeshletsBound(
+          indices.size(), Mesh::MAX_MESHLET_INDICES, Mesh::MAX_MESHLET_PRIMITIVES);
+      raw_meshlets.resize(max_meshlets);
+      meshlet_indices.resize(max_meshlets * Mesh::MAX_MESHLET_INDICES);
+      local_triangle_indices.resize(max_meshlets * Mesh::MAX_MESHLET_PRIMITIVES * 3);
+      const auto meshlet_count = meshopt_buildMeshlets(raw_meshlets.data(),
+                                                       meshlet_indices.data(),
+                                                       local_triangle_indices.data(),
+                                                       indices.data(),
+                                                       indices.size(),
+                                                       reinterpret_cast<const f32*>(positions.data()),
+                                                       positions.size(),
+                                                       sizeof(glm::vec3),
+                                                       Mesh::MAX_MESHLET_INDICES,
+                                                       Mesh::MAX_MESHLET_PRIMITIVES,
+                                                       0.0f);
+
+      for (const auto& raw_meshlet : std::span(raw_meshlets).first(meshlet_count)) {
+        const auto bounds = meshopt_computeMeshletBounds(&meshlet_indices[raw_meshlet.vertex_offset],
+                                                         &local_triangle_indices[raw_meshlet.triangle_offset],
+                                                         raw_meshlet.triangle_count,
+                                                         reinterpret_cast<const f32*>(positions.data()),
+                                                         positions.size(),
+                                                         sizeof(glm::vec3));
+        meshlet_bounds.push_back({
+            .sphere_center = glm::make_vec3(bounds.center),
+            .sphere_radius = bounds.radius,
+            .cone_apex = glm::make_vec3(bounds.cone_apex),
+            .cone_axis = glm::make_vec3(bounds.cone_axis),
+            .cone_cutoff = bounds.cone_cutoff,
+        });
+      }
+    }
+
+    if (triangle_count == 0 || meshlet_bounds.empty()) {
+      fmt::println("  {}: no triangles", mesh.name);
+      continue;
+    }
+
+    // Cone test seen from the six sides of the mesh.
+    const auto bounds = mesh_quantization::get_position_bounds(mesh.positions);
+    const auto center = bounds.min + bounds.extent * 0.5f;
+    const auto distance = glm::max(glm::length(bounds.extent), 1.0f);
+    const auto camera_positions = std::vector<glm::vec3>{
+        center + glm::vec3(distance, 0.0f, 0.0f),
+        center - glm::vec3(distance, 0.0f, 0.0f),
+        center + glm::vec3(0.0f, distance, 0.0f),
+        center - glm::vec3(0.0f, distance, 0.0f),
+        center + glm::vec3(0.0f, 0.0f, distance),
+        center - glm::vec3(0.0f, 0.0f, distance),
+    };
+    const auto rejection_rate = meshlet_culling::get_cone_rejection_rate(
+        meshlet_bounds, glm::mat4(1.0f), camera_positions);
+
+    const auto triangles = static_cast<f64>(triangle_count);
+    fmt::println("  {}: {} triangles, ACMR {:.3f} -> {:.3f} in {:.2f} ms, {} meshlets at {:.1f}% fill, "
+                 "cone culling rejects {:.1f}%",
+                 mesh.name,
+                 triangle_count,
+                 acmr_before / triangles,
+                 acmr_after / triangles,
+                 optimize_millis,
+                 meshlet_bounds.size(),
+                 100.0 * triangles / static_cast<f64>(meshlet_bounds.size() * Mesh::MAX_MESHLET_PRIMITIVES),
+                 rejection_rate * 100.0f);
+  }
+}
+} // namespace ox
@@ -0,0 +1,122 @@
+#include "Test.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Asset/MeshQuantization.hpp"
+
+namespace ox {
+static auto max_position_error(std::span<const glm::vec3> positions, const mesh_quantization::PositionBounds& bounds)
+    -> f32 {
+  auto max_error = 0.0f;
+  for (const auto& position : positions) {
+    const auto decoded = mesh_quantization::decode_position(mesh_quantization::encode_position(position, bounds),
+                                                            bounds);
+    max_error = ox::max(max_error, std::abs(decoded.x - position.x));
+    max_error = ox::max(max_error, std::abs(decoded.y - position.y));
+    max_error = ox::max(max_error, std::abs(decoded.z - position.z));
+  }
+
+  return max_error;
+}
+
+OX_TEST(mesh_quantization_position_round_trip) {
+  auto rng = std::mt19937(3);
+  auto x = std::uniform_real_distribution(-3.0f, 7.0f);
+  auto y = std::uniform_real_distribution(0.0f, 0.01f);
+  auto z = std::uniform_real_distribution(-1000.0f, 1000.0f);
+
+  auto positions = std::vector<glm::vec3>();
+  for (u32 i = 0; i < 10000; i++) {
+    positions.emplace_back(x(rng), y(rng), z(rng));
+  }
+
+  const auto bounds = mesh_quantization::get_position_bounds(positions);
+  for (const auto& position : positions) {
+    const auto decoded = mesh_quantization::decode_position(mesh_quantization::encode_position(position, bounds),
+                                                            bounds);
+    // Half a step per axis, plus float rounding of the decode.
+    for (i32 axis = 0; axis < 3; axis++) {
+      const auto step = bounds.extent[axis] / 65535.0f;
+      const auto rounding = 1e-6f * (std::abs(bounds.min[axis]) + bounds.extent[axis]);
+      OX_CHECK(std::abs(decoded[axis] - position[axis]) <= step * 0.5f + rounding);
+    }
+  }
+
+  // Outside of the bounds clamps to them.
+  const auto outside = mesh_quantization::decode_position(
+      mesh_quantization::encode_position(bounds.min - glm::vec3(1.0f), bounds), bounds);
+  OX_CHECK(outside == bounds.min);
+}
+
+OX_TEST(mesh_quantization_flat_axis) {
+  const auto positions = std::vector<glm::vec3>{{0.0f, 1.0f, 5.0f}, {2.0f, 3.0f, 5.0f}, {1.0f, 2.0f, 5.0f}};
+  const auto bounds = mesh_quantization::get_position_bounds(positions);
+  OX_CHECK(bounds.extent.z == 0.0f);
+
+  for (const auto& position : positions) {
+    const auto decoded = mesh_quantization::decode_position(mesh_quantization::encode_position(position, bounds),
+                                                            bounds);
+    OX_CHECK(decoded.z == 5.0f);
+  }
+
+  OX_CHECK(mesh_quantization::get_position_bounds({}).extent == glm::vec3(0.0f));
+}
+
+OX_TEST(mesh_quantization_per_mesh_precision) {
+  // A 1 cm part of a 2 km model.
+  auto rng = std::mt19937(5);
+  auto part = std::uniform_real_distribution(500.0f, 500.01f);
+  auto positions = std::vector<glm::vec3>();
+  for (u32 i = 0; i < 1000; i++) {
+    positions.emplace_back(part(rng), part(rng), part(rng));
+  }
+
+  const auto model_bounds = mesh_quantization::PositionBounds{
+      .min = glm::vec3(-1000.0f),
+      .extent = glm::vec3(2000.0f),
+  };
+  const auto part_bounds = mesh_quantization::get_position_bounds(positions);
+
+  // Model wide steps are 3 cm, larger than the part itself.
+  OX_CHECK(max_position_error(positions, model_bounds) > 0.001f);
+  OX_CHECK(max_position_error(positions, part_bounds) < 0.0001f);
+}
+
+OX_TEST(mesh_quantization_normal_round_trip) {
+  auto rng = std::mt19937(11);
+  auto component = std::normal_distribution(0.0f, 1.0f);
+
+  for (u32 i = 0; i < 10000; i++) {
+    const auto normal = glm::normalize(glm::vec3(component(rng), component(rng), component(rng)));
+    const auto decoded = glm::normalize(mesh_quantization::decode_normal(mesh_quantization::encode_normal(normal)));
+    OX_CHECK(glm::dot(normal, decoded) > 0.9999f);
+  }
+
+  // Unnormalized input comes back unit length, zero length doesn't come back as NaN.
+  const auto scaled = mesh_quantization::decode_normal(mesh_quantization::encode_normal(glm::vec3(0.0f, 5.0f, 0.0f)));
+  OX_CHECK(std::abs(scaled.y - 1.0f) < 1e-4f);
+  const auto zero = mesh_quantization::decode_normal(mesh_quantization::encode_normal(glm::vec3(0.0f)));
+  OX_CHECK(!std::isnan(zero.x) && !std::isnan(zero.y) && !std::isnan(zero.z));
+}
+
+OX_TEST(mesh_quantization_tex_coord_round_trip) {
+  auto rng = std::mt19937(13);
+  auto unit = std::uniform_real_distribution(0.0f, 1.0f);
+  auto tiled = std::uniform_real_distribution(-8.0f, 8.0f);
+
+  for (u32 i = 0; i < 10000; i++) {
+    const auto tex_coord = glm::vec2(unit(rng), unit(rng));
+    const auto decoded = mesh_quantization::decode_tex_coord(mesh_quantization::encode_tex_coord(tex_coord));
+    OX_CHECK(std::abs(decoded.x - tex_coord.x) <= 1.0f / 2048.0f);
+    OX_CHECK(std::abs(decoded.y - tex_coord.y) <= 1.0f / 2048.0f);
+
+    // Steps grow with magnitude, 1/256 between 4 and 8.
+    const auto repeated = glm::vec2(tiled(rng), tiled(rng));
+    const auto decoded_repeated = mesh_quantization::decode_tex_coord(mesh_quantization::encode_tex_coord(repeated));
+    OX_CHECK(std::abs(decoded_repeated.x - repeated.x) <= 1.0f / 512.0f);
+    OX_CHECK(std::abs(decoded_repeated.y - repeated.y) <= 1.0f / 512.0f);
+  }
+}
+} // namespace ox
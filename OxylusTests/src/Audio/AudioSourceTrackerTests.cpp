@@ -0,0 +1,132 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <flecs.h>
+#include <vector>
+
+#include "Audio/AudioSourceTracker.hpp"
+#include "Scene/ECSModule/Core.hpp"
+
+namespace ox {
+// Parents with a few audio sources each, like a scene's moving props.
+struct AudioTrackerTestWorld {
+  flecs::world world = {};
+  std::vector<flecs::entity> parents = {};
+  std::vector<flecs::entity> sources = {};
+
+  AudioTrackerTestWorld(u32 parent_count, u32 sources_per_parent) {
+    for (u32 i = 0; i < parent_count; i++) {
+      auto parent = world.entity();
+      parent.set<TransformComponent>({glm::vec3(static_cast<f32>(i), 0.0f, 0.0f)});
+      parents.emplace_back(parent);
+
+      for (u32 j = 0; j < sources_per_parent; j++) {
+        auto source = world.entity().child_of(parent);
+        source.set<TransformComponent>({glm::vec3(0.0f, static_cast<f32>(j), 0.0f)});
+        source.set<AudioSourceComponent>({});
+        sources.emplace_back(source);
+      }
+    }
+  }
+
+  // Translation only, enough to tell whether a source saw its parent move.
+  static auto get_world_position(flecs::entity entity) -> glm::vec3 {
+    auto position = glm::vec3(0.0f);
+    for (auto e = entity; e != flecs::entity::null(); e = e.parent()) {
+      position += e.get<TransformComponent>()->position;
+    }
+    return position;
+  }
+};
+
+static auto contains(std::span<const flecs::entity> entities, flecs::entity entity) -> bool {
+  return std::ranges::find(entities, entity) != entities.end();
+}
+
+OX_TEST(audio_tracker_marks_sources_below_moved_parent) {
+  auto test_world = AudioTrackerTestWorld(2, 0);
+  const auto parent = test_world.parents[0];
+
+  // A child without a source in between, its own child still moves.
+  auto group = test_world.world.entity().child_of(parent);
+  group.set<TransformComponent>({});
+  auto nested = test_world.world.entity().child_of(group);
+  nested.set<TransformComponent>({});
+  nested.set<AudioSourceComponent>({});
+  auto direct = test_world.world.entity().child_of(parent);
+  direct.set<TransformComponent>({});
+  direct.set<AudioSourceComponent>({});
+  auto unrelated = test_world.world.entity().child_of(test_world.parents[1]);
+  unrelated.set<TransformComponent>({});
+  unrelated.set<AudioSourceComponent>({});
+
+  auto tracker = AudioSourceTracker();
+  tracker.mark_dirty(parent);
+  OX_CHECK(tracker.get_dirty().size() == 2);
+  OX_CHECK(contains(tracker.get_dirty(), nested));
+  OX_CHECK(contains(tracker.get_dirty(), direct));
+  OX_CHECK(!contains(tracker.get_dirty(), unrelated));
+
+  // Children reporting their own change after the parent don't add anything.
+  tracker.mark_dirty(group);
+  tracker.mark_dirty(nested);
+  OX_CHECK(tracker.get_dirty().size() == 2);
+  OX_CHECK(tracker.get_visited_count() == 4);
+
+  tracker.clear();
+  OX_CHECK(tracker.get_dirty().empty());
+  tracker.mark_dirty(unrelated);
+  OX_CHECK(tracker.get_dirty().size() == 1);
+}
+
+// Per frame cost of handing sources to their voices with K moved parents, through the tracker
+// against visiting every source like a per frame system does.
+OX_BENCHMARK(audio_source_updates) {
+  constexpr auto SOURCES_PER_PARENT = 4_u32;
+  constexpr auto FRAMES = 64_u32;
+
+  for (const auto source_count : {1'000_u32, 10'000_u32, 100'000_u32}) {
+    auto test_world = AudioTrackerTestWorld(source_count / SOURCES_PER_PARENT, SOURCES_PER_PARENT);
+    auto all_sources = test_world.world.query<const AudioSourceComponent>();
+    auto tracker = AudioSourceTracker();
+    auto sum = glm::vec3(0.0f);
+
+    auto every_source_millis = 0.0;
+    {
+      const auto start = test::now_millis();
+      for (u32 frame = 0; frame < FRAMES; frame++) {
+        all_sources.each([&sum](flecs::entity entity, const AudioSourceComponent&) {
+          sum += AudioTrackerTestWorld::get_world_position(entity);
+        });
+      }
+      every_source_millis = (test::now_millis() - start) / FRAMES;
+    }
+
+    for (const auto moved_count : {0_u32, 16_u32, 256_u32}) {
+      auto sent = 0_u64;
+      const auto start = test::now_millis();
+      for (u32 frame = 0; frame < FRAMES; frame++) {
+        for (u32 i = 0; i < moved_count; i++) {
+          const auto parent = test_world.parents[(frame * moved_count + i) % test_world.parents.size()];
+          tracker.mark_dirty(parent);
+        }
+        for (const auto entity : tracker.get_dirty()) {
+          sum += AudioTrackerTestWorld::get_world_position(entity);
+        }
+        sent += tracker.get_dirty().size();
+        tracker.clear();
+      }
+      const auto tracked_millis = (test::now_millis() - start) / FRAMES;
+
+      fmt::println("  {:>6} sources, {:>3} moved parents: tracked {:.4f} ms ({} sources sent), "
+                   "every source {:.4f} ms",
+                   source_count,
+                   moved_count,
+                   tracked_millis,
+                   sent / FRAMES,
+                   every_source_millis);
+    }
+    test::do_not_optimize(sum);
+  }
+}
+} // namespace ox
@@ -0,0 +1,128 @@
+#include "Test.hpp"
+
+#include <memory_resource>
+#include <vector>
+
+#include "Memory/FrameArena.hpp"
+
+namespace ox {
+// Heap that counts the allocations reaching it.
+class CountingHeapResource final : public std::pmr::memory_resource {
+public:
+  u64 allocation_count = 0;
+
+private:
+  auto do_allocate(usize bytes, usize alignment) -> void* override {
+    allocation_count += 1;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  auto do_deallocate(void* ptr, usize bytes, usize alignment) -> void override {
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+  }
+
+  auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override { return this == &other; }
+};
+
+// Routes containers without a resource of their own to `heap` for one scope.
+struct DefaultResourceScope {
+  std::pmr::memory_resource* previous = nullptr;
+
+  explicit DefaultResourceScope(std::pmr::memory_resource* resource) {
+    previous = std::pmr::set_default_resource(resource);
+  }
+  ~DefaultResourceScope() { std::pmr::set_default_resource(previous); }
+};
+
+// What the render pipeline keeps per frame, on a given resource.
+struct FrameTestData {
+  std::pmr::vector<u32> dirty_ids;
+  std::pmr::vector<glm::mat4> dirty_values;
+
+  explicit FrameTestData(std::pmr::memory_resource* resource) : dirty_ids(resource), dirty_values(resource) {}
+
+  // Same as `EasyRenderPipeline::publish`, rebuilt with the members' own allocator.
+  auto rebuild(const std::vector<u32>& ids, const std::vector<glm::mat4>& values) -> void {
+    dirty_ids = std::pmr::vector<u32>(ids.begin(), ids.end(), dirty_ids.get_allocator());
+    dirty_values = std::pmr::vector<glm::mat4>(values.begin(), values.end(), dirty_values.get_allocator());
+  }
+};
+
+OX_TEST(frame_arena_members_skip_the_heap) {
+  auto heap = CountingHeapResource();
+  const auto default_resource = DefaultResourceScope(&heap);
+  auto arena = memory::FrameArena(ox::mib_to_bytes(1));
+
+  const auto ids = std::vector<u32>(2048, 7);
+  const auto values = std::vector<glm::mat4>(2048, glm::mat4(1.0f));
+  auto data = FrameTestData(arena.get_resource());
+  for (u32 frame = 0; frame < 8; frame++) {
+    arena.begin_frame();
+    data.rebuild(ids, values);
+    OX_CHECK(arena.owns(data.dirty_ids.data()));
+    OX_CHECK(arena.owns(data.dirty_values.data()));
+  }
+  arena.begin_frame();
+  OX_CHECK(heap.allocation_count == 0);
+  OX_CHECK(arena.get_stats().allocation_count == 2);
+  OX_CHECK(arena.get_stats().overflow_count == 0);
+}
+
+OX_TEST(frame_arena_move_assign_keeps_target_resource) {
+  auto heap = CountingHeapResource();
+  const auto default_resource = DefaultResourceScope(&heap);
+  auto arena = memory::FrameArena(ox::mib_to_bytes(1));
+  const auto ids = std::vector<u32>(2048, 7);
+
+  // A member constructed without the arena never ends up on it, the elements are copied
+  // into its own resource instead of the arena's memory being taken over.
+  auto member = std::pmr::vector<u32>();
+  arena.begin_frame();
+  member = std::pmr::vector<u32>(ids.begin(), ids.end(), arena.get_resource());
+  OX_CHECK(!arena.owns(member.data()));
+  OX_CHECK(heap.allocation_count == 1);
+}
+
+// Heap allocations of one frame's transform data with containers made fresh every frame,
+// the way the pipeline used to copy them, against members on the frame arena.
+OX_BENCHMARK(frame_arena_heap_allocations) {
+  constexpr auto FRAMES = 256_u32;
+
+  for (const auto dirty_count : {256_u32, 4096_u32, 65536_u32}) {
+    const auto ids = std::vector<u32>(dirty_count, 7);
+    const auto values = std::vector<glm::mat4>(dirty_count, glm::mat4(1.0f));
+
+    const auto run = [&](FrameTestData& data, memory::FrameArena& arena) {
+      const auto start = test::now_millis();
+      for (u32 frame = 0; frame < FRAMES; frame++) {
+        arena.begin_frame();
+        data.rebuild(ids, values);
+        // Scratch the size of the dirty set, like the upload offsets.
+        auto offsets = std::pmr::vector<u64>(dirty_count, data.dirty_ids.get_allocator());
+        test::do_not_optimize(offsets.data());
+      }
+      return (test::now_millis() - start) / FRAMES;
+    };
+
+    auto heap = CountingHeapResource();
+    const auto default_resource = DefaultResourceScope(&heap);
+    auto arena = memory::FrameArena(ox::mib_to_bytes(16));
+
+    auto heap_data = FrameTestData(&heap);
+    const auto heap_millis = run(heap_data, arena);
+    const auto heap_allocations = heap.allocation_count;
+
+    heap.allocation_count = 0;
+    auto arena_data = FrameTestData(arena.get_resource());
+    const auto arena_millis = run(arena_data, arena);
+
+    fmt::println("  {:>5} dirty transforms: heap {:.1f} allocations per frame {:.4f} ms, "
+                 "frame arena {:.1f} allocations per frame {:.4f} ms",
+                 dirty_count,
+                 static_cast<f64>(heap_allocations) / FRAMES,
+                 heap_millis,
+                 static_cast<f64>(heap.allocation_count) / FRAMES,
+                 arena_millis);
+  }
+}
+} // namespace ox
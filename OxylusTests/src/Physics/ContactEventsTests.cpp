@@ -0,0 +1,372 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <flecs.h>
+#include <mutex>
+#include <random>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Physics/ContactEvents.hpp"
+#include "Physics/JoltTestWorld.hpp"
+#include "Physics/PhysicsInterfaces.hpp"
+#include "Scene/SceneEvents.hpp"
+
+namespace ox {
+// Events with unique sort keys, the way Jolt reports them within one step.
+static auto make_events(u32 count, u32 seed) -> std::vector<ContactEvent> {
+  auto rng = std::mt19937(seed);
+  auto events = std::vector<ContactEvent>();
+  for (u32 i = 0; i < count; i++) {
+    auto event = ContactEvent{
+        .type = static_cast<ContactEvent::Type>(rng() % 3),
+        .body1 = JPH::BodyID(rng() % 64),
+        .body2 = JPH::BodyID(rng() % 64),
+        .user_data1 = i,
+        .user_data2 = rng(),
+        .position = {static_cast<f32>(i), 0.0f, 0.0f},
+        .contact_point_count = rng() % 4,
+    };
+    event.sub_shape1.SetValue(rng() % 8);
+    event.sub_shape2.SetValue(i);
+    events.push_back(event);
+  }
+
+  std::ranges::shuffle(events, rng);
+  return events;
+}
+
+// Records `events` split round robin across `thread_count` threads.
+static auto record_from_threads(ContactEventStream& stream, std::span<const ContactEvent> events, u32 thread_count)
+    -> void {
+  auto threads = std::vector<std::thread>();
+  for (u32 t = 0; t < thread_count; t++) {
+    threads.emplace_back([&stream, events, t, thread_count] {
+      for (usize i = t; i < events.size(); i += thread_count) {
+        stream.record(events[i]);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+static auto is_sorted_by_key(std::span<const ContactEvent> events) -> bool {
+  return std::ranges::is_sorted(events, {}, get_contact_sort_key);
+}
+
+static auto is_permutation_of(std::span<const ContactEvent> events, std::span<const ContactEvent> expected) -> bool {
+  auto sorted_events = std::vector(events.begin(), events.end());
+  auto sorted_expected = std::vector(expected.begin(), expected.end());
+  std::ranges::sort(sorted_events, {}, get_contact_sort_key);
+  std::ranges::sort(sorted_expected, {}, get_contact_sort_key);
+  return sorted_events == sorted_expected;
+}
+
+OX_TEST(contact_sort_key_order) {
+  auto a = ContactEvent{.type = ContactEvent::Type::Added, .body1 = JPH::BodyID(5), .body2 = JPH::BodyID(1)};
+  auto b = a;
+  b.body2 = JPH::BodyID(2);
+  auto c = a;
+  c.sub_shape1.SetValue(1);
+  auto d = a;
+  d.type = ContactEvent::Type::Persisted;
+  d.body1 = JPH::BodyID(0);
+
+  OX_CHECK(get_contact_sort_key(a) < get_contact_sort_key(c));
+  OX_CHECK(get_contact_sort_key(c) < get_contact_sort_key(b));
+  OX_CHECK(get_contact_sort_key(b) < get_contact_sort_key(d));
+  // Payload doesn't take part in the order.
+  auto e = a;
+  e.user_data1 = 7;
+  e.penetration_depth = 1.0f;
+  OX_CHECK(get_contact_sort_key(a) == get_contact_sort_key(e));
+}
+
+OX_TEST(contact_event_stream_batch_is_independent_of_threads) {
+  const auto events = make_events(5000, 1);
+
+  auto first_batch = std::vector<ContactEvent>();
+  for (const auto thread_count : {1_u32, 2_u32, 3_u32, 8_u32}) {
+    auto stream = ContactEventStream();
+    record_from_threads(stream, events, thread_count);
+    const auto& batch = stream.flush();
+
+    OX_CHECK(batch.size() == events.size());
+    OX_CHECK(is_sorted_by_key(batch));
+    OX_CHECK(is_permutation_of(batch, events));
+    if (first_batch.empty())
+      first_batch = batch;
+    OX_CHECK(batch == first_batch);
+
+    // Flushing drains the thread buffers.
+    OX_CHECK(stream.flush().empty());
+  }
+}
+
+// Fresh threads every step recording into two streams at once, nothing is lost or duplicated.
+OX_TEST(contact_event_stream_stress) {
+  constexpr auto STEPS = 32_u32;
+  constexpr auto THREADS = 16_u32;
+
+  auto stream_a = ContactEventStream();
+  auto stream_b = ContactEventStream();
+  for (u32 step = 0; step < STEPS; step++) {
+    const auto events_a = make_events(2000 + step * 17, step * 2);
+    const auto events_b = make_events(500 + step * 31, step * 2 + 1);
+
+    auto threads = std::vector<std::thread>();
+    for (u32 t = 0; t < THREADS; t++) {
+      threads.emplace_back([&, t] {
+        for (usize i = t; i < std::max(events_a.size(), events_b.size()); i += THREADS) {
+          if (i < events_a.size())
+            stream_a.record(events_a[i]);
+          if (i < events_b.size())
+            stream_b.record(events_b[i]);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    const auto& batch_a = stream_a.flush();
+    OX_CHECK(batch_a.size() == events_a.size());
+    OX_CHECK(is_sorted_by_key(batch_a));
+    OX_CHECK(is_permutation_of(batch_a, events_a));
+
+    const auto& batch_b = stream_b.flush();
+    OX_CHECK(batch_b.size() == events_b.size());
+    OX_CHECK(is_sorted_by_key(batch_b));
+    OX_CHECK(is_permutation_of(batch_b, events_b));
+  }
+}
+
+// Stands in for the old dispatch from inside the callbacks: keeps the key and user data of
+// every contact as Jolt reports it, next to the batched stream.
+class RecordingContactListener final : public Physics3DContactListener {
+public:
+  struct Reported {
+    ContactSortKey key = {};
+    u64 user_data1 = 0;
+    u64 user_data2 = 0;
+
+    auto operator<=>(const Reported&) const = default;
+  };
+
+  RecordingContactListener() : Physics3DContactListener(nullptr) {}
+
+  void OnContactAdded(const JPH::Body& inBody1,
+                      const JPH::Body& inBody2,
+                      const JPH::ContactManifold& inManifold,
+                      JPH::ContactSettings& ioSettings) override {
+    Physics3DContactListener::OnContactAdded(inBody1, inBody2, inManifold, ioSettings);
+    report(ContactEvent::Type::Added, inBody1, inBody2, inManifold);
+  }
+
+  void OnContactPersisted(const JPH::Body& inBody1,
+                          const JPH::Body& inBody2,
+                          const JPH::ContactManifold& inManifold,
+                          JPH::ContactSettings& ioSettings) override {
+    Physics3DContactListener::OnContactPersisted(inBody1, inBody2, inManifold, ioSettings);
+    report(ContactEvent::Type::Persisted, inBody1, inBody2, inManifold);
+  }
+
+  void OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) override {
+    Physics3DContactListener::OnContactRemoved(inSubShapePair);
+    const auto event = ContactEvent{
+        .type = ContactEvent::Type::Removed,
+        .body1 = inSubShapePair.GetBody1ID(),
+        .body2 = inSubShapePair.GetBody2ID(),
+        .sub_shape1 = inSubShapePair.GetSubShapeID1(),
+        .sub_shape2 = inSubShapePair.GetSubShapeID2(),
+    };
+    std::lock_guard lock(mutex);
+    reported.push_back({.key = get_contact_sort_key(event)});
+  }
+
+  auto take_reported() -> std::vector<Reported> {
+    std::ranges::sort(reported);
+    return std::exchange(reported, {});
+  }
+
+private:
+  std::mutex mutex = {};
+  std::vector<Reported> reported = {};
+
+  auto report(ContactEvent::Type type,
+              const JPH::Body& inBody1,
+              const JPH::Body& inBody2,
+              const JPH::ContactManifold& inManifold) -> void {
+    const auto event = ContactEvent{
+        .type = type,
+        .body1 = inBody1.GetID(),
+        .body2 = inBody2.GetID(),
+        .sub_shape1 = inManifold.mSubShapeID1,
+        .sub_shape2 = inManifold.mSubShapeID2,
+    };
+    std::lock_guard lock(mutex);
+    reported.push_back({
+        .key = get_contact_sort_key(event),
+        .user_data1 = inBody1.GetUserData(),
+        .user_data2 = inBody2.GetUserData(),
+    });
+  }
+};
+
+// Boxes and spheres dropped on a floor, returns the flushed batch of every step.
+static auto simulate_contacts(u32 thread_count, u32 step_count) -> std::vector<std::vector<ContactEvent>> {
+  // Declared before the world so it outlives the physics system.
+  auto listener = RecordingContactListener();
+  auto world = test::JoltTestWorld(thread_count);
+  world.physics_system.SetContactListener(&listener);
+  world.add_floor(20.0f);
+  world.add_body_grid(4, 4, 4);
+
+  auto batches = std::vector<std::vector<ContactEvent>>();
+  for (u32 step = 0; step < step_count; step++) {
+    world.step();
+
+    const auto& batch = listener.get_event_stream().flush();
+    OX_CHECK(is_sorted_by_key(batch));
+
+    // Same contacts as the callbacks reported, in key order.
+    const auto reported = listener.take_reported();
+    OX_CHECK(reported.size() == batch.size());
+    for (usize i = 0; i < std::min(reported.size(), batch.size()); i++) {
+      OX_CHECK(reported[i].key == get_contact_sort_key(batch[i]));
+      if (batch[i].type != ContactEvent::Type::Removed) {
+        OX_CHECK(reported[i].user_data1 == batch[i].user_data1);
+        OX_CHECK(reported[i].user_data2 == batch[i].user_data2);
+      }
+    }
+
+    batches.push_back(batch);
+  }
+
+  return batches;
+}
+
+OX_TEST(contact_event_stream_jolt_batches_match_across_threads) {
+  constexpr auto STEPS = 60_u32;
+  const auto single_threaded = simulate_contacts(1, STEPS);
+
+  auto event_count = 0_sz;
+  for (const auto& batch : single_threaded) {
+    event_count += batch.size();
+  }
+  OX_CHECK(event_count > 0);
+
+  for (const auto thread_count : {2_u32, 4_u32}) {
+    OX_CHECK(simulate_contacts(thread_count, STEPS) == single_threaded);
+  }
+}
+
+// The listener before contacts were deferred: each callback emitted an event to the scene's
+// observers right away, from the job thread Jolt ran it on. flecs needs those serialized.
+struct ImmediateContactEvent {
+  const JPH::Body* body1 = nullptr;
+  const JPH::Body* body2 = nullptr;
+  const JPH::ContactManifold* manifold = nullptr;
+};
+
+class ImmediateContactListener final : public JPH::ContactListener {
+public:
+  explicit ImmediateContactListener(flecs::entity events_) : events(events_) {}
+
+  void OnContactAdded(const JPH::Body& inBody1,
+                      const JPH::Body& inBody2,
+                      const JPH::ContactManifold& inManifold,
+                      JPH::ContactSettings&) override {
+    std::lock_guard lock(mutex);
+    events.emit<ImmediateContactEvent>({&inBody1, &inBody2, &inManifold});
+  }
+
+  void OnContactPersisted(const JPH::Body& inBody1,
+                          const JPH::Body& inBody2,
+                          const JPH::ContactManifold& inManifold,
+                          JPH::ContactSettings&) override {
+    std::lock_guard lock(mutex);
+    events.emit<ImmediateContactEvent>({&inBody1, &inBody2, &inManifold});
+  }
+
+  void OnContactRemoved(const JPH::SubShapeIDPair&) override {
+    std::lock_guard lock(mutex);
+    events.emit<ImmediateContactEvent>({});
+  }
+
+private:
+  flecs::entity events = {};
+  std::mutex mutex = {};
+};
+
+// Step time of a settled pile with tens of thousands of contacts per step, the same per contact
+// work done in observers of immediate events against one observer of the deferred batch.
+OX_BENCHMARK(contact_event_dispatch) {
+  constexpr auto WARMUP_STEPS = 90_u32;
+  constexpr auto STEPS = 30_u32;
+  const auto thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+  const auto run = [&](const char* name, bool deferred) {
+    auto world = flecs::world();
+    auto physics_events = world.entity();
+    auto contact_count = 0_u64;
+    auto depth_sum = 0.0f;
+    physics_events.observe<ImmediateContactEvent>([&](ImmediateContactEvent& event) {
+      contact_count += 1;
+      if (event.manifold)
+        depth_sum += event.manifold->mPenetrationDepth;
+    });
+    physics_events.observe<SceneEvents::OnContactEventsBatch>([&](SceneEvents::OnContactEventsBatch& batch) {
+      contact_count += batch.events.size();
+      for (const auto& event : batch.events) {
+        depth_sum += event.penetration_depth;
+      }
+    });
+
+    // Declared before the world so they outlive the physics system.
+    auto deferred_listener = Physics3DContactListener(nullptr);
+    auto immediate_listener = ImmediateContactListener(physics_events);
+    auto jolt_world = test::JoltTestWorld(thread_count, 16384);
+    if (deferred) {
+      jolt_world.physics_system.SetContactListener(&deferred_listener);
+    } else {
+      jolt_world.physics_system.SetContactListener(&immediate_listener);
+    }
+    jolt_world.add_floor(40.0f);
+    const auto body_count = jolt_world.add_body_grid(40, 10, 40);
+
+    const auto step = [&] {
+      jolt_world.step();
+      if (deferred) {
+        const auto& batch = deferred_listener.get_event_stream().flush();
+        physics_events.emit<SceneEvents::OnContactEventsBatch>({std::span<const ContactEvent>(batch)});
+      }
+    };
+
+    for (u32 i = 0; i < WARMUP_STEPS; i++) {
+      step();
+    }
+    contact_count = 0;
+    const auto start = test::now_millis();
+    for (u32 i = 0; i < STEPS; i++) {
+      step();
+    }
+    const auto step_millis = (test::now_millis() - start) / STEPS;
+    test::do_not_optimize(depth_sum);
+
+    fmt::println("  {:<9}: {} bodies, {} threads, {} contacts per step, {:.3f} ms per step",
+                 name,
+                 body_count,
+                 thread_count,
+                 contact_count / STEPS,
+                 step_millis);
+  };
+
+  run("immediate", false);
+  run("deferred", true);
+}
+} // namespace ox
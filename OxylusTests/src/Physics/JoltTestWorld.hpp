@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/RegisterTypes.h>
+
+#include "Physics/PhysicsInterfaces.hpp"
+
+namespace ox::test {
+// Tests don't go through `Physics::init`, Jolt's allocator and types are registered once
+// for the whole run.
+inline auto init_jolt() -> bool {
+  static const auto initialized = [] {
+#ifndef JPH_DISABLE_CUSTOM_ALLOCATOR
+    JPH::RegisterDefaultAllocator();
+#endif
+    JPH::Factory::sInstance = new JPH::Factory();
+    JPH::RegisterTypes();
+    return true;
+  }();
+  return initialized;
+}
+
+// Physics system with the engine's layers, without an app or a scene.
+struct JoltTestWorld {
+  // First, the members below already allocate through Jolt.
+  bool jolt_initialized = init_jolt();
+
+  BPLayerInterfaceImpl layer_interface = {};
+  ObjectVsBroadPhaseLayerFilterImpl object_vs_broad_phase_filter = {};
+  ObjectLayerPairFilterImpl object_layer_pair_filter = {};
+  JPH::TempAllocatorImpl temp_allocator;
+  JPH::JobSystemThreadPool job_system;
+  JPH::PhysicsSystem physics_system = {};
+
+  // Temporary memory grows with the body count, 16 MiB for the default 4096 bodies.
+  explicit JoltTestWorld(u32 thread_count, u32 max_bodies = 4096)
+      : temp_allocator(max_bodies * 4096),
+        job_system(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, static_cast<i32>(thread_count) - 1) {
+    physics_system.Init(max_bodies,
+                        0,
+                        max_bodies * 4,
+                        max_bodies * 4,
+                        layer_interface,
+                        object_vs_broad_phase_filter,
+                        object_layer_pair_filter);
+  }
+
+  auto add_floor(f32 half_extent) -> JPH::BodyID {
+    const auto settings = JPH::BodyCreationSettings(new JPH::BoxShape(JPH::Vec3(half_extent, 0.5f, half_extent)),
+                                                    JPH::RVec3(0.0f, -0.5f, 0.0f),
+                                                    JPH::Quat::sIdentity(),
+                                                    JPH::EMotionType::Static,
+                                                    PhysicsLayers::NON_MOVING);
+    return physics_system.GetBodyInterface().CreateAndAddBody(settings, JPH::EActivation::DontActivate);
+  }
+
+  // Unit spheres and boxes alternating on a grid above the floor, centered on the y axis.
+  // Their user data counts up from 1 in creation order. Returns the number of bodies.
+  auto add_body_grid(u32 size_x, u32 size_y, u32 size_z) -> u32 {
+    auto& body_interface = physics_system.GetBodyInterface();
+    const auto sphere_shape = JPH::RefConst<JPH::Shape>(new JPH::SphereShape(0.5f));
+    const auto box_shape = JPH::RefConst<JPH::Shape>(new JPH::BoxShape(JPH::Vec3::sReplicate(0.5f)));
+
+    auto count = 0_u32;
+    for (u32 y = 0; y < size_y; y++) {
+      for (u32 z = 0; z < size_z; z++) {
+        for (u32 x = 0; x < size_x; x++) {
+          const auto position = JPH::RVec3(static_cast<f32>(x) * 1.1f - static_cast<f32>(size_x) * 0.55f,
+                                           0.6f + static_cast<f32>(y) * 1.2f,
+                                           static_cast<f32>(z) * 1.1f - static_cast<f32>(size_z) * 0.55f);
+          auto settings = JPH::BodyCreationSettings((x + y + z) % 2 == 0 ? sphere_shape : box_shape,
+                                                    position,
+                                                    JPH::Quat::sIdentity(),
+                                                    JPH::EMotionType::Dynamic,
+                                                    PhysicsLayers::MOVING);
+          settings.mUserData = ++count;
+          body_interface.CreateAndAddBody(settings, JPH::EActivation::Activate);
+        }
+      }
+    }
+
+    physics_system.OptimizeBroadPhase();
+    return count;
+  }
+
+  auto step() -> void { physics_system.Update(1.0f / 60.0f, 1, &temp_allocator, &job_system); }
+};
+} // namespace ox::test
@@ -0,0 +1,191 @@
+#include "Test.hpp"
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyFilter.h>
+#include <thread>
+#include <vector>
+
+#include "Physics/JoltTestWorld.hpp"
+#include "Render/DebugRenderer.hpp"
+
+namespace ox {
+static auto get_retained_instance_count(const DebugRenderer::DrawData& data) -> u32 {
+  auto count = 0_u32;
+  for (const auto& batch : data.batches) {
+    count += batch.retained ? batch.instance_count : 0;
+  }
+  return count;
+}
+
+OX_TEST(debug_renderer_collects_every_thread) {
+  DebugRenderer::init();
+
+  constexpr auto THREADS = 8_u32;
+  constexpr auto LINES = 1000_u32;
+  auto threads = std::vector<std::thread>();
+  for (u32 t = 0; t < THREADS; t++) {
+    threads.emplace_back([t] {
+      for (u32 i = 0; i < LINES; i++) {
+        DebugRenderer::draw_line({0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, 1.0f, glm::vec4(1.0f), t % 2 == 0);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto data = DebugRenderer::DrawData{};
+  DebugRenderer::collect(data);
+  OX_CHECK(data.vertices.size() == THREADS * LINES * 2);
+  OX_CHECK(data.batches.size() == 2);
+
+  // Collecting drains the lists.
+  DebugRenderer::collect(data);
+  OX_CHECK(data.vertices.empty());
+  OX_CHECK(data.batches.empty());
+
+  DebugRenderer::release();
+}
+
+OX_TEST(debug_renderer_instances_retained_geometry) {
+  DebugRenderer::init();
+
+  const auto triangle = DebugRenderer::Triangle{
+      .p1 = {0.0f, 0.0f, 0.0f},
+      .p2 = {1.0f, 0.0f, 0.0f},
+      .p3 = {0.0f, 1.0f, 0.0f},
+      .col = glm::vec4(1.0f),
+  };
+  const auto id = DebugRenderer::create_geometry({}, std::span(&triangle, 1));
+
+  for (u32 i = 0; i < 10; i++) {
+    DebugRenderer::draw_geometry(id, glm::mat4(1.0f), glm::vec4(1.0f), i % 2 == 0);
+  }
+
+  auto data = DebugRenderer::DrawData{};
+  DebugRenderer::collect(data);
+  // One instanced batch per mode, nothing copied per draw.
+  OX_CHECK(data.vertices.empty());
+  OX_CHECK(data.batches.size() == 2);
+  for (const auto& batch : data.batches) {
+    OX_CHECK(batch.retained);
+    OX_CHECK(batch.instance_count == 5);
+    OX_CHECK(batch.vertex_count == (batch.topology == DebugRenderer::Topology::Lines ? 6 : 3));
+  }
+
+  // Geometry is only copied again after it changed.
+  data.geometry_vertices.clear();
+  DebugRenderer::collect(data);
+  OX_CHECK(data.geometry_vertices.empty());
+
+  // Instances of destroyed geometry are dropped.
+  DebugRenderer::destroy_geometry(id);
+  DebugRenderer::draw_geometry(id, glm::mat4(1.0f));
+  DebugRenderer::collect(data);
+  OX_CHECK(data.batches.empty());
+
+  DebugRenderer::release();
+}
+
+// Jolt shapes go through `DrawGeometry`, each body becomes one instance of its shape's batch.
+OX_TEST(debug_renderer_jolt_bodies_are_instanced) {
+  auto world = test::JoltTestWorld(1);
+  world.add_floor(50.0f);
+  const auto body_count = world.add_body_grid(8, 2, 8) + 1;
+
+  {
+    auto renderer = PhysicsDebugRenderer();
+    auto data = DebugRenderer::DrawData{};
+
+    for (const auto wireframe : {true, false}) {
+      auto settings = JPH::BodyManager::DrawSettings{};
+      settings.mDrawShape = true;
+      settings.mDrawShapeWireframe = wireframe;
+      world.physics_system.DrawBodies(settings, &renderer);
+
+      DebugRenderer::collect(data);
+      OX_CHECK(data.vertices.empty());
+      OX_CHECK(get_retained_instance_count(data) == body_count);
+      // Spheres and boxes share their batches, only the sphere LOD and the box are drawn.
+      OX_CHECK(data.batches.size() == 2);
+      for (const auto& batch : data.batches) {
+        OX_CHECK(batch.topology == (wireframe ? DebugRenderer::Topology::Lines : DebugRenderer::Topology::Triangles));
+        OX_CHECK(batch.first_vertex + batch.vertex_count <= data.geometry_vertices.size());
+      }
+    }
+
+    // Only the floor, its instance carries the body transform.
+    struct StaticBodyFilter final : JPH::BodyDrawFilter {
+      bool ShouldDraw(const JPH::Body& body) const override { return body.IsStatic(); }
+    };
+    auto settings = JPH::BodyManager::DrawSettings{};
+    settings.mDrawShape = true;
+    const auto filter = StaticBodyFilter{};
+    world.physics_system.DrawBodies(settings, &renderer, &filter);
+    DebugRenderer::collect(data);
+    OX_CHECK(get_retained_instance_count(data) == 1);
+    const auto center = data.instances.back().transform * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    OX_CHECK(glm::abs(center.y + 0.5f) < 1e-5f);
+  }
+
+  DebugRenderer::release();
+}
+
+// Jolt debug drawing of many bodies per frame: instancing the retained shape batches against
+// copying every transformed edge as lines, which is what the renderer did before.
+OX_BENCHMARK(debug_renderer_jolt_bodies) {
+  auto world = test::JoltTestWorld(1, 8192);
+  world.add_floor(100.0f);
+  const auto body_count = world.add_body_grid(20, 5, 20) + 1;
+
+  {
+    auto renderer = PhysicsDebugRenderer();
+    auto data = DebugRenderer::DrawData{};
+    auto settings = JPH::BodyManager::DrawSettings{};
+    settings.mDrawShape = true;
+    settings.mDrawShapeWireframe = true;
+
+    constexpr auto FRAMES = 32;
+    world.physics_system.DrawBodies(settings, &renderer);
+    DebugRenderer::collect(data);
+    const auto start = test::now_millis();
+    for (u32 frame = 0; frame < FRAMES; frame++) {
+      world.physics_system.DrawBodies(settings, &renderer);
+      DebugRenderer::collect(data);
+    }
+    const auto instanced_millis = (test::now_millis() - start) / FRAMES;
+    const auto batch_count = data.batches.size();
+
+    // Same frame with every instance expanded into immediate lines.
+    const auto copy_start = test::now_millis();
+    for (u32 frame = 0; frame < FRAMES; frame++) {
+      world.physics_system.DrawBodies(settings, &renderer);
+      DebugRenderer::collect(data);
+      const auto& geometry_vertices = data.geometry_vertices;
+      for (const auto& batch : data.batches) {
+        for (u32 i = batch.first_instance; i < batch.first_instance + batch.instance_count; i++) {
+          const auto& instance = data.instances[i];
+          for (u32 v = batch.first_vertex; v + 1 < batch.first_vertex + batch.vertex_count; v += 2) {
+            const auto p1 = instance.transform * glm::vec4(geometry_vertices[v].position, 1.0f);
+            const auto p2 = instance.transform * glm::vec4(geometry_vertices[v + 1].position, 1.0f);
+            DebugRenderer::draw_line(glm::vec3(p1), glm::vec3(p2), 1.0f, instance.color);
+          }
+        }
+      }
+      DebugRenderer::collect(data);
+    }
+    const auto copied_millis = (test::now_millis() - copy_start) / FRAMES;
+    const auto copied_lines = data.vertices.size() / 2;
+
+    fmt::println("  {} bodies: instanced {:.3f} ms ({} batches), copied {:.3f} ms ({} lines), {:.1f}x",
+                 body_count,
+                 instanced_millis,
+                 batch_count,
+                 copied_millis,
+                 copied_lines,
+                 copied_millis / instanced_millis);
+  }
+
+  DebugRenderer::release();
+}
+} // namespace ox
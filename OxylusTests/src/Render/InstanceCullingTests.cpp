@@ -0,0 +1,149 @@
+#include "Test.hpp"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Render/InstanceCulling.hpp"
+
+namespace ox {
+static auto random_bounds(std::mt19937& rng, usize count) -> InstanceBounds {
+  auto position = std::uniform_real_distribution(-100.0f, 100.0f);
+  auto extent = std::uniform_real_distribution(0.0f, 10.0f);
+
+  auto bounds = InstanceBounds{};
+  for (usize i = 0; i < count; i++) {
+    bounds.push_back({position(rng), position(rng), position(rng)}, {extent(rng), extent(rng), extent(rng)});
+  }
+
+  return bounds;
+}
+
+// Arbitrary planes rather than a real camera, the rounding has to match for any input.
+static auto random_frustum(std::mt19937& rng) -> CullFrustum {
+  auto component = std::uniform_real_distribution(-1.0f, 1.0f);
+  auto distance = std::uniform_real_distribution(-50.0f, 50.0f);
+
+  auto frustum = CullFrustum{};
+  for (auto& plane : frustum.planes) {
+    plane = glm::vec4(component(rng), component(rng), component(rng), distance(rng));
+  }
+
+  return frustum;
+}
+
+static auto check_matches_reference(const InstanceBounds& bounds,
+                                    std::span<const CullFrustum> frusta,
+                                    usize begin,
+                                    usize end) -> void {
+  auto visibility = std::vector<u8>(bounds.size(), 0xff_u8);
+  instance_culling::cull(bounds, frusta, visibility, begin, end);
+
+  for (usize i = 0; i < bounds.size(); i++) {
+    auto expected = 0_u8;
+    if (i >= begin && i < end) {
+      for (usize f = 0; f < frusta.size(); f++) {
+        if (instance_culling::is_visible(bounds, i, frusta[f]))
+          expected |= static_cast<u8>(1 << f);
+      }
+    } else {
+      // Outside of the range is left alone.
+      expected = 0xff_u8;
+    }
+
+    OX_CHECK(visibility[i] == expected);
+  }
+}
+
+OX_TEST(instance_culling_matches_scalar_reference) {
+  auto rng = std::mt19937(1234);
+  // Not a multiple of the SIMD width, the tail goes through the scalar path.
+  const auto bounds = random_bounds(rng, 4099);
+
+  for (u32 iteration = 0; iteration < 64; iteration++) {
+    auto frusta = std::vector<CullFrustum>();
+    const auto frustum_count = 1 + iteration % instance_culling::MAX_FRUSTA;
+    for (usize f = 0; f < frustum_count; f++) {
+      frusta.push_back(random_frustum(rng));
+    }
+
+    check_matches_reference(bounds, frusta, 0, bounds.size());
+    check_matches_reference(bounds, frusta, 3, bounds.size() - 5);
+  }
+}
+
+OX_TEST(instance_culling_edge_cases) {
+  auto frustum = CullFrustum{};
+  for (auto& plane : frustum.planes) {
+    plane = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+  }
+
+  auto bounds = InstanceBounds{};
+  // Touching the plane counts as visible.
+  bounds.push_back({-1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f});
+  // Just behind it doesn't.
+  bounds.push_back({-1.0f - 1e-5f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f});
+  // Degenerate box on the plane.
+  bounds.push_back({0.0f, 5.0f, 5.0f}, {0.0f, 0.0f, 0.0f});
+  // NaN never passes.
+  bounds.push_back({std::numeric_limits<f32>::quiet_NaN(), 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f});
+  // Infinite extent always passes.
+  bounds.push_back({-1000.0f, 0.0f, 0.0f}, {std::numeric_limits<f32>::infinity(), 0.0f, 0.0f});
+
+  const auto expected = std::vector<u8>{1, 0, 1, 0, 1};
+  auto visibility = std::vector<u8>(bounds.size());
+  instance_culling::cull(bounds, std::span(&frustum, 1), visibility, 0, bounds.size());
+  OX_CHECK(visibility == expected);
+
+  check_matches_reference(bounds, std::span(&frustum, 1), 0, bounds.size());
+}
+
+OX_BENCHMARK(instance_culling_throughput) {
+  auto rng = std::mt19937(42);
+
+  for (const auto instance_count : {100'000_sz, 1'000'000_sz}) {
+    const auto local = random_bounds(rng, instance_count);
+    auto transforms = std::vector<GPU::Transforms>(1);
+    transforms[0].world = glm::mat4(1.0f);
+    const auto transform_indices = std::vector<u32>(instance_count, 0);
+    auto world = InstanceBounds{};
+    world.resize(instance_count);
+
+    auto frusta = std::vector<CullFrustum>();
+    for (usize f = 0; f < instance_culling::MAX_FRUSTA; f++) {
+      frusta.push_back(random_frustum(rng));
+    }
+
+    auto visibility = std::vector<u8>(instance_count);
+    for (const auto frustum_count : {1_sz, instance_culling::MAX_FRUSTA}) {
+      const auto frusta_span = std::span(frusta).first(frustum_count);
+      constexpr auto ITERATIONS = 8;
+
+      const auto start = test::now_millis();
+      for (u32 i = 0; i < ITERATIONS; i++) {
+        instance_culling::transform_bounds(local, transform_indices, transforms, world, 0, instance_count);
+        instance_culling::cull(world, frusta_span, visibility, 0, instance_count);
+        test::do_not_optimize(visibility);
+      }
+      const auto cull_millis = (test::now_millis() - start) / ITERATIONS;
+
+      const auto reference_start = test::now_millis();
+      auto visible_count = 0_sz;
+      for (usize i = 0; i < instance_count; i++) {
+        for (const auto& frustum : frusta_span) {
+          visible_count += instance_culling::is_visible(world, i, frustum);
+        }
+      }
+      test::do_not_optimize(visible_count);
+      const auto reference_millis = test::now_millis() - reference_start;
+
+      fmt::println("  {:>7} instances, {} frusta: {:.3f} ms ({:.1f} M instances/s), scalar reference {:.3f} ms",
+                   instance_count,
+                   frustum_count,
+                   cull_millis,
+                   static_cast<f64>(instance_count) / cull_millis / 1000.0,
+                   reference_millis);
+    }
+  }
+}
+} // namespace ox
@@ -0,0 +1,120 @@
+#include "Test.hpp"
+
+#include <random>
+
+#include "Render/LightClustering.hpp"
+
+namespace ox {
+static auto make_grid(bool orthographic) -> LightClusterGrid {
+  auto grid = LightClusterGrid{.near_clip = 0.1f, .far_clip = 200.0f, .orthographic = orthographic};
+  if (orthographic) {
+    grid.projection_scale = {1.0f / 40.0f, 1.0f / 22.5f};
+  } else {
+    // 60 degree vertical field of view at 16:9.
+    const auto scale_y = 1.0f / glm::tan(glm::radians(30.0f));
+    grid.projection_scale = {scale_y * 9.0f / 16.0f, scale_y};
+  }
+  return grid;
+}
+
+// Lights spread through and around the frustum, some behind the eye or beyond the far plane.
+static auto make_spheres(u32 count, u32 seed, f32 max_radius) -> LightSpheres {
+  auto rng = std::mt19937(seed);
+  auto position = std::uniform_real_distribution(-60.0f, 60.0f);
+  auto depth = std::uniform_real_distribution(-10.0f, 220.0f);
+  auto radius = std::uniform_real_distribution(0.0f, max_radius);
+
+  auto spheres = LightSpheres{};
+  for (u32 i = 0; i < count; i++) {
+    spheres.push_back({position(rng), position(rng), -depth(rng)}, radius(rng));
+  }
+  return spheres;
+}
+
+static auto matches_reference(const LightClusterGrid& grid, const LightSpheres& spheres) -> bool {
+  auto expected = LightClusterList{};
+  light_clustering::bin_lights_reference(grid, spheres, expected);
+  auto list = LightClusterList{};
+  light_clustering::bin_lights(grid, spheres, list);
+
+  return list.ranges == expected.ranges && list.indices == expected.indices &&
+         list.overflow_count == expected.overflow_count;
+}
+
+OX_TEST(light_clustering_matches_reference) {
+  for (const auto orthographic : {false, true}) {
+    const auto grid = make_grid(orthographic);
+    OX_CHECK(matches_reference(grid, {}));
+    // Counts that leave a partial group of four.
+    for (const auto count : {1_u32, 3_u32, 5_u32, 130_u32, 1021_u32}) {
+      OX_CHECK(matches_reference(grid, make_spheres(count, count, 8.0f)));
+    }
+  }
+}
+
+OX_TEST(light_clustering_matches_reference_on_boundaries) {
+  const auto grid = make_grid(false);
+
+  // Zero radius lights on every slice boundary and on tile edges, where rounding decides.
+  auto spheres = LightSpheres{};
+  for (u32 z = 0; z <= grid.size.z; z++) {
+    auto min = glm::vec3{};
+    auto max = glm::vec3{};
+    grid.get_cluster_bounds(grid.size.x / 2, grid.size.y / 2, ox::min(z, grid.size.z - 1), min, max);
+    const auto depth = grid.get_slice_depth(z);
+    spheres.push_back({min.x, min.y, -depth}, 0.0f);
+    spheres.push_back({max.x, max.y, -depth}, 0.0f);
+    spheres.push_back({min.x, 0.0f, -depth}, 0.5f);
+  }
+  OX_CHECK(matches_reference(grid, spheres));
+}
+
+OX_TEST(light_clustering_overflow) {
+  const auto grid = LightClusterGrid{.size = {4, 4, 4}};
+  // Every light covers the whole frustum, each cluster keeps the first ones.
+  auto spheres = LightSpheres{};
+  for (u32 i = 0; i < light_clustering::MAX_LIGHTS_PER_CLUSTER + 10; i++) {
+    spheres.push_back({0.0f, 0.0f, -10.0f}, 10000.0f);
+  }
+
+  auto list = LightClusterList{};
+  light_clustering::bin_lights(grid, spheres, list);
+  OX_CHECK(matches_reference(grid, spheres));
+  OX_CHECK(list.overflow_count == grid.get_cluster_count() * 10);
+  for (const auto& range : list.ranges) {
+    OX_CHECK(range.y == light_clustering::MAX_LIGHTS_PER_CLUSTER);
+    OX_CHECK(list.indices[range.x + range.y - 1] == light_clustering::MAX_LIGHTS_PER_CLUSTER - 1);
+  }
+}
+
+// Single threaded binning against the brute force reference, per light count.
+OX_BENCHMARK(light_clustering_bin_lights) {
+  const auto grid = make_grid(false);
+  for (const auto count : {256_u32, 1024_u32, 4096_u32}) {
+    const auto spheres = make_spheres(count, 7, 6.0f);
+
+    auto list = LightClusterList{};
+    const auto measure = [&](auto&& bin, u32 iterations) {
+      bin(grid, spheres, list);
+      const auto start = test::now_millis();
+      for (u32 i = 0; i < iterations; i++) {
+        bin(grid, spheres, list);
+        test::do_not_optimize(list.indices.data());
+      }
+      return (test::now_millis() - start) / iterations;
+    };
+
+    const auto reference_millis = measure(light_clustering::bin_lights_reference, 4);
+    const auto binned_millis = measure(light_clustering::bin_lights, 32);
+    OX_CHECK(matches_reference(grid, spheres));
+
+    fmt::println("  {:>5} lights: reference {:.3f} ms, bin_lights {:.3f} ms ({:.1f}x), {} indices, {} overflow",
+                 count,
+                 reference_millis,
+                 binned_millis,
+                 reference_millis / binned_millis,
+                 list.indices.size(),
+                 list.overflow_count);
+  }
+}
+} // namespace ox
@@ -0,0 +1,89 @@
+#include "Test.hpp"
+
+#include <cmath>
+
+#include "Render/MeshletCulling.hpp"
+
+namespace ox {
+// Flat meshlet at `apex` whose triangles face `normal`.
+static auto make_flat_meshlet(const glm::vec3& apex, const glm::vec3& normal) -> GPU::MeshletBounds {
+  return {
+      .sphere_center = apex,
+      .sphere_radius = 1.0f,
+      .cone_apex = apex,
+      .cone_axis = normal,
+      .cone_cutoff = 0.0f,
+  };
+}
+
+static auto is_culled(const GPU::MeshletBounds& bounds, const glm::mat4& world, const glm::vec3& camera_position)
+    -> bool {
+  const auto normal_matrix = glm::transpose(glm::inverse(glm::mat3(world)));
+  return meshlet_culling::is_cone_culled(bounds, world, normal_matrix, camera_position);
+}
+
+OX_TEST(meshlet_culling_cone) {
+  const auto identity = glm::mat4(1.0f);
+  const auto facing_z = make_flat_meshlet(glm::vec3(0.0f), {0.0f, 0.0f, 1.0f});
+
+  OX_CHECK(!is_culled(facing_z, identity, {0.0f, 0.0f, 5.0f}));
+  OX_CHECK(!is_culled(facing_z, identity, {3.0f, -2.0f, 0.5f}));
+  OX_CHECK(is_culled(facing_z, identity, {0.0f, 0.0f, -5.0f}));
+  OX_CHECK(is_culled(facing_z, identity, {3.0f, -2.0f, -0.5f}));
+
+  // A wider cone only rejects viewers well behind it.
+  auto spread = facing_z;
+  spread.cone_cutoff = 0.5f;
+  OX_CHECK(!is_culled(spread, identity, {0.0f, 5.0f, -1.0f}));
+  OX_CHECK(is_culled(spread, identity, {0.0f, 1.0f, -5.0f}));
+
+  // Normals too spread out for a cone and a camera at the apex are never culled.
+  auto no_cone = facing_z;
+  no_cone.cone_cutoff = 1.0f;
+  OX_CHECK(!is_culled(no_cone, identity, {0.0f, 0.0f, -5.0f}));
+  OX_CHECK(!is_culled(facing_z, identity, glm::vec3(0.0f)));
+}
+
+OX_TEST(meshlet_culling_cone_in_world_space) {
+  const auto facing_z = make_flat_meshlet(glm::vec3(0.0f), {0.0f, 0.0f, 1.0f});
+
+  // Turned around the x axis, it now faces -z.
+  auto turned = glm::mat4(1.0f);
+  turned[1][1] = turned[2][2] = -1.0f;
+  OX_CHECK(is_culled(facing_z, turned, {0.0f, 0.0f, 5.0f}));
+  OX_CHECK(!is_culled(facing_z, turned, {0.0f, 0.0f, -5.0f}));
+
+  // Moved past the camera.
+  auto moved = glm::mat4(1.0f);
+  moved[3] = glm::vec4(0.0f, 0.0f, 10.0f, 1.0f);
+  OX_CHECK(is_culled(facing_z, moved, {0.0f, 0.0f, 5.0f}));
+
+  // Non uniform scale goes through the normal matrix, stretching z tilts a 45 degree normal
+  // towards x.
+  const auto tilted = make_flat_meshlet(glm::vec3(0.0f), glm::normalize(glm::vec3(1.0f, 0.0f, 1.0f)));
+  auto stretched = glm::mat4(1.0f);
+  stretched[2][2] = 4.0f;
+  OX_CHECK(is_culled(tilted, glm::mat4(1.0f), {2.5f, 0.0f, -5.0f}));
+  OX_CHECK(!is_culled(tilted, stretched, {2.5f, 0.0f, -5.0f}));
+}
+
+OX_TEST(meshlet_culling_cone_rejection_rate) {
+  auto bounds = std::vector{
+      make_flat_meshlet(glm::vec3(0.0f), {0.0f, 0.0f, 1.0f}),
+      make_flat_meshlet(glm::vec3(0.0f), {0.0f, 0.0f, -1.0f}),
+  };
+  const auto camera_positions = std::vector<glm::vec3>{{0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -5.0f}};
+
+  // Every camera sees one side.
+  const auto rate = meshlet_culling::get_cone_rejection_rate(bounds, glm::mat4(1.0f), camera_positions);
+  OX_CHECK(std::abs(rate - 0.5f) < 1e-6f);
+
+  bounds.push_back(make_flat_meshlet(glm::vec3(0.0f), {0.0f, 0.0f, 1.0f}));
+  bounds.back().cone_cutoff = 1.0f;
+  const auto with_no_cone = meshlet_culling::get_cone_rejection_rate(bounds, glm::mat4(1.0f), camera_positions);
+  OX_CHECK(std::abs(with_no_cone - 2.0f / 6.0f) < 1e-6f);
+
+  OX_CHECK(meshlet_culling::get_cone_rejection_rate({}, glm::mat4(1.0f), camera_positions) == 0.0f);
+  OX_CHECK(meshlet_culling::get_cone_rejection_rate(bounds, glm::mat4(1.0f), {}) == 0.0f);
+}
+} // namespace ox
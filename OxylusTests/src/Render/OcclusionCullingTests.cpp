@@ -0,0 +1,105 @@
+#include "Test.hpp"
+
+#include <random>
+#include <vector>
+
+#include "Render/OcclusionCulling.hpp"
+
+namespace ox {
+// Camera at the origin looking down -z with a 90 degree vertical field of view.
+static auto make_projection_view(f32 aspect) -> glm::mat4 {
+  const auto projection = glm::perspective(glm::radians(90.0f), aspect, 0.1f, 1000.0f);
+  const auto view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  return projection * view;
+}
+
+// Square facing the camera at `z`, both windings so either facing is covered.
+static auto add_wall(OcclusionBuffer& buffer, f32 half_size, f32 z) -> void {
+  const auto positions = std::vector<glm::vec3>{
+      {-half_size, -half_size, z},
+      {half_size, -half_size, z},
+      {half_size, half_size, z},
+      {-half_size, half_size, z},
+  };
+  const auto indices = std::vector<u32>{0, 1, 2, 0, 2, 3, 0, 2, 1, 0, 3, 2};
+  buffer.add_occluder(positions, indices, glm::mat4(1.0f));
+}
+
+OX_TEST(occlusion_rasterize_matches_reference) {
+  auto rng = std::mt19937(99);
+  auto lateral = std::uniform_real_distribution(-30.0f, 30.0f);
+  auto distance = std::uniform_real_distribution(-60.0f, 5.0f);
+
+  for (u32 iteration = 0; iteration < 16; iteration++) {
+    auto buffer = OcclusionBuffer();
+    // Neither size is a multiple of the SIMD width or the band height.
+    buffer.begin_frame(make_projection_view(2.0f), 125 + iteration, 67);
+
+    // Triangles crossing the screen edges and the near plane included.
+    auto positions = std::vector<glm::vec3>();
+    auto indices = std::vector<u32>();
+    for (u32 i = 0; i < 300; i++) {
+      positions.emplace_back(lateral(rng), lateral(rng), distance(rng));
+      indices.push_back(i);
+    }
+    buffer.add_occluder(positions, indices, glm::mat4(1.0f));
+    OX_CHECK(buffer.get_triangle_count() > 0);
+
+    buffer.rasterize(false);
+    auto reference = std::vector<f32>(buffer.get_depth().size());
+    buffer.rasterize_reference(reference);
+
+    const auto depth = buffer.get_depth();
+    OX_CHECK(std::ranges::equal(depth, reference));
+    OX_CHECK(std::ranges::any_of(depth, [](f32 d) { return d > 0.0f; }));
+  }
+}
+
+OX_TEST(occlusion_is_visible_behind_a_wall) {
+  auto buffer = OcclusionBuffer();
+  buffer.begin_frame(make_projection_view(2.0f), 128, 64);
+
+  // Nothing rasterized yet hides nothing.
+  OX_CHECK(buffer.is_visible({0.0f, 0.0f, -20.0f}, glm::vec3(1.0f)));
+
+  // Covers the middle half of the screen vertically and a quarter horizontally.
+  add_wall(buffer, 5.0f, -10.0f);
+  buffer.rasterize(false);
+
+  // Behind the wall.
+  OX_CHECK(!buffer.is_visible({0.0f, 0.0f, -20.0f}, glm::vec3(1.0f)));
+  OX_CHECK(!buffer.is_visible({2.0f, -2.0f, -40.0f}, glm::vec3(3.0f)));
+  // In front of it.
+  OX_CHECK(buffer.is_visible({0.0f, 0.0f, -5.0f}, glm::vec3(1.0f)));
+  // Intersecting it.
+  OX_CHECK(buffer.is_visible({0.0f, 0.0f, -10.0f}, glm::vec3(1.0f)));
+  // Behind it, but wider than the wall on screen.
+  OX_CHECK(buffer.is_visible({0.0f, 0.0f, -20.0f}, glm::vec3(15.0f, 1.0f, 1.0f)));
+  // Behind it, next to the wall.
+  OX_CHECK(buffer.is_visible({12.0f, 0.0f, -20.0f}, glm::vec3(1.0f)));
+  // Reaching the camera.
+  OX_CHECK(buffer.is_visible({0.0f, 0.0f, -20.0f}, glm::vec3(1.0f, 1.0f, 20.0f)));
+  // Behind the camera and off screen are left to frustum culling.
+  OX_CHECK(buffer.is_visible({0.0f, 0.0f, 20.0f}, glm::vec3(1.0f)));
+  OX_CHECK(buffer.is_visible({500.0f, 0.0f, -20.0f}, glm::vec3(1.0f)));
+}
+
+OX_TEST(occlusion_cull_instances) {
+  auto buffer = OcclusionBuffer();
+  buffer.begin_frame(make_projection_view(2.0f), 128, 64);
+  add_wall(buffer, 5.0f, -10.0f);
+  buffer.rasterize(false);
+
+  auto bounds = InstanceBounds{};
+  bounds.push_back({0.0f, 0.0f, -20.0f}, glm::vec3(1.0f));
+  bounds.push_back({0.0f, 0.0f, -5.0f}, glm::vec3(1.0f));
+  bounds.push_back({12.0f, 0.0f, -20.0f}, glm::vec3(1.0f));
+  bounds.push_back({1.0f, 1.0f, -30.0f}, glm::vec3(1.0f));
+  auto visibility = std::vector<u8>{0b11, 0b11, 0b11, 0b10};
+
+  // Only the bit that is asked for is cleared, instances without it aren't tested.
+  buffer.cull_instances(bounds, visibility, 0b01, false);
+  const auto expected = std::vector<u8>{0b10, 0b11, 0b11, 0b10};
+  OX_CHECK(visibility == expected);
+}
+} // namespace ox
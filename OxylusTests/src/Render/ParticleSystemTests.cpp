@@ -0,0 +1,151 @@
+#include "Test.hpp"
+
+#include <cmath>
+#include <random>
+
+#include "Render/ParticleSystem.hpp"
+
+namespace ox {
+static auto make_buffer(u32 count, u32 seed) -> ParticleBuffer {
+  auto rng = std::mt19937(seed);
+  auto position = std::uniform_real_distribution(-10.0f, 10.0f);
+  auto velocity = std::uniform_real_distribution(-3.0f, 3.0f);
+  auto life = std::uniform_real_distribution(0.0f, 3.0f);
+
+  auto buffer = ParticleBuffer{};
+  buffer.set_capacity(count);
+  for (u32 i = 0; i < count; i++) {
+    const auto p = glm::vec3(position(rng), position(rng), position(rng));
+    const auto v = glm::vec3(velocity(rng), velocity(rng), velocity(rng));
+    buffer.push(p, v, life(rng));
+  }
+  return buffer;
+}
+
+// Every module that feeds the kernel enabled, with gravity.
+static auto make_properties() -> ParticleProperties {
+  auto properties = ParticleProperties{};
+  properties.start_lifetime = 3.0f;
+  properties.gravity_modifier = 0.5f;
+  properties.force_over_lifetime = {glm::vec3(1.0f, 2.0f, -1.0f), glm::vec3(-2.0f, 0.5f, 3.0f)};
+  properties.force_over_lifetime.enabled = true;
+  properties.velocity_over_lifetime = {glm::vec3(1.0f, 0.5f, 2.0f), glm::vec3(0.25f, 1.5f, 1.0f)};
+  properties.velocity_over_lifetime.enabled = true;
+  return properties;
+}
+
+static auto is_close(const std::vector<f32>& a, const std::vector<f32>& b) -> bool {
+  for (usize i = 0; i < a.size(); i++) {
+    if (std::abs(a[i] - b[i]) > 1e-5f * ox::max(1.0f, std::abs(b[i])))
+      return false;
+  }
+  return a.size() == b.size();
+}
+
+static auto is_close(const ParticleBuffer& a, const ParticleBuffer& b) -> bool {
+  return a.count == b.count && is_close(a.position_x, b.position_x) && is_close(a.position_y, b.position_y) &&
+         is_close(a.position_z, b.position_z) && is_close(a.velocity_x, b.velocity_x) &&
+         is_close(a.velocity_y, b.velocity_y) && is_close(a.velocity_z, b.velocity_z) && is_close(a.life, b.life);
+}
+
+OX_TEST(particles_simulate_matches_scalar) {
+  const auto params = particles::get_simulate_params(make_properties(), 1.0f / 60.0f);
+
+  // Ranges that start and end off a group of four.
+  for (const auto count : {0_u32, 1_u32, 3_u32, 4_u32, 7_u32, 1001_u32}) {
+    for (const auto begin : {0_u32, 1_u32, 2_u32}) {
+      if (begin > count)
+        continue;
+
+      auto expected = make_buffer(count, count + begin);
+      auto buffer = expected;
+      for (u32 step = 0; step < 30; step++) {
+        particles::simulate_scalar(expected, params, begin, count);
+        particles::simulate(buffer, params, begin, count);
+      }
+      OX_CHECK(is_close(buffer, expected));
+    }
+  }
+
+  // Particles outside the range are left alone.
+  const auto original = make_buffer(16, 1);
+  auto buffer = original;
+  particles::simulate(buffer, params, 4, 12);
+  for (u32 i = 0; i < 16; i++) {
+    const auto inside = i >= 4 && i < 12;
+    OX_CHECK((buffer.life[i] == original.life[i]) != inside);
+    OX_CHECK((buffer.position_y[i] == original.position_y[i]) != inside);
+  }
+}
+
+OX_TEST(particles_simulate_params_identity) {
+  // Disabled modules and no gravity leave velocities alone and move by velocity * dt.
+  auto properties = ParticleProperties{};
+  properties.velocity_over_lifetime.enabled = false;
+  const auto params = particles::get_simulate_params(properties, 0.5f);
+
+  auto buffer = ParticleBuffer{};
+  buffer.set_capacity(1);
+  buffer.push({1.0f, 2.0f, 3.0f}, {2.0f, -4.0f, 0.0f}, 2.0f);
+  particles::simulate(buffer, params, 0, buffer.count);
+
+  OX_CHECK(buffer.position_x[0] == 2.0f);
+  OX_CHECK(buffer.position_y[0] == 0.0f);
+  OX_CHECK(buffer.position_z[0] == 3.0f);
+  OX_CHECK(buffer.velocity_x[0] == 2.0f);
+  OX_CHECK(buffer.life[0] == 1.5f);
+}
+
+OX_TEST(particles_buffer_remove_dead) {
+  auto buffer = ParticleBuffer{};
+  buffer.set_capacity(8);
+  for (u32 i = 0; i < 8; i++) {
+    buffer.push({static_cast<f32>(i), 0.0f, 0.0f}, {}, i % 3 == 0 ? 0.0f : 1.0f);
+  }
+  OX_CHECK(!buffer.push({}, {}, 1.0f));
+
+  OX_CHECK(buffer.remove_dead() == 3);
+  OX_CHECK(buffer.count == 5);
+  // Survivors keep their data, only alive particles are left in [0, count).
+  auto id_sum = 0.0f;
+  for (u32 i = 0; i < buffer.count; i++) {
+    OX_CHECK(buffer.life[i] > 0.0f);
+    id_sum += buffer.position_x[i];
+  }
+  OX_CHECK(id_sum == 1.0f + 2.0f + 4.0f + 5.0f + 7.0f);
+
+  buffer.set_capacity(2);
+  OX_CHECK(buffer.count == 2);
+}
+
+// One emitter step over a full buffer, single threaded.
+OX_BENCHMARK(particles_simulate) {
+  const auto params = particles::get_simulate_params(make_properties(), 1.0f / 60.0f);
+
+  for (const auto count : {10'000_u32, 100'000_u32, 1'000'000_u32}) {
+    const auto steps = 10'000'000 / count;
+    const auto measure = [&](auto&& simulate) {
+      auto buffer = make_buffer(count, 3);
+      simulate(buffer, params, 0, buffer.count);
+      const auto start = test::now_millis();
+      for (u32 step = 0; step < steps; step++) {
+        simulate(buffer, params, 0, buffer.count);
+      }
+      const auto step_millis = (test::now_millis() - start) / steps;
+      test::do_not_optimize(buffer.position_x.data());
+      return step_millis;
+    };
+
+    const auto scalar_millis = measure(particles::simulate_scalar);
+    const auto simd_millis = measure(particles::simulate);
+    fmt::println("  {:>7} particles: scalar {:.3f} ms ({:.0f} particles/ms), simulate {:.3f} ms ({:.0f} particles/ms), "
+                 "{:.1f}x",
+                 count,
+                 scalar_millis,
+                 count / scalar_millis,
+                 simd_millis,
+                 count / simd_millis,
+                 scalar_millis / simd_millis);
+  }
+}
+} // namespace ox
@@ -0,0 +1,223 @@
+#include "Test.hpp"
+
+#include <random>
+#include <vector>
+
+#include "Render/ShadowAtlas.hpp"
+
+namespace ox {
+// Spot lights 100 units apart on x looking down -z, their views never overlap.
+static auto make_request(u64 light, u32 resolution) -> ShadowViewRequest {
+  const auto position = glm::vec3(static_cast<f32>(light) * 100.0f, 0.0f, 0.0f);
+  return {
+      .key = {.light = light},
+      .resolution = resolution,
+      .view_projection = shadow_atlas::get_spot_view_projection(
+          position, glm::vec3(0.0f, 0.0f, -1.0f), 10.0f, glm::radians(30.0f)),
+  };
+}
+
+static auto check_layout(const ShadowAtlas& atlas) -> void {
+  const auto views = atlas.get_views();
+  for (usize i = 0; i < views.size(); i++) {
+    const auto& a = views[i];
+    if (a.size == 0)
+      continue;
+
+    OX_CHECK(a.x + a.size <= atlas.get_size());
+    OX_CHECK(a.y + a.size <= atlas.get_size());
+    for (usize j = i + 1; j < views.size(); j++) {
+      const auto& b = views[j];
+      const auto overlaps = b.size != 0 && a.x < b.x + b.size && b.x < a.x + a.size && a.y < b.y + b.size &&
+                            b.y < a.y + a.size;
+      OX_CHECK(!overlaps);
+    }
+  }
+}
+
+static auto find(const ShadowAtlas& atlas, u64 light) -> const ShadowAtlasView& {
+  const auto* view = atlas.find_view({.light = light});
+  OX_CHECK(view != nullptr);
+  return *view;
+}
+
+OX_TEST(shadow_atlas_packs_without_overlap) {
+  auto rng = std::mt19937(7);
+  auto resolution = std::uniform_int_distribution(6, 11);
+
+  for (u32 iteration = 0; iteration < 32; iteration++) {
+    auto atlas = ShadowAtlas();
+    auto requests = std::vector<ShadowViewRequest>();
+    for (u64 light = 0; light < 8 + iteration; light++) {
+      requests.push_back(make_request(light, 1_u32 << resolution(rng)));
+    }
+
+    atlas.update(requests, {});
+    check_layout(atlas);
+
+    // Everything fits once halved, nothing is dropped.
+    for (const auto& view : atlas.get_views()) {
+      OX_CHECK(view.size == ox::max(view.requested_resolution >> atlas.get_resolution_shift(),
+                                    shadow_atlas::MIN_RESOLUTION));
+    }
+  }
+}
+
+OX_TEST(shadow_atlas_drops_views_from_the_back) {
+  auto atlas = ShadowAtlas();
+  atlas.set_size(512);
+
+  // 64 minimum sized views fill the atlas.
+  auto requests = std::vector<ShadowViewRequest>();
+  for (u64 light = 0; light < 70; light++) {
+    requests.push_back(make_request(light, shadow_atlas::MIN_RESOLUTION));
+  }
+
+  atlas.update(requests, {});
+  check_layout(atlas);
+
+  const auto views = atlas.get_views();
+  for (usize i = 0; i < views.size(); i++) {
+    OX_CHECK((views[i].size != 0) == (i < 64));
+    OX_CHECK(views[i].dirty == (i < 64));
+  }
+}
+
+OX_TEST(shadow_atlas_keeps_rects_when_repacking) {
+  auto atlas = ShadowAtlas();
+  atlas.set_size(2048);
+
+  atlas.update(std::vector{make_request(0, 1024), make_request(1, 512), make_request(2, 512)}, {});
+  check_layout(atlas);
+  const auto b = find(atlas, 1);
+  const auto c = find(atlas, 2);
+
+  // The first light goes away and a new one takes its space, the others stay put.
+  atlas.update(std::vector{make_request(1, 512), make_request(2, 512), make_request(3, 1024)}, {});
+  check_layout(atlas);
+  OX_CHECK(find(atlas, 1).x == b.x && find(atlas, 1).y == b.y && !find(atlas, 1).dirty);
+  OX_CHECK(find(atlas, 2).x == c.x && find(atlas, 2).y == c.y && !find(atlas, 2).dirty);
+  OX_CHECK(find(atlas, 3).x == 0 && find(atlas, 3).y == 0 && find(atlas, 3).dirty);
+  OX_CHECK(atlas.get_dirty_count() == 1);
+
+  // Only the view that changed resolution moves.
+  atlas.update(std::vector{make_request(1, 512), make_request(2, 256), make_request(3, 1024)}, {});
+  check_layout(atlas);
+  OX_CHECK(find(atlas, 1).x == b.x && find(atlas, 1).y == b.y && !find(atlas, 1).dirty);
+  OX_CHECK(find(atlas, 2).size == 256 && find(atlas, 2).dirty);
+  OX_CHECK(!find(atlas, 3).dirty);
+}
+
+OX_TEST(shadow_atlas_repacks_when_kept_rects_get_in_the_way) {
+  auto atlas = ShadowAtlas();
+  atlas.set_size(2048);
+
+  // Two small views end up in different quadrants.
+  atlas.update(std::vector{make_request(0, 512), make_request(1, 1024), make_request(2, 1024), make_request(3, 1024)},
+               {});
+  atlas.update(std::vector{make_request(0, 512), make_request(1, 1024), make_request(2, 1024), make_request(4, 512)},
+               {});
+  check_layout(atlas);
+  OX_CHECK(find(atlas, 0).x >= 1024 && find(atlas, 0).y >= 1024);
+  OX_CHECK(find(atlas, 4).x < 1024 && find(atlas, 4).y >= 1024);
+
+  // Three large views only fit when the small ones share a quadrant.
+  atlas.update(std::vector{make_request(0, 512), make_request(4, 512), make_request(5, 1024), make_request(6, 1024),
+                           make_request(7, 1024)},
+               {});
+  check_layout(atlas);
+  OX_CHECK(atlas.get_resolution_shift() == 0);
+  for (const auto& view : atlas.get_views()) {
+    OX_CHECK(view.size == view.requested_resolution);
+  }
+}
+
+OX_TEST(shadow_atlas_invalidation) {
+  auto atlas = ShadowAtlas();
+  auto requests = std::vector{make_request(0, 512), make_request(1, 512), make_request(2, 512)};
+
+  atlas.update(requests, {});
+  OX_CHECK(atlas.get_dirty_count() == 3);
+  atlas.update(requests, {});
+  OX_CHECK(atlas.get_dirty_count() == 0);
+
+  // A caster moving in front of the second light only touches its view.
+  auto moved = InstanceBounds{};
+  moved.push_back({100.0f, 0.0f, -5.0f}, {0.5f, 0.5f, 0.5f});
+  atlas.update(requests, moved);
+  OX_CHECK(atlas.get_dirty_count() == 1);
+  OX_CHECK(find(atlas, 1).dirty);
+
+  // Behind the light doesn't count.
+  moved.clear();
+  moved.push_back({100.0f, 0.0f, 5.0f}, {0.5f, 0.5f, 0.5f});
+  atlas.update(requests, moved);
+  OX_CHECK(atlas.get_dirty_count() == 0);
+
+  // The light itself moved.
+  requests[2].view_projection = make_request(3, 512).view_projection;
+  atlas.update(requests, {});
+  OX_CHECK(atlas.get_dirty_count() == 1);
+  OX_CHECK(find(atlas, 2).dirty);
+
+  atlas.invalidate();
+  atlas.update(requests, {});
+  OX_CHECK(atlas.get_dirty_count() == 3);
+
+  atlas.set_size(1024);
+  atlas.update(requests, {});
+  check_layout(atlas);
+  OX_CHECK(atlas.get_dirty_count() == 3);
+}
+
+// A frame that didn't render its dirty views hands their keys back, the indices it saw
+// belong to other lights once priorities reorder the requests.
+OX_TEST(shadow_atlas_invalidate_skipped_views) {
+  auto atlas = ShadowAtlas();
+  atlas.update(std::vector{make_request(0, 512), make_request(1, 512), make_request(2, 512)}, {});
+  atlas.update(std::vector{make_request(0, 512), make_request(1, 512), make_request(2, 512)}, {});
+  OX_CHECK(atlas.get_dirty_count() == 0);
+
+  // The second light moves, its view is dirty at index 1 but the frame is skipped.
+  auto requests = std::vector{make_request(0, 512), make_request(1, 512), make_request(2, 512)};
+  requests[1].view_projection = make_request(4, 512).view_projection;
+  atlas.update(requests, {});
+  OX_CHECK(atlas.get_dirty_count() == 1);
+  OX_CHECK(atlas.get_views()[1].dirty);
+  const auto skipped = atlas.get_views()[1].key;
+
+  // Priorities reorder the requests, the skipped light moves to the front.
+  atlas.invalidate(skipped);
+  atlas.update(std::vector{requests[1], requests[2], requests[0]}, {});
+  check_layout(atlas);
+  OX_CHECK(atlas.get_dirty_count() == 1);
+  OX_CHECK(atlas.get_views()[0].dirty);
+  OX_CHECK(atlas.get_views()[0].key == skipped);
+  OX_CHECK(!atlas.get_views()[1].dirty);
+  OX_CHECK(!atlas.get_views()[2].dirty);
+
+  // Handed back once, rendered once.
+  atlas.update(std::vector{requests[1], requests[2], requests[0]}, {});
+  OX_CHECK(atlas.get_dirty_count() == 0);
+
+  // Keys of views that aren't requested anymore are dropped.
+  atlas.invalidate({.light = 9});
+  atlas.update(std::vector{requests[1], requests[2], requests[0]}, {});
+  OX_CHECK(atlas.get_dirty_count() == 0);
+}
+
+OX_TEST(shadow_atlas_select_resolution_hysteresis) {
+  OX_CHECK(shadow_atlas::select_resolution(1024, 1.0f) == 1024);
+  OX_CHECK(shadow_atlas::select_resolution(1024, 0.5f) == 512);
+  OX_CHECK(shadow_atlas::select_resolution(1024, 0.0f) == shadow_atlas::MIN_RESOLUTION);
+
+  // 0.55 is past the 512 step, but not by the band.
+  OX_CHECK(shadow_atlas::select_resolution(1024, 0.55f, 256, 0.25f) == 256);
+  OX_CHECK(shadow_atlas::select_resolution(1024, 0.7f, 256, 0.25f) == 512);
+  // 0.45 is below it, but 0.45 * 1.25 isn't.
+  OX_CHECK(shadow_atlas::select_resolution(1024, 0.45f, 512, 0.25f) == 512);
+  OX_CHECK(shadow_atlas::select_resolution(1024, 0.3f, 512, 0.25f) == 256);
+  // A lower maximum always wins.
+  OX_CHECK(shadow_atlas::select_resolution(256, 1.0f, 512, 0.25f) == 256);
+}
+} // namespace ox
@@ -0,0 +1,143 @@
+#include "Test.hpp"
+
+#include <cstdlib>
+#include <sol/sol.hpp>
+
+#include "Scripting/LuaAllocator.hpp"
+
+#ifdef OX_LUA_BINDINGS
+  #include "Scripting/LuaMathBindings.hpp"
+#endif
+
+namespace ox {
+// Plain malloc backed `lua_Alloc` that counts, the baseline for `LuaAllocator`.
+struct CountingLuaAllocator {
+  u64 allocation_count = 0;
+
+  static auto lua_alloc(void* user_data, void* ptr, usize old_size, usize new_size) -> void* {
+    auto* self = static_cast<CountingLuaAllocator*>(user_data);
+    if (new_size == 0) {
+      std::free(ptr);
+      return nullptr;
+    }
+
+    self->allocation_count += 1;
+    return std::realloc(ptr, new_size);
+  }
+};
+
+constexpr static auto CHURN_SCRIPT = R"(
+local keep = {}
+for i = 1, 2000 do
+  local t = { i, tostring(i), { x = i } }
+  keep[i % 100 + 1] = t
+  -- Grows through several size classes and onto the heap.
+  local s = string.rep("x", i % 600)
+  keep[i % 7 + 200] = s
+end
+return #keep
+)";
+
+OX_TEST(lua_allocator_returns_everything) {
+  auto allocator = LuaAllocator();
+  {
+    auto state = sol::state(sol::default_at_panic, &LuaAllocator::lua_alloc, &allocator);
+    state.open_libraries(sol::lib::base, sol::lib::string, sol::lib::table);
+    OX_CHECK(state.safe_script(CHURN_SCRIPT).valid());
+    state.collect_gc();
+
+    const auto& stats = allocator.get_stats();
+    OX_CHECK(stats.used_bytes > 0);
+    OX_CHECK(stats.peak_bytes >= stats.used_bytes);
+    OX_CHECK(stats.reserved_bytes % LuaAllocator::PAGE_SIZE == 0);
+    // Most allocations are small enough for the pools.
+    OX_CHECK(stats.heap_allocation_count * 4 < stats.allocation_count);
+  }
+
+  // Closing the state frees every block it ever got.
+  OX_CHECK(allocator.get_stats().used_bytes == 0);
+}
+
+OX_TEST(lua_allocator_reuses_freed_blocks) {
+  auto allocator = LuaAllocator();
+  auto state = sol::state(sol::default_at_panic, &LuaAllocator::lua_alloc, &allocator);
+  state.open_libraries(sol::lib::base, sol::lib::string, sol::lib::table);
+  // Only explicit collections, so every run peaks at the same live size.
+  state.stop_gc();
+
+  OX_CHECK(state.safe_script(CHURN_SCRIPT).valid());
+  state.collect_gc();
+  const auto reserved_bytes = allocator.get_stats().reserved_bytes;
+
+  // The same churn again fits into the blocks the collector returned.
+  for (u32 i = 0; i < 4; i++) {
+    OX_CHECK(state.safe_script(CHURN_SCRIPT).valid());
+    state.collect_gc();
+  }
+  OX_CHECK(allocator.get_stats().reserved_bytes == reserved_bytes);
+}
+
+#ifdef OX_LUA_BINDINGS
+// Integrates a point for `iterations` steps, with operators that return new vectors or with
+// the in place methods.
+constexpr static auto OPERATOR_SCRIPT = R"(
+return function(iterations)
+  local p, v, a = Vec3.new(0, 0, 0), Vec3.new(1, 2, 3), Vec3.new(0, -9.8, 0)
+  local dt = 1 / 60
+  for i = 1, iterations do
+    v = v + a * dt
+    p = p + v * dt
+  end
+  return p.y
+end
+)";
+
+constexpr static auto IN_PLACE_SCRIPT = R"(
+return function(iterations)
+  local p, v, a = Vec3.new(0, 0, 0), Vec3.new(1, 2, 3), Vec3.new(0, -9.8, 0)
+  local dt = 1 / 60
+  for i = 1, iterations do
+    v:add_scaled(a, dt)
+    p:add_scaled(v, dt)
+  end
+  return p.y
+end
+)";
+
+// Vector math in a script loop: allocations per iteration and time, on the malloc baseline and
+// on `LuaAllocator`, with operators and with the in place methods.
+OX_BENCHMARK(lua_math_allocations) {
+  constexpr auto ITERATIONS = 1'000'000_u32;
+
+  const auto run = [&](const char* allocator_name, lua_Alloc alloc, void* user_data, auto&& get_allocation_count) {
+    for (const auto& [style, script] : {std::pair("operators", OPERATOR_SCRIPT), std::pair("in place", IN_PLACE_SCRIPT)}) {
+      auto state = sol::state(sol::default_at_panic, alloc, user_data);
+      state.open_libraries(sol::lib::base, sol::lib::math);
+      LuaBindings::bind_math(&state);
+      const sol::protected_function integrate = state.script(script);
+      integrate(1000);
+
+      const auto allocations_before = get_allocation_count();
+      const auto start = test::now_millis();
+      const auto result = integrate(ITERATIONS);
+      const auto millis = test::now_millis() - start;
+      OX_CHECK(result.valid());
+      const auto allocations = get_allocation_count() - allocations_before;
+
+      fmt::println("  {:<14} {:<9}: {:>8.2f} ms, {:.2f} allocations per iteration",
+                   allocator_name,
+                   style,
+                   millis,
+                   static_cast<f64>(allocations) / ITERATIONS);
+    }
+  };
+
+  auto counting = CountingLuaAllocator();
+  run("malloc", &CountingLuaAllocator::lua_alloc, &counting, [&] { return counting.allocation_count; });
+
+  auto pooled = LuaAllocator();
+  run("LuaAllocator", &LuaAllocator::lua_alloc, &pooled, [&] { return pooled.get_stats().allocation_count; });
+  fmt::println("  LuaAllocator heap allocations: {}", pooled.get_stats().heap_allocation_count);
+}
+#endif
+} // namespace ox
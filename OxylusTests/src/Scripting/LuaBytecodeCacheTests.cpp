@@ -0,0 +1,59 @@
+#include "Test.hpp"
+
+#include <sol/sol.hpp>
+#include <string>
+#include <vector>
+
+#include "Scripting/LuaBytecodeCache.hpp"
+
+namespace ox {
+constexpr static auto TEST_SOURCE = std::string_view("local a = 20\nreturn a + 22\n");
+
+static auto compile(std::string_view source) -> std::string {
+  auto state = sol::state();
+  const sol::protected_function chunk = state.load(source, "@test", sol::load_mode::text);
+  return std::string(chunk.dump().as_string_view());
+}
+
+OX_TEST(lua_bytecode_cache_round_trip) {
+  const auto bytecode = compile(TEST_SOURCE);
+  const auto file = lua_bytecode_cache::encode(TEST_SOURCE, bytecode);
+  const auto decoded = lua_bytecode_cache::decode(file, TEST_SOURCE);
+  OX_CHECK(decoded == bytecode);
+
+  // The decoded chunk loads and runs.
+  auto state = sol::state();
+  auto result = state.load_buffer(decoded.data(), decoded.size(), "@test", sol::load_mode::binary);
+  OX_CHECK(result.valid());
+  const sol::protected_function chunk = result;
+  OX_CHECK(chunk().get<i32>() == 42);
+}
+
+OX_TEST(lua_bytecode_cache_rejects_invalid_files) {
+  const auto bytecode = compile(TEST_SOURCE);
+  const auto file = lua_bytecode_cache::encode(TEST_SOURCE, bytecode);
+
+  // Source edited since the file was written, same size and different size.
+  OX_CHECK(lua_bytecode_cache::decode(file, "local a = 20\nreturn a + 23\n").empty());
+  OX_CHECK(lua_bytecode_cache::decode(file, "return 42\n").empty());
+
+  // Any flipped byte, in the header or the bytecode.
+  for (usize i = 0; i < file.size(); i++) {
+    auto corrupted = file;
+    corrupted[i] ^= 0x10_u8;
+    OX_CHECK(lua_bytecode_cache::decode(corrupted, TEST_SOURCE).empty());
+  }
+
+  // Truncated anywhere, or with trailing bytes.
+  for (usize size = 0; size < file.size(); size++) {
+    OX_CHECK(lua_bytecode_cache::decode(std::span(file).first(size), TEST_SOURCE).empty());
+  }
+  auto extended = file;
+  extended.push_back(0);
+  OX_CHECK(lua_bytecode_cache::decode(extended, TEST_SOURCE).empty());
+
+  // Raw bytecode without a header, as older caches stored it.
+  const auto raw = std::vector<u8>(bytecode.begin(), bytecode.end());
+  OX_CHECK(lua_bytecode_cache::decode(raw, TEST_SOURCE).empty());
+}
+} // namespace ox
@@ -0,0 +1,182 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <sol/sol.hpp>
+#include <vector>
+
+#include "Scripting/LuaAllocator.hpp"
+#include "Scripting/LuaConfig.hpp"
+#include "Scripting/LuaGC.hpp"
+
+namespace ox {
+// Keeps `live` small tables alive and makes `garbage` new ones every call.
+constexpr static auto FRAME_SCRIPT = R"(
+local live = {}
+return function(live_count, garbage)
+  for i = #live + 1, live_count do
+    live[i] = { i, x = i * 0.5 }
+  end
+  local sum = 0
+  for i = 1, garbage do
+    local t = { i, name = "g" .. (i % 64) }
+    sum = sum + t[1]
+  end
+  return sum
+end
+)";
+
+struct LuaGCTestState {
+  LuaAllocator allocator = {};
+  sol::state state;
+  sol::protected_function frame;
+
+  LuaGCTestState() : state(sol::default_at_panic, &LuaAllocator::lua_alloc, &allocator) {
+    state.open_libraries(sol::lib::base, sol::lib::string, sol::lib::table);
+    frame = state.script(FRAME_SCRIPT);
+  }
+};
+
+// Sets the gc cvars for one scope.
+struct LuaGCSettingsScope {
+  f32 budget_ms = LuaCVar::cvar_gc_budget_ms.get();
+  i32 generational = LuaCVar::cvar_gc_generational.get();
+
+  LuaGCSettingsScope(f32 budget_ms_, bool generational_) {
+    LuaCVar::cvar_gc_budget_ms.set(budget_ms_);
+    LuaCVar::cvar_gc_generational.set(generational_ ? 1 : 0);
+  }
+
+  ~LuaGCSettingsScope() {
+    LuaCVar::cvar_gc_budget_ms.set(budget_ms);
+    LuaCVar::cvar_gc_generational.set(generational);
+  }
+};
+
+OX_TEST(lua_gc_time_slices) {
+  const auto settings = LuaGCSettingsScope(0.0f, false);
+  auto test_state = LuaGCTestState();
+  auto gc = LuaGC(test_state.state.lua_state(), &test_state.allocator);
+  OX_CHECK(!gc.get_stats().generational);
+
+  // Lua doesn't collect on its own anymore, garbage piles up until `step`.
+  OX_CHECK(test_state.frame(1000, 20000).valid());
+  const auto heap_bytes = test_state.allocator.get_stats().used_bytes;
+
+  // With no budget every frame takes exactly one step until the cycle is done.
+  auto frames = 0_u32;
+  while (gc.get_stats().cycle_count == 0) {
+    gc.step();
+    OX_CHECK(gc.get_stats().last_frame_steps == 1);
+    frames += 1;
+    OX_CHECK(frames < 100'000);
+  }
+  OX_CHECK(frames > 1);
+  OX_CHECK(gc.get_stats().heap_bytes < heap_bytes);
+
+  // Nothing to do until the heap grew by the pause again.
+  gc.step();
+  OX_CHECK(gc.get_stats().last_frame_steps == 0);
+}
+
+OX_TEST(lua_gc_full_request) {
+  const auto settings = LuaGCSettingsScope(0.0f, false);
+  auto test_state = LuaGCTestState();
+  auto gc = LuaGC(test_state.state.lua_state(), &test_state.allocator);
+
+  OX_CHECK(test_state.frame(1000, 20000).valid());
+  const auto heap_bytes = test_state.allocator.get_stats().used_bytes;
+
+  gc.request_full_gc();
+  gc.step();
+  OX_CHECK(gc.get_stats().cycle_count == 1);
+  OX_CHECK(gc.get_stats().last_frame_steps == 1);
+  OX_CHECK(gc.get_stats().heap_bytes < heap_bytes);
+
+  // The request only holds for one step.
+  gc.step();
+  OX_CHECK(gc.get_stats().cycle_count == 1);
+}
+
+OX_TEST(lua_gc_switches_mode) {
+  const auto settings = LuaGCSettingsScope(1.0f, true);
+  auto test_state = LuaGCTestState();
+  auto gc = LuaGC(test_state.state.lua_state(), &test_state.allocator);
+#if LUA_VERSION_NUM >= 504
+  OX_CHECK(gc.get_stats().generational);
+
+  // A minor collection once the heap grew by `lua.gc_minor_kb`.
+  OX_CHECK(test_state.frame(0, 50000).valid());
+  gc.step();
+  OX_CHECK(gc.get_stats().cycle_count == 1);
+
+  LuaCVar::cvar_gc_generational.set(0);
+  gc.step();
+  OX_CHECK(!gc.get_stats().generational);
+#else
+  OX_CHECK(!gc.get_stats().generational);
+#endif
+}
+
+// Frame times of a script that keeps a large live set and makes garbage every frame, with the
+// collector run in different ways. Worst frame is what shows up as a hitch.
+OX_BENCHMARK(lua_gc_frame_times) {
+  constexpr auto FRAMES = 600_u32;
+  constexpr auto LIVE_COUNT = 300'000_u32;
+  constexpr auto GARBAGE = 5000_u32;
+
+  const auto run = [&](const char* name, auto&& setup, auto&& end_frame) {
+    auto test_state = LuaGCTestState();
+    OX_CHECK(test_state.frame(LIVE_COUNT, 0).valid());
+    setup(test_state);
+
+    auto frame_millis = std::vector<f64>();
+    frame_millis.reserve(FRAMES);
+    for (u32 frame = 0; frame < FRAMES; frame++) {
+      const auto start = test::now_millis();
+      test_state.frame(LIVE_COUNT, GARBAGE);
+      end_frame(test_state, frame);
+      frame_millis.emplace_back(test::now_millis() - start);
+    }
+
+    auto total_millis = 0.0;
+    for (const auto millis : frame_millis) {
+      total_millis += millis;
+    }
+    std::ranges::sort(frame_millis);
+    fmt::println("  {:<22}: avg {:.3f} ms, p99 {:.3f} ms, worst {:.3f} ms, heap {} KiB",
+                 name,
+                 total_millis / FRAMES,
+                 frame_millis[FRAMES * 99 / 100],
+                 frame_millis.back(),
+                 test_state.allocator.get_stats().used_bytes / 1024);
+  };
+
+  const auto no_setup = [](LuaGCTestState&) {};
+  const auto no_end_frame = [](LuaGCTestState&, u32) {};
+  run("lua incremental", no_setup, no_end_frame);
+
+  // What a collect in the middle of gameplay costs, once a second.
+  run(
+      "full collection",
+      [](LuaGCTestState& test_state) { test_state.state.stop_gc(); },
+      [](LuaGCTestState& test_state, u32 frame) {
+        if (frame % 60 == 59)
+          test_state.state.collect_gc();
+      });
+
+  for (const auto generational : {false, true}) {
+    const auto settings = LuaGCSettingsScope(1.0f, generational);
+    auto gc = std::unique_ptr<LuaGC>();
+    run(
+        generational ? "LuaGC generational" : "LuaGC time sliced 1ms",
+        [&](LuaGCTestState& test_state) {
+          gc = std::make_unique<LuaGC>(test_state.state.lua_state(), &test_state.allocator);
+        },
+        [&](LuaGCTestState&, u32) { gc->step(); });
+    fmt::println("  {:<22}  {} cycles, worst gc step {:.3f} ms",
+                 "",
+                 gc->get_stats().cycle_count,
+                 gc->get_stats().max_frame_millis);
+  }
+}
+} // namespace ox
@@ -0,0 +1,233 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <flecs.h>
+#include <sol/sol.hpp>
+#include <vector>
+
+#include "Scripting/LuaAllocator.hpp"
+#include "Scripting/LuaProfiler.hpp"
+#include "Scripting/LuaQuery.hpp"
+
+namespace ox {
+struct TestPosition {
+  f32 x = 0.0f;
+  f32 y = 0.0f;
+  f32 z = 0.0f;
+};
+
+struct TestVelocity {
+  f32 x = 0.0f;
+  f32 y = 0.0f;
+  f32 z = 0.0f;
+};
+
+struct TestMoved {};
+
+struct TestQueryWorld {
+  flecs::world world = {};
+  // Only used for layouts, which don't need a scene.
+  LuaQueryCache cache = LuaQueryCache(nullptr);
+  std::unique_ptr<LuaQuery> query = nullptr;
+
+  explicit TestQueryWorld(u32 entity_count) {
+    world.component<TestPosition>("TestPosition").member<f32>("x").member<f32>("y").member<f32>("z");
+    world.component<TestVelocity>("TestVelocity").member<f32>("x").member<f32>("y").member<f32>("z");
+    world.component<TestMoved>("TestMoved");
+
+    // Every other entity has the tag, so the query matches two tables.
+    for (u32 i = 0; i < entity_count; i++) {
+      auto entity = world.entity();
+      entity.set<TestPosition>({});
+      entity.set<TestVelocity>({1.0f, 2.0f, 3.0f});
+      if (i % 2 == 0)
+        entity.add<TestMoved>();
+    }
+
+    query = std::make_unique<LuaQuery>(
+        world,
+        std::vector{cache.get_layout(world.component<TestPosition>()), cache.get_layout(world.component<TestVelocity>())});
+  }
+};
+
+OX_TEST(lua_query_mark_modified_is_deferred) {
+  auto fixture = TestQueryWorld(1000);
+  fixture.world.remove_all<TestMoved>();
+
+  auto iterating = false;
+  auto event_count = 0_u32;
+  auto events_during_iteration = 0_u32;
+  // Moves the entity to another table, which would invalidate the open chunk.
+  auto observer = fixture.world.observer<TestPosition>()
+                      .event(flecs::OnSet)
+                      .each([&](flecs::entity entity, TestPosition&) {
+    event_count += 1;
+    events_during_iteration += iterating ? 1 : 0;
+    entity.add<TestMoved>();
+  });
+
+  auto chunk_count = 0_u32;
+  fixture.query->each_chunk([&](const LuaQueryChunk& chunk) {
+    iterating = true;
+    const auto x = chunk.column(1, "x");
+    for (u32 i = 1; i <= x.count; i++) {
+      *x.at<f32>(i) += 1.0f;
+    }
+    chunk.mark_modified(1);
+    iterating = false;
+
+    chunk_count += 1;
+    return true;
+  });
+
+  OX_CHECK(chunk_count == 1);
+  OX_CHECK(events_during_iteration == 0);
+  OX_CHECK(event_count == 1000);
+  OX_CHECK(fixture.world.count<TestMoved>() == 1000);
+  // Every row was written exactly once.
+  fixture.world.each([](const TestPosition& position) { OX_CHECK(position.x == 1.0f); });
+
+  observer.destruct();
+}
+
+OX_TEST(lua_query_each_chunk_stops_early) {
+  auto fixture = TestQueryWorld(100);
+  auto chunk_count = 0_u32;
+  fixture.query->each_chunk([&](const LuaQueryChunk&) {
+    chunk_count += 1;
+    return false;
+  });
+
+  OX_CHECK(chunk_count == 1);
+  // The world isn't left deferred.
+  OX_CHECK(!fixture.world.is_deferred());
+}
+
+constexpr static auto UPDATE_SCRIPT = R"(
+return function(query, dt)
+  query:each_chunk(function(chunk)
+    local px, py, pz = chunk:column(1, "x"), chunk:column(1, "y"), chunk:column(1, "z")
+    local vx, vy, vz = chunk:column(2, "x"), chunk:column(2, "y"), chunk:column(2, "z")
+    for i = 1, chunk:count() do
+      px:set_number(i, px:get_number(i) + vx:get_number(i) * dt)
+      py:set_number(i, py:get_number(i) + vy:get_number(i) * dt)
+      pz:set_number(i, pz:get_number(i) + vz:get_number(i) * dt)
+    end
+    chunk:mark_modified(1)
+  end)
+end
+)";
+
+constexpr static auto COUNT_SCRIPT = R"(
+return function(query, max_chunks)
+  local chunks, entities = 0, 0
+  query:each_chunk(function(chunk)
+    chunks = chunks + 1
+    entities = entities + chunk:count()
+    return chunks < max_chunks
+  end)
+  return chunks, entities
+end
+)";
+
+OX_TEST(lua_query_script_iterates_chunks) {
+  auto fixture = TestQueryWorld(100);
+  auto state = sol::state();
+  state.open_libraries(sol::lib::base);
+  bind_lua_query_types(&state);
+  const sol::protected_function count = state.script(COUNT_SCRIPT);
+
+  // Both tables, every entity once.
+  const std::tuple<u32, u32> all = count(fixture.query.get(), 16);
+  OX_CHECK(std::get<0>(all) == 2);
+  OX_CHECK(std::get<1>(all) == 100);
+
+  // Returning false from the chunk function stops after the first table.
+  const std::tuple<u32, u32> first = count(fixture.query.get(), 1);
+  OX_CHECK(std::get<0>(first) == 1);
+  OX_CHECK(std::get<1>(first) == 50);
+  OX_CHECK(!fixture.world.is_deferred());
+}
+
+OX_TEST(lua_query_script_update_is_profiled) {
+  constexpr auto ENTITY_COUNT = 100_u32;
+  constexpr auto FRAMES = 4_u32;
+  const auto script_name = std::string("query_update.lua");
+
+  auto fixture = TestQueryWorld(ENTITY_COUNT);
+  auto event_count = 0_u32;
+  auto observer = fixture.world.observer<TestPosition>()
+                      .event(flecs::OnSet)
+                      .each([&](TestPosition&) { event_count += 1; });
+
+  auto allocator = LuaAllocator();
+  auto state = sol::state(sol::default_at_panic, &LuaAllocator::lua_alloc, &allocator);
+  state.open_libraries(sol::lib::base, sol::lib::math);
+  bind_lua_query_types(&state);
+  const sol::protected_function update = state.script(UPDATE_SCRIPT, script_name);
+
+  // Small interval so a few hundred rows are sampled.
+  auto profiler = LuaProfiler();
+  profiler.start(state.lua_state(), &allocator, 10);
+  for (u32 frame = 0; frame < FRAMES; frame++) {
+    const auto scope = LuaProfiler::Scope(&profiler, script_name);
+    OX_CHECK(update(fixture.query.get(), 0.5f).valid());
+  }
+  profiler.stop();
+
+  // Every row of both tables moved by its velocity once per frame.
+  fixture.world.each([](const TestPosition& position) {
+    OX_CHECK(position.x == 0.5f * FRAMES);
+    OX_CHECK(position.y == 1.0f * FRAMES);
+    OX_CHECK(position.z == 1.5f * FRAMES);
+  });
+  OX_CHECK(event_count == ENTITY_COUNT * FRAMES);
+
+  const auto scripts = profiler.get_scripts();
+  OX_CHECK(scripts.size() == 1);
+  OX_CHECK(scripts[0].script == script_name);
+  OX_CHECK(scripts[0].calls == FRAMES);
+
+  // Samples land in the script, most of them on the column loop.
+  const auto lines = profiler.get_lines();
+  OX_CHECK(!lines.empty());
+  OX_CHECK(std::ranges::all_of(lines, [&](const LuaProfileLine& line) {
+    return line.script == script_name && line.source.contains(script_name);
+  }));
+  OX_CHECK(std::ranges::any_of(lines, [](const LuaProfileLine& line) { return line.line >= 6 && line.line <= 9; }));
+
+  observer.destruct();
+}
+
+// One script update over every entity through chunk columns, with the OnSet events it emits.
+OX_BENCHMARK(lua_query_script_update) {
+  for (const auto entity_count : {10'000_u32, 100'000_u32}) {
+    auto fixture = TestQueryWorld(entity_count);
+    auto event_count = 0_u64;
+    auto observer = fixture.world.observer<TestPosition>()
+                        .event(flecs::OnSet)
+                        .each([&](TestPosition&) { event_count += 1; });
+
+    auto state = sol::state();
+    state.open_libraries(sol::lib::base, sol::lib::math);
+    bind_lua_query_types(&state);
+    const sol::protected_function update = state.script(UPDATE_SCRIPT);
+
+    constexpr auto FRAMES = 16;
+    const auto start = test::now_millis();
+    for (u32 frame = 0; frame < FRAMES; frame++) {
+      const auto result = update(fixture.query.get(), 1.0f / 60.0f);
+      OX_CHECK(result.valid());
+    }
+    const auto frame_millis = (test::now_millis() - start) / FRAMES;
+
+    OX_CHECK(event_count == static_cast<u64>(entity_count) * FRAMES);
+    fmt::println("  {:>6} entities: {:.3f} ms per update ({:.0f} entities/ms)",
+                 entity_count,
+                 frame_millis,
+                 static_cast<f64>(entity_count) / frame_millis);
+
+    observer.destruct();
+  }
+}
+} // namespace ox
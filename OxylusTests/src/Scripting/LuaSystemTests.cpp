@@ -0,0 +1,242 @@
+#include "Test.hpp"
+
+#include <flecs.h>
+#include <map>
+#include <sol/sol.hpp>
+#include <vector>
+
+#include "Scripting/LuaSystem.hpp"
+
+namespace ox {
+struct ScriptTestPosition {
+  f32 x = 0.0f;
+  f32 y = 0.0f;
+};
+
+struct ScriptTestVelocity {
+  f32 x = 0.0f;
+  f32 y = 0.0f;
+};
+
+// Entities with a position and velocity, and a Lua state where scripts reach them through
+// plain functions instead of the scene's component bindings.
+struct ScriptTestWorld {
+  flecs::world world = {};
+  std::vector<flecs::entity> entities = {};
+  sol::state state;
+  u32 on_update_calls = 0;
+  u32 on_update_batch_calls = 0;
+  u32 on_init_calls = 0;
+  std::map<std::string, u32> load_counts = {};
+
+  explicit ScriptTestWorld(u32 entity_count) {
+    for (u32 i = 0; i < entity_count; i++) {
+      auto entity = world.entity();
+      entity.set<ScriptTestPosition>({static_cast<f32>(i), 0.0f});
+      entity.set<ScriptTestVelocity>({static_cast<f32>(i % 7), 1.0f + static_cast<f32>(i % 3)});
+      entities.emplace_back(entity);
+    }
+
+    state.open_libraries(sol::lib::base, sol::lib::math, sol::lib::table);
+    state.set_function("get_position", [](flecs::entity entity) {
+      const auto* position = entity.get<ScriptTestPosition>();
+      return std::make_tuple(position->x, position->y);
+    });
+    state.set_function("get_velocity", [](flecs::entity entity) {
+      const auto* velocity = entity.get<ScriptTestVelocity>();
+      return std::make_tuple(velocity->x, velocity->y);
+    });
+    state.set_function("set_position",
+                       [](flecs::entity entity, f32 x, f32 y) { entity.set<ScriptTestPosition>({x, y}); });
+    state.set_function("count_on_update", [this] { on_update_calls += 1; });
+    state.set_function("count_on_update_batch", [this] { on_update_batch_calls += 1; });
+    state.set_function("count_on_init", [this] { on_init_calls += 1; });
+    state.set_function("count_load", [this](const std::string& name) { load_counts[name] += 1; });
+  }
+
+  auto get_positions() const -> std::vector<f32> {
+    auto positions = std::vector<f32>();
+    for (const auto entity : entities) {
+      const auto* position = entity.get<ScriptTestPosition>();
+      positions.insert(positions.end(), {position->x, position->y});
+    }
+    return positions;
+  }
+};
+
+constexpr static auto PER_ENTITY_SCRIPT = R"(
+function on_update(dt)
+  local x, y = get_position(this)
+  local vx, vy = get_velocity(this)
+  set_position(this, x + vx * dt, y + vy * dt)
+end
+)";
+
+constexpr static auto BATCH_SCRIPT = R"(
+function on_update_batch(entities, dt)
+  for i = 1, #entities do
+    local e = entities[i]
+    local x, y = get_position(e)
+    local vx, vy = get_velocity(e)
+    set_position(e, x + vx * dt, y + vy * dt)
+  end
+end
+)";
+
+// Both entry points, `on_update` would zero every position.
+constexpr static auto BOTH_SCRIPT = R"(
+function on_update(dt)
+  count_on_update()
+  set_position(this, 0, 0)
+end
+
+function on_update_batch(entities, dt)
+  count_on_update_batch()
+  for i = 1, #entities do
+    local e = entities[i]
+    local x, y = get_position(e)
+    local vx, vy = get_velocity(e)
+    set_position(e, x + vx * dt, y + vy * dt)
+  end
+end
+)";
+
+// Counts its loads under its own name. The helpers only make compiling cost about what a
+// gameplay script does.
+static auto get_startup_script(u32 index) -> std::string {
+  auto source = fmt::format("count_load(\"script_{}\")\n", index);
+  for (u32 i = 0; i < 50; i++) {
+    source += fmt::format("local function helper_{}(x) return x * {} + math.sin(x) end\n", i, i);
+  }
+  source += "function on_init()\n  count_on_init()\nend\n";
+  return source;
+}
+
+// `count` entities spread over `scripts` in turn, like a scene with a few shared scripts.
+static auto get_script_instances(const ScriptTestWorld& fixture,
+                                 const std::vector<std::unique_ptr<LuaSystem>>& scripts,
+                                 u32 count) -> std::vector<std::pair<LuaSystem*, flecs::entity>> {
+  auto instances = std::vector<std::pair<LuaSystem*, flecs::entity>>();
+  for (u32 i = 0; i < count; i++) {
+    instances.emplace_back(scripts[i % scripts.size()].get(), fixture.entities[i]);
+  }
+  return instances;
+}
+
+static auto make_startup_scripts(ScriptTestWorld& fixture, u32 count) -> std::vector<std::unique_ptr<LuaSystem>> {
+  auto scripts = std::vector<std::unique_ptr<LuaSystem>>();
+  for (u32 i = 0; i < count; i++) {
+    scripts.emplace_back(
+        std::make_unique<LuaSystem>(fixture.state, fmt::format("script_{}.lua", i), get_startup_script(i)));
+  }
+  fixture.load_counts.clear();
+  return scripts;
+}
+
+OX_TEST(lua_scripts_start_loads_each_script_once) {
+  constexpr auto SCRIPT_COUNT = 3_u32;
+  auto fixture = ScriptTestWorld(300);
+  const auto scripts = make_startup_scripts(fixture, SCRIPT_COUNT);
+  const auto instances = get_script_instances(fixture, scripts, 300);
+
+  OX_CHECK(LuaSystem::start_scripts(nullptr, instances, 0.0f) == SCRIPT_COUNT);
+  OX_CHECK(fixture.load_counts.size() == SCRIPT_COUNT);
+  for (const auto& [name, count] : fixture.load_counts) {
+    OX_CHECK(count == 1);
+  }
+  OX_CHECK(fixture.on_init_calls == 300);
+}
+
+OX_TEST(lua_script_batch_matches_per_entity) {
+  constexpr auto FRAMES = 5_u32;
+
+  auto per_entity = ScriptTestWorld(100);
+  auto per_entity_script = LuaSystem(per_entity.state, "per_entity.lua", PER_ENTITY_SCRIPT);
+  OX_CHECK(!per_entity_script.has_batch_update());
+
+  auto batch = ScriptTestWorld(100);
+  auto batch_script = LuaSystem(batch.state, "batch.lua", BATCH_SCRIPT);
+  OX_CHECK(batch_script.has_batch_update());
+
+  for (u32 frame = 0; frame < FRAMES; frame++) {
+    per_entity_script.update_entities(nullptr, per_entity.entities, 1.0f / 60.0f);
+    batch_script.update_entities(nullptr, batch.entities, 1.0f / 60.0f);
+  }
+
+  OX_CHECK(per_entity.get_positions() == batch.get_positions());
+  OX_CHECK(per_entity.get_positions() != ScriptTestWorld(100).get_positions());
+}
+
+OX_TEST(lua_script_batch_update_takes_precedence) {
+  auto both = ScriptTestWorld(10);
+  auto both_script = LuaSystem(both.state, "both.lua", BOTH_SCRIPT);
+  auto batch = ScriptTestWorld(10);
+  auto batch_script = LuaSystem(batch.state, "batch.lua", BATCH_SCRIPT);
+
+  both_script.update_entities(nullptr, both.entities, 0.5f);
+  batch_script.update_entities(nullptr, batch.entities, 0.5f);
+
+  OX_CHECK(both.on_update_calls == 0);
+  OX_CHECK(both.on_update_batch_calls == 1);
+  OX_CHECK(both.get_positions() == batch.get_positions());
+}
+
+// Same script logic over ~10k entities, one Lua call per entity against one call per script.
+OX_BENCHMARK(lua_script_batch_update) {
+  constexpr auto ENTITY_COUNT = 10'000_u32;
+  constexpr auto FRAMES = 32_u32;
+
+  const auto measure = [&](const char* source) {
+    auto fixture = ScriptTestWorld(ENTITY_COUNT);
+    auto script = LuaSystem(fixture.state, "bench.lua", source);
+    script.update_entities(nullptr, fixture.entities, 1.0f / 60.0f);
+
+    const auto start = test::now_millis();
+    for (u32 frame = 0; frame < FRAMES; frame++) {
+      script.update_entities(nullptr, fixture.entities, 1.0f / 60.0f);
+    }
+    return (test::now_millis() - start) / FRAMES;
+  };
+
+  const auto per_entity_millis = measure(PER_ENTITY_SCRIPT);
+  const auto batch_millis = measure(BATCH_SCRIPT);
+  fmt::println("  {} entities: on_update {:.3f} ms ({:.0f} entities/ms), on_update_batch {:.3f} ms "
+               "({:.0f} entities/ms), {:.1f}x",
+               ENTITY_COUNT,
+               per_entity_millis,
+               ENTITY_COUNT / per_entity_millis,
+               batch_millis,
+               ENTITY_COUNT / batch_millis,
+               per_entity_millis / batch_millis);
+}
+
+// Scene start with many entities sharing a few scripts, reloading a script for every entity
+// that uses it against once per script.
+OX_BENCHMARK(lua_scripts_start) {
+  constexpr auto SCRIPT_COUNT = 4_u32;
+
+  for (const auto entity_count : {100_u32, 1'000_u32, 10'000_u32}) {
+    auto fixture = ScriptTestWorld(entity_count);
+    const auto scripts = make_startup_scripts(fixture, SCRIPT_COUNT);
+    const auto instances = get_script_instances(fixture, scripts, entity_count);
+
+    const auto per_entity_start = test::now_millis();
+    for (const auto& [script, entity] : instances) {
+      script->reload();
+      script->on_init(nullptr, entity, 0.0f);
+    }
+    const auto per_entity_millis = test::now_millis() - per_entity_start;
+
+    const auto once_start = test::now_millis();
+    LuaSystem::start_scripts(nullptr, instances, 0.0f);
+    const auto once_millis = test::now_millis() - once_start;
+
+    fmt::println("  {:>5} entities, {} scripts: reload per entity {:.3f} ms, once per script {:.3f} ms, {:.1f}x",
+                 entity_count,
+                 SCRIPT_COUNT,
+                 per_entity_millis,
+                 once_millis,
+                 per_entity_millis / once_millis);
+  }
+}
+} // namespace ox
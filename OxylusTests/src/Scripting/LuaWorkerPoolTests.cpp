@@ -0,0 +1,176 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <sol/sol.hpp>
+#include <thread>
+#include <vector>
+
+#include "Scripting/LuaAllocator.hpp"
+
+#ifdef OX_LUA_BINDINGS
+  #include "Scripting/LuaMathBindings.hpp"
+#endif
+
+namespace ox {
+// `LuaWorkerPool` needs a scene and the app's task scheduler, these run the same setup on plain
+// threads: one state per thread with its own allocator, the script loaded from bytecode into an
+// environment and `on_update` called once per job.
+constexpr static auto ISOLATED_SCRIPT = std::string_view(R"(
+local positions = {}
+function on_update(entity, dt)
+  local p = positions[entity] or entity
+  for i = 1, 100 do
+    p = p + math.sin(p + i * dt) * dt
+  end
+  positions[entity] = p
+  return p
+end
+)");
+
+struct IsolatedTestWorker {
+  // Must outlive the state.
+  std::unique_ptr<LuaAllocator> allocator = std::make_unique<LuaAllocator>();
+  std::unique_ptr<sol::state> state = nullptr;
+  std::unique_ptr<sol::environment> environment = nullptr;
+  sol::protected_function on_update = {};
+
+  explicit IsolatedTestWorker(std::string_view bytecode) {
+    state = std::make_unique<sol::state>(sol::default_at_panic, &LuaAllocator::lua_alloc, allocator.get());
+    state->open_libraries(sol::lib::base, sol::lib::math, sol::lib::table, sol::lib::string);
+#ifdef OX_LUA_BINDINGS
+    LuaBindings::bind_math(state.get());
+#endif
+
+    environment = std::make_unique<sol::environment>(*state, sol::create, state->globals());
+    sol::protected_function chunk = state->load(bytecode, "@isolated", sol::load_mode::binary);
+    sol::set_environment(*environment, chunk);
+    chunk();
+    on_update = (*environment)["on_update"];
+  }
+
+  auto run(u32 job, f32 delta_time) -> f64 { return on_update(job, delta_time).get<f64>(); }
+};
+
+static auto compile_isolated_script() -> std::string {
+  auto state = sol::state();
+  const sol::protected_function chunk = state.load(ISOLATED_SCRIPT, "@isolated", sol::load_mode::text);
+  return std::string(chunk.dump().as_string_view());
+}
+
+// Splits `job_count` jobs into one contiguous range per thread, like the task set does.
+template <typename F>
+static auto run_on_threads(u32 thread_count, u32 job_count, F&& f) -> void {
+  auto threads = std::vector<std::thread>();
+  const auto jobs_per_thread = (job_count + thread_count - 1) / thread_count;
+  for (u32 t = 0; t < thread_count; t++) {
+    const auto begin = std::min(t * jobs_per_thread, job_count);
+    const auto end = std::min(begin + jobs_per_thread, job_count);
+    threads.emplace_back([&f, t, begin, end] { f(t, begin, end); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+OX_TEST(lua_isolated_workers_match_single_state) {
+  constexpr auto JOBS = 257_u32;
+  constexpr auto FRAMES = 3_u32;
+  const auto bytecode = compile_isolated_script();
+
+  auto expected = std::vector<f64>(JOBS);
+  auto single = IsolatedTestWorker(bytecode);
+  for (u32 frame = 0; frame < FRAMES; frame++) {
+    for (u32 job = 0; job < JOBS; job++) {
+      expected[job] = single.run(job, 1.0f / 60.0f);
+    }
+  }
+
+  // Each entity always lands on the same worker here, so its script state carries over frames.
+  for (const auto thread_count : {1_u32, 2_u32, 5_u32}) {
+    auto workers = std::vector<std::unique_ptr<IsolatedTestWorker>>();
+    for (u32 t = 0; t < thread_count; t++) {
+      workers.emplace_back(std::make_unique<IsolatedTestWorker>(bytecode));
+    }
+
+    auto results = std::vector<f64>(JOBS);
+    for (u32 frame = 0; frame < FRAMES; frame++) {
+      run_on_threads(thread_count, JOBS, [&](u32 t, u32 begin, u32 end) {
+        for (u32 job = begin; job < end; job++) {
+          results[job] = workers[t]->run(job, 1.0f / 60.0f);
+        }
+      });
+    }
+    OX_CHECK(results == expected);
+  }
+}
+
+// Isolated script throughput with 1 to hardware_concurrency workers, against every thread
+// sharing the main state behind a lock.
+OX_BENCHMARK(lua_isolated_script_scaling) {
+  constexpr auto JOBS = 8192_u32;
+  constexpr auto FRAMES = 10_u32;
+  const auto bytecode = compile_isolated_script();
+  const auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  auto thread_counts = std::vector<u32>();
+  for (u32 count = 1; count < max_threads; count *= 2) {
+    thread_counts.emplace_back(count);
+  }
+  thread_counts.emplace_back(max_threads);
+
+  auto isolated_base_millis = 0.0;
+  for (const auto thread_count : thread_counts) {
+    auto workers = std::vector<std::unique_ptr<IsolatedTestWorker>>();
+    for (u32 t = 0; t < thread_count; t++) {
+      workers.emplace_back(std::make_unique<IsolatedTestWorker>(bytecode));
+    }
+
+    auto sums = std::vector<f64>(thread_count);
+    const auto run_frame = [&] {
+      run_on_threads(thread_count, JOBS, [&](u32 t, u32 begin, u32 end) {
+        // Summed locally, neighbouring slots share a cache line.
+        auto sum = 0.0;
+        for (u32 job = begin; job < end; job++) {
+          sum += workers[t]->run(job, 1.0f / 60.0f);
+        }
+        sums[t] += sum;
+      });
+    };
+    run_frame();
+    const auto start = test::now_millis();
+    for (u32 frame = 0; frame < FRAMES; frame++) {
+      run_frame();
+    }
+    const auto isolated_millis = (test::now_millis() - start) / FRAMES;
+
+    auto shared = IsolatedTestWorker(bytecode);
+    auto shared_mutex = std::mutex();
+    const auto shared_start = test::now_millis();
+    for (u32 frame = 0; frame < FRAMES; frame++) {
+      run_on_threads(thread_count, JOBS, [&](u32 t, u32 begin, u32 end) {
+        auto sum = 0.0;
+        for (u32 job = begin; job < end; job++) {
+          auto lock = std::unique_lock(shared_mutex);
+          sum += shared.run(job, 1.0f / 60.0f);
+        }
+        sums[t] += sum;
+      });
+    }
+    const auto shared_millis = (test::now_millis() - shared_start) / FRAMES;
+    test::do_not_optimize(sums.data());
+
+    if (thread_count == 1)
+      isolated_base_millis = isolated_millis;
+
+    fmt::println("  {:>3} threads: isolated {:.3f} ms ({:.0f} jobs/ms, {:.2f}x), "
+                 "shared state {:.3f} ms ({:.0f} jobs/ms)",
+                 thread_count,
+                 isolated_millis,
+                 JOBS / isolated_millis,
+                 isolated_base_millis / isolated_millis,
+                 shared_millis,
+                 JOBS / shared_millis);
+  }
+}
+} // namespace ox
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include "Core/Types.hpp"
+
+namespace ox::test {
+struct Case {
+  const c8* name = nullptr;
+  void (*function)() = nullptr;
+  bool benchmark = false;
+};
+
+auto register_case(const Case& test_case) -> bool;
+auto report_failure(const c8* file, i32 line, const c8* expression) -> void;
+
+extern const volatile void* sink;
+
+// Keeps the optimizer from dropping a result that is only computed for a benchmark.
+template <typename T>
+auto do_not_optimize(const T& value) -> void {
+  sink = &value;
+}
+
+auto now_millis() -> f64;
+} // namespace ox::test
+
+#define OX_TEST_CASE(name, benchmark)                                                                        \
+  static void name();                                                                                        \
+  [[maybe_unused]] static const bool name##_registered = ox::test::register_case({#name, name, benchmark}); \
+  static void name()
+
+// Unit test, runs with every `xmake test`.
+#define OX_TEST(name) OX_TEST_CASE(name, false)
+// Only runs with `--bench`, prints its own measurements.
+#define OX_BENCHMARK(name) OX_TEST_CASE(name, true)
+
+#define OX_CHECK(expression)                                     \
+  do {                                                           \
+    if (!(expression))                                           \
+      ox::test::report_failure(__FILE__, __LINE__, #expression); \
+  } while (false)
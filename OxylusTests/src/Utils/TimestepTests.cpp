@@ -0,0 +1,149 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Utils/Timestep.hpp"
+
+namespace ox {
+struct PacingResult {
+  f64 median_error = 0.0;
+  f64 p99_error = 0.0;
+  f64 max_error = 0.0;
+  // Per frame.
+  f64 sleep_time = 0.0;
+  f64 spin_time = 0.0;
+};
+
+static auto measure_pacing(f64 fps, u32 frame_count) -> PacingResult {
+  auto timestep = Timestep{};
+  timestep.set_max_frame_time(fps);
+  // The first frame starts from the timer creation, skip it.
+  timestep.on_update();
+
+  auto errors = std::vector<f64>{};
+  auto result = PacingResult{};
+  for (u32 i = 0; i < frame_count; i++) {
+    timestep.on_update();
+    errors.push_back(timestep.get_pacing_error_millis());
+    result.sleep_time += timestep.get_sleep_millis();
+    result.spin_time += timestep.get_spin_millis();
+  }
+
+  std::ranges::sort(errors);
+  result.median_error = errors[errors.size() / 2];
+  result.p99_error = errors[errors.size() * 99 / 100];
+  result.max_error = errors.back();
+  result.sleep_time /= frame_count;
+  result.spin_time /= frame_count;
+
+  return result;
+}
+
+// Simulated time for the frame limiter. The OS sleep wakes up `overshoot` late and every clock
+// read costs `read_cost`, so spinning moves time forward like it does on a real timer.
+struct FakeFrameClock {
+  f64 time = 0.0;
+  f64 overshoot = 0.0;
+  f64 read_cost = 0.001;
+  u32 sleep_count = 0;
+
+  auto get_clock() -> Timestep::Clock {
+    return {
+        .now =
+            [this] {
+              time += read_cost;
+              return time;
+            },
+        .sleep =
+            [this](f64 millis) {
+              time += millis + overshoot;
+              sleep_count += 1;
+            },
+    };
+  }
+};
+
+static auto run_frames(Timestep& timestep, u32 frame_count) -> void {
+  for (u32 i = 0; i < frame_count; i++) {
+    timestep.on_update();
+  }
+}
+
+OX_TEST(timestep_learns_sleep_overshoot) {
+  auto fake_clock = FakeFrameClock{.overshoot = 0.8};
+  auto timestep = Timestep(fake_clock.get_clock());
+  timestep.set_max_frame_time(120.0);
+
+  // The initial estimate is below the real overshoot, the first frames start late.
+  timestep.on_update();
+  OX_CHECK(timestep.get_pacing_error_millis() > Timestep::PACING_TOLERANCE_MILLIS);
+
+  // Once it converged the sleep ends where the frame should start, nothing is left to spin.
+  run_frames(timestep, 256);
+  for (u32 i = 0; i < 16; i++) {
+    timestep.on_update();
+    OX_CHECK(timestep.get_pacing_error_millis() <= Timestep::PACING_TOLERANCE_MILLIS);
+    OX_CHECK(timestep.get_spin_millis() <= Timestep::PACING_TOLERANCE_MILLIS);
+    OX_CHECK(timestep.get_sleep_millis() >= timestep.get_max_frame_time() - Timestep::PACING_TOLERANCE_MILLIS);
+  }
+}
+
+OX_TEST(timestep_spins_through_early_wake_up) {
+  // A sleep waking up on time, the estimated overshoot is spun and the frame still lands on target.
+  auto fake_clock = FakeFrameClock{.overshoot = 0.0};
+  auto timestep = Timestep(fake_clock.get_clock());
+  timestep.set_max_frame_time(120.0);
+
+  timestep.on_update();
+  OX_CHECK(timestep.get_pacing_error_millis() <= Timestep::PACING_TOLERANCE_MILLIS);
+  OX_CHECK(timestep.get_spin_millis() > 0.0);
+  OX_CHECK(timestep.get_spin_millis() <= Timestep::MAX_SPIN_MILLIS);
+}
+
+OX_TEST(timestep_caps_spin_on_late_wake_up) {
+  // A scheduler waking up later than `MAX_SPIN_MILLIS` shows up as pacing error instead of
+  // the limiter spinning longer.
+  auto fake_clock = FakeFrameClock{.overshoot = 5.0};
+  auto timestep = Timestep(fake_clock.get_clock());
+  timestep.set_max_frame_time(60.0);
+
+  run_frames(timestep, 256);
+  timestep.on_update();
+  const auto expected_error = fake_clock.overshoot - Timestep::MAX_SPIN_MILLIS;
+  OX_CHECK(std::abs(timestep.get_pacing_error_millis() - expected_error) <= Timestep::PACING_TOLERANCE_MILLIS);
+  OX_CHECK(timestep.get_spin_millis() == 0.0);
+}
+
+OX_TEST(timestep_skips_sleep_on_slow_frame) {
+  auto fake_clock = FakeFrameClock{};
+  auto timestep = Timestep(fake_clock.get_clock());
+  timestep.set_max_frame_time(120.0);
+  timestep.on_update();
+
+  // The frame's work already took longer than the frame time.
+  const auto sleep_count = fake_clock.sleep_count;
+  fake_clock.time += 20.0;
+  timestep.on_update();
+  OX_CHECK(fake_clock.sleep_count == sleep_count);
+  OX_CHECK(timestep.get_sleep_millis() == 0.0);
+  OX_CHECK(timestep.get_spin_millis() == 0.0);
+  OX_CHECK(timestep.get_millis() >= 20.0);
+}
+
+// Pacing on the real timer and OS sleep, depends on the machine's scheduler so it is only reported.
+OX_BENCHMARK(timestep_frame_pacing) {
+  for (const auto fps : {30.0, 60.0, 144.0, 240.0}) {
+    const auto result = measure_pacing(fps, static_cast<u32>(fps * 2.0));
+    fmt::println("  {:>3.0f} fps: error median {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms, "
+                 "sleep {:.3f} ms, spin {:.3f} ms per frame",
+                 fps,
+                 result.median_error,
+                 result.p99_error,
+                 result.max_error,
+                 result.sleep_time,
+                 result.spin_time);
+  }
+}
+} // namespace ox
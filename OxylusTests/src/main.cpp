@@ -0,0 +1,68 @@
+#include "Test.hpp"
+
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+namespace ox::test {
+const volatile void* sink = nullptr;
+
+static auto get_cases() -> std::vector<Case>& {
+  static std::vector<Case> cases = {};
+  return cases;
+}
+
+static i32 failure_count = 0;
+
+auto register_case(const Case& test_case) -> bool {
+  get_cases().push_back(test_case);
+  return true;
+}
+
+auto report_failure(const c8* file, i32 line, const c8* expression) -> void {
+  fmt::println("  {}:{}: check failed: {}", file, line, expression);
+  failure_count += 1;
+}
+
+auto now_millis() -> f64 {
+  using Clock = std::chrono::steady_clock;
+  static const auto start = Clock::now();
+  return std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+}
+} // namespace ox::test
+
+// OxylusTests [--bench] [filter]
+// Runs the unit tests, or the benchmarks with `--bench`. `filter` keeps the cases whose name contains it.
+auto main(int argc, char** argv) -> int {
+  auto benchmark = false;
+  auto filter = std::string_view{};
+  for (int i = 1; i < argc; i++) {
+    const auto arg = std::string_view(argv[i]);
+    if (arg == "--bench")
+      benchmark = true;
+    else
+      filter = arg;
+  }
+
+  auto run_count = 0;
+  auto failed_count = 0;
+  for (const auto& test_case : ox::test::get_cases()) {
+    if (test_case.benchmark != benchmark || !std::string_view(test_case.name).contains(filter))
+      continue;
+
+    fmt::println("[ RUN  ] {}", test_case.name);
+    const auto failures_before = ox::test::failure_count;
+    const auto start = ox::test::now_millis();
+    test_case.function();
+    const auto duration = ox::test::now_millis() - start;
+
+    const auto passed = ox::test::failure_count == failures_before;
+    fmt::println("[ {} ] {} ({:.1f} ms)", passed ? " OK " : "FAIL", test_case.name, duration);
+    run_count += 1;
+    failed_count += passed ? 0 : 1;
+  }
+
+  fmt::println("{} of {} {} passed", run_count - failed_count, run_count, benchmark ? "benchmarks" : "tests");
+
+  return failed_count == 0 ? 0 : 1;
+}
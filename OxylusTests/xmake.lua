@@ -0,0 +1,14 @@
+target("OxylusTests")
+    set_kind("binary")
+    set_languages("cxx23")
+    set_default(false)
+
+    add_includedirs("./src")
+    add_files("./src/**.cpp")
+
+    add_deps("Oxylus")
+
+    -- `xmake test` runs the unit tests, benchmarks run with `xmake run OxylusTests --bench [filter]`.
+    add_tests("default")
+
+target_end()
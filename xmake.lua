@@ -32,3 +32,4 @@ includes("xmake/toolchains.lua")
 
 includes("Oxylus")
 includes("OxylusEditor")
+includes("OxylusTests")